@@ -0,0 +1,288 @@
+#include "animation/animation_clip.hpp"
+
+#include "core/simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		// Above this cosine the keys are nearly parallel: slerp's 1/sin(theta) loses precision and nlerp
+		// is indistinguishable from it.
+		constexpr float kNlerpThreshold = 0.9995F;
+
+#if TRANSFORMER_HAS_SSE2
+		using Float4 = __m128;
+
+		Float4 set(float x, float y, float z, float w)
+		{
+			return _mm_setr_ps(x, y, z, w);
+		}
+
+		Float4 splat(float value)
+		{
+			return _mm_set1_ps(value);
+		}
+
+		Float4 add(Float4 a, Float4 b)
+		{
+			return _mm_add_ps(a, b);
+		}
+
+		Float4 sub(Float4 a, Float4 b)
+		{
+			return _mm_sub_ps(a, b);
+		}
+
+		Float4 mul(Float4 a, Float4 b)
+		{
+			return _mm_mul_ps(a, b);
+		}
+
+		void store(Float4 value, float* lanes)
+		{
+			_mm_storeu_ps(lanes, value);
+		}
+
+		float dot4(Float4 a, Float4 b)
+		{
+			const __m128 products = _mm_mul_ps(a, b);
+			__m128 shuffled = _mm_shuffle_ps(products, products, _MM_SHUFFLE(2, 3, 0, 1));
+			__m128 sums = _mm_add_ps(products, shuffled);
+			shuffled = _mm_movehl_ps(shuffled, sums);
+			sums = _mm_add_ss(sums, shuffled);
+			return _mm_cvtss_f32(sums);
+		}
+#else
+		struct Float4
+		{
+			float lanes[4];
+		};
+
+		Float4 set(float x, float y, float z, float w)
+		{
+			return {{x, y, z, w}};
+		}
+
+		Float4 splat(float value)
+		{
+			return {{value, value, value, value}};
+		}
+
+		Float4 add(Float4 a, Float4 b)
+		{
+			return {{a.lanes[0] + b.lanes[0], a.lanes[1] + b.lanes[1], a.lanes[2] + b.lanes[2],
+					 a.lanes[3] + b.lanes[3]}};
+		}
+
+		Float4 sub(Float4 a, Float4 b)
+		{
+			return {{a.lanes[0] - b.lanes[0], a.lanes[1] - b.lanes[1], a.lanes[2] - b.lanes[2],
+					 a.lanes[3] - b.lanes[3]}};
+		}
+
+		Float4 mul(Float4 a, Float4 b)
+		{
+			return {{a.lanes[0] * b.lanes[0], a.lanes[1] * b.lanes[1], a.lanes[2] * b.lanes[2],
+					 a.lanes[3] * b.lanes[3]}};
+		}
+
+		void store(Float4 value, float* lanes)
+		{
+			std::copy(value.lanes, value.lanes + 4, lanes);
+		}
+
+		// Same pairing as the SSE shuffle version, so both round identically.
+		float dot4(Float4 a, Float4 b)
+		{
+			const Float4 products = mul(a, b);
+			return (products.lanes[0] + products.lanes[1]) + (products.lanes[2] + products.lanes[3]);
+		}
+#endif
+
+		Float4 load(const Quat& q)
+		{
+			return set(q.x, q.y, q.z, q.w);
+		}
+
+		Float4 load(const Vec3& v)
+		{
+			return set(v.x, v.y, v.z, 0.0F);
+		}
+
+		Quat to_quat(Float4 value)
+		{
+			float lanes[4];
+			store(value, lanes);
+			return {lanes[0], lanes[1], lanes[2], lanes[3]};
+		}
+
+		Vec3 to_vec3(Float4 value)
+		{
+			float lanes[4];
+			store(value, lanes);
+			return {lanes[0], lanes[1], lanes[2]};
+		}
+
+		Float4 negate(Float4 value)
+		{
+			return sub(splat(0.0F), value);
+		}
+
+		Float4 lerp(Float4 a, Float4 b, float t)
+		{
+			return add(a, mul(sub(b, a), splat(t)));
+		}
+
+		Float4 normalize(Float4 q)
+		{
+			return mul(q, splat(1.0F / std::sqrt(dot4(q, q))));
+		}
+
+		Float4 slerp(Float4 a, Float4 b, float t)
+		{
+			float cosine = dot4(a, b);
+			// Take the short way round.
+			if (cosine < 0.0F)
+			{
+				b = negate(b);
+				cosine = -cosine;
+			}
+
+			if (cosine > kNlerpThreshold)
+			{
+				return normalize(lerp(a, b, t));
+			}
+
+			const float theta = std::acos(cosine);
+			const float inverse_sine = 1.0F / std::sin(theta);
+			const Float4 weight_a = splat(std::sin((1.0F - t) * theta) * inverse_sine);
+			const Float4 weight_b = splat(std::sin(t * theta) * inverse_sine);
+			return add(mul(a, weight_a), mul(b, weight_b));
+		}
+
+	}  // namespace
+
+	BoneTransform sample_track(const BoneTrack& track, float time)
+	{
+		if (time <= track.times.front())
+		{
+			return track.keys.front();
+		}
+		if (time >= track.times.back())
+		{
+			return track.keys.back();
+		}
+
+		// times[next - 1] <= time < times[next]
+		const auto next = static_cast<std::size_t>(
+				std::upper_bound(track.times.begin(), track.times.end(), time) - track.times.begin());
+		const BoneTransform& a = track.keys[next - 1];
+		const BoneTransform& b = track.keys[next];
+		const float t = (time - track.times[next - 1]) / (track.times[next] - track.times[next - 1]);
+		if (t == 0.0F)
+		{
+			return a;
+		}
+
+		return {
+				.translation = to_vec3(lerp(load(a.translation), load(b.translation), t)),
+				.rotation = to_quat(slerp(load(a.rotation), load(b.rotation), t)),
+				.scale = to_vec3(lerp(load(a.scale), load(b.scale), t)),
+		};
+	}
+
+	Mat4 to_matrix(const BoneTransform& transform)
+	{
+		const Quat& q = transform.rotation;
+		const float xx = q.x * q.x;
+		const float yy = q.y * q.y;
+		const float zz = q.z * q.z;
+		const float xy = q.x * q.y;
+		const float xz = q.x * q.z;
+		const float yz = q.y * q.z;
+		const float wx = q.w * q.x;
+		const float wy = q.w * q.y;
+		const float wz = q.w * q.z;
+
+		const Vec3& s = transform.scale;
+		const Vec3& t = transform.translation;
+		// Column-major: rotation columns scaled per axis, translation in the last column.
+		return Mat4{{
+				(1.0F - 2.0F * (yy + zz)) * s.x, 2.0F * (xy + wz) * s.x, 2.0F * (xz - wy) * s.x, 0.0F,  //
+				2.0F * (xy - wz) * s.y, (1.0F - 2.0F * (xx + zz)) * s.y, 2.0F * (yz + wx) * s.y, 0.0F,  //
+				2.0F * (xz + wy) * s.z, 2.0F * (yz - wx) * s.z, (1.0F - 2.0F * (xx + yy)) * s.z, 0.0F,  //
+				t.x, t.y, t.z, 1.0F,
+		}};
+	}
+
+	void evaluate_pose(
+			const std::vector<ClipLayer>& layers,
+			float time,
+			const std::vector<Mat4>& base_pose,
+			std::vector<Mat4>& pose)
+	{
+		pose.assign(base_pose.begin(), base_pose.end());
+
+		for (std::size_t bone = 0; bone < base_pose.size(); ++bone)
+		{
+			BoneTransform single;
+			std::size_t layer_count = 0;
+			float total_weight = 0.0F;
+			Float4 translation = splat(0.0F);
+			Float4 rotation = splat(0.0F);
+			Float4 scale = splat(0.0F);
+			Float4 first_rotation = splat(0.0F);
+
+			for (const ClipLayer& layer : layers)
+			{
+				if (layer.weight <= 0.0F || bone >= layer.clip->tracks.size() || layer.clip->tracks[bone].keys.empty())
+				{
+					continue;
+				}
+
+				const BoneTransform sample = sample_track(layer.clip->tracks[bone], time);
+				Float4 sample_rotation = load(sample.rotation);
+				if (layer_count == 0)
+				{
+					single = sample;
+					first_rotation = sample_rotation;
+				}
+				else if (dot4(first_rotation, sample_rotation) < 0.0F)
+				{
+					// q and -q are the same rotation; blend in one hemisphere.
+					sample_rotation = negate(sample_rotation);
+				}
+
+				const Float4 weight = splat(layer.weight);
+				translation = add(translation, mul(load(sample.translation), weight));
+				rotation = add(rotation, mul(sample_rotation, weight));
+				scale = add(scale, mul(load(sample.scale), weight));
+				total_weight += layer.weight;
+				++layer_count;
+			}
+
+			if (layer_count == 0)
+			{
+				continue;
+			}
+			if (layer_count == 1)
+			{
+				pose[bone] = to_matrix(single);
+				continue;
+			}
+
+			const Float4 inverse_weight = splat(1.0F / total_weight);
+			pose[bone] = to_matrix({
+					.translation = to_vec3(mul(translation, inverse_weight)),
+					.rotation = to_quat(normalize(rotation)),
+					.scale = to_vec3(mul(scale, inverse_weight)),
+			});
+		}
+	}
+
+}  // namespace transformer
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core/math_types.hpp"
+
+#include <string>
+#include <vector>
+
+namespace transformer
+{
+
+	struct Quat
+	{
+		float x = 0.0F;
+		float y = 0.0F;
+		float z = 0.0F;
+		float w = 1.0F;
+	};
+
+	// Decomposed bone transform. Keys are in the same (model) space as the --new-pose matrices.
+	struct BoneTransform
+	{
+		Vec3 translation{};
+		Quat rotation{};
+		Vec3 scale{1.0F, 1.0F, 1.0F};
+	};
+
+	// Keyframes of one bone, sorted by time. Tracks are sparse: a bone without keys is not animated.
+	struct BoneTrack
+	{
+		std::vector<float> times;
+		std::vector<BoneTransform> keys;
+	};
+
+	struct AnimationClip
+	{
+		std::string name;
+		// Indexed by bone; may be shorter than the skeleton.
+		std::vector<BoneTrack> tracks;
+	};
+
+	struct ClipLayer
+	{
+		const AnimationClip* clip = nullptr;
+		float weight = 1.0F;
+	};
+
+	// Samples a track at time (clamped to the first/last key): lerp for translation and scale, slerp for
+	// rotation (nlerp when the keys are nearly parallel). Sampling exactly on a key returns that key.
+	[[nodiscard]]
+	BoneTransform sample_track(const BoneTrack& track, float time);
+
+	// Column-major translation * rotation * scale.
+	[[nodiscard]]
+	Mat4 to_matrix(const BoneTransform& transform);
+
+	// Evaluates and blends the clip layers at time into one matrix per bone. For every bone the layers
+	// that animate it are blended with their weights renormalized (weighted lerp, quaternion nlerp with
+	// the sign aligned to the first layer); bones no layer animates keep their base_pose matrix.
+	void evaluate_pose(
+			const std::vector<ClipLayer>& layers,
+			float time,
+			const std::vector<Mat4>& base_pose,
+			std::vector<Mat4>& pose);
+
+}  // namespace transformer
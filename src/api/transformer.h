@@ -0,0 +1,81 @@
+#ifndef TRANSFORMER_H
+#define TRANSFORMER_H
+
+// C API of transformer_core for in-process skinning. Vertex, weight and palette buffers belong to the caller
+// and are used where they are, without copies. Functions return a transformer_status; after a failure,
+// transformer_last_error() describes it. A skinner may be used from several threads; calls that split over
+// its skinning threads take turns.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+	#define TRANSFORMER_API __attribute__((visibility("default")))
+#else
+	#define TRANSFORMER_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Raised when a function or struct of this header changes incompatibly.
+#define TRANSFORMER_API_VERSION 1
+
+// Matrices in a palette. Unused influence slots (bone index -1) read the last one, which must stay zero.
+#define TRANSFORMER_PALETTE_SIZE 256
+
+typedef enum transformer_status
+{
+	TRANSFORMER_OK = 0,
+	TRANSFORMER_INVALID_ARGUMENT = 1,
+	TRANSFORMER_ERROR = 2
+} transformer_status;
+
+// One vertex, laid out like the library's own: skinning writes position and leaves the rest alone.
+// Weights of one vertex sum to 1; slots past the used ones have bone index -1 and weight 0.
+typedef struct transformer_vertex
+{
+	float position[3];
+	int8_t bone_indices[4];
+	float weights[4];
+} transformer_vertex;
+
+typedef struct transformer_skinner transformer_skinner;
+
+TRANSFORMER_API uint32_t transformer_api_version(void);
+
+// Message of the last failed call on this thread; empty if there was none.
+TRANSFORMER_API const char* transformer_last_error(void);
+
+// kernel: as --kernel ("auto", "fastest", "avx2", ...); NULL means "auto". threads: skinning threads,
+// including the calling one; 0 means one per hardware thread.
+TRANSFORMER_API transformer_status transformer_skinner_create(
+		const char* kernel, size_t threads, transformer_skinner** skinner);
+
+TRANSFORMER_API void transformer_skinner_destroy(transformer_skinner* skinner);
+
+// Name of the kernel variant the skinner runs, e.g. "avx2". Valid as long as the library is loaded.
+TRANSFORMER_API const char* transformer_skinner_kernel(const transformer_skinner* skinner);
+
+// Writes the TRANSFORMER_PALETTE_SIZE column-major 4x4 matrices of palette: new_pose * inverse_bind_pose
+// for each of bone_count bones (at most 255), zero for the rest.
+TRANSFORMER_API transformer_status transformer_build_palette(
+		const float* inverse_bind_pose, const float* new_pose, size_t bone_count, float* palette);
+
+// Skins count vertices of source into result (which may be source) with palette, as built by
+// transformer_build_palette. max_influences (1 to 4) is the number of leading weight slots any vertex
+// uses; fewer skip work.
+TRANSFORMER_API transformer_status transformer_skin(
+		transformer_skinner* skinner,
+		const float* palette,
+		const transformer_vertex* source,
+		transformer_vertex* result,
+		size_t count,
+		size_t max_influences);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
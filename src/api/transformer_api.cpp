@@ -0,0 +1,171 @@
+#include "api/transformer.h"
+
+#include "core/chunk_threads.hpp"
+#include "core/math_utils.hpp"
+#include "skinning/kernels/kernel_registry.hpp"
+#include "skinning/mesh_skinner.hpp"
+#include "skinning/skinning_kernel.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+
+struct transformer_skinner
+{
+	transformer::MeshSkinner skinner;
+	// nullptr when skinning on the calling thread only.
+	std::unique_ptr<transformer::ChunkThreads> threads;
+};
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		// Caller buffers are used as the library's own types, so their layouts have to match exactly.
+		static_assert(sizeof(transformer_vertex) == sizeof(Mesh::Entry));
+		static_assert(offsetof(transformer_vertex, position) == offsetof(Mesh::Entry, vertex));
+		static_assert(
+				offsetof(transformer_vertex, bone_indices)
+				== offsetof(Mesh::Entry, bone_weights) + offsetof(VertexBoneWeights, bone_indices));
+		static_assert(
+				offsetof(transformer_vertex, weights)
+				== offsetof(Mesh::Entry, bone_weights) + offsetof(VertexBoneWeights, weights));
+		static_assert(sizeof(SkinningPalette) == TRANSFORMER_PALETTE_SIZE * sizeof(Mat4));
+		static_assert(sizeof(Mat4) == 16 * sizeof(float) && alignof(Mat4) == alignof(float));
+
+		thread_local std::string last_error;
+
+		transformer_status fail(transformer_status status, const char* message)
+		{
+			last_error = message;
+			return status;
+		}
+
+		// Exceptions must not cross the C boundary.
+		template <class Function>
+		transformer_status guarded(Function&& function)
+		{
+			try
+			{
+				return function();
+			}
+			catch (const std::exception& ex)
+			{
+				return fail(TRANSFORMER_ERROR, ex.what());
+			}
+			catch (...)
+			{
+				return fail(TRANSFORMER_ERROR, "Unknown error");
+			}
+		}
+
+		Mat4 read_matrix(const float* values)
+		{
+			Mat4 matrix;
+			std::memcpy(matrix.m.data(), values, sizeof(matrix.m));
+			return matrix;
+		}
+
+	}  // namespace
+
+}  // namespace transformer
+
+// Declared extern "C" by the header, so these keep C linkage.
+
+uint32_t transformer_api_version()
+{
+	return TRANSFORMER_API_VERSION;
+}
+
+const char* transformer_last_error()
+{
+	return transformer::last_error.c_str();
+}
+
+transformer_status transformer_skinner_create(const char* kernel, size_t threads, transformer_skinner** skinner)
+{
+	using namespace transformer;
+	if (skinner == nullptr)
+	{
+		return fail(TRANSFORMER_INVALID_ARGUMENT, "skinner is null");
+	}
+	return guarded(
+			[&]
+			{
+				const SkinningKernel& found = find_skinning_kernel(kernel != nullptr ? kernel : "");
+				auto created = std::make_unique<transformer_skinner>(transformer_skinner{MeshSkinner(found), {}});
+				if (threads != 1)
+				{
+					created->threads = std::make_unique<ChunkThreads>(threads);
+				}
+				*skinner = created.release();
+				return TRANSFORMER_OK;
+			});
+}
+
+void transformer_skinner_destroy(transformer_skinner* skinner)
+{
+	delete skinner;
+}
+
+const char* transformer_skinner_kernel(const transformer_skinner* skinner)
+{
+	return skinner != nullptr ? skinner->skinner.kernel_name() : "";
+}
+
+transformer_status transformer_build_palette(
+		const float* inverse_bind_pose, const float* new_pose, size_t bone_count, float* palette)
+{
+	using namespace transformer;
+	if (inverse_bind_pose == nullptr || new_pose == nullptr || palette == nullptr)
+	{
+		return fail(TRANSFORMER_INVALID_ARGUMENT, "A pose or the palette is null");
+	}
+	if (bone_count >= TRANSFORMER_PALETTE_SIZE)
+	{
+		return fail(TRANSFORMER_INVALID_ARGUMENT, "At most 255 bones fit a palette");
+	}
+	auto* matrices = reinterpret_cast<Mat4*>(palette);
+	for (std::size_t bone = 0; bone < bone_count; ++bone)
+	{
+		matrices[bone]
+				= multiply(read_matrix(new_pose + bone * 16), read_matrix(inverse_bind_pose + bone * 16));
+	}
+	for (std::size_t bone = bone_count; bone < TRANSFORMER_PALETTE_SIZE; ++bone)
+	{
+		matrices[bone] = Mat4{};
+	}
+	return TRANSFORMER_OK;
+}
+
+transformer_status transformer_skin(
+		transformer_skinner* skinner,
+		const float* palette,
+		const transformer_vertex* source,
+		transformer_vertex* result,
+		size_t count,
+		size_t max_influences)
+{
+	using namespace transformer;
+	if (skinner == nullptr || palette == nullptr || (count != 0 && (source == nullptr || result == nullptr)))
+	{
+		return fail(TRANSFORMER_INVALID_ARGUMENT, "The skinner, palette or a vertex buffer is null");
+	}
+	if (max_influences < 1 || max_influences > kMaxInfluences)
+	{
+		return fail(TRANSFORMER_INVALID_ARGUMENT, "max_influences must be 1 to 4");
+	}
+	return guarded(
+			[&]
+			{
+				skinner->skinner.skin_entries(
+						*reinterpret_cast<const SkinningPalette*>(palette),
+						reinterpret_cast<const Mesh::Entry*>(source), reinterpret_cast<Mesh::Entry*>(result), count,
+						max_influences, skinner->threads.get());
+				return TRANSFORMER_OK;
+			});
+}
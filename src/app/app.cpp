@@ -1,31 +1,183 @@
 #include "app/app.hpp"
 
+#include "app/frame_pipeline.hpp"
+#include "core/mesh_utils.hpp"
 #include "core/profiler.hpp"
+#include "core/weight_validation.hpp"
+#include "io/vertex_cache_writer.hpp"
+#include "skinning/determinism_check.hpp"
+#include "skinning/incremental_skinner.hpp"
+#include "skinning/mesh_optimizer.hpp"
+#include "skinning/skinning_cache.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <exception>
+#include <filesystem>
+#include <future>
 #include <iostream>
+#include <optional>
 #include <stdexcept>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace transformer
 {
 
+	namespace
+	{
+
+		// Double buffered: one frame is skinned while the previous one is written.
+		constexpr std::size_t kPipelineBuffers = 2;
+
+	}  // namespace
+
+	std::string frame_output_path(const std::string& output_file, std::size_t frame, std::size_t frame_count)
+	{
+		if (frame_count <= 1)
+		{
+			return output_file;
+		}
+		std::filesystem::path path(output_file);
+		const std::string extension = path.extension().string();
+		path.replace_filename(path.stem().string() + "_" + std::to_string(frame) + extension);
+		return path.string();
+	}
+
+	std::vector<ClipLayer> make_clip_layers(
+			const std::vector<const AnimationClip*>& clips,
+			const std::vector<ClipInput>& clip_inputs,
+			std::size_t bone_count)
+	{
+		std::vector<ClipLayer> layers;
+		for (std::size_t i = 0; i < clips.size(); ++i)
+		{
+			const AnimationClip& clip = *clips[i];
+			if (clip.tracks.size() > bone_count)
+			{
+				const std::string name = clip.name.empty() ? clip_inputs[i].file : clip.name;
+				throw std::runtime_error(
+						"Animation clip '" + name + "' animates bone " + std::to_string(clip.tracks.size() - 1)
+						+ " but the pose has " + std::to_string(bone_count) + " bones");
+			}
+			layers.push_back({.clip = &clip, .weight = clip_inputs[i].weight});
+		}
+		return layers;
+	}
+
 	SkinningApp::SkinningApp(
 			const IMeshReader& mesh_reader,
 			const IBoneWeightsReader& bone_weights_reader,
 			const IBonePoseReader& bone_pose_reader,
+			const IMorphTargetReader& morph_target_reader,
+			const IAnimationClipReader& clip_reader,
 			const IMeshWriter& mesh_writer,
 			const IStatsWriter& stats_writer,
 			const MeshSkinner& mesh_skinner) :
 			mesh_reader_(mesh_reader),
 			bone_weights_reader_(bone_weights_reader),
 			bone_pose_reader_(bone_pose_reader),
+			morph_target_reader_(morph_target_reader),
+			clip_reader_(clip_reader),
 			mesh_writer_(mesh_writer),
 			stats_writer_(stats_writer),
 			mesh_skinner_(mesh_skinner)
 	{}
 
+	SkinningApp::LoadedInputs SkinningApp::load_inputs(const AppInput& input, Profiler& profiler) const
+	{
+		const auto load_start = std::chrono::steady_clock::now();
+
+		// Declared before the futures: if a get() throws, the remaining futures still block in their
+		// destructors until their tasks finish writing here.
+		Profiler mesh_profiler;
+		Profiler weights_profiler;
+		Profiler inverse_bind_pose_profiler;
+		Profiler new_pose_profiler;
+		Profiler morph_profiler;
+		Profiler clip_profiler;
+
+		auto mesh = std::async(std::launch::async, [&] { return mesh_reader_.read(input.mesh_file, mesh_profiler); });
+		auto bone_weights_data = std::async(
+				std::launch::async, [&] { return bone_weights_reader_.read(input.weights_file, weights_profiler); });
+		auto inverse_bind_pose = std::async(
+				std::launch::async,
+				[&]
+				{
+					return bone_pose_reader_.read_matrices(
+							input.inverse_bind_pose_file, inverse_bind_pose_profiler, "read_inverse_bind_pose_json");
+				});
+		auto new_pose = std::async(
+				std::launch::async,
+				[&]
+				{
+					return bone_pose_reader_.read_matrices(
+							input.new_pose_file, new_pose_profiler, "read_new_pose_json");
+				});
+
+		std::future<std::pair<std::vector<MorphTarget>, std::vector<float>>> morphs;
+		if (!input.morph_targets_file.empty())
+		{
+			morphs = std::async(
+					std::launch::async,
+					[&]
+					{
+						std::vector<MorphTarget> targets
+								= morph_target_reader_.read_targets(input.morph_targets_file, morph_profiler);
+						std::vector<float> weights
+								= morph_target_reader_.read_weights(input.morph_weights_file, morph_profiler);
+						return std::make_pair(std::move(targets), std::move(weights));
+					});
+		}
+
+		std::future<std::vector<AnimationClip>> clips;
+		if (!input.clips.empty())
+		{
+			clips = std::async(
+					std::launch::async,
+					[&]
+					{
+						std::vector<AnimationClip> loaded;
+						loaded.reserve(input.clips.size());
+						for (const ClipInput& clip : input.clips)
+						{
+							loaded.push_back(clip_reader_.read(clip.file, clip_profiler));
+						}
+						return loaded;
+					});
+		}
+
+		LoadedInputs inputs{
+				.mesh = mesh.get(),
+				.bone_weights_data = bone_weights_data.get(),
+				.inverse_bind_pose = inverse_bind_pose.get(),
+				.new_pose = new_pose.get(),
+		};
+		if (morphs.valid())
+		{
+			std::tie(inputs.morph_targets, inputs.morph_weights) = morphs.get();
+		}
+		if (clips.valid())
+		{
+			inputs.clips = clips.get();
+		}
+
+		const auto load_end = std::chrono::steady_clock::now();
+
+		// Per-reader stages in a fixed order, then the wall time of the overlapped load: the slowest
+		// reader bounds it, not the sum of all of them.
+		profiler.merge(mesh_profiler);
+		profiler.merge(weights_profiler);
+		profiler.merge(inverse_bind_pose_profiler);
+		profiler.merge(new_pose_profiler);
+		profiler.merge(morph_profiler);
+		profiler.merge(clip_profiler);
+		profiler.record("load_critical_path", std::chrono::duration<double, std::micro>(load_end - load_start).count());
+
+		return inputs;
+	}
+
 	int SkinningApp::run(const AppInput& input) const
 	{
 		Profiler profiler;
@@ -33,63 +185,186 @@ namespace transformer
 
 		try
 		{
-			Mesh source_mesh = mesh_reader_.read(input.mesh_file, profiler);
-			const BoneWeightsData bone_weights_data = bone_weights_reader_.read(input.weights_file, profiler);
+			LoadedInputs inputs = load_inputs(input, profiler);
 
-			if (source_mesh.vertex_count != bone_weights_data.per_vertex_weights.size())
+			Mesh source_mesh = std::move(inputs.mesh);
+			merge_bone_weights(source_mesh, inputs.bone_weights_data);
 			{
-				throw std::runtime_error("Vertex count mismatch between mesh and skinning weights");
+				const auto scope = profiler.stage("validate_weights");
+				const std::size_t renormalized
+						= validate_bone_weights(source_mesh, inputs.inverse_bind_pose.size(), input.weights_policy);
+				if (renormalized != 0)
+				{
+					profiler.add_counter("weights_renormalized", renormalized);
+				}
 			}
 
-			for (std::size_t vertex_index = 0; vertex_index < source_mesh.vertex_count; ++vertex_index)
+			if (inputs.morph_weights.size() != inputs.morph_targets.size())
 			{
-				source_mesh.entries[vertex_index].bone_weights = bone_weights_data.per_vertex_weights[vertex_index];
+				throw std::runtime_error("Morph target count mismatch between targets and weights");
 			}
+			attach_morph_targets(source_mesh, std::move(inputs.morph_targets));
 
-			BonePoseData bone_pose_data;
-			const std::vector<Mat4> inverse_bind_pose = bone_pose_reader_.read_matrices(
-					input.inverse_bind_pose_file, profiler, "read_inverse_bind_pose_json");
-			const std::vector<Mat4> new_pose
-					= bone_pose_reader_.read_matrices(input.new_pose_file, profiler, "read_new_pose_json");
-
-			if (inverse_bind_pose.size() != new_pose.size())
+			if (input.optimize_layout)
 			{
-				throw std::runtime_error("Bone count mismatch between inverse bind pose and new pose");
+				optimize_mesh_layout(source_mesh, profiler);
+			}
+			SkinningCache* const skinning_cache = mesh_skinner_.cache();
+			if (skinning_cache != nullptr && skinning_cache->caches_outputs())
+			{
+				const auto scope = profiler.stage("mesh_content_key");
+				source_mesh.content_key = mesh_content_key(source_mesh);
 			}
 
-			bone_pose_data.bone_poses.reserve(inverse_bind_pose.size());
-			for (std::size_t i = 0; i < inverse_bind_pose.size(); ++i)
+			std::vector<const AnimationClip*> clips;
+			for (const AnimationClip& clip : inputs.clips)
 			{
-				bone_pose_data.bone_poses.push_back({inverse_bind_pose[i], new_pose[i]});
+				clips.push_back(&clip);
 			}
+			const std::vector<ClipLayer> layers = make_clip_layers(clips, input.clips, inputs.new_pose.size());
+			// Without clips the --new-pose matrices are the only frame.
+			const std::size_t frame_count = layers.empty() ? 1 : std::max<std::size_t>(input.sample_times.size(), 1);
 
 			std::vector<double> bench_runs_microseconds;
-			bench_runs_microseconds.reserve(input.bench_runs);
+			bench_runs_microseconds.reserve(input.bench_runs * frame_count);
+
+			std::optional<IncrementalMeshSkinner> incremental_skinner;
+			if (input.incremental)
+			{
+				incremental_skinner.emplace(source_mesh);
+			}
+
+			// Frames are handed to the encoder thread and compressed while the next one is skinned.
+			std::optional<VertexCacheWriter> vertex_cache;
+			if (input.vertex_cache_bits != 0)
+			{
+				vertex_cache.emplace(input.output_mesh_file, frame_count, input.vertex_cache_bits);
+			}
 
-			Mesh skinned_mesh = source_mesh;
-			for (std::size_t run_index = 0; run_index < input.bench_runs; ++run_index)
+			SkinnedBounds unused_bounds;
+			std::vector<SkinnedBounds> frame_bounds(input.bounds == BoundsMode::None ? 0 : frame_count);
+
+			// Several frames to separate files: frame N + 1 is skinned while frame N is written. Not for the
+			// vertex cache, which has its own encoder thread, or the incremental skinner, which updates one
+			// mesh in place from frame to frame.
+			std::optional<FramePipeline> pipeline;
+			if (frame_count > 1 && !vertex_cache.has_value() && !incremental_skinner.has_value())
 			{
-				mesh_skinner_.skin(source_mesh, bone_pose_data, profiler, skinned_mesh);
+				pipeline.emplace(
+						source_mesh,
+						kPipelineBuffers,
+						[this, &input, frame_count](std::size_t frame, const Mesh& mesh, Profiler& write_profiler)
+						{
+							const std::string output_file
+									= frame_output_path(input.output_mesh_file, frame, frame_count);
+							mesh_writer_.write(output_file, mesh, write_profiler);
+						});
+			}
+
+			std::vector<Mat4> frame_pose = inputs.new_pose;
+			Mesh single_mesh = pipeline.has_value() ? Mesh{} : source_mesh;
+			for (std::size_t frame = 0; frame < frame_count; ++frame)
+			{
+				Mesh& skinned_mesh = pipeline.has_value() ? pipeline->acquire() : single_mesh;
+				if (!layers.empty())
+				{
+					const float time = input.sample_times.empty() ? 0.0F : input.sample_times[frame];
+					const auto scope = profiler.stage("evaluate_pose");
+					evaluate_pose(layers, time, inputs.new_pose, frame_pose);
+					profiler.add_counter("poses_evaluated", 1);
+				}
+
+				const BonePoseData bone_pose_data = make_bone_pose_data(inputs.inverse_bind_pose, frame_pose);
 
-				if (input.bench_runs > 1)
+				for (std::size_t run_index = 0; run_index < input.bench_runs; ++run_index)
 				{
-					const std::vector<TimingEntry>& entries = profiler.entries();
-					if (entries.empty() || entries.back().stage != "cpu_skinning")
+					if (incremental_skinner.has_value())
 					{
-						throw std::runtime_error("Internal profiler error: missing cpu_skinning timing entry");
+						const IncrementalUpdateStats update
+								= incremental_skinner->update(bone_pose_data, profiler, skinned_mesh);
+						profiler.add_counter("incremental_updates", 1);
+						profiler.add_counter("incremental_changed_bones", update.changed_bones);
+						profiler.add_counter("incremental_vertices_touched", update.vertices_touched);
+					}
+					else
+					{
+						mesh_skinner_.skin(
+								source_mesh,
+								bone_pose_data,
+								inputs.morph_weights,
+								profiler,
+								skinned_mesh,
+								input.bounds,
+								input.bounds == BoundsMode::None ? unused_bounds : frame_bounds[frame]);
 					}
 
-					bench_runs_microseconds.push_back(entries.back().microseconds);
+					if (input.bench_runs > 1)
+					{
+						const std::vector<TimingEntry>& entries = profiler.entries();
+						if (entries.empty() || entries.back().stage != "cpu_skinning")
+						{
+							throw std::runtime_error("Internal profiler error: missing cpu_skinning timing entry");
+						}
+
+						bench_runs_microseconds.push_back(entries.back().microseconds);
+					}
+				}
+
+				if (vertex_cache.has_value())
+				{
+					const auto scope = profiler.stage("vertex_cache_push");
+					vertex_cache->push(skinned_mesh);
+				}
+				else if (pipeline.has_value())
+				{
+					pipeline->submit(frame);
+				}
+				else
+				{
+					const std::string output_file = frame_output_path(input.output_mesh_file, frame, frame_count);
+					mesh_writer_.write(output_file, skinned_mesh, profiler);
 				}
 			}
 
-			mesh_writer_.write(input.output_mesh_file, skinned_mesh, profiler);
+			if (pipeline.has_value())
+			{
+				pipeline->finish(profiler);
+			}
+
+			std::optional<DeterminismSummary> determinism;
+			if (input.deterministic)
+			{
+				// On the last frame's pose; the fused kernel's result is only compared, never written.
+				const auto scope = profiler.stage("determinism_check");
+				determinism = compare_with_fastest_kernel(
+						mesh_skinner_.kernel(), source_mesh, make_bone_pose_data(inputs.inverse_bind_pose, frame_pose));
+			}
+
+			std::optional<VertexCacheSummary> vertex_cache_summary;
+			if (vertex_cache.has_value())
+			{
+				// Only the encoding that did not overlap with skinning shows up here.
+				const auto scope = profiler.stage("vertex_cache_drain");
+				vertex_cache_summary = vertex_cache->finish();
+			}
 
 			const auto total_end = std::chrono::steady_clock::now();
 			const auto total_us = std::chrono::duration<double, std::micro>(total_end - total_start).count();
 			profiler.record("total", total_us);
+			if (skinning_cache != nullptr)
+			{
+				skinning_cache->add_counters(profiler);
+			}
 
-			StatsReport report{.stages = profiler.entries()};
+			StatsReport report{
+					.stages = profiler.entries(),
+					.counters = profiler.counters(),
+					.vertex_cache = vertex_cache_summary,
+					.determinism = determinism,
+					.bounds = std::move(frame_bounds),
+					.kernel = incremental_skinner.has_value() ? IncrementalMeshSkinner::kKernelName
+															  : mesh_skinner_.kernel_name(),
+			};
 			if (input.bench_runs > 1)
 			{
 				report.bench_summary = compute_bench_summary(bench_runs_microseconds);
@@ -108,7 +383,7 @@ namespace transformer
 
 			try
 			{
-				const StatsReport report{.stages = profiler.entries()};
+				const StatsReport report{.stages = profiler.entries(), .counters = profiler.counters()};
 				stats_writer_.write(input.stats_file, report);
 			}
 			catch (...)
@@ -1,13 +1,27 @@
 #pragma once
 
+#include "animation/animation_clip.hpp"
 #include "core/app_input.hpp"
 #include "core/math_types.hpp"
 #include "io/io_interfaces.hpp"
 #include "skinning/mesh_skinner.hpp"
 
+#include <cstddef>
+#include <string>
+#include <vector>
+
 namespace transformer
 {
 
+	// With several sample times every frame gets its own file: mesh.obj -> mesh_0.obj, mesh_1.obj, ...
+	std::string frame_output_path(const std::string& output_file, std::size_t frame, std::size_t frame_count);
+
+	// One layer per clip, weighted as in clip_inputs. Throws if a clip animates more bones than the pose has.
+	std::vector<ClipLayer> make_clip_layers(
+			const std::vector<const AnimationClip*>& clips,
+			const std::vector<ClipInput>& clip_inputs,
+			std::size_t bone_count);
+
 	class SkinningApp
 	{
 	public:
@@ -15,6 +29,8 @@ namespace transformer
 				const IMeshReader& mesh_reader,
 				const IBoneWeightsReader& bone_weights_reader,
 				const IBonePoseReader& bone_pose_reader,
+				const IMorphTargetReader& morph_target_reader,
+				const IAnimationClipReader& clip_reader,
 				const IMeshWriter& mesh_writer,
 				const IStatsWriter& stats_writer,
 				const MeshSkinner& mesh_skinner);
@@ -22,9 +38,27 @@ namespace transformer
 		int run(const AppInput& input) const;
 
 	private:
+		struct LoadedInputs
+		{
+			Mesh mesh;
+			BoneWeightsData bone_weights_data;
+			std::vector<Mat4> inverse_bind_pose;
+			std::vector<Mat4> new_pose;
+			// Empty unless --morph-targets is given.
+			std::vector<MorphTarget> morph_targets;
+			std::vector<float> morph_weights;
+			// One per --clip, in command-line order.
+			std::vector<AnimationClip> clips;
+		};
+
+		// The input files are independent, so they are read and parsed concurrently.
+		LoadedInputs load_inputs(const AppInput& input, Profiler& profiler) const;
+
 		const IMeshReader& mesh_reader_;
 		const IBoneWeightsReader& bone_weights_reader_;
 		const IBonePoseReader& bone_pose_reader_;
+		const IMorphTargetReader& morph_target_reader_;
+		const IAnimationClipReader& clip_reader_;
 		const IMeshWriter& mesh_writer_;
 		const IStatsWriter& stats_writer_;
 		const MeshSkinner& mesh_skinner_;
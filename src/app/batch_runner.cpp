@@ -0,0 +1,485 @@
+#include "app/batch_runner.hpp"
+
+#include "app/app.hpp"
+#include "core/mesh_utils.hpp"
+#include "core/profiler.hpp"
+#include "core/weight_validation.hpp"
+#include "core/work_stealing_pool.hpp"
+#include "skinning/mesh_optimizer.hpp"
+#include "skinning/skinning_cache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		using Clock = std::chrono::steady_clock;
+
+		// Parsed inputs shared between jobs, keyed by file. How many jobs use each key is known from the
+		// manifest up front; the entry is dropped when the last of them has taken its reference, so an
+		// asset lives only while jobs that still need it hold it.
+		template <class T>
+		class SharedAssets
+		{
+		public:
+			void expect(const std::string& key)
+			{
+				++entries_[key].remaining;
+			}
+
+			// The first caller runs load; callers that come while it runs wait for it and get the same
+			// asset (or rethrow the same error). loaded tells which of the two happened.
+			std::shared_ptr<const T> acquire(const std::string& key, const std::function<T()>& load, bool& loaded)
+			{
+				std::promise<std::shared_ptr<const T>> promise;
+				std::shared_future<std::shared_ptr<const T>> asset;
+				{
+					const std::lock_guard<std::mutex> lock(mutex_);
+					Entry& entry = entries_.at(key);
+					loaded = !entry.asset.valid();
+					if (loaded)
+					{
+						entry.asset = promise.get_future().share();
+					}
+					asset = entry.asset;
+					if (--entry.remaining == 0)
+					{
+						entries_.erase(key);
+					}
+				}
+				if (loaded)
+				{
+					try
+					{
+						promise.set_value(std::make_shared<const T>(load()));
+					}
+					catch (...)
+					{
+						promise.set_exception(std::current_exception());
+					}
+				}
+				return asset.get();
+			}
+
+		private:
+			struct Entry
+			{
+				std::shared_future<std::shared_ptr<const T>> asset;
+				std::size_t remaining = 0;
+			};
+
+			std::mutex mutex_;
+			std::unordered_map<std::string, Entry> entries_;
+		};
+
+		struct Job
+		{
+			std::size_t index = 0;
+			AppInput input;
+			Clock::time_point start;
+
+			std::shared_ptr<const Mesh> mesh;
+			std::shared_ptr<const std::vector<Mat4>> inverse_bind_pose;
+			std::shared_ptr<const std::vector<Mat4>> new_pose;
+			std::vector<std::shared_ptr<const AnimationClip>> clips;
+			std::vector<ClipLayer> layers;
+			std::size_t frame_count = 1;
+
+			std::atomic<std::size_t> frames_left{0};
+			std::atomic<bool> failed{false};
+		};
+
+		// The prepared mesh depends on the weights (merged in) and on the bone count (validated against).
+		std::string mesh_key(const AppInput& input)
+		{
+			return input.mesh_file + '\n' + input.weights_file + '\n' + input.inverse_bind_pose_file;
+		}
+
+		class Batch
+		{
+		public:
+			Batch(const IMeshReader& mesh_reader,
+				  const IBoneWeightsReader& bone_weights_reader,
+				  const IBonePoseReader& bone_pose_reader,
+				  const IAnimationClipReader& clip_reader,
+				  const IMeshWriter& mesh_writer,
+				  const MeshSkinner& mesh_skinner,
+				  WorkStealingPool& pool) :
+					mesh_reader_(mesh_reader),
+					bone_weights_reader_(bone_weights_reader),
+					bone_pose_reader_(bone_pose_reader),
+					clip_reader_(clip_reader),
+					mesh_writer_(mesh_writer),
+					mesh_skinner_(mesh_skinner),
+					pool_(pool)
+			{}
+
+			void expect(const AppInput& input)
+			{
+				meshes_.expect(mesh_key(input));
+				inverse_bind_poses_.expect(input.inverse_bind_pose_file);
+				poses_.expect(input.new_pose_file);
+				for (const ClipInput& clip : input.clips)
+				{
+					clips_.expect(clip.file);
+				}
+			}
+
+			// Reads (or shares) the job's inputs, then queues its frames on this worker.
+			void load(const std::shared_ptr<Job>& job)
+			{
+				Profiler profiler;
+				job->start = Clock::now();
+				try
+				{
+					const AppInput& input = job->input;
+					job->inverse_bind_pose = acquire(
+							inverse_bind_poses_,
+							input.inverse_bind_pose_file,
+							[&]
+							{
+								return bone_pose_reader_.read_matrices(
+										input.inverse_bind_pose_file, profiler, "read_inverse_bind_pose_json");
+							});
+					job->new_pose = acquire(
+							poses_,
+							input.new_pose_file,
+							[&]
+							{
+								return bone_pose_reader_.read_matrices(
+										input.new_pose_file, profiler, "read_new_pose_json");
+							});
+					job->mesh = acquire(meshes_, mesh_key(input), [&] { return prepare_mesh(*job, profiler); });
+
+					std::vector<const AnimationClip*> clips;
+					for (const ClipInput& clip : input.clips)
+					{
+						job->clips.push_back(
+								acquire(clips_, clip.file, [&] { return clip_reader_.read(clip.file, profiler); }));
+						clips.push_back(job->clips.back().get());
+					}
+					job->layers = make_clip_layers(clips, input.clips, job->new_pose->size());
+					job->frame_count = job->layers.empty() ? 1 : std::max<std::size_t>(input.sample_times.size(), 1);
+				}
+				catch (const std::exception& ex)
+				{
+					fail(*job, ex.what());
+					finish(*job, profiler);
+					return;
+				}
+
+				merge(profiler);
+				job->frames_left = job->frame_count;
+				// Newest first from this worker's deque: the frames run before it picks up another job,
+				// while the mesh is hot; idle workers steal the rest.
+				for (std::size_t frame = 0; frame < job->frame_count; ++frame)
+				{
+					pool_.submit([this, job, frame] { skin_frame(job, frame); });
+				}
+			}
+
+			void skin_frame(const std::shared_ptr<Job>& job, std::size_t frame)
+			{
+				Profiler profiler;
+				try
+				{
+					std::vector<Mat4> frame_pose = *job->new_pose;
+					if (!job->layers.empty())
+					{
+						const std::vector<float>& times = job->input.sample_times;
+						const auto scope = profiler.stage("evaluate_pose");
+						evaluate_pose(job->layers, times.empty() ? 0.0F : times[frame], *job->new_pose, frame_pose);
+					}
+
+					const BonePoseData bone_pose_data = make_bone_pose_data(*job->inverse_bind_pose, frame_pose);
+					Mesh skinned_mesh = *job->mesh;
+					mesh_skinner_.skin(*job->mesh, bone_pose_data, profiler, skinned_mesh);
+					mesh_writer_.write(
+							frame_output_path(job->input.output_mesh_file, frame, job->frame_count),
+							skinned_mesh,
+							profiler);
+
+					frames_written_.fetch_add(1);
+					vertices_skinned_.fetch_add(skinned_mesh.vertex_count);
+				}
+				catch (const std::exception& ex)
+				{
+					fail(*job, ex.what());
+				}
+
+				if (--job->frames_left == 0)
+				{
+					finish(*job, profiler);
+				}
+				else
+				{
+					merge(profiler);
+				}
+			}
+
+			std::size_t failed_jobs() const
+			{
+				return failed_jobs_;
+			}
+
+			std::size_t frames_written() const
+			{
+				return frames_written_.load();
+			}
+
+			std::uint64_t vertices_skinned() const
+			{
+				return vertices_skinned_.load();
+			}
+
+			std::uint64_t assets_loaded() const
+			{
+				return assets_loaded_.load();
+			}
+
+			std::uint64_t assets_shared() const
+			{
+				return assets_shared_.load();
+			}
+
+			// Stages and counters of every task, summed.
+			const Profiler& totals() const
+			{
+				return totals_;
+			}
+
+			const std::vector<double>& job_latencies() const
+			{
+				return job_latencies_;
+			}
+
+		private:
+			template <class T, class Load>
+			std::shared_ptr<const T> acquire(SharedAssets<T>& assets, const std::string& key, Load&& load)
+			{
+				bool loaded = false;
+				std::shared_ptr<const T> asset = assets.acquire(key, std::forward<Load>(load), loaded);
+				(loaded ? assets_loaded_ : assets_shared_).fetch_add(1);
+				return asset;
+			}
+
+			Mesh prepare_mesh(const Job& job, Profiler& profiler) const
+			{
+				const AppInput& input = job.input;
+				Mesh mesh = mesh_reader_.read(input.mesh_file, profiler);
+				merge_bone_weights(mesh, bone_weights_reader_.read(input.weights_file, profiler));
+				{
+					const auto scope = profiler.stage("validate_weights");
+					validate_bone_weights(mesh, job.inverse_bind_pose->size(), input.weights_policy);
+				}
+				if (input.optimize_layout)
+				{
+					optimize_mesh_layout(mesh, profiler);
+				}
+				const SkinningCache* cache = mesh_skinner_.cache();
+				if (cache != nullptr && cache->caches_outputs())
+				{
+					const auto scope = profiler.stage("mesh_content_key");
+					mesh.content_key = mesh_content_key(mesh);
+				}
+				return mesh;
+			}
+
+			void fail(Job& job, const std::string& message)
+			{
+				const std::lock_guard<std::mutex> lock(mutex_);
+				if (!job.failed.exchange(true))
+				{
+					++failed_jobs_;
+					std::cerr << "Error: job " << job.index << " (" << job.input.output_mesh_file << "): " << message
+							  << std::endl;
+				}
+			}
+
+			void merge(const Profiler& profiler)
+			{
+				const std::lock_guard<std::mutex> lock(mutex_);
+				totals_.accumulate(profiler);
+			}
+
+			// Last task of a job: its latency counts only if every frame was written.
+			void finish(Job& job, const Profiler& profiler)
+			{
+				const double latency = std::chrono::duration<double, std::micro>(Clock::now() - job.start).count();
+				const std::lock_guard<std::mutex> lock(mutex_);
+				totals_.accumulate(profiler);
+				if (!job.failed)
+				{
+					job_latencies_.push_back(latency);
+				}
+				// Releases the job's references to shared inputs.
+				job.mesh.reset();
+				job.inverse_bind_pose.reset();
+				job.new_pose.reset();
+				job.clips.clear();
+				job.layers.clear();
+			}
+
+			const IMeshReader& mesh_reader_;
+			const IBoneWeightsReader& bone_weights_reader_;
+			const IBonePoseReader& bone_pose_reader_;
+			const IAnimationClipReader& clip_reader_;
+			const IMeshWriter& mesh_writer_;
+			const MeshSkinner& mesh_skinner_;
+			WorkStealingPool& pool_;
+
+			SharedAssets<Mesh> meshes_;
+			SharedAssets<std::vector<Mat4>> inverse_bind_poses_;
+			SharedAssets<std::vector<Mat4>> poses_;
+			SharedAssets<AnimationClip> clips_;
+
+			std::atomic<std::size_t> frames_written_{0};
+			std::atomic<std::uint64_t> vertices_skinned_{0};
+			std::atomic<std::uint64_t> assets_loaded_{0};
+			std::atomic<std::uint64_t> assets_shared_{0};
+
+			// Guards the totals below and serializes error output.
+			std::mutex mutex_;
+			std::size_t failed_jobs_ = 0;
+			Profiler totals_;
+			std::vector<double> job_latencies_;
+		};
+
+	}  // namespace
+
+	BatchRunner::BatchRunner(
+			const IJobManifestReader& manifest_reader,
+			const IMeshReader& mesh_reader,
+			const IBoneWeightsReader& bone_weights_reader,
+			const IBonePoseReader& bone_pose_reader,
+			const IAnimationClipReader& clip_reader,
+			const IMeshWriter& mesh_writer,
+			const IStatsWriter& stats_writer,
+			const MeshSkinner& mesh_skinner) :
+			manifest_reader_(manifest_reader),
+			mesh_reader_(mesh_reader),
+			bone_weights_reader_(bone_weights_reader),
+			bone_pose_reader_(bone_pose_reader),
+			clip_reader_(clip_reader),
+			mesh_writer_(mesh_writer),
+			stats_writer_(stats_writer),
+			mesh_skinner_(mesh_skinner)
+	{}
+
+	int BatchRunner::run(const std::string& manifest_file, const AppInput& defaults, const BatchOptions& options) const
+	{
+		Profiler profiler;
+		const auto total_start = Clock::now();
+
+		std::vector<AppInput> inputs;
+		try
+		{
+			inputs = manifest_reader_.read(manifest_file, defaults, profiler);
+		}
+		catch (const std::exception& ex)
+		{
+			std::cerr << "Error: " << ex.what() << std::endl;
+			return 1;
+		}
+
+		const std::filesystem::path output_directory = options.output_directory.empty()
+				? std::filesystem::path(manifest_file).parent_path()
+				: std::filesystem::path(options.output_directory);
+
+		WorkStealingPool pool(options.threads);
+		Batch batch(
+				mesh_reader_, bone_weights_reader_, bone_pose_reader_, clip_reader_, mesh_writer_, mesh_skinner_, pool);
+
+		std::vector<std::shared_ptr<Job>> jobs;
+		jobs.reserve(inputs.size());
+		for (std::size_t i = 0; i < inputs.size(); ++i)
+		{
+			auto job = std::make_shared<Job>();
+			job->index = i;
+			job->input = std::move(inputs[i]);
+			const std::filesystem::path output(job->input.output_mesh_file);
+			if (output.is_relative())
+			{
+				job->input.output_mesh_file = (output_directory / output).string();
+			}
+			batch.expect(job->input);
+			jobs.push_back(std::move(job));
+		}
+
+		for (const std::shared_ptr<Job>& job : jobs)
+		{
+			pool.submit([&batch, job] { batch.load(job); });
+		}
+		pool.wait();
+
+		const double wall_us = std::chrono::duration<double, std::micro>(Clock::now() - total_start).count();
+		profiler.accumulate(batch.totals());
+		profiler.record("total", wall_us);
+
+		profiler.add_counter("jobs", jobs.size());
+		profiler.add_counter("jobs_failed", batch.failed_jobs());
+		profiler.add_counter("frames_written", batch.frames_written());
+		profiler.add_counter("vertices_skinned", batch.vertices_skinned());
+		profiler.add_counter("assets_loaded", batch.assets_loaded());
+		profiler.add_counter("assets_shared", batch.assets_shared());
+		profiler.add_counter("tasks_stolen", pool.steals());
+		if (const SkinningCache* cache = mesh_skinner_.cache(); cache != nullptr)
+		{
+			cache->add_counters(profiler);
+		}
+
+		BatchSummary summary{
+				.workers = pool.thread_count(),
+				.jobs = jobs.size(),
+				.failed_jobs = batch.failed_jobs(),
+				.frames = batch.frames_written(),
+				.vertices_skinned = batch.vertices_skinned(),
+				.wall_microseconds = wall_us,
+		};
+		if (!batch.job_latencies().empty())
+		{
+			summary.job_latency = compute_bench_summary(batch.job_latencies());
+		}
+
+		const StatsReport report{
+				.stages = profiler.entries(),
+				.counters = profiler.counters(),
+				.batch = summary,
+				.kernel = mesh_skinner_.kernel_name(),
+		};
+		try
+		{
+			stats_writer_.write(options.stats_file, report);
+		}
+		catch (const std::exception& ex)
+		{
+			std::cerr << "Error: " << ex.what() << std::endl;
+			return 1;
+		}
+
+		if (batch.failed_jobs() != 0)
+		{
+			std::cerr << batch.failed_jobs() << " of " << jobs.size() << " jobs failed." << std::endl;
+			return 1;
+		}
+		std::cout << "Success" << std::endl;
+		return 0;
+	}
+
+}  // namespace transformer
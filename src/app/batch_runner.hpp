@@ -0,0 +1,54 @@
+#pragma once
+
+#include "core/app_input.hpp"
+#include "io/io_interfaces.hpp"
+#include "skinning/mesh_skinner.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace transformer
+{
+
+	struct BatchOptions
+	{
+		// Worker threads; 0 means one per hardware thread.
+		std::size_t threads = 0;
+		// Relative job outputs are written under this directory; empty means the manifest's directory.
+		std::string output_directory;
+		std::string stats_file;
+	};
+
+	// Runs the jobs of a `--jobs` manifest on a work-stealing pool. Each job is a load task that submits
+	// one skin-and-write task per frame, so one job's parsing overlaps another job's skinning and the
+	// frames of a long clip spread over idle workers. Input files named by several jobs are parsed once
+	// and released when the last of those jobs has them. A failed job is reported; the others still run.
+	class BatchRunner
+	{
+	public:
+		BatchRunner(
+				const IJobManifestReader& manifest_reader,
+				const IMeshReader& mesh_reader,
+				const IBoneWeightsReader& bone_weights_reader,
+				const IBonePoseReader& bone_pose_reader,
+				const IAnimationClipReader& clip_reader,
+				const IMeshWriter& mesh_writer,
+				const IStatsWriter& stats_writer,
+				const MeshSkinner& mesh_skinner);
+
+		// defaults carries the command-line options every job shares (weights policy, layout
+		// optimization). Returns 1 if any job failed.
+		int run(const std::string& manifest_file, const AppInput& defaults, const BatchOptions& options) const;
+
+	private:
+		const IJobManifestReader& manifest_reader_;
+		const IMeshReader& mesh_reader_;
+		const IBoneWeightsReader& bone_weights_reader_;
+		const IBonePoseReader& bone_pose_reader_;
+		const IAnimationClipReader& clip_reader_;
+		const IMeshWriter& mesh_writer_;
+		const IStatsWriter& stats_writer_;
+		const MeshSkinner& mesh_skinner_;
+	};
+
+}  // namespace transformer
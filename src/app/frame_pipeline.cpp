@@ -0,0 +1,119 @@
+#include "app/frame_pipeline.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		double microseconds_since(std::chrono::steady_clock::time_point start)
+		{
+			return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+		}
+
+	}  // namespace
+
+	FramePipeline::FramePipeline(const Mesh& prototype, std::size_t buffer_count, WriteFunction write) :
+			buffers_(buffer_count, prototype),
+			write_(std::move(write)),
+			// Room for every buffer and the stop marker.
+			filled_(buffer_count + 1),
+			free_(buffer_count)
+	{
+		if (buffer_count == 0)
+		{
+			throw std::invalid_argument("FramePipeline needs at least one buffer");
+		}
+		for (std::size_t buffer = 0; buffer < buffer_count; ++buffer)
+		{
+			free_.push(buffer);
+		}
+		writer_ = std::thread([this] { write_loop(); });
+	}
+
+	FramePipeline::~FramePipeline()
+	{
+		stop_writer();
+	}
+
+	Mesh& FramePipeline::acquire()
+	{
+		if (acquired_ == kStop)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			acquired_ = free_.pop();
+			skin_stall_microseconds_ += microseconds_since(start);
+		}
+		return buffers_[acquired_];
+	}
+
+	void FramePipeline::submit(std::size_t frame)
+	{
+		if (acquired_ == kStop)
+		{
+			throw std::logic_error("FramePipeline::submit without acquire");
+		}
+		filled_.push({.buffer = acquired_, .frame = frame});
+		acquired_ = kStop;
+		if (failed_.load(std::memory_order_acquire))
+		{
+			stop_writer();
+			std::rethrow_exception(error_);
+		}
+	}
+
+	void FramePipeline::finish(Profiler& profiler)
+	{
+		stop_writer();
+		if (error_)
+		{
+			std::rethrow_exception(error_);
+		}
+		profiler.merge(write_profiler_);
+		profiler.record("pipeline_skin_stall", skin_stall_microseconds_);
+		profiler.record("pipeline_write_stall", write_stall_microseconds_);
+	}
+
+	void FramePipeline::write_loop()
+	{
+		while (true)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			const QueuedFrame queued = filled_.pop();
+			write_stall_microseconds_ += microseconds_since(start);
+			if (queued.buffer == kStop)
+			{
+				return;
+			}
+
+			// After a failure the remaining frames are only handed back, so the caller never waits forever.
+			if (!failed_.load(std::memory_order_relaxed))
+			{
+				try
+				{
+					write_(queued.frame, buffers_[queued.buffer], write_profiler_);
+				}
+				catch (...)
+				{
+					error_ = std::current_exception();
+					failed_.store(true, std::memory_order_release);
+				}
+			}
+			free_.push(queued.buffer);
+		}
+	}
+
+	void FramePipeline::stop_writer()
+	{
+		if (writer_.joinable())
+		{
+			filled_.push({.buffer = kStop});
+			writer_.join();
+		}
+	}
+
+}  // namespace transformer
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "core/math_types.hpp"
+#include "core/profiler.hpp"
+#include "core/spsc_ring.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace transformer
+{
+
+	// Skins and writes a run of frames on two threads: the caller skins frame N + 1 into one mesh buffer
+	// while a writer thread serializes frame N from another. Buffers go to the writer and back through
+	// two SpscRings, so a hand-off takes no lock, and at most buffer_count frames are in flight.
+	class FramePipeline
+	{
+	public:
+		using WriteFunction = std::function<void(std::size_t frame, const Mesh& mesh, Profiler& profiler)>;
+
+		// Every buffer starts as a copy of prototype (the skinner only overwrites positions). write runs on
+		// the writer thread, for the frames in submission order.
+		FramePipeline(const Mesh& prototype, std::size_t buffer_count, WriteFunction write);
+		// Lets the writer finish the frames already submitted.
+		~FramePipeline();
+
+		FramePipeline(const FramePipeline&) = delete;
+		FramePipeline& operator=(const FramePipeline&) = delete;
+
+		// A buffer to skin the next frame into; waits while all of them are queued or being written.
+		Mesh& acquire();
+
+		// Hands the acquired buffer to the writer as the given frame. Rethrows an earlier write error.
+		void submit(std::size_t frame);
+
+		// Waits until every submitted frame is written and rethrows a write error. Then merges the writer's
+		// stages into profiler and records the time each side waited for the other as pipeline_skin_stall
+		// (no free buffer) and pipeline_write_stall (no skinned frame).
+		void finish(Profiler& profiler);
+
+	private:
+		struct QueuedFrame
+		{
+			std::size_t buffer = 0;
+			std::size_t frame = 0;
+		};
+
+		// Buffer index that stops the writer.
+		static constexpr std::size_t kStop = SIZE_MAX;
+
+		void write_loop();
+		void stop_writer();
+
+		std::vector<Mesh> buffers_;
+		WriteFunction write_;
+		SpscRing<QueuedFrame> filled_;
+		SpscRing<std::size_t> free_;
+
+		// Caller thread.
+		std::size_t acquired_ = kStop;
+		double skin_stall_microseconds_ = 0.0;
+
+		// Writer thread; read by the caller after the join.
+		Profiler write_profiler_;
+		double write_stall_microseconds_ = 0.0;
+		std::exception_ptr error_;
+		// Set after error_, so submit can report a failed write early.
+		std::atomic<bool> failed_{false};
+
+		std::thread writer_;
+	};
+
+}  // namespace transformer
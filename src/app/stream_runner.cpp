@@ -0,0 +1,223 @@
+#include "app/stream_runner.hpp"
+
+#include "core/mesh_utils.hpp"
+#include "core/profiler.hpp"
+#include "core/weight_validation.hpp"
+#include "io/json_readers.hpp"
+#include "io/obj_io.hpp"
+#include "skinning/skinning_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace transformer
+{
+
+	StreamRunner::StreamRunner(
+			const IBonePoseReader& bone_pose_reader,
+			const IStatsWriter& stats_writer,
+			const MeshSkinner& mesh_skinner) :
+			bone_pose_reader_(bone_pose_reader),
+			stats_writer_(stats_writer),
+			mesh_skinner_(mesh_skinner)
+	{}
+
+	int StreamRunner::run(const AppInput& input) const
+	{
+		Profiler profiler;
+		const auto total_start = std::chrono::steady_clock::now();
+
+		try
+		{
+			const std::size_t budget = input.stream_memory_budget;
+			const std::size_t window_vertices = budget / kBytesPerWindowVertex;
+			if (window_vertices < kMinWindowVertices)
+			{
+				throw std::runtime_error(
+						"--memory-budget " + std::to_string(budget) + " is too small for streaming (at least "
+						+ std::to_string(kMinWindowVertices * kBytesPerWindowVertex) + " bytes)");
+			}
+
+			const std::vector<Mat4> inverse_bind_pose = bone_pose_reader_.read_matrices(
+					input.inverse_bind_pose_file, profiler, "read_inverse_bind_pose_json");
+			const std::vector<Mat4> new_pose
+					= bone_pose_reader_.read_matrices(input.new_pose_file, profiler, "read_new_pose_json");
+			const BonePoseData bone_pose_data = make_bone_pose_data(inverse_bind_pose, new_pose);
+
+			ObjMeshStream mesh_stream(input.mesh_file);
+			JsonBoneWeightsStream weights_stream(input.weights_file);
+			ObjStreamWriter writer(input.output_mesh_file);
+
+			std::size_t windows = 0;
+			std::size_t vertices = 0;
+			std::size_t renormalized = 0;
+			{
+				std::array<Mesh, 2> sources;
+				std::array<Mesh, 2> results;
+				for (std::size_t i = 0; i < 2; ++i)
+				{
+					sources[i].entries.resize(window_vertices);
+					results[i].entries.resize(window_vertices);
+				}
+
+				// One profiler per pipeline stage: a stage's next task only starts after its previous one
+				// was waited for, so none of them is used by two threads at once.
+				Profiler read_profiler;
+				Profiler skin_profiler;
+				Profiler write_profiler;
+
+				std::size_t first_vertex = 0;
+				const auto read_window = [&](Mesh& window)
+				{
+					Profiler window_profiler;
+					std::size_t count = 0;
+					{
+						const auto scope = window_profiler.stage("stream_read");
+						count = mesh_stream.read_vertices(window.entries.data(), window_vertices);
+						if (weights_stream.read(window.entries.data(), window_vertices) != count)
+						{
+							throw std::runtime_error("Vertex count mismatch between mesh and skinning weights");
+						}
+					}
+					window.vertex_count = count;
+					if (count != 0)
+					{
+						const auto scope = window_profiler.stage("validate_weights");
+						try
+						{
+							renormalized
+									+= validate_bone_weights(window, inverse_bind_pose.size(), input.weights_policy);
+						}
+						catch (const std::runtime_error& ex)
+						{
+							// Vertex numbers in the report count from the start of the window.
+							throw std::runtime_error(
+									"Streamed window of vertices " + std::to_string(first_vertex) + "-"
+									+ std::to_string(first_vertex + count - 1) + ": " + ex.what());
+						}
+					}
+					first_vertex += count;
+					read_profiler.accumulate(window_profiler);
+					return count;
+				};
+				const auto write_window = [&](const Mesh& window)
+				{
+					Profiler window_profiler;
+					{
+						const auto scope = window_profiler.stage("stream_write");
+						writer.write_vertices(window);
+					}
+					write_profiler.accumulate(window_profiler);
+				};
+
+				// Declared after everything the tasks touch: destroying a std::async future waits for it.
+				std::future<std::size_t> reading
+						= std::async(std::launch::async, read_window, std::ref(sources[0]));
+				std::future<void> writing;
+				for (std::size_t window = 0;; ++window)
+				{
+					const std::size_t count = reading.get();
+					if (count == 0)
+					{
+						break;
+					}
+					const Mesh& source = sources[window % 2];
+					reading = std::async(std::launch::async, read_window, std::ref(sources[(window + 1) % 2]));
+
+					Mesh& result = results[window % 2];
+					result.vertex_count = count;
+					Profiler window_profiler;
+					mesh_skinner_.skin(source, bone_pose_data, window_profiler, result);
+					skin_profiler.accumulate(window_profiler);
+
+					// Windows are appended in order, so the previous write has to finish first.
+					if (writing.valid())
+					{
+						writing.get();
+					}
+					writing = std::async(std::launch::async, write_window, std::cref(result));
+
+					++windows;
+					vertices += count;
+				}
+				if (writing.valid())
+				{
+					writing.get();
+				}
+
+				profiler.merge(read_profiler);
+				profiler.merge(skin_profiler);
+				profiler.merge(write_profiler);
+			}
+
+			// The vertex windows are freed by now; the face window gets the whole budget.
+			std::size_t triangles = 0;
+			{
+				const auto scope = profiler.stage("stream_faces");
+				const std::size_t window_triangles = budget / (3 * sizeof(std::uint32_t));
+				std::vector<std::uint32_t> indices(window_triangles * 3);
+				for (std::size_t count = 0; (count = mesh_stream.read_faces(indices.data(), window_triangles)) != 0;)
+				{
+					writer.write_faces(indices.data(), count);
+					triangles += count;
+				}
+				writer.close();
+			}
+
+			const auto total_end = std::chrono::steady_clock::now();
+			profiler.record("total", std::chrono::duration<double, std::micro>(total_end - total_start).count());
+
+			profiler.add_counter("stream_windows", windows);
+			profiler.add_counter("stream_window_vertices", window_vertices);
+			profiler.add_counter("stream_buffer_bytes", window_vertices * kBytesPerWindowVertex);
+			profiler.add_counter("vertices_skinned", vertices);
+			profiler.add_counter("triangles_written", triangles);
+			if (renormalized != 0)
+			{
+				profiler.add_counter("weights_renormalized", renormalized);
+			}
+			if (const SkinningCache* cache = mesh_skinner_.cache(); cache != nullptr)
+			{
+				cache->add_counters(profiler);
+			}
+
+			const StatsReport report{
+					.stages = profiler.entries(),
+					.counters = profiler.counters(),
+					.kernel = mesh_skinner_.kernel_name(),
+			};
+			stats_writer_.write(input.stats_file, report);
+
+			std::cout << "Success" << std::endl;
+			return 0;
+		}
+		catch (const std::exception& ex)
+		{
+			const auto total_end = std::chrono::steady_clock::now();
+			profiler.record("total", std::chrono::duration<double, std::micro>(total_end - total_start).count());
+
+			try
+			{
+				const StatsReport report{.stages = profiler.entries(), .counters = profiler.counters()};
+				stats_writer_.write(input.stats_file, report);
+			}
+			catch (...)
+			{
+				// Best effort: do not mask original error.
+			}
+
+			std::cerr << "Error: " << ex.what() << std::endl;
+			return 1;
+		}
+	}
+
+}  // namespace transformer
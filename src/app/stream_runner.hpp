@@ -0,0 +1,38 @@
+#pragma once
+
+#include "core/app_input.hpp"
+#include "io/io_interfaces.hpp"
+#include "skinning/mesh_skinner.hpp"
+
+#include <cstddef>
+
+namespace transformer
+{
+
+	// Out-of-core skinning for `--stream`: an OBJ mesh and its JSON weights are read front to back in
+	// windows of vertices, skinned and appended to the output OBJ, so memory does not grow with the mesh.
+	// Two input and two output windows rotate: window k+1 is read while window k is skinned and window
+	// k-1 is written. The faces are copied in a second pass over the mesh file.
+	class StreamRunner
+	{
+	public:
+		// Bytes of window buffers per vertex: two input and two output windows of Mesh::Entry.
+		static constexpr std::size_t kBytesPerWindowVertex = 4 * sizeof(Mesh::Entry);
+		// Smaller windows would spend more time handing buffers around than skinning.
+		static constexpr std::size_t kMinWindowVertices = 64;
+
+		StreamRunner(
+				const IBonePoseReader& bone_pose_reader,
+				const IStatsWriter& stats_writer,
+				const MeshSkinner& mesh_skinner);
+
+		// Uses input.stream_memory_budget; throws nothing, errors are reported and return 1.
+		int run(const AppInput& input) const;
+
+	private:
+		const IBonePoseReader& bone_pose_reader_;
+		const IStatsWriter& stats_writer_;
+		const MeshSkinner& mesh_skinner_;
+	};
+
+}  // namespace transformer
@@ -0,0 +1,126 @@
+#include "core/memory_tracking.hpp"
+
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+	#include <malloc.h>
+#elif defined(__APPLE__)
+	#include <malloc/malloc.h>
+#else
+	#include <malloc.h>
+#endif
+
+// Linked into the executables only, not into transformer_core: a program embedding the library keeps its
+// own operator new, and --track-allocations then sees only the mapped vertex buffers.
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		// Size the allocator actually reserved; the same on allocation and release, so live bytes balance
+		// without a size header in every block.
+		std::size_t block_size(void* block)
+		{
+#if defined(_WIN32)
+			return _msize(block);
+#elif defined(__APPLE__)
+			return malloc_size(block);
+#else
+			return malloc_usable_size(block);
+#endif
+		}
+
+		void* allocate(std::size_t size) noexcept
+		{
+			void* block = std::malloc(size == 0 ? 1 : size);
+			if (block != nullptr && allocation_tracking_enabled())
+			{
+				count_heap_allocation(size, block_size(block));
+			}
+			return block;
+		}
+
+		void* allocate_or_throw(std::size_t size)
+		{
+			while (true)
+			{
+				if (void* block = allocate(size))
+				{
+					return block;
+				}
+				const std::new_handler handler = std::get_new_handler();
+				if (handler == nullptr)
+				{
+					throw std::bad_alloc();
+				}
+				handler();
+			}
+		}
+
+		void deallocate(void* block) noexcept
+		{
+			if (block != nullptr && allocation_tracking_enabled())
+			{
+				count_heap_release(block_size(block));
+			}
+			std::free(block);
+		}
+
+	}  // namespace
+
+}  // namespace transformer
+
+// Replacements of the global allocation functions; the aligned overloads keep their defaults (and are not
+// counted). Every translation unit of the program allocates through these.
+void* operator new(std::size_t size)
+{
+	return transformer::allocate_or_throw(size);
+}
+
+void* operator new[](std::size_t size)
+{
+	return transformer::allocate_or_throw(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t& /*tag*/) noexcept
+{
+	return transformer::allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& /*tag*/) noexcept
+{
+	return transformer::allocate(size);
+}
+
+void operator delete(void* block) noexcept
+{
+	transformer::deallocate(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+	transformer::deallocate(block);
+}
+
+void operator delete(void* block, std::size_t /*size*/) noexcept
+{
+	transformer::deallocate(block);
+}
+
+void operator delete[](void* block, std::size_t /*size*/) noexcept
+{
+	transformer::deallocate(block);
+}
+
+void operator delete(void* block, const std::nothrow_t& /*tag*/) noexcept
+{
+	transformer::deallocate(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t& /*tag*/) noexcept
+{
+	transformer::deallocate(block);
+}
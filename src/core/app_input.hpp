@@ -1,11 +1,21 @@
 #pragma once
 
+#include "core/math_types.hpp"
+#include "core/weight_validation.hpp"
+
 #include <cstddef>
 #include <string>
+#include <vector>
 
 namespace transformer
 {
 
+	struct ClipInput
+	{
+		std::string file;
+		float weight = 1.0F;
+	};
+
 	struct AppInput
 	{
 		std::string mesh_file;
@@ -14,7 +24,32 @@ namespace transformer
 		std::string new_pose_file;
 		std::string output_mesh_file;
 		std::string stats_file;
+		// Optional blend shapes: sparse targets plus this frame's weight per target.
+		std::string morph_targets_file;
+		std::string morph_weights_file;
+		// Optional keyframed clips, blended by weight and sampled at each of sample_times (one output
+		// mesh per time). When set they replace the --new-pose matrices of the bones they animate.
+		std::vector<ClipInput> clips;
+		std::vector<float> sample_times;
+		// Non-zero: write every frame into one delta-compressed vertex cache quantized to this many bits,
+		// instead of a mesh file per frame.
+		unsigned vertex_cache_bits = 0;
+		// Skinned AABB (and per-dominant-bone AABBs) of every frame, collected during skinning and
+		// written to the stats file.
+		BoundsMode bounds = BoundsMode::None;
+		// Vertices with invalid influences are rejected (default) or repaired after loading.
+		WeightsPolicy weights_policy = WeightsPolicy::Error;
+		// Non-zero: --stream. The mesh is read, skinned and written in windows of vertices whose buffers fit
+		// in this many bytes, instead of being loaded whole.
+		std::size_t stream_memory_budget = 0;
 		std::size_t bench_runs = 1;
+		bool optimize_layout = false;
+		bool incremental = false;
+		// --deterministic: the kernel is a bit-exact one; the stats compare it with the fastest fused one.
+		bool deterministic = false;
+		// Service mode: skin through a running `--serve` process instead of in-process.
+		std::string client_socket;
+		bool shutdown_server = false;
 	};
 
 }  // namespace transformer
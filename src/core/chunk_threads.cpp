@@ -0,0 +1,119 @@
+#include "core/chunk_threads.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace transformer
+{
+
+	ChunkThreads::ChunkThreads(std::size_t thread_count) :
+			thread_count_(thread_count == 0 ? std::max(1U, std::thread::hardware_concurrency()) : thread_count)
+	{
+		threads_.reserve(thread_count_ - 1);
+		for (std::size_t chunk = 1; chunk < thread_count_; ++chunk)
+		{
+			threads_.emplace_back([this, chunk] { worker_loop(chunk); });
+		}
+	}
+
+	ChunkThreads::~ChunkThreads()
+	{
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		work_ready_.notify_all();
+		for (std::thread& thread : threads_)
+		{
+			thread.join();
+		}
+	}
+
+	std::size_t ChunkThreads::thread_count() const
+	{
+		return thread_count_;
+	}
+
+	std::size_t ChunkThreads::chunk_begin(std::size_t count, std::size_t chunk) const
+	{
+		return count / thread_count_ * chunk + std::min(chunk, count % thread_count_);
+	}
+
+	void ChunkThreads::run(std::size_t count, const ChunkFunction& function)
+	{
+		const std::lock_guard<std::mutex> run_lock(run_mutex_);
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			function_ = &function;
+			count_ = count;
+			remaining_ = threads_.size();
+			++generation_;
+		}
+		work_ready_.notify_all();
+
+		std::exception_ptr error;
+		run_chunk(0, error);
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		work_done_.wait(lock, [this] { return remaining_ == 0; });
+		function_ = nullptr;
+		std::exception_ptr worker_error = std::exchange(error_, nullptr);
+		lock.unlock();
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+		if (worker_error)
+		{
+			std::rethrow_exception(worker_error);
+		}
+	}
+
+	void ChunkThreads::run_chunk(std::size_t chunk, std::exception_ptr& error) const
+	{
+		const std::size_t begin = chunk_begin(count_, chunk);
+		const std::size_t end = chunk_begin(count_, chunk + 1);
+		if (begin == end)
+		{
+			return;
+		}
+		try
+		{
+			(*function_)(chunk, begin, end);
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+	}
+
+	void ChunkThreads::worker_loop(std::size_t chunk)
+	{
+		std::uint64_t seen = 0;
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (true)
+		{
+			work_ready_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+			if (stopping_)
+			{
+				return;
+			}
+			seen = generation_;
+			// function_ and count_ stay set until every worker has reported back.
+			lock.unlock();
+			std::exception_ptr error;
+			run_chunk(chunk, error);
+			lock.lock();
+
+			if (error && !error_)
+			{
+				error_ = error;
+			}
+			if (--remaining_ == 0)
+			{
+				work_done_.notify_one();
+			}
+		}
+	}
+
+}  // namespace transformer
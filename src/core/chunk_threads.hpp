@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace transformer
+{
+
+	// Fixed threads that split every range the same way: chunk i of each run() always executes on the
+	// same thread. Data first touched through one run (see vertex_buffer.hpp) is therefore processed by
+	// the thread whose NUMA node it was placed on in every later run.
+	class ChunkThreads
+	{
+	public:
+		// (chunk index, first element, one past the last element)
+		using ChunkFunction = std::function<void(std::size_t, std::size_t, std::size_t)>;
+
+		// thread_count includes the calling thread; 0 means std::thread::hardware_concurrency().
+		explicit ChunkThreads(std::size_t thread_count);
+		~ChunkThreads();
+
+		ChunkThreads(const ChunkThreads&) = delete;
+		ChunkThreads& operator=(const ChunkThreads&) = delete;
+
+		[[nodiscard]]
+		std::size_t thread_count() const;
+
+		// First element of chunk `chunk` when count elements are split into thread_count() chunks.
+		[[nodiscard]]
+		std::size_t chunk_begin(std::size_t count, std::size_t chunk) const;
+
+		// Runs function on each non-empty chunk of [0, count): chunk 0 on the calling thread, chunk i on
+		// worker i. Blocks until all are done and rethrows the first exception. Concurrent calls take turns.
+		void run(std::size_t count, const ChunkFunction& function);
+
+	private:
+		void run_chunk(std::size_t chunk, std::exception_ptr& error) const;
+		void worker_loop(std::size_t chunk);
+
+		std::size_t thread_count_ = 1;
+		std::mutex run_mutex_;
+
+		// The current run; guarded by mutex_.
+		std::mutex mutex_;
+		std::condition_variable work_ready_;
+		std::condition_variable work_done_;
+		const ChunkFunction* function_ = nullptr;
+		std::size_t count_ = 0;
+		std::uint64_t generation_ = 0;
+		std::size_t remaining_ = 0;
+		std::exception_ptr error_;
+		bool stopping_ = false;
+
+		std::vector<std::thread> threads_;
+	};
+
+}  // namespace transformer
@@ -1,8 +1,11 @@
 #pragma once
 
+#include "core/vertex_buffer.hpp"
+
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <vector>
 
 namespace transformer
@@ -35,6 +38,13 @@ namespace transformer
 		std::array<float, 4> weights{0.0F, 0.0F, 0.0F, 0.0F};
 	};
 
+	// Sparse blend shape: position deltas for the vertices it moves, sorted by vertex index.
+	struct MorphTarget
+	{
+		std::vector<std::uint32_t> vertex_indices;
+		std::vector<Vec3> deltas;
+	};
+
 	struct Mesh
 	{
 		struct Entry
@@ -43,9 +53,57 @@ namespace transformer
 			VertexBoneWeights bone_weights{};
 		};
 
-		std::vector<Entry> entries;
-		std::vector<std::int16_t> indices;
+		// Large buffers are mapped as set by configure_vertex_buffers() (core/vertex_buffer.hpp).
+		using Entries = std::vector<Entry, VertexBufferAllocator<Entry>>;
+
+		Entries entries;
+		std::vector<std::uint32_t> indices;
 		std::size_t vertex_count = 0;
+		// Leading weight slots that may be non-zero; slots past it are 0 in every vertex. Lowered by
+		// validate_bone_weights(), and MeshSkinner runs the loop specialised for this count.
+		std::size_t max_influences = 4;
+		// mesh_content_key() (skinning/skinning_cache.hpp) when skinned outputs are cached, 0 otherwise.
+		std::uint64_t content_key = 0;
+
+		// Filled by optimize_mesh_layout(): source (file) index of every stored vertex and triangle,
+		// so writers can report results in the original order. Empty while the mesh is in file order.
+		std::vector<std::uint32_t> vertex_source_index;
+		std::vector<std::uint32_t> triangle_source_index;
+
+		// Indexed like entries (stored order). Weighted per frame and applied before skinning.
+		std::vector<MorphTarget> morph_targets;
+	};
+
+	// Axis-aligned box; default constructed it is empty (min > max), so the first point sets both corners.
+	struct Aabb
+	{
+		Vec3 min{std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(),
+				 std::numeric_limits<float>::infinity()};
+		Vec3 max{-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+				 -std::numeric_limits<float>::infinity()};
+
+		[[nodiscard]]
+		bool empty() const
+		{
+			return min.x > max.x;
+		}
+	};
+
+	// Which bounds MeshSkinner collects while it skins.
+	enum class BoundsMode
+	{
+		None,
+		Mesh,
+		// Mesh plus one box per bone over the vertices it dominates (largest weight).
+		MeshAndBones,
+	};
+
+	// Bounds of one skinned frame. bones is indexed by bone and empty unless BoundsMode::MeshAndBones;
+	// a bone that dominates no vertex keeps an empty box.
+	struct SkinnedBounds
+	{
+		Aabb mesh;
+		std::vector<Aabb> bones;
 	};
 
 	struct BoneWeightsData
@@ -53,6 +111,10 @@ namespace transformer
 		std::vector<VertexBoneWeights> per_vertex_weights;
 	};
 
+	// Bone indices are int8 and unused slots (-1) select the zero palette matrix 255, so a pose has at most
+	// 255 bones.
+	inline constexpr std::size_t kMaxBones = 255;
+
 	struct BonePoseData
 	{
 		// [bone_index][0 = inverse_bind_pose, 1 = new_pose]
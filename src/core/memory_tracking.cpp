@@ -0,0 +1,189 @@
+#include "core/memory_tracking.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	// Version 2 maps GetProcessMemoryInfo to kernel32, so psapi.lib need not be linked.
+	#define PSAPI_VERSION 2
+	#include <windows.h>
+	#include <psapi.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		std::atomic<bool> tracking{false};
+		std::atomic<std::uint64_t> allocations{0};
+		std::atomic<std::uint64_t> allocated_bytes{0};
+		std::atomic<std::int64_t> live_bytes{0};
+		std::atomic<std::int64_t> peak_live_bytes{0};
+		// Innermost AllocationScope of this thread.
+		thread_local AllocationScope* current_scope = nullptr;
+
+		void raise(std::atomic<std::int64_t>& peak, std::int64_t value)
+		{
+			std::int64_t current = peak.load(std::memory_order_relaxed);
+			while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		void count(std::size_t requested, std::size_t reserved_size)
+		{
+			allocations.fetch_add(1, std::memory_order_relaxed);
+			allocated_bytes.fetch_add(requested, std::memory_order_relaxed);
+			const auto reserved = static_cast<std::int64_t>(reserved_size);
+			const std::int64_t live = live_bytes.fetch_add(reserved, std::memory_order_relaxed) + reserved;
+			raise(peak_live_bytes, live);
+		}
+
+	}  // namespace
+
+	void enable_allocation_tracking()
+	{
+		tracking.store(true);
+	}
+
+	bool allocation_tracking_enabled()
+	{
+		return tracking.load(std::memory_order_relaxed);
+	}
+
+	AllocationCounts allocation_totals()
+	{
+		return {
+				.allocations = allocations.load(),
+				.allocated_bytes = allocated_bytes.load(),
+				.peak_live_bytes = static_cast<std::uint64_t>(std::max<std::int64_t>(peak_live_bytes.load(), 0)),
+		};
+	}
+
+	void count_heap_allocation(std::size_t requested, std::size_t reserved)
+	{
+		count(requested, reserved);
+		AllocationScope::count_in_scopes(requested, static_cast<std::int64_t>(reserved));
+	}
+
+	void count_heap_release(std::size_t reserved)
+	{
+		live_bytes.fetch_sub(static_cast<std::int64_t>(reserved), std::memory_order_relaxed);
+		AllocationScope::release_in_scopes(static_cast<std::int64_t>(reserved));
+	}
+
+	void count_external_allocation(std::size_t bytes)
+	{
+		if (tracking.load(std::memory_order_relaxed))
+		{
+			count(bytes, bytes);
+			AllocationScope::count_in_scopes(bytes, static_cast<std::int64_t>(bytes));
+		}
+	}
+
+	void count_external_release(std::size_t bytes)
+	{
+		if (tracking.load(std::memory_order_relaxed))
+		{
+			live_bytes.fetch_sub(static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+			AllocationScope::release_in_scopes(static_cast<std::int64_t>(bytes));
+		}
+	}
+
+	AllocationScope::AllocationScope() :
+			active_(allocation_tracking_enabled())
+	{
+		if (active_)
+		{
+			outer_ = current_scope;
+			current_scope = this;
+		}
+	}
+
+	AllocationScope::~AllocationScope()
+	{
+		if (active_)
+		{
+			current_scope = outer_;
+		}
+	}
+
+	AllocationCounts AllocationScope::finish() const
+	{
+		if (!active_)
+		{
+			return {};
+		}
+		return {
+				.allocations = allocations_.load(),
+				.allocated_bytes = allocated_bytes_.load(),
+				.peak_live_bytes = static_cast<std::uint64_t>(peak_live_bytes_.load()),
+		};
+	}
+
+	AllocationScope* AllocationScope::current()
+	{
+		return current_scope;
+	}
+
+	void AllocationScope::count_in_scopes(std::size_t requested, std::int64_t reserved)
+	{
+		for (AllocationScope* scope = current_scope; scope != nullptr; scope = scope->outer_)
+		{
+			scope->allocations_.fetch_add(1, std::memory_order_relaxed);
+			scope->allocated_bytes_.fetch_add(requested, std::memory_order_relaxed);
+			const std::int64_t live = scope->live_bytes_.fetch_add(reserved, std::memory_order_relaxed) + reserved;
+			raise(scope->peak_live_bytes_, live);
+		}
+	}
+
+	void AllocationScope::release_in_scopes(std::int64_t reserved)
+	{
+		for (AllocationScope* scope = current_scope; scope != nullptr; scope = scope->outer_)
+		{
+			scope->live_bytes_.fetch_sub(reserved, std::memory_order_relaxed);
+		}
+	}
+
+	AllocationScopeBinding::AllocationScopeBinding(AllocationScope* scope) :
+			previous_(current_scope)
+	{
+		current_scope = scope;
+	}
+
+	AllocationScopeBinding::~AllocationScopeBinding()
+	{
+		current_scope = previous_;
+	}
+
+	std::uint64_t process_peak_rss_bytes()
+	{
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) == 0)
+		{
+			return 0;
+		}
+		return counters.PeakWorkingSetSize;
+#else
+		struct rusage usage{};
+		if (::getrusage(RUSAGE_SELF, &usage) != 0)
+		{
+			return 0;
+		}
+	#if defined(__APPLE__)
+		// Bytes on macOS, kilobytes elsewhere.
+		return static_cast<std::uint64_t>(usage.ru_maxrss);
+	#else
+		return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+	#endif
+#endif
+	}
+
+}  // namespace transformer
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace transformer
+{
+
+	struct AllocationCounts
+	{
+		std::uint64_t allocations = 0;
+		// Bytes requested from operator new.
+		std::uint64_t allocated_bytes = 0;
+		// Highest number of live heap bytes (as the allocator sized the blocks). Per stage: above the live
+		// bytes at the stage's start.
+		std::uint64_t peak_live_bytes = 0;
+	};
+
+	// The global operator new/delete of allocation_hooks.cpp count heap allocations once this has been
+	// called (--track-allocations); until then they only cost a flag check. Blocks freed after enabling
+	// that were allocated before it make the live byte count slightly low, so enable it early.
+	void enable_allocation_tracking();
+
+	[[nodiscard]]
+	bool allocation_tracking_enabled();
+
+	// Process-wide counts since enable_allocation_tracking().
+	[[nodiscard]]
+	AllocationCounts allocation_totals();
+
+	// For the operator new/delete replacements of allocation_hooks.cpp: count a heap block that the
+	// allocator sized `reserved` for a request of `requested` bytes. Callers check the tracking flag.
+	void count_heap_allocation(std::size_t requested, std::size_t reserved);
+	void count_heap_release(std::size_t reserved);
+
+	// For allocators that bypass operator new (vertex_buffer.cpp): count a block of `bytes` like one from
+	// operator new. No-ops while tracking is off.
+	void count_external_allocation(std::size_t bytes);
+	void count_external_release(std::size_t bytes);
+
+	// Allocations between construction and finish() on the constructing thread, and on threads working for
+	// it under an AllocationScopeBinding. Scopes nest per thread: an allocation counts towards every scope
+	// open around it. Stages running on other threads at the same time are not counted, so the four
+	// concurrent readers get their own numbers. Profiler::ScopedStage keeps one. The thread tracks its
+	// innermost scope by address, so a scope cannot be copied or moved and must end on its own thread.
+	class AllocationScope
+	{
+	public:
+		AllocationScope();
+		~AllocationScope();
+		AllocationScope(const AllocationScope&) = delete;
+		AllocationScope& operator=(const AllocationScope&) = delete;
+
+		[[nodiscard]]
+		AllocationCounts finish() const;
+
+		// Innermost scope open on (or bound to) the calling thread; nullptr if none.
+		[[nodiscard]]
+		static AllocationScope* current();
+
+	private:
+		friend void count_heap_allocation(std::size_t requested, std::size_t reserved);
+		friend void count_heap_release(std::size_t reserved);
+		friend void count_external_allocation(std::size_t bytes);
+		friend void count_external_release(std::size_t bytes);
+
+		// Adds to the scopes of the calling thread, innermost outwards.
+		static void count_in_scopes(std::size_t requested, std::int64_t reserved);
+		static void release_in_scopes(std::int64_t reserved);
+
+		// Tracking was on at construction; otherwise the scope is not entered and finish() returns zeros.
+		bool active_ = false;
+		AllocationScope* outer_ = nullptr;
+		// Updated by bound worker threads too.
+		std::atomic<std::uint64_t> allocations_{0};
+		std::atomic<std::uint64_t> allocated_bytes_{0};
+		// Relative to the start; blocks from before the scope freed inside it make this negative.
+		std::atomic<std::int64_t> live_bytes_{0};
+		std::atomic<std::int64_t> peak_live_bytes_{0};
+	};
+
+	// Makes the calling thread count its allocations into scope (and the scopes around it) until
+	// destroyed, for workers that do part of another thread's stage (run_chunk_tasks). scope may be
+	// nullptr, which stops the thread counting into any scope; it must outlive the binding.
+	class AllocationScopeBinding
+	{
+	public:
+		explicit AllocationScopeBinding(AllocationScope* scope);
+		~AllocationScopeBinding();
+		AllocationScopeBinding(const AllocationScopeBinding&) = delete;
+		AllocationScopeBinding& operator=(const AllocationScopeBinding&) = delete;
+
+	private:
+		AllocationScope* previous_;
+	};
+
+	// Peak resident set size of the process so far (getrusage / GetProcessMemoryInfo); 0 if unavailable.
+	[[nodiscard]]
+	std::uint64_t process_peak_rss_bytes();
+
+}  // namespace transformer
@@ -0,0 +1,103 @@
+#include "core/mesh_utils.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace transformer
+{
+
+	void merge_bone_weights(Mesh& mesh, const BoneWeightsData& bone_weights_data)
+	{
+		if (mesh.vertex_count != bone_weights_data.per_vertex_weights.size())
+		{
+			throw std::runtime_error("Vertex count mismatch between mesh and skinning weights");
+		}
+
+		for (std::size_t vertex_index = 0; vertex_index < mesh.vertex_count; ++vertex_index)
+		{
+			mesh.entries[vertex_index].bone_weights = bone_weights_data.per_vertex_weights[vertex_index];
+		}
+	}
+
+	void attach_morph_targets(Mesh& mesh, std::vector<MorphTarget> morph_targets)
+	{
+		for (std::size_t target = 0; target < morph_targets.size(); ++target)
+		{
+			const MorphTarget& morph_target = morph_targets[target];
+			const std::string name = "Morph target " + std::to_string(target);
+			if (morph_target.vertex_indices.size() != morph_target.deltas.size())
+			{
+				throw std::runtime_error(name + ": vertex index and delta counts differ");
+			}
+			for (std::size_t i = 0; i < morph_target.vertex_indices.size(); ++i)
+			{
+				if (morph_target.vertex_indices[i] >= mesh.vertex_count)
+				{
+					throw std::runtime_error(name + ": vertex index out of range");
+				}
+				if (i > 0 && morph_target.vertex_indices[i] <= morph_target.vertex_indices[i - 1])
+				{
+					throw std::runtime_error(name + ": vertex indices must be strictly increasing");
+				}
+			}
+		}
+		mesh.morph_targets = std::move(morph_targets);
+	}
+
+	std::vector<Vec3> compute_vertex_normals(const Mesh& mesh)
+	{
+		std::vector<Vec3> normals(mesh.vertex_count);
+		for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+		{
+			const Vec3& a = mesh.entries[mesh.indices[i]].vertex;
+			const Vec3& b = mesh.entries[mesh.indices[i + 1]].vertex;
+			const Vec3& c = mesh.entries[mesh.indices[i + 2]].vertex;
+			const Vec3 ab{b.x - a.x, b.y - a.y, b.z - a.z};
+			const Vec3 ac{c.x - a.x, c.y - a.y, c.z - a.z};
+			// The unnormalized cross product is twice the triangle area, which gives the area weighting.
+			const Vec3 face{ab.y * ac.z - ab.z * ac.y, ab.z * ac.x - ab.x * ac.z, ab.x * ac.y - ab.y * ac.x};
+			for (std::size_t k = 0; k < 3; ++k)
+			{
+				Vec3& normal = normals[mesh.indices[i + k]];
+				normal.x += face.x;
+				normal.y += face.y;
+				normal.z += face.z;
+			}
+		}
+
+		for (Vec3& normal : normals)
+		{
+			const float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+			if (length > 0.0F)
+			{
+				normal = {normal.x / length, normal.y / length, normal.z / length};
+			}
+		}
+		return normals;
+	}
+
+	BonePoseData make_bone_pose_data(const std::vector<Mat4>& inverse_bind_pose, const std::vector<Mat4>& new_pose)
+	{
+		if (inverse_bind_pose.size() != new_pose.size())
+		{
+			throw std::runtime_error("Bone count mismatch between inverse bind pose and new pose");
+		}
+		if (inverse_bind_pose.size() > kMaxBones)
+		{
+			throw std::runtime_error(
+					"Too many bones: " + std::to_string(inverse_bind_pose.size()) + " (at most "
+					+ std::to_string(kMaxBones) + ")");
+		}
+
+		BonePoseData bone_pose_data;
+		bone_pose_data.bone_poses.reserve(inverse_bind_pose.size());
+		for (std::size_t i = 0; i < inverse_bind_pose.size(); ++i)
+		{
+			bone_pose_data.bone_poses.push_back({inverse_bind_pose[i], new_pose[i]});
+		}
+		return bone_pose_data;
+	}
+
+}  // namespace transformer
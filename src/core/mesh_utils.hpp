@@ -0,0 +1,26 @@
+#pragma once
+
+#include "core/math_types.hpp"
+
+#include <vector>
+
+namespace transformer
+{
+
+	// Copies per-vertex weights into Mesh::entries; throws if the vertex counts differ.
+	void merge_bone_weights(Mesh& mesh, const BoneWeightsData& bone_weights_data);
+
+	// Moves morph targets into the mesh; throws if a target's lists differ in length, are not strictly
+	// increasing, or reference a vertex out of range.
+	void attach_morph_targets(Mesh& mesh, std::vector<MorphTarget> morph_targets);
+
+	// Area-weighted vertex normals of the mesh triangles, indexed like entries. Vertices that only touch
+	// degenerate triangles (or none) get a zero normal.
+	[[nodiscard]]
+	std::vector<Vec3> compute_vertex_normals(const Mesh& mesh);
+
+	// Pairs inverse bind and new pose matrices per bone; throws if the bone counts differ or exceed kMaxBones.
+	[[nodiscard]]
+	BonePoseData make_bone_pose_data(const std::vector<Mat4>& inverse_bind_pose, const std::vector<Mat4>& new_pose);
+
+}  // namespace transformer
@@ -57,6 +57,11 @@ namespace transformer
 	{
 		const auto end = std::chrono::steady_clock::now();
 		const auto elapsed = std::chrono::duration<double, std::micro>(end - start_).count();
+		if (allocation_tracking_enabled())
+		{
+			profiler_.record(stage_name_, elapsed, allocations_.finish());
+			return;
+		}
 		profiler_.record(stage_name_, elapsed);
 	}
 
@@ -70,9 +75,76 @@ namespace transformer
 		entries_.push_back(TimingEntry{stage_name, microseconds});
 	}
 
+	void Profiler::record(const std::string& stage_name, double microseconds, const AllocationCounts& allocations)
+	{
+		entries_.push_back(TimingEntry{stage_name, microseconds, allocations});
+	}
+
+	void Profiler::add_counter(const std::string& counter_name, std::uint64_t delta)
+	{
+		const auto it = std::find_if(
+				counters_.begin(),
+				counters_.end(),
+				[&](const CounterEntry& counter) { return counter.name == counter_name; });
+		if (it != counters_.end())
+		{
+			it->value += delta;
+			return;
+		}
+		counters_.push_back(CounterEntry{counter_name, delta});
+	}
+
+	void Profiler::merge(const Profiler& other)
+	{
+		entries_.insert(entries_.end(), other.entries_.begin(), other.entries_.end());
+		for (const CounterEntry& counter : other.counters_)
+		{
+			add_counter(counter.name, counter.value);
+		}
+	}
+
+	void Profiler::accumulate(const Profiler& other)
+	{
+		for (const TimingEntry& entry : other.entries_)
+		{
+			const auto it = std::find_if(
+					entries_.begin(),
+					entries_.end(),
+					[&](const TimingEntry& total) { return total.stage == entry.stage; });
+			if (it == entries_.end())
+			{
+				entries_.push_back(entry);
+			}
+			else
+			{
+				it->microseconds += entry.microseconds;
+				if (!it->allocations)
+				{
+					it->allocations = entry.allocations;
+				}
+				else if (entry.allocations)
+				{
+					it->allocations->allocations += entry.allocations->allocations;
+					it->allocations->allocated_bytes += entry.allocations->allocated_bytes;
+					it->allocations->peak_live_bytes
+							= std::max(it->allocations->peak_live_bytes, entry.allocations->peak_live_bytes);
+				}
+			}
+		}
+		for (const CounterEntry& counter : other.counters_)
+		{
+			add_counter(counter.name, counter.value);
+		}
+	}
+
 	const std::vector<TimingEntry>& Profiler::entries() const
 	{
 		return entries_;
 	}
 
+	const std::vector<CounterEntry>& Profiler::counters() const
+	{
+		return counters_;
+	}
+
 }  // namespace transformer
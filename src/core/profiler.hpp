@@ -1,6 +1,10 @@
 #pragma once
 
+#include "core/math_types.hpp"
+#include "core/memory_tracking.hpp"
+
 #include <chrono>
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <vector>
@@ -12,6 +16,14 @@ namespace transformer
 	{
 		std::string stage;
 		double microseconds = 0.0;
+		// Heap use of the stage when --track-allocations is on.
+		std::optional<AllocationCounts> allocations;
+	};
+
+	struct CounterEntry
+	{
+		std::string name;
+		std::uint64_t value = 0;
 	};
 
 	struct BenchSummary
@@ -24,10 +36,57 @@ namespace transformer
 		double stddev_microseconds = 0.0;
 	};
 
+	// Output of a --output-format vertex-cache run; the stats writer adds ratio and throughput.
+	struct VertexCacheSummary
+	{
+		std::size_t frames = 0;
+		// Size of the same frames as plain float xyz positions.
+		std::uint64_t raw_bytes = 0;
+		// Cache file size, header included.
+		std::uint64_t encoded_bytes = 0;
+		// Quantization and entropy coding on the encoder thread, file writes excluded.
+		double encode_microseconds = 0.0;
+	};
+
+	// Output of a --jobs run: throughput over the wall time of the whole batch, latency per job (first
+	// input read to last frame written).
+	struct BatchSummary
+	{
+		std::size_t workers = 0;
+		std::size_t jobs = 0;
+		std::size_t failed_jobs = 0;
+		std::size_t frames = 0;
+		std::uint64_t vertices_skinned = 0;
+		double wall_microseconds = 0.0;
+		BenchSummary job_latency;
+	};
+
+	// Output of --deterministic: the deterministic kernel in use against the fastest fused (_fma) one on a
+	// sample of the mesh. fastest_kernel is empty when no fused kernel runs on this machine.
+	struct DeterminismSummary
+	{
+		std::string kernel;
+		std::string fastest_kernel;
+		std::size_t sample_vertices = 0;
+		// Fastest of several passes over the sample each.
+		double deterministic_microseconds = 0.0;
+		double fastest_microseconds = 0.0;
+		// Sample vertices whose fused result differs in any bit.
+		std::size_t differing_vertices = 0;
+	};
+
 	struct StatsReport
 	{
 		std::vector<TimingEntry> stages;
+		std::vector<CounterEntry> counters;
 		std::optional<BenchSummary> bench_summary;
+		std::optional<VertexCacheSummary> vertex_cache;
+		std::optional<BatchSummary> batch;
+		std::optional<DeterminismSummary> determinism;
+		// One per output frame when --bounds is given.
+		std::vector<SkinnedBounds> bounds;
+		// Skinning kernel variant that ran (see skinning/kernels/kernel_registry.hpp); omitted if empty.
+		std::string kernel;
 	};
 
 	[[nodiscard]]
@@ -46,16 +105,29 @@ namespace transformer
 			Profiler& profiler_;
 			std::string stage_name_;
 			std::chrono::steady_clock::time_point start_;
+			AllocationScope allocations_;
 		};
 
 		[[nodiscard]]
 		ScopedStage stage(const std::string& stage_name);
 		void record(const std::string& stage_name, double microseconds);
+		void record(const std::string& stage_name, double microseconds, const AllocationCounts& allocations);
+		// Accumulates into a named counter; counters keep the order they were first added in.
+		void add_counter(const std::string& counter_name, std::uint64_t delta);
+		// Appends another profiler's stages and adds its counters. Profiler is not thread-safe, so
+		// concurrent tasks record into their own instance and are merged after the join.
+		void merge(const Profiler& other);
+		// Like merge, but adds each stage to the entry of the same name (appending unseen names), so
+		// repeated work (per job, per window) stays one entry per stage. Allocation peaks take the maximum.
+		void accumulate(const Profiler& other);
 		[[nodiscard]]
 		const std::vector<TimingEntry>& entries() const;
+		[[nodiscard]]
+		const std::vector<CounterEntry>& counters() const;
 
 	private:
 		std::vector<TimingEntry> entries_;
+		std::vector<CounterEntry> counters_;
 	};
 
 }  // namespace transformer
@@ -0,0 +1,10 @@
+#pragma once
+
+// SSE2 is part of every x86-64 target (and of 32-bit x86 builds that enable it). Code with an SSE path
+// checks TRANSFORMER_HAS_SSE2 and keeps a scalar path for other targets, e.g. ARM.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define TRANSFORMER_HAS_SSE2 1
+	#include <immintrin.h>	// SIMD
+#else
+	#define TRANSFORMER_HAS_SSE2 0
+#endif
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace transformer
+{
+
+	// Bounded lock-free queue between exactly one producer thread and one consumer thread. Each side
+	// owns one index and only reads the other's, so a transfer is one release store and, when the
+	// cached copy of the other index is stale, one acquire load. The blocking push and pop sleep on
+	// the other side's index (std::atomic::wait) instead of spinning.
+	template <typename T>
+	class SpscRing
+	{
+	public:
+		// capacity is rounded up to a power of two.
+		explicit SpscRing(std::size_t capacity) :
+				slots_(round_up_to_power_of_two(capacity)),
+				mask_(slots_.size() - 1)
+		{}
+
+		SpscRing(const SpscRing&) = delete;
+		SpscRing& operator=(const SpscRing&) = delete;
+
+		[[nodiscard]]
+		std::size_t capacity() const
+		{
+			return slots_.size();
+		}
+
+		// Producer only. False if the ring is full.
+		bool try_push(const T& value)
+		{
+			const std::size_t head = head_.load(std::memory_order_relaxed);
+			if (head - producer_tail_ == slots_.size())
+			{
+				producer_tail_ = tail_.load(std::memory_order_acquire);
+				if (head - producer_tail_ == slots_.size())
+				{
+					return false;
+				}
+			}
+			slots_[head & mask_] = value;
+			head_.store(head + 1, std::memory_order_release);
+			head_.notify_one();
+			return true;
+		}
+
+		// Consumer only. False if the ring is empty.
+		bool try_pop(T& value)
+		{
+			const std::size_t tail = tail_.load(std::memory_order_relaxed);
+			if (tail == consumer_head_)
+			{
+				consumer_head_ = head_.load(std::memory_order_acquire);
+				if (tail == consumer_head_)
+				{
+					return false;
+				}
+			}
+			value = std::move(slots_[tail & mask_]);
+			tail_.store(tail + 1, std::memory_order_release);
+			tail_.notify_one();
+			return true;
+		}
+
+		// Producer only. Waits while the ring is full.
+		void push(const T& value)
+		{
+			while (!try_push(value))
+			{
+				tail_.wait(producer_tail_, std::memory_order_acquire);
+			}
+		}
+
+		// Consumer only. Waits while the ring is empty.
+		T pop()
+		{
+			T value;
+			while (!try_pop(value))
+			{
+				head_.wait(consumer_head_, std::memory_order_acquire);
+			}
+			return value;
+		}
+
+	private:
+		static std::size_t round_up_to_power_of_two(std::size_t value)
+		{
+			std::size_t rounded = 1;
+			while (rounded < value)
+			{
+				rounded <<= 1;
+			}
+			return rounded;
+		}
+
+		// 64 bytes apart, so the two sides do not share a cache line.
+		static constexpr std::size_t kCacheLine = 64;
+
+		std::vector<T> slots_;
+		std::size_t mask_ = 0;
+
+		// Next slot to write; written by the producer.
+		alignas(kCacheLine) std::atomic<std::size_t> head_{0};
+		// Producer's last view of tail_.
+		std::size_t producer_tail_ = 0;
+
+		// Next slot to read; written by the consumer.
+		alignas(kCacheLine) std::atomic<std::size_t> tail_{0};
+		// Consumer's last view of head_.
+		std::size_t consumer_head_ = 0;
+	};
+
+}  // namespace transformer
@@ -0,0 +1,202 @@
+#include "core/vertex_buffer.hpp"
+
+#include "core/chunk_threads.hpp"
+#include "core/memory_tracking.hpp"
+
+#include <atomic>
+#include <memory>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+#endif
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		constexpr std::size_t kHugePageBytes = kMappedVertexBufferBytes;
+		// First touch writes one byte per small page.
+		constexpr std::size_t kTouchStride = 4096;
+
+		bool huge_pages = false;
+		std::unique_ptr<ChunkThreads> threads;
+
+		std::atomic<std::uint64_t> reserved_huge_page_bytes{0};
+		std::atomic<std::uint64_t> transparent_huge_page_bytes{0};
+		std::atomic<std::uint64_t> small_page_bytes{0};
+
+		std::size_t mapped_size(std::size_t bytes)
+		{
+			return (bytes + kHugePageBytes - 1) / kHugePageBytes * kHugePageBytes;
+		}
+
+#if defined(_WIN32)
+		void* map(std::size_t size)
+		{
+			if (huge_pages)
+			{
+				// Needs the "Lock pages in memory" privilege; without it the call fails and normal pages are used.
+				const std::size_t large_page = GetLargePageMinimum();
+				if (large_page != 0 && size % large_page == 0)
+				{
+					void* buffer
+							= VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+					if (buffer != nullptr)
+					{
+						reserved_huge_page_bytes.fetch_add(size);
+						return buffer;
+					}
+				}
+			}
+			void* buffer = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			if (buffer == nullptr)
+			{
+				throw std::bad_alloc();
+			}
+			small_page_bytes.fetch_add(size);
+			return buffer;
+		}
+
+		void unmap(void* buffer, std::size_t /*size*/)
+		{
+			VirtualFree(buffer, 0, MEM_RELEASE);
+		}
+#else
+		void* map(std::size_t size)
+		{
+	#if defined(MAP_HUGETLB)
+			if (huge_pages)
+			{
+				// Fails with ENOMEM when the pool (vm.nr_hugepages) cannot hold the whole buffer.
+				constexpr int kFlags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+				void* buffer = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, kFlags, -1, 0);
+				if (buffer != MAP_FAILED)
+				{
+					reserved_huge_page_bytes.fetch_add(size);
+					return buffer;
+				}
+			}
+	#endif
+			// Over-map by one huge page and trim both ends, so the buffer starts on a huge page boundary.
+			const std::size_t padded = size + kHugePageBytes;
+			void* mapping = ::mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (mapping == MAP_FAILED)
+			{
+				throw std::bad_alloc();
+			}
+			const auto start = reinterpret_cast<std::uintptr_t>(mapping);
+			const std::uintptr_t aligned = (start + kHugePageBytes - 1) / kHugePageBytes * kHugePageBytes;
+			if (aligned != start)
+			{
+				::munmap(mapping, aligned - start);
+			}
+			if (const std::size_t tail = padded - (aligned - start) - size; tail != 0)
+			{
+				::munmap(reinterpret_cast<void*>(aligned + size), tail);
+			}
+			auto* buffer = reinterpret_cast<void*>(aligned);
+
+	#if defined(MADV_HUGEPAGE)
+			// Without THP support (or with it set to "never") this fails or does nothing; normal pages remain.
+			if (huge_pages && ::madvise(buffer, size, MADV_HUGEPAGE) == 0)
+			{
+				transparent_huge_page_bytes.fetch_add(size);
+				return buffer;
+			}
+	#endif
+			small_page_bytes.fetch_add(size);
+			return buffer;
+		}
+
+		void unmap(void* buffer, std::size_t size)
+		{
+			::munmap(buffer, size);
+		}
+#endif
+
+		// Writes the first byte of every page, each chunk on the skinning thread that will process it, so
+		// first-touch placement puts the pages on that thread's NUMA node.
+		void first_touch(void* buffer, std::size_t bytes, std::size_t element_size)
+		{
+			auto* bytes_begin = static_cast<volatile unsigned char*>(buffer);
+			threads->run(
+					bytes / element_size,
+					[&](std::size_t /*chunk*/, std::size_t begin, std::size_t end)
+					{
+						const std::size_t first_byte = begin * element_size;
+						const std::size_t end_byte = end * element_size;
+						// Each page start lies in exactly one chunk.
+						for (std::size_t offset = (first_byte + kTouchStride - 1) / kTouchStride * kTouchStride;
+							 offset < end_byte;
+							 offset += kTouchStride)
+						{
+							bytes_begin[offset] = 0;
+						}
+					});
+		}
+
+	}  // namespace
+
+	void configure_vertex_buffers(const VertexBufferOptions& options)
+	{
+		huge_pages = options.huge_pages;
+		threads.reset();
+		if (options.threads != 1)
+		{
+			threads = std::make_unique<ChunkThreads>(options.threads);
+			if (threads->thread_count() == 1)
+			{
+				threads.reset();
+			}
+		}
+	}
+
+	ChunkThreads* vertex_buffer_threads()
+	{
+		return threads.get();
+	}
+
+	VertexBufferCounts vertex_buffer_counts()
+	{
+		return {
+				.reserved_huge_page_bytes = reserved_huge_page_bytes.load(),
+				.transparent_huge_page_bytes = transparent_huge_page_bytes.load(),
+				.small_page_bytes = small_page_bytes.load(),
+		};
+	}
+
+	void* allocate_vertex_buffer(std::size_t bytes, std::size_t element_size)
+	{
+		if (bytes < kMappedVertexBufferBytes)
+		{
+			return ::operator new(bytes);
+		}
+		const std::size_t size = mapped_size(bytes);
+		void* buffer = map(size);
+		count_external_allocation(size);
+		if (threads != nullptr)
+		{
+			first_touch(buffer, bytes, element_size);
+		}
+		return buffer;
+	}
+
+	void free_vertex_buffer(void* buffer, std::size_t bytes) noexcept
+	{
+		if (bytes < kMappedVertexBufferBytes)
+		{
+			::operator delete(buffer);
+			return;
+		}
+		const std::size_t size = mapped_size(bytes);
+		count_external_release(size);
+		unmap(buffer, size);
+	}
+
+}  // namespace transformer
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+namespace transformer
+{
+
+	class ChunkThreads;
+
+	struct VertexBufferOptions
+	{
+		// Back mapped buffers with huge pages: MAP_HUGETLB (large pages on Windows) while the reserved pool
+		// has room, else transparent huge pages via madvise, else normal pages.
+		bool huge_pages = false;
+		// Skinning threads; 0 means one per hardware thread. Above 1, MeshSkinner splits its pass over
+		// vertex_buffer_threads(), and the pages of every new mapped buffer are first touched by the thread
+		// that will skin them.
+		std::size_t threads = 1;
+	};
+
+	// Buffers of at least this many bytes are mapped directly, 2 MB aligned so that huge pages can back
+	// them; smaller ones come from operator new.
+	inline constexpr std::size_t kMappedVertexBufferBytes = std::size_t{2} << 20;
+
+	// Applies to buffers allocated afterwards, whatever was configured when the existing ones were
+	// allocated. Not thread-safe: call it while no vertex buffer is being allocated or skinned.
+	void configure_vertex_buffers(const VertexBufferOptions& options);
+
+	// The skinning threads, or nullptr when skinning runs on the calling thread only.
+	[[nodiscard]]
+	ChunkThreads* vertex_buffer_threads();
+
+	// Bytes of mapped buffers by page kind, since the start of the process.
+	struct VertexBufferCounts
+	{
+		std::uint64_t reserved_huge_page_bytes = 0;
+		std::uint64_t transparent_huge_page_bytes = 0;
+		std::uint64_t small_page_bytes = 0;
+	};
+
+	[[nodiscard]]
+	VertexBufferCounts vertex_buffer_counts();
+
+	// Throws std::bad_alloc. element_size is the stride the first-touch split keeps chunks aligned to.
+	[[nodiscard]]
+	void* allocate_vertex_buffer(std::size_t bytes, std::size_t element_size);
+	void free_vertex_buffer(void* buffer, std::size_t bytes) noexcept;
+
+	// Allocator of Mesh::entries (vertex input and skinned output).
+	template <typename T>
+	class VertexBufferAllocator
+	{
+	public:
+		using value_type = T;
+
+		VertexBufferAllocator() = default;
+
+		template <typename U>
+		VertexBufferAllocator(const VertexBufferAllocator<U>& /*other*/) noexcept
+		{}
+
+		[[nodiscard]]
+		T* allocate(std::size_t count)
+		{
+			if (count > std::numeric_limits<std::size_t>::max() / sizeof(T))
+			{
+				throw std::bad_array_new_length();
+			}
+			return static_cast<T*>(allocate_vertex_buffer(count * sizeof(T), sizeof(T)));
+		}
+
+		void deallocate(T* buffer, std::size_t count) noexcept
+		{
+			free_vertex_buffer(buffer, count * sizeof(T));
+		}
+
+		friend bool operator==(const VertexBufferAllocator& /*lhs*/, const VertexBufferAllocator& /*rhs*/)
+		{
+			return true;
+		}
+	};
+
+}  // namespace transformer
@@ -0,0 +1,206 @@
+#include "core/weight_validation.hpp"
+
+#include "core/simd.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		constexpr float kWeightSumTolerance = 1e-3F;
+		constexpr std::size_t kMaxReportedVertices = 10;
+
+#if TRANSFORMER_HAS_SSE2
+		// Bit v is set if entries[v] may break the rules; a cheap, conservative screen (SSE2 only).
+		// limit is bone_count (at most 255) in every byte, so the unused index -1 (255) is always >= limit.
+		// Also ORs the slots with a non-zero weight into used_slots.
+		int screen_block(const Mesh::Entry* entries, __m128i limit, int& used_slots)
+		{
+			std::int32_t packed_indices[4];
+			for (std::size_t v = 0; v < 4; ++v)
+			{
+				std::memcpy(&packed_indices[v], entries[v].bone_weights.bone_indices.data(), sizeof(std::int32_t));
+			}
+			// Unsigned byte compare: index >= limit  <=>  max(index, limit) == index.
+			const __m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(packed_indices));
+			const __m128i no_bone = _mm_cmpeq_epi8(_mm_max_epu8(indices, limit), indices);
+
+			// Widen the byte mask to one dword per slot: vertex v owns bytes 4v .. 4v + 3.
+			const __m128i low = _mm_unpacklo_epi8(no_bone, no_bone);
+			const __m128i high = _mm_unpackhi_epi8(no_bone, no_bone);
+			const __m128i no_bone_slots[4] = {
+					_mm_unpacklo_epi16(low, low),
+					_mm_unpackhi_epi16(low, low),
+					_mm_unpacklo_epi16(high, high),
+					_mm_unpackhi_epi16(high, high),
+			};
+
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 largest = _mm_set1_ps(std::numeric_limits<float>::max());
+			__m128 rows[4];
+			int flags = 0;
+			for (std::size_t v = 0; v < 4; ++v)
+			{
+				rows[v] = _mm_loadu_ps(entries[v].bone_weights.weights.data());
+				// The negated compares are also true for NaN.
+				const __m128 out_of_range = _mm_or_ps(_mm_cmpnge_ps(rows[v], zero), _mm_cmpnle_ps(rows[v], largest));
+				const __m128 weighted = _mm_cmpneq_ps(rows[v], zero);
+				const __m128 stray = _mm_and_ps(_mm_castsi128_ps(no_bone_slots[v]), weighted);
+				flags |= (_mm_movemask_ps(_mm_or_ps(out_of_range, stray)) != 0 ? 1 : 0) << v;
+				used_slots |= _mm_movemask_ps(weighted);
+			}
+
+			// After the transpose rows[slot] holds that slot's weight for all four vertices.
+			_MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+			const __m128 sums = _mm_add_ps(_mm_add_ps(rows[0], rows[1]), _mm_add_ps(rows[2], rows[3]));
+			const __m128 error = _mm_andnot_ps(_mm_set1_ps(-0.0F), _mm_sub_ps(sums, _mm_set1_ps(1.0F)));
+			return flags | _mm_movemask_ps(_mm_cmpnlt_ps(error, _mm_set1_ps(kWeightSumTolerance)));
+		}
+#endif
+
+		int used_slot_mask(const VertexBoneWeights& bone_weights)
+		{
+			int mask = 0;
+			for (std::size_t slot = 0; slot < 4; ++slot)
+			{
+				mask |= (bone_weights.weights[slot] != 0.0F ? 1 : 0) << slot;
+			}
+			return mask;
+		}
+
+		// Empty if the vertex is fine after all (the screen over-approximates), else the first problem.
+		std::string describe_problem(const VertexBoneWeights& bone_weights, std::size_t limit)
+		{
+			float sum = 0.0F;
+			for (std::size_t slot = 0; slot < 4; ++slot)
+			{
+				const float weight = bone_weights.weights[slot];
+				const auto bone = static_cast<std::uint8_t>(bone_weights.bone_indices[slot]);
+				if (!std::isfinite(weight) || weight < 0.0F)
+				{
+					return "weight " + std::to_string(weight) + " in slot " + std::to_string(slot);
+				}
+				if (weight != 0.0F && bone >= limit)
+				{
+					const std::string bone_text = bone == 255 ? "unused" : "bone " + std::to_string(bone);
+					return "slot " + std::to_string(slot) + " (" + bone_text + ") has weight " + std::to_string(weight);
+				}
+				sum += weight;
+			}
+			if (!(std::abs(sum - 1.0F) < kWeightSumTolerance))
+			{
+				return "weights sum to " + std::to_string(sum);
+			}
+			return {};
+		}
+
+		// Drops influences describe_problem() would reject and rescales the rest. False if none is left.
+		bool renormalize(VertexBoneWeights& bone_weights, std::size_t limit)
+		{
+			float sum = 0.0F;
+			for (std::size_t slot = 0; slot < 4; ++slot)
+			{
+				float& weight = bone_weights.weights[slot];
+				const auto bone = static_cast<std::uint8_t>(bone_weights.bone_indices[slot]);
+				if (!std::isfinite(weight) || weight <= 0.0F || bone >= limit)
+				{
+					bone_weights.bone_indices[slot] = -1;
+					weight = 0.0F;
+				}
+				sum += weight;
+			}
+			if (sum <= 0.0F)
+			{
+				return false;
+			}
+			for (float& weight : bone_weights.weights)
+			{
+				weight /= sum;
+			}
+			return true;
+		}
+
+	}  // namespace
+
+	std::size_t validate_bone_weights(Mesh& mesh, std::size_t bone_count, WeightsPolicy policy)
+	{
+		if (bone_count > kMaxBones)
+		{
+			throw std::runtime_error(
+					"Too many bones: " + std::to_string(bone_count) + " (at most " + std::to_string(kMaxBones) + ")");
+		}
+
+		std::size_t renormalized = 0;
+		std::size_t invalid = 0;
+		std::string report;
+		auto check_vertex = [&](std::size_t vertex_index)
+		{
+			VertexBoneWeights& bone_weights = mesh.entries[vertex_index].bone_weights;
+			const std::string problem = describe_problem(bone_weights, bone_count);
+			if (problem.empty())
+			{
+				return;
+			}
+			if (policy == WeightsPolicy::Renormalize && renormalize(bone_weights, bone_count))
+			{
+				++renormalized;
+				return;
+			}
+			if (invalid++ < kMaxReportedVertices)
+			{
+				report += "\n  vertex " + std::to_string(vertex_index) + ": " + problem;
+			}
+		};
+
+		// Weight slots non-zero in any vertex, before repairs (which only clear slots).
+		int used_slots = 0;
+		std::size_t vertex_index = 0;
+#if TRANSFORMER_HAS_SSE2
+		const __m128i limit_bytes = _mm_set1_epi8(static_cast<char>(bone_count));
+		for (; vertex_index + 4 <= mesh.vertex_count; vertex_index += 4)
+		{
+			const int flags = screen_block(mesh.entries.data() + vertex_index, limit_bytes, used_slots);
+			for (std::size_t v = 0; flags != 0 && v < 4; ++v)
+			{
+				if ((flags & (1 << v)) != 0)
+				{
+					check_vertex(vertex_index + v);
+				}
+			}
+		}
+#endif
+		for (; vertex_index < mesh.vertex_count; ++vertex_index)
+		{
+			used_slots |= used_slot_mask(mesh.entries[vertex_index].bone_weights);
+			check_vertex(vertex_index);
+		}
+
+		if (invalid != 0)
+		{
+			throw std::runtime_error(
+					"Invalid bone weights in " + std::to_string(invalid) + " of " + std::to_string(mesh.vertex_count)
+					+ " vertices (" + std::to_string(bone_count) + " bones)"
+					+ (policy == WeightsPolicy::Error ? "; --weights-policy renormalize repairs them" : "") + ":"
+					+ report + (invalid > kMaxReportedVertices ? "\n  ..." : ""));
+		}
+
+		mesh.max_influences = 1;
+		for (std::size_t slot = 1; slot < 4; ++slot)
+		{
+			if ((used_slots & (1 << slot)) != 0)
+			{
+				mesh.max_influences = slot + 1;
+			}
+		}
+		return renormalized;
+	}
+
+}  // namespace transformer
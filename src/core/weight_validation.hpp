@@ -0,0 +1,29 @@
+#pragma once
+
+#include "core/math_types.hpp"
+
+#include <cstddef>
+
+namespace transformer
+{
+
+	// What to do with vertices whose influences break the skinning kernel's assumptions.
+	enum class WeightsPolicy
+	{
+		// Throw, listing the offending vertices.
+		Error,
+		// Drop invalid influences and rescale the rest to sum to 1; only vertices left without any
+		// weight are an error.
+		Renormalize,
+	};
+
+	// The hot loop never branches on influences, so every vertex must satisfy, in Release builds too:
+	// all four weights finite and non-negative, summing to 1 (within 1e-3), and a non-zero weight only on
+	// slots whose bone index is below bone_count (unused slots, index -1, carry weight 0). Screened with
+	// SSE2 four vertices at a time (where available); only vertices that fail take the scalar path that
+	// reports or repairs them. Also sets mesh.max_influences (slots up to the last one weighted in any
+	// vertex). Returns the number of vertices renormalized (always 0 with WeightsPolicy::Error). Throws
+	// std::runtime_error if bone_count exceeds kMaxBones, whatever the policy.
+	std::size_t validate_bone_weights(Mesh& mesh, std::size_t bone_count, WeightsPolicy policy);
+
+}  // namespace transformer
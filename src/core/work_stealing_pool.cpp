@@ -0,0 +1,163 @@
+#include "core/work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		// The pool and deque index of the calling thread, if it is a pool worker.
+		thread_local const WorkStealingPool* current_pool = nullptr;
+		thread_local std::size_t current_worker = 0;
+
+	}  // namespace
+
+	WorkStealingPool::WorkStealingPool(std::size_t thread_count)
+	{
+		if (thread_count == 0)
+		{
+			thread_count = std::max(1U, std::thread::hardware_concurrency());
+		}
+		workers_.reserve(thread_count);
+		for (std::size_t i = 0; i < thread_count; ++i)
+		{
+			workers_.push_back(std::make_unique<Worker>());
+		}
+		threads_.reserve(thread_count);
+		for (std::size_t i = 0; i < thread_count; ++i)
+		{
+			threads_.emplace_back([this, i] { worker_loop(i); });
+		}
+	}
+
+	WorkStealingPool::~WorkStealingPool()
+	{
+		{
+			const std::lock_guard<std::mutex> lock(state_mutex_);
+			stopping_ = true;
+		}
+		work_available_.notify_all();
+		for (std::thread& thread : threads_)
+		{
+			thread.join();
+		}
+	}
+
+	void WorkStealingPool::submit(Task task)
+	{
+		const std::size_t index = current_pool == this ? current_worker
+														: next_worker_.fetch_add(1) % workers_.size();
+		{
+			// Counted before the task becomes stealable: a worker that takes and finishes it at once must not
+			// bring pending_ to 0 while the submitting task still runs. Under the state mutex, so a worker
+			// about to sleep cannot miss it; one woken before the push below just looks again.
+			const std::lock_guard<std::mutex> lock(state_mutex_);
+			++pending_;
+			queued_.fetch_add(1);
+		}
+		{
+			const std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+			workers_[index]->tasks.push_back(std::move(task));
+		}
+		work_available_.notify_one();
+	}
+
+	void WorkStealingPool::wait()
+	{
+		std::unique_lock<std::mutex> lock(state_mutex_);
+		all_done_.wait(lock, [this] { return pending_ == 0; });
+		if (error_)
+		{
+			std::exception_ptr error = std::exchange(error_, nullptr);
+			lock.unlock();
+			std::rethrow_exception(error);
+		}
+	}
+
+	std::size_t WorkStealingPool::thread_count() const
+	{
+		return workers_.size();
+	}
+
+	std::uint64_t WorkStealingPool::steals() const
+	{
+		return steals_.load();
+	}
+
+	bool WorkStealingPool::pop_local(std::size_t index, Task& task)
+	{
+		Worker& worker = *workers_[index];
+		const std::lock_guard<std::mutex> lock(worker.mutex);
+		if (worker.tasks.empty())
+		{
+			return false;
+		}
+		task = std::move(worker.tasks.back());
+		worker.tasks.pop_back();
+		queued_.fetch_sub(1);
+		return true;
+	}
+
+	bool WorkStealingPool::steal(std::size_t thief, Task& task)
+	{
+		for (std::size_t offset = 1; offset < workers_.size(); ++offset)
+		{
+			Worker& victim = *workers_[(thief + offset) % workers_.size()];
+			const std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.tasks.empty())
+			{
+				task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+				queued_.fetch_sub(1);
+				steals_.fetch_add(1);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void WorkStealingPool::worker_loop(std::size_t index)
+	{
+		current_pool = this;
+		current_worker = index;
+		while (true)
+		{
+			Task task;
+			if (!pop_local(index, task) && !steal(index, task))
+			{
+				std::unique_lock<std::mutex> lock(state_mutex_);
+				work_available_.wait(lock, [this] { return queued_.load() != 0 || stopping_; });
+				if (stopping_ && queued_.load() == 0)
+				{
+					return;
+				}
+				continue;
+			}
+
+			std::exception_ptr error;
+			try
+			{
+				task();
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+			task = nullptr;
+
+			const std::lock_guard<std::mutex> lock(state_mutex_);
+			if (error && !error_)
+			{
+				error_ = error;
+			}
+			if (--pending_ == 0)
+			{
+				all_done_.notify_all();
+			}
+		}
+	}
+
+}  // namespace transformer
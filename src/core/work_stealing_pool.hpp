@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace transformer
+{
+
+	// Fixed set of worker threads, one task deque each. A worker pops its own newest task first (so the
+	// follow-up work a task submits runs next, while its data is hot) and, when it runs dry, steals the
+	// oldest task of another worker. Tasks submitted from outside the pool are spread round-robin.
+	class WorkStealingPool
+	{
+	public:
+		using Task = std::function<void()>;
+
+		// thread_count 0 means std::thread::hardware_concurrency().
+		explicit WorkStealingPool(std::size_t thread_count = 0);
+		~WorkStealingPool();
+
+		WorkStealingPool(const WorkStealingPool&) = delete;
+		WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+		// From a task of this pool the task goes to the calling worker's deque.
+		void submit(Task task);
+
+		// Blocks until every submitted task, including those submitted by tasks, has run. Rethrows the
+		// first exception a task let escape (the other tasks still run).
+		void wait();
+
+		[[nodiscard]]
+		std::size_t thread_count() const;
+
+		// Tasks a worker took from another worker's deque.
+		[[nodiscard]]
+		std::uint64_t steals() const;
+
+	private:
+		struct Worker
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		bool pop_local(std::size_t index, Task& task);
+		bool steal(std::size_t thief, Task& task);
+		void worker_loop(std::size_t index);
+
+		std::vector<std::unique_ptr<Worker>> workers_;
+
+		// Guards sleeping and completion; queued_ and pending_ change under it.
+		std::mutex state_mutex_;
+		std::condition_variable work_available_;
+		std::condition_variable all_done_;
+		std::atomic<std::size_t> queued_{0};
+		std::size_t pending_ = 0;
+		bool stopping_ = false;
+		std::exception_ptr error_;
+
+		std::atomic<std::size_t> next_worker_{0};
+		std::atomic<std::uint64_t> steals_{0};
+
+		std::vector<std::thread> threads_;
+	};
+
+}  // namespace transformer
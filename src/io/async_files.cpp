@@ -0,0 +1,171 @@
+#include "io/async_files.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <utility>
+
+namespace transformer
+{
+
+	IoTask<std::int64_t> read_file(AsyncIo& io, const IoFile& file, char* buffer, std::size_t size)
+	{
+		std::deque<IoFuture> reads;
+		std::size_t offset = 0;
+		std::int64_t total = 0;
+		while (offset < size || !reads.empty())
+		{
+			while (offset < size && reads.size() < kAsyncReadsInFlight)
+			{
+				const std::size_t length = std::min(kAsyncReadBytes, size - offset);
+				reads.push_back(io.read(file, buffer + offset, length, offset));
+				offset += length;
+			}
+
+			IoFuture read = std::move(reads.front());
+			reads.pop_front();
+			const std::int64_t result = co_await read;
+			if (result < 0)
+			{
+				// The reads still in flight are waited for as the deque goes.
+				co_return result;
+			}
+			total += result;
+		}
+		co_return total;
+	}
+
+	bool InputFile::open(const std::string& path)
+	{
+		data_.reset();
+		size_ = 0;
+		if (async_io_backend() == AsyncIoBackend::Off)
+		{
+			return mapped_.open(path);
+		}
+
+		IoFile file;
+		if (!file.open_read(path))
+		{
+			return false;
+		}
+		const auto size = static_cast<std::size_t>(file.size());
+		data_ = std::make_unique_for_overwrite<char[]>(size);
+		AsyncIo& io = thread_async_io();
+		const std::int64_t result = io.run(read_file(io, file, data_.get(), size));
+		if (result < 0)
+		{
+			throw std::runtime_error("Failed to read file: " + path + ": " + std::strerror(static_cast<int>(-result)));
+		}
+		size_ = static_cast<std::size_t>(result);
+		return true;
+	}
+
+	std::string_view InputFile::view() const
+	{
+		return data_ == nullptr ? mapped_.view() : std::string_view(data_.get(), size_);
+	}
+
+	InputFile load_input_file(const std::string& path)
+	{
+		InputFile file;
+		open_with_typo_fallback(file, path);
+		return file;
+	}
+
+	AsyncFileWriter::AsyncFileWriter(AsyncIo& io) :
+			io_(io)
+	{}
+
+	AsyncFileWriter::~AsyncFileWriter()
+	{
+		close();
+	}
+
+	bool AsyncFileWriter::open(const std::string& path)
+	{
+		close();
+		if (!file_.create(path))
+		{
+			return false;
+		}
+		for (Block& block : blocks_)
+		{
+			if (block.data == nullptr)
+			{
+				block.data = std::make_unique_for_overwrite<char[]>(kAsyncWriteBytes);
+			}
+		}
+		current_ = 0;
+		offset_ = 0;
+		failed_ = false;
+		setp(blocks_[0].data.get(), blocks_[0].data.get() + kAsyncWriteBytes);
+		return true;
+	}
+
+	bool AsyncFileWriter::close()
+	{
+		if (!file_.is_open())
+		{
+			return !failed_;
+		}
+		issue();
+		for (Block& block : blocks_)
+		{
+			wait(block);
+		}
+		setp(nullptr, nullptr);
+		if (!file_.close())
+		{
+			failed_ = true;
+		}
+		return !failed_;
+	}
+
+	AsyncFileWriter::int_type AsyncFileWriter::overflow(int_type ch)
+	{
+		if (!file_.is_open())
+		{
+			return traits_type::eof();
+		}
+		issue();
+		if (traits_type::eq_int_type(ch, traits_type::eof()))
+		{
+			return traits_type::not_eof(ch);
+		}
+		*pptr() = traits_type::to_char_type(ch);
+		pbump(1);
+		return ch;
+	}
+
+	void AsyncFileWriter::issue()
+	{
+		Block& block = blocks_[current_];
+		block.size = static_cast<std::size_t>(pptr() - pbase());
+		if (block.size == 0)
+		{
+			return;
+		}
+		block.write.emplace(io_.write(file_, block.data.get(), block.size, offset_));
+		offset_ += block.size;
+
+		current_ = (current_ + 1) % blocks_.size();
+		Block& next = blocks_[current_];
+		wait(next);
+		setp(next.data.get(), next.data.get() + kAsyncWriteBytes);
+	}
+
+	void AsyncFileWriter::wait(Block& block)
+	{
+		if (block.write)
+		{
+			if (block.write->wait() != static_cast<std::int64_t>(block.size))
+			{
+				failed_ = true;
+			}
+			block.write.reset();
+		}
+	}
+
+}  // namespace transformer
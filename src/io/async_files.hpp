@@ -0,0 +1,91 @@
+#pragma once
+
+#include "io/async_io.hpp"
+#include "io/mapped_file.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+namespace transformer
+{
+
+	// Reads in flight per file, and the size of each.
+	inline constexpr std::size_t kAsyncReadsInFlight = 16;
+	inline constexpr std::size_t kAsyncReadBytes = std::size_t{1} << 20;
+
+	// Reads size bytes of file from offset 0 into buffer, keeping kAsyncReadsInFlight reads in flight.
+	// Returns the bytes read (fewer if the file shrank), or -errno.
+	IoTask<std::int64_t> read_file(AsyncIo& io, const IoFile& file, char* buffer, std::size_t size);
+
+	// A whole input file for the parsers. Mapped while async I/O is off; otherwise read into memory through
+	// the calling thread's AsyncIo.
+	class InputFile
+	{
+	public:
+		// Returns false if the file cannot be opened, like MappedFile::open; throws std::runtime_error if
+		// reading it fails.
+		bool open(const std::string& path);
+
+		[[nodiscard]]
+		std::string_view view() const;
+
+	private:
+		MappedFile mapped_;
+		std::unique_ptr<char[]> data_;
+		std::size_t size_ = 0;
+	};
+
+	// Like open_input_file(), for an InputFile.
+	[[nodiscard]]
+	InputFile load_input_file(const std::string& path);
+
+	// Output stream buffer that writes through an AsyncIo in kAsyncWriteBytes blocks, up to
+	// kAsyncWritesInFlight at once, so formatting the next block overlaps writing the previous ones.
+	class AsyncFileWriter final : public std::streambuf
+	{
+	public:
+		static constexpr std::size_t kAsyncWritesInFlight = 4;
+		static constexpr std::size_t kAsyncWriteBytes = std::size_t{1} << 20;
+
+		explicit AsyncFileWriter(AsyncIo& io);
+		// Closes the file, ignoring errors.
+		~AsyncFileWriter() override;
+
+		AsyncFileWriter(const AsyncFileWriter&) = delete;
+		AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+		// Creates or truncates path; returns false if it cannot be opened.
+		bool open(const std::string& path);
+		// Writes what is buffered and waits for every block. Returns false if a write or the close failed.
+		bool close();
+
+	protected:
+		int_type overflow(int_type ch) override;
+
+	private:
+		struct Block
+		{
+			std::unique_ptr<char[]> data;
+			std::optional<IoFuture> write;
+			std::size_t size = 0;
+		};
+
+		// Starts writing the current block and makes the next one current once its last write is done.
+		void issue();
+		void wait(Block& block);
+
+		AsyncIo& io_;
+		IoFile file_;
+		std::array<Block, kAsyncWritesInFlight> blocks_;
+		std::size_t current_ = 0;
+		std::uint64_t offset_ = 0;
+		bool failed_ = false;
+	};
+
+}  // namespace transformer
@@ -0,0 +1,817 @@
+#include "io/async_io.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+	#include <linux/io_uring.h>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+	// IORING_OP_READ/WRITE and IORING_FEAT_RW_CUR_POS came with Linux 5.6.
+	#if defined(IORING_FEAT_RW_CUR_POS) && defined(__NR_io_uring_setup)
+		#define TRANSFORMER_HAS_IO_URING 1
+	#endif
+#endif
+
+namespace transformer
+{
+
+	struct IoOperation
+	{
+		IoFile::Handle file;
+		char* buffer;
+		std::size_t size;
+		std::uint64_t offset;
+		bool write;
+		// Bytes done by earlier transfers; a short one is resubmitted for the rest.
+		std::size_t transferred = 0;
+		// The backend's result for the last transfer (bytes or -errno), then the final one.
+		std::int64_t result = 0;
+		bool done = false;
+		std::coroutine_handle<> waiter;
+	};
+
+	class AsyncIo::Backend
+	{
+	public:
+		virtual ~Backend() = default;
+
+		[[nodiscard]]
+		virtual AsyncIoBackend kind() const = 0;
+		[[nodiscard]]
+		virtual std::size_t queue_depth() const = 0;
+		// Queues the next transfer of operation, at operation.transferred.
+		virtual void submit(IoOperation& operation) = 0;
+		// Appends operations whose transfer finished, with result set. Blocks until there is one.
+		virtual void wait(std::vector<IoOperation*>& completed) = 0;
+	};
+
+	namespace
+	{
+
+		AsyncIoBackend configured_backend = AsyncIoBackend::Off;
+
+		// Transfers are split at 1 GB: io_uring lengths and Windows byte counts are 32-bit.
+		constexpr std::size_t kMaxTransferBytes = std::size_t{1} << 30;
+
+		std::size_t transfer_length(const IoOperation& operation)
+		{
+			return std::min(operation.size - operation.transferred, kMaxTransferBytes);
+		}
+
+		// One blocking transfer of operation at its current position.
+		std::int64_t transfer(const IoOperation& operation)
+		{
+			char* data = operation.buffer + operation.transferred;
+			const std::size_t length = transfer_length(operation);
+			const std::uint64_t offset = operation.offset + operation.transferred;
+#if defined(_WIN32)
+			OVERLAPPED position{};
+			position.Offset = static_cast<DWORD>(offset);
+			position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+			DWORD done = 0;
+			const BOOL ok = operation.write
+									? WriteFile(operation.file, data, static_cast<DWORD>(length), &done, &position)
+									: ReadFile(operation.file, data, static_cast<DWORD>(length), &done, &position);
+			if (!ok)
+			{
+				return GetLastError() == ERROR_HANDLE_EOF ? 0 : -EIO;
+			}
+			return done;
+#else
+			const ssize_t done = operation.write ? ::pwrite(operation.file, data, length, static_cast<off_t>(offset))
+												 : ::pread(operation.file, data, length, static_cast<off_t>(offset));
+			return done < 0 ? -errno : done;
+#endif
+		}
+
+		class ThreadBackend final : public AsyncIo::Backend
+		{
+		public:
+			[[nodiscard]]
+			AsyncIoBackend kind() const override
+			{
+				return AsyncIoBackend::Threads;
+			}
+
+			[[nodiscard]]
+			std::size_t queue_depth() const override
+			{
+				return kQueueDepth;
+			}
+
+			void submit(IoOperation& operation) override;
+
+			void wait(std::vector<IoOperation*>& completed) override
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				finished_.wait(lock, [this] { return !done_.empty(); });
+				completed.insert(completed.end(), done_.begin(), done_.end());
+				done_.clear();
+			}
+
+			// Called by an I/O thread. Notifies under the lock: once the owner sees its last operation done,
+			// it may destroy this backend.
+			void finish(IoOperation& operation, std::int64_t result)
+			{
+				const std::lock_guard<std::mutex> lock(mutex_);
+				operation.result = result;
+				done_.push_back(&operation);
+				finished_.notify_one();
+			}
+
+		private:
+			static constexpr std::size_t kQueueDepth = 64;
+
+			std::mutex mutex_;
+			std::condition_variable finished_;
+			std::vector<IoOperation*> done_;
+		};
+
+		// The threads behind every ThreadBackend, started on first use. A few are enough to keep a disk's
+		// queue filled; the transfers themselves are memory copies.
+		class IoThreadPool
+		{
+		public:
+			static IoThreadPool& instance()
+			{
+				static IoThreadPool pool;
+				return pool;
+			}
+
+			~IoThreadPool()
+			{
+				{
+					const std::lock_guard<std::mutex> lock(mutex_);
+					stopping_ = true;
+				}
+				work_available_.notify_all();
+				for (std::thread& thread : threads_)
+				{
+					thread.join();
+				}
+			}
+
+			void post(ThreadBackend& owner, IoOperation& operation)
+			{
+				{
+					const std::lock_guard<std::mutex> lock(mutex_);
+					jobs_.push_back({&owner, &operation});
+				}
+				work_available_.notify_one();
+			}
+
+		private:
+			static constexpr std::size_t kThreads = 4;
+
+			struct Job
+			{
+				ThreadBackend* owner;
+				IoOperation* operation;
+			};
+
+			IoThreadPool()
+			{
+				threads_.reserve(kThreads);
+				for (std::size_t i = 0; i < kThreads; ++i)
+				{
+					threads_.emplace_back([this] { run(); });
+				}
+			}
+
+			void run()
+			{
+				while (true)
+				{
+					Job job{};
+					{
+						std::unique_lock<std::mutex> lock(mutex_);
+						work_available_.wait(lock, [this] { return !jobs_.empty() || stopping_; });
+						if (jobs_.empty())
+						{
+							return;
+						}
+						job = jobs_.front();
+						jobs_.pop_front();
+					}
+					job.owner->finish(*job.operation, transfer(*job.operation));
+				}
+			}
+
+			std::mutex mutex_;
+			std::condition_variable work_available_;
+			std::deque<Job> jobs_;
+			bool stopping_ = false;
+			std::vector<std::thread> threads_;
+		};
+
+		void ThreadBackend::submit(IoOperation& operation)
+		{
+			IoThreadPool::instance().post(*this, operation);
+		}
+
+#if defined(TRANSFORMER_HAS_IO_URING)
+		constexpr unsigned kUringEntries = 64;
+		constexpr unsigned kUringFeatures = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_RW_CUR_POS;
+
+		// Raw system calls: the rings are simple enough that liburing is not worth the dependency.
+		class UringBackend final : public AsyncIo::Backend
+		{
+		public:
+			// Throws std::runtime_error if the kernel refuses the ring (too old, or blocked by a sandbox).
+			UringBackend()
+			{
+				io_uring_params params{};
+				ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, kUringEntries, &params));
+				if (ring_fd_ < 0)
+				{
+					throw std::runtime_error(std::string("io_uring is unavailable: ") + std::strerror(errno));
+				}
+				if ((params.features & kUringFeatures) != kUringFeatures)
+				{
+					release();
+					throw std::runtime_error("io_uring is unavailable: the kernel is older than 5.6");
+				}
+
+				ring_bytes_ = std::max(
+						params.sq_off.array + params.sq_entries * sizeof(std::uint32_t),
+						params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+				ring_ = ::mmap(
+						nullptr,
+						ring_bytes_,
+						PROT_READ | PROT_WRITE,
+						MAP_SHARED | MAP_POPULATE,
+						ring_fd_,
+						IORING_OFF_SQ_RING);
+				sqe_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+				void* sqes = ::mmap(
+						nullptr,
+						sqe_bytes_,
+						PROT_READ | PROT_WRITE,
+						MAP_SHARED | MAP_POPULATE,
+						ring_fd_,
+						IORING_OFF_SQES);
+				if (ring_ == MAP_FAILED || sqes == MAP_FAILED)
+				{
+					const std::string reason = std::strerror(errno);
+					if (sqes != MAP_FAILED)
+					{
+						::munmap(sqes, sqe_bytes_);
+					}
+					release();
+					throw std::runtime_error("io_uring is unavailable: " + reason);
+				}
+
+				char* ring = static_cast<char*>(ring_);
+				sq_tail_ = reinterpret_cast<std::uint32_t*>(ring + params.sq_off.tail);
+				sq_mask_ = *reinterpret_cast<std::uint32_t*>(ring + params.sq_off.ring_mask);
+				sq_array_ = reinterpret_cast<std::uint32_t*>(ring + params.sq_off.array);
+				cq_head_ = reinterpret_cast<std::uint32_t*>(ring + params.cq_off.head);
+				cq_tail_ = reinterpret_cast<std::uint32_t*>(ring + params.cq_off.tail);
+				cq_mask_ = *reinterpret_cast<std::uint32_t*>(ring + params.cq_off.ring_mask);
+				cqes_ = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+				sqes_ = static_cast<io_uring_sqe*>(sqes);
+				sq_entries_ = params.sq_entries;
+				cq_entries_ = params.cq_entries;
+			}
+
+			~UringBackend() override
+			{
+				if (sqes_ != nullptr)
+				{
+					::munmap(sqes_, sqe_bytes_);
+				}
+				release();
+			}
+
+			UringBackend(const UringBackend&) = delete;
+			UringBackend& operator=(const UringBackend&) = delete;
+
+			[[nodiscard]]
+			AsyncIoBackend kind() const override
+			{
+				return AsyncIoBackend::Uring;
+			}
+
+			// With NODROP the kernel keeps overflowing completions anyway, but staying within the
+			// completion ring never needs that slow path.
+			[[nodiscard]]
+			std::size_t queue_depth() const override
+			{
+				return cq_entries_;
+			}
+
+			void submit(IoOperation& operation) override
+			{
+				if (unsubmitted_ == sq_entries_)
+				{
+					enter(0);
+				}
+
+				// This thread is the only producer, so the tail needs no atomic load.
+				const std::uint32_t tail = *sq_tail_;
+				const std::uint32_t index = tail & sq_mask_;
+				io_uring_sqe& entry = sqes_[index];
+				entry = {};
+				entry.opcode = operation.write ? IORING_OP_WRITE : IORING_OP_READ;
+				entry.fd = operation.file;
+				entry.addr = reinterpret_cast<std::uint64_t>(operation.buffer + operation.transferred);
+				entry.len = static_cast<std::uint32_t>(transfer_length(operation));
+				entry.off = operation.offset + operation.transferred;
+				entry.user_data = reinterpret_cast<std::uint64_t>(&operation);
+				sq_array_[index] = index;
+				std::atomic_ref<std::uint32_t>(*sq_tail_).store(tail + 1, std::memory_order_release);
+				++unsubmitted_;
+			}
+
+			void wait(std::vector<IoOperation*>& completed) override
+			{
+				// Submitting the queued entries and waiting is one system call.
+				while (!reap(completed))
+				{
+					enter(1);
+				}
+				if (unsubmitted_ != 0)
+				{
+					enter(0);
+				}
+			}
+
+		private:
+			void enter(unsigned min_complete)
+			{
+				const unsigned flags = min_complete != 0 ? IORING_ENTER_GETEVENTS : 0;
+				while (true)
+				{
+					const long submitted
+							= ::syscall(__NR_io_uring_enter, ring_fd_, unsubmitted_, min_complete, flags, nullptr, 0);
+					if (submitted >= 0)
+					{
+						unsubmitted_ -= static_cast<unsigned>(submitted);
+						return;
+					}
+					if (errno != EINTR)
+					{
+						throw std::runtime_error(std::string("io_uring_enter failed: ") + std::strerror(errno));
+					}
+				}
+			}
+
+			bool reap(std::vector<IoOperation*>& completed)
+			{
+				std::uint32_t head = *cq_head_;
+				const std::uint32_t tail = std::atomic_ref<std::uint32_t>(*cq_tail_).load(std::memory_order_acquire);
+				if (head == tail)
+				{
+					return false;
+				}
+				for (; head != tail; ++head)
+				{
+					const io_uring_cqe& completion = cqes_[head & cq_mask_];
+					auto* operation = reinterpret_cast<IoOperation*>(completion.user_data);
+					operation->result = completion.res;
+					completed.push_back(operation);
+				}
+				std::atomic_ref<std::uint32_t>(*cq_head_).store(head, std::memory_order_release);
+				return true;
+			}
+
+			void release()
+			{
+				if (ring_ != nullptr && ring_ != MAP_FAILED)
+				{
+					::munmap(ring_, ring_bytes_);
+				}
+				ring_ = nullptr;
+				if (ring_fd_ >= 0)
+				{
+					::close(ring_fd_);
+				}
+				ring_fd_ = -1;
+			}
+
+			int ring_fd_ = -1;
+			void* ring_ = nullptr;
+			std::size_t ring_bytes_ = 0;
+			io_uring_sqe* sqes_ = nullptr;
+			std::size_t sqe_bytes_ = 0;
+
+			std::uint32_t* sq_tail_ = nullptr;
+			std::uint32_t sq_mask_ = 0;
+			std::uint32_t* sq_array_ = nullptr;
+			std::uint32_t* cq_head_ = nullptr;
+			std::uint32_t* cq_tail_ = nullptr;
+			std::uint32_t cq_mask_ = 0;
+			io_uring_cqe* cqes_ = nullptr;
+			unsigned sq_entries_ = 0;
+			unsigned cq_entries_ = 0;
+			// Entries past the kernel's view of the submission queue.
+			unsigned unsubmitted_ = 0;
+		};
+#endif
+
+		std::unique_ptr<AsyncIo::Backend> make_backend(AsyncIoBackend backend)
+		{
+			switch (backend)
+			{
+			case AsyncIoBackend::Uring:
+#if defined(TRANSFORMER_HAS_IO_URING)
+				return std::make_unique<UringBackend>();
+#else
+				throw std::runtime_error("io_uring is unavailable: not built for Linux 5.6 or later");
+#endif
+			case AsyncIoBackend::Threads:
+				return std::make_unique<ThreadBackend>();
+			default:
+				throw std::runtime_error("AsyncIo needs the uring or threads backend");
+			}
+		}
+
+	}  // namespace
+
+	void configure_async_io(AsyncIoBackend backend)
+	{
+		if (backend == AsyncIoBackend::Auto)
+		{
+			backend = io_uring_available() ? AsyncIoBackend::Uring : AsyncIoBackend::Threads;
+		}
+		else if (backend == AsyncIoBackend::Uring)
+		{
+			// Throws with the reason when the kernel refuses.
+			make_backend(backend);
+		}
+		configured_backend = backend;
+	}
+
+	AsyncIoBackend async_io_backend()
+	{
+		return configured_backend;
+	}
+
+	bool io_uring_available()
+	{
+		try
+		{
+			make_backend(AsyncIoBackend::Uring);
+			return true;
+		}
+		catch (const std::runtime_error&)
+		{
+			return false;
+		}
+	}
+
+	IoFile::~IoFile()
+	{
+		close();
+	}
+
+	IoFile::IoFile(IoFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	IoFile& IoFile::operator=(IoFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			handle_ = std::exchange(other.handle_, kNoHandle);
+			size_ = std::exchange(other.size_, 0);
+		}
+		return *this;
+	}
+
+#if defined(_WIN32)
+	bool IoFile::open_read(const std::string& path)
+	{
+		close();
+		HANDLE file = CreateFileA(
+				path.c_str(),
+				GENERIC_READ,
+				FILE_SHARE_READ,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_FLAG_SEQUENTIAL_SCAN,
+				nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER size{};
+		if (!GetFileSizeEx(file, &size))
+		{
+			CloseHandle(file);
+			return false;
+		}
+		handle_ = file;
+		size_ = static_cast<std::uint64_t>(size.QuadPart);
+		return true;
+	}
+
+	bool IoFile::create(const std::string& path)
+	{
+		close();
+		HANDLE file
+				= CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		handle_ = file;
+		return true;
+	}
+
+	bool IoFile::close()
+	{
+		const bool closed = handle_ == nullptr || CloseHandle(handle_) != 0;
+		handle_ = nullptr;
+		size_ = 0;
+		return closed;
+	}
+
+	bool IoFile::is_open() const
+	{
+		return handle_ != nullptr;
+	}
+#else
+	bool IoFile::open_read(const std::string& path)
+	{
+		close();
+		const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			return false;
+		}
+		struct stat status{};
+		if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+		{
+			::close(fd);
+			return false;
+		}
+		handle_ = fd;
+		size_ = static_cast<std::uint64_t>(status.st_size);
+		return true;
+	}
+
+	bool IoFile::create(const std::string& path)
+	{
+		close();
+		handle_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		return handle_ >= 0;
+	}
+
+	bool IoFile::close()
+	{
+		const bool closed = handle_ < 0 || ::close(handle_) == 0;
+		handle_ = -1;
+		size_ = 0;
+		return closed;
+	}
+
+	bool IoFile::is_open() const
+	{
+		return handle_ >= 0;
+	}
+#endif
+
+	std::uint64_t IoFile::size() const
+	{
+		return size_;
+	}
+
+	IoFile::Handle IoFile::handle() const
+	{
+		return handle_;
+	}
+
+	IoFuture::IoFuture(AsyncIo& io, std::unique_ptr<IoOperation> operation) :
+			io_(&io),
+			operation_(std::move(operation))
+	{}
+
+	IoFuture::~IoFuture()
+	{
+		finish();
+	}
+
+	IoFuture::IoFuture(IoFuture&& other) noexcept :
+			io_(other.io_),
+			operation_(std::move(other.operation_))
+	{}
+
+	IoFuture& IoFuture::operator=(IoFuture&& other) noexcept
+	{
+		if (this != &other)
+		{
+			finish();
+			io_ = other.io_;
+			operation_ = std::move(other.operation_);
+		}
+		return *this;
+	}
+
+	std::int64_t IoFuture::wait()
+	{
+		while (!operation_->done)
+		{
+			io_->poll();
+		}
+		return operation_->result;
+	}
+
+	bool IoFuture::await_ready() const noexcept
+	{
+		return operation_->done;
+	}
+
+	void IoFuture::await_suspend(std::coroutine_handle<> awaiting) noexcept
+	{
+		operation_->waiter = awaiting;
+	}
+
+	std::int64_t IoFuture::await_resume() const noexcept
+	{
+		return operation_->result;
+	}
+
+	void IoFuture::finish() noexcept
+	{
+		if (operation_ == nullptr || operation_->done)
+		{
+			return;
+		}
+		// The future dies with the coroutine that awaited it, so nothing may resume that one.
+		operation_->waiter = {};
+		try
+		{
+			wait();
+		}
+		catch (...)
+		{
+			// The ring itself failed; nothing is left to wait with.
+		}
+	}
+
+	AsyncIo::AsyncIo(AsyncIoBackend backend) :
+			backend_(make_backend(backend))
+	{}
+
+	AsyncIo::~AsyncIo()
+	{
+		try
+		{
+			while (in_flight_ != 0)
+			{
+				poll();
+			}
+		}
+		catch (...)
+		{
+			// Best effort, like IoFuture::finish().
+		}
+	}
+
+	AsyncIoBackend AsyncIo::backend() const
+	{
+		return backend_->kind();
+	}
+
+	std::size_t AsyncIo::queue_depth() const
+	{
+		return backend_->queue_depth();
+	}
+
+	IoFuture AsyncIo::read(const IoFile& file, void* buffer, std::size_t size, std::uint64_t offset)
+	{
+		return start(std::make_unique<IoOperation>(
+				IoOperation{.file = file.handle(),
+							.buffer = static_cast<char*>(buffer),
+							.size = size,
+							.offset = offset,
+							.write = false}));
+	}
+
+	IoFuture AsyncIo::write(const IoFile& file, const void* data, std::size_t size, std::uint64_t offset)
+	{
+		// The buffer is only read from; the const_cast keeps one operation type for both directions.
+		return start(std::make_unique<IoOperation>(
+				IoOperation{.file = file.handle(),
+							.buffer = const_cast<char*>(static_cast<const char*>(data)),
+							.size = size,
+							.offset = offset,
+							.write = true}));
+	}
+
+	IoFuture AsyncIo::start(std::unique_ptr<IoOperation> operation)
+	{
+		while (in_flight_ >= backend_->queue_depth())
+		{
+			poll();
+		}
+		submit(*operation);
+		return IoFuture(*this, std::move(operation));
+	}
+
+	void AsyncIo::submit(IoOperation& operation)
+	{
+		backend_->submit(operation);
+		++in_flight_;
+	}
+
+	void AsyncIo::poll()
+	{
+		if (in_flight_ == 0)
+		{
+			throw std::runtime_error("AsyncIo: waiting for I/O while none is in flight");
+		}
+		completed_.clear();
+		backend_->wait(completed_);
+		for (IoOperation* operation : completed_)
+		{
+			--in_flight_;
+			complete(*operation);
+		}
+	}
+
+	void AsyncIo::complete(IoOperation& operation)
+	{
+		const std::int64_t result = operation.result;
+		if (result == -EINTR || result == -EAGAIN)
+		{
+			submit(operation);
+			return;
+		}
+		if (result > 0)
+		{
+			operation.transferred += static_cast<std::size_t>(result);
+			if (operation.transferred < operation.size)
+			{
+				// Short transfer; a read that reached the end of the file comes back with 0 next time.
+				submit(operation);
+				return;
+			}
+		}
+		operation.result = result < 0 ? result : static_cast<std::int64_t>(operation.transferred);
+		operation.done = true;
+		if (operation.waiter)
+		{
+			ready_.push_back(std::exchange(operation.waiter, {}));
+		}
+	}
+
+	void AsyncIo::resume_ready()
+	{
+		try
+		{
+			if (ready_.empty())
+			{
+				poll();
+			}
+		}
+		catch (...)
+		{
+			// The task is destroyed on the way out; none of its coroutines may be resumed later.
+			ready_.clear();
+			throw;
+		}
+		// Resumed coroutines start more operations; their completions collect for the next round.
+		const std::vector<std::coroutine_handle<>> ready = std::exchange(ready_, {});
+		for (const std::coroutine_handle<> coroutine : ready)
+		{
+			coroutine.resume();
+		}
+	}
+
+	AsyncIo& thread_async_io()
+	{
+		thread_local std::unique_ptr<AsyncIo> io;
+		if (configured_backend == AsyncIoBackend::Off)
+		{
+			throw std::runtime_error("Asynchronous I/O is off");
+		}
+		if (io == nullptr || io->backend() != configured_backend)
+		{
+			io = std::make_unique<AsyncIo>(configured_backend);
+		}
+		return *io;
+	}
+
+}  // namespace transformer
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace transformer
+{
+
+	// How readers and writers reach the disk (--async-io).
+	enum class AsyncIoBackend
+	{
+		// Blocking paths: inputs are memory-mapped, outputs go through std::ofstream or writev.
+		Off,
+		// io_uring where the kernel allows it, Threads otherwise.
+		Auto,
+		// One io_uring per thread; a batch of reads and writes costs one system call.
+		Uring,
+		// Positional reads and writes on a small pool of I/O threads shared by the process.
+		Threads,
+	};
+
+	// Applies to the AsyncIo of every thread from its next thread_async_io() call. Auto is resolved here;
+	// Uring throws std::runtime_error if io_uring is unavailable. Not thread-safe: call it while no file
+	// is being read or written.
+	void configure_async_io(AsyncIoBackend backend);
+
+	// The configured backend after resolving Auto: Off, Uring or Threads.
+	[[nodiscard]]
+	AsyncIoBackend async_io_backend();
+
+	[[nodiscard]]
+	bool io_uring_available();
+
+	// A file opened for AsyncIo. Every operation carries its own offset, so one handle serves any number
+	// of reads or writes in flight.
+	class IoFile
+	{
+	public:
+#if defined(_WIN32)
+		using Handle = void*;
+#else
+		using Handle = int;
+#endif
+
+		IoFile() = default;
+		~IoFile();
+
+		IoFile(const IoFile&) = delete;
+		IoFile& operator=(const IoFile&) = delete;
+		IoFile(IoFile&& other) noexcept;
+		IoFile& operator=(IoFile&& other) noexcept;
+
+		// Return false if the file cannot be opened, like checking an std::ifstream.
+		bool open_read(const std::string& path);
+		// Creates or truncates path.
+		bool create(const std::string& path);
+		// Returns false if closing reported a write error.
+		bool close();
+
+		[[nodiscard]]
+		bool is_open() const;
+		// Size when opened for reading.
+		[[nodiscard]]
+		std::uint64_t size() const;
+		[[nodiscard]]
+		Handle handle() const;
+
+	private:
+#if defined(_WIN32)
+		static constexpr Handle kNoHandle = nullptr;
+#else
+		static constexpr Handle kNoHandle = -1;
+#endif
+		Handle handle_ = kNoHandle;
+		std::uint64_t size_ = 0;
+	};
+
+	class AsyncIo;
+	struct IoOperation;
+
+	// One read or write in flight. co_await it inside an IoTask, or wait() for it outside one. Both give
+	// the bytes transferred, which is less than asked only at the end of the file, or -errno on failure.
+	class [[nodiscard]] IoFuture
+	{
+	public:
+		IoFuture(AsyncIo& io, std::unique_ptr<IoOperation> operation);
+		// Waits for an unfinished operation: the kernel or an I/O thread still uses its buffer.
+		~IoFuture();
+
+		IoFuture(const IoFuture&) = delete;
+		IoFuture& operator=(const IoFuture&) = delete;
+		IoFuture(IoFuture&& other) noexcept;
+		IoFuture& operator=(IoFuture&& other) noexcept;
+
+		std::int64_t wait();
+
+		[[nodiscard]]
+		bool await_ready() const noexcept;
+		void await_suspend(std::coroutine_handle<> awaiting) noexcept;
+		std::int64_t await_resume() const noexcept;
+
+	private:
+		void finish() noexcept;
+
+		AsyncIo* io_;
+		std::unique_ptr<IoOperation> operation_;
+	};
+
+	// Lazily started coroutine producing a T. The outermost one runs with AsyncIo::run(); inner ones are
+	// co_awaited and resume their caller when they return. Exceptions propagate to whoever awaits it.
+	template <class T>
+	class [[nodiscard]] IoTask
+	{
+	public:
+		struct promise_type;
+
+		struct FinalAwaiter
+		{
+			[[nodiscard]]
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> finished) const noexcept
+			{
+				const std::coroutine_handle<> continuation = finished.promise().continuation;
+				return continuation ? continuation : std::noop_coroutine();
+			}
+
+			void await_resume() const noexcept {}
+		};
+
+		struct promise_type
+		{
+			std::optional<T> value;
+			std::exception_ptr error;
+			std::coroutine_handle<> continuation;
+
+			IoTask get_return_object()
+			{
+				return IoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+			}
+
+			std::suspend_always initial_suspend() const noexcept
+			{
+				return {};
+			}
+
+			FinalAwaiter final_suspend() const noexcept
+			{
+				return {};
+			}
+
+			void return_value(T result)
+			{
+				value.emplace(std::move(result));
+			}
+
+			void unhandled_exception()
+			{
+				error = std::current_exception();
+			}
+		};
+
+		IoTask(IoTask&& other) noexcept :
+				handle_(std::exchange(other.handle_, {}))
+		{}
+
+		IoTask& operator=(IoTask&& other) noexcept
+		{
+			if (this != &other)
+			{
+				destroy();
+				handle_ = std::exchange(other.handle_, {});
+			}
+			return *this;
+		}
+
+		~IoTask()
+		{
+			destroy();
+		}
+
+		[[nodiscard]]
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+		{
+			handle_.promise().continuation = awaiting;
+			return handle_;
+		}
+
+		T await_resume()
+		{
+			return take_result();
+		}
+
+	private:
+		friend class AsyncIo;
+
+		explicit IoTask(std::coroutine_handle<promise_type> handle) :
+				handle_(handle)
+		{}
+
+		void destroy()
+		{
+			if (handle_)
+			{
+				handle_.destroy();
+				handle_ = {};
+			}
+		}
+
+		T take_result()
+		{
+			promise_type& promise = handle_.promise();
+			if (promise.error)
+			{
+				std::rethrow_exception(promise.error);
+			}
+			return std::move(*promise.value);
+		}
+
+		std::coroutine_handle<promise_type> handle_;
+	};
+
+	// Submits reads and writes for the thread that owns it and resumes the coroutines waiting on them.
+	// Operations queue up and reach the kernel together at the next wait, at most queue_depth() at once.
+	// Not thread-safe: each thread uses its own (see thread_async_io()).
+	class AsyncIo
+	{
+	public:
+		// backend must be Uring or Threads; Uring throws std::runtime_error if io_uring is unavailable.
+		explicit AsyncIo(AsyncIoBackend backend);
+		// Waits for the operations still in flight.
+		~AsyncIo();
+
+		AsyncIo(const AsyncIo&) = delete;
+		AsyncIo& operator=(const AsyncIo&) = delete;
+
+		[[nodiscard]]
+		AsyncIoBackend backend() const;
+		[[nodiscard]]
+		std::size_t queue_depth() const;
+
+		// buffer must stay valid until the returned future is done.
+		IoFuture read(const IoFile& file, void* buffer, std::size_t size, std::uint64_t offset);
+		IoFuture write(const IoFile& file, const void* data, std::size_t size, std::uint64_t offset);
+
+		// Runs task on the calling thread until it returns, resuming it whenever the I/O it awaits
+		// completes.
+		template <class T>
+		T run(IoTask<T> task)
+		{
+			task.handle_.resume();
+			while (!task.handle_.done())
+			{
+				resume_ready();
+			}
+			return task.take_result();
+		}
+
+		class Backend;
+
+	private:
+		friend class IoFuture;
+
+		IoFuture start(std::unique_ptr<IoOperation> operation);
+		void submit(IoOperation& operation);
+		// Takes the completions of at least one operation, blocking until there is one.
+		void poll();
+		void complete(IoOperation& operation);
+		void resume_ready();
+
+		std::unique_ptr<Backend> backend_;
+		std::size_t in_flight_ = 0;
+		std::vector<IoOperation*> completed_;
+		std::vector<std::coroutine_handle<>> ready_;
+	};
+
+	// The calling thread's AsyncIo, created with the configured backend on first use (and again after the
+	// backend changed). Throws std::runtime_error while async I/O is off.
+	[[nodiscard]]
+	AsyncIo& thread_async_io();
+
+}  // namespace transformer
@@ -0,0 +1,280 @@
+#include "io/binary_mesh_writer.hpp"
+
+#include "core/mesh_utils.hpp"
+#include "core/profiler.hpp"
+#include "io/async_io.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+	#include <fstream>
+#else
+	#include <fcntl.h>
+	#include <sys/uio.h>
+	#include <unistd.h>
+#endif
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		constexpr std::size_t kMaxAlignment = 4096;
+
+		std::size_t align_up(std::size_t value, std::size_t alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+		std::size_t minimum_stride(const BinaryMeshLayout& layout)
+		{
+			return !layout.planar && layout.normals ? 2 * sizeof(Vec3) : sizeof(Vec3);
+		}
+
+		struct Piece
+		{
+			const void* data;
+			std::size_t size;
+		};
+
+#if defined(_WIN32)
+		void write_pieces(const std::string& output_file, const std::vector<Piece>& pieces)
+		{
+			std::ofstream output(output_file, std::ios::binary);
+			if (!output)
+			{
+				throw std::runtime_error("Failed to open output binary mesh file: " + output_file);
+			}
+			for (const Piece& piece : pieces)
+			{
+				output.write(static_cast<const char*>(piece.data), static_cast<std::streamsize>(piece.size));
+			}
+			if (!output)
+			{
+				throw std::runtime_error("Failed to write binary mesh file: " + output_file);
+			}
+		}
+#else
+		void write_pieces(const std::string& output_file, const std::vector<Piece>& pieces)
+		{
+			const int fd = ::open(output_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+			if (fd < 0)
+			{
+				throw std::runtime_error("Failed to open output binary mesh file: " + output_file);
+			}
+
+			std::vector<iovec> iovecs;
+			for (const Piece& piece : pieces)
+			{
+				if (piece.size != 0)
+				{
+					iovecs.push_back({const_cast<void*>(piece.data), piece.size});
+				}
+			}
+
+			// One call in practice; the loop only resumes after a short write or a signal.
+			std::size_t first = 0;
+			while (first < iovecs.size())
+			{
+				const ssize_t written = ::writev(fd, iovecs.data() + first, static_cast<int>(iovecs.size() - first));
+				if (written < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					const std::string reason = std::strerror(errno);
+					::close(fd);
+					throw std::runtime_error("Failed to write binary mesh file: " + output_file + ": " + reason);
+				}
+
+				auto remaining = static_cast<std::size_t>(written);
+				while (first < iovecs.size() && remaining >= iovecs[first].iov_len)
+				{
+					remaining -= iovecs[first].iov_len;
+					++first;
+				}
+				if (remaining > 0)
+				{
+					iovecs[first].iov_base = static_cast<char*>(iovecs[first].iov_base) + remaining;
+					iovecs[first].iov_len -= remaining;
+				}
+			}
+
+			if (::close(fd) != 0)
+			{
+				throw std::runtime_error("Failed to write binary mesh file: " + output_file);
+			}
+		}
+#endif
+
+		// Every piece in flight at once through this thread's AsyncIo, each at its own file offset.
+		void write_pieces_async(const std::string& output_file, const std::vector<Piece>& pieces)
+		{
+			IoFile file;
+			if (!file.create(output_file))
+			{
+				throw std::runtime_error("Failed to open output binary mesh file: " + output_file);
+			}
+
+			AsyncIo& io = thread_async_io();
+			std::vector<IoFuture> writes;
+			writes.reserve(pieces.size());
+			std::uint64_t offset = 0;
+			for (const Piece& piece : pieces)
+			{
+				writes.push_back(io.write(file, piece.data, piece.size, offset));
+				offset += piece.size;
+			}
+
+			std::string failure;
+			for (std::size_t i = 0; i < pieces.size(); ++i)
+			{
+				const std::int64_t written = writes[i].wait();
+				if (written < 0 && failure.empty())
+				{
+					failure = std::string(": ") + std::strerror(static_cast<int>(-written));
+				}
+				else if (written >= 0 && static_cast<std::size_t>(written) != pieces[i].size && failure.empty())
+				{
+					failure = ": short write";
+				}
+			}
+			if (!file.close() || !failure.empty())
+			{
+				throw std::runtime_error("Failed to write binary mesh file: " + output_file + failure);
+			}
+		}
+
+	}  // namespace
+
+	void validate_binary_mesh_layout(const BinaryMeshLayout& layout)
+	{
+		const bool power_of_two = (layout.alignment & (layout.alignment - 1)) == 0;
+		if (layout.alignment < 4 || layout.alignment > kMaxAlignment || !power_of_two)
+		{
+			throw std::runtime_error("Binary mesh alignment must be a power of two in [4, 4096]");
+		}
+		if (layout.stride != 0 && (layout.stride % 4 != 0 || layout.stride < minimum_stride(layout)))
+		{
+			throw std::runtime_error(
+					"Binary mesh stride must be a multiple of 4 and at least " + std::to_string(minimum_stride(layout))
+					+ " bytes");
+		}
+	}
+
+	BinaryMeshWriter::BinaryMeshWriter(const BinaryMeshLayout& layout) :
+			layout_(layout)
+	{
+		validate_binary_mesh_layout(layout_);
+	}
+
+	void BinaryMeshWriter::write(const std::string& output_file, const Mesh& mesh, Profiler& profiler) const
+	{
+		const auto scope = profiler.stage("write_binary_mesh");
+
+		if (mesh.vertex_count > std::numeric_limits<std::uint32_t>::max()
+			|| mesh.indices.size() > std::numeric_limits<std::uint32_t>::max())
+		{
+			throw std::runtime_error("Mesh is too large for the binary mesh format");
+		}
+
+		const std::size_t stride = layout_.stride != 0 ? layout_.stride : minimum_stride(layout_);
+		const std::size_t stream_size = mesh.vertex_count * stride;
+
+		BinaryMeshHeader header;
+		header.flags = static_cast<std::uint16_t>(
+				(layout_.planar ? kBinaryMeshPlanar : 0U) | (layout_.normals ? kBinaryMeshHasNormals : 0U));
+		header.vertex_count = static_cast<std::uint32_t>(mesh.vertex_count);
+		header.index_count = static_cast<std::uint32_t>(mesh.indices.size());
+		header.vertex_stride = static_cast<std::uint32_t>(stride);
+		header.alignment = static_cast<std::uint32_t>(layout_.alignment);
+		header.position_offset = align_up(sizeof(BinaryMeshHeader), layout_.alignment);
+
+		std::size_t vertex_end = header.position_offset + stream_size;
+		if (layout_.normals)
+		{
+			if (layout_.planar)
+			{
+				header.normal_offset = align_up(vertex_end, layout_.alignment);
+				vertex_end = header.normal_offset + stream_size;
+			}
+			else
+			{
+				header.normal_offset = header.position_offset + sizeof(Vec3);
+			}
+		}
+		if (!mesh.indices.empty())
+		{
+			header.index_offset = align_up(vertex_end, layout_.alignment);
+		}
+		header.file_size = mesh.indices.empty() ? vertex_end : header.index_offset + mesh.indices.size() * 4;
+
+		// Header plus everything up to the index buffer, gaps zero filled.
+		const std::size_t staging_size = mesh.indices.empty() ? vertex_end : header.index_offset;
+		std::vector<char> staging(staging_size, 0);
+		std::memcpy(staging.data(), &header, sizeof(header));
+
+		// A reordered mesh is written back in source order, like the OBJ output.
+		const bool reordered = !mesh.vertex_source_index.empty();
+		std::vector<std::uint32_t> stored_vertex(reordered ? mesh.vertex_count : 0);
+		for (std::size_t i = 0; i < stored_vertex.size(); ++i)
+		{
+			stored_vertex[mesh.vertex_source_index[i]] = static_cast<std::uint32_t>(i);
+		}
+
+		char* positions = staging.data() + header.position_offset;
+		for (std::size_t i = 0; i < mesh.vertex_count; ++i)
+		{
+			const Vec3& position = mesh.entries[reordered ? stored_vertex[i] : i].vertex;
+			std::memcpy(positions + i * stride, &position, sizeof(Vec3));
+		}
+
+		if (layout_.normals)
+		{
+			const std::vector<Vec3> normals = compute_vertex_normals(mesh);
+			char* normal_stream = staging.data() + header.normal_offset;
+			for (std::size_t i = 0; i < mesh.vertex_count; ++i)
+			{
+				std::memcpy(normal_stream + i * stride, &normals[reordered ? stored_vertex[i] : i], sizeof(Vec3));
+			}
+		}
+
+		std::vector<std::uint32_t> source_indices;
+		const std::uint32_t* indices = mesh.indices.data();
+		if (reordered)
+		{
+			// triangle_source_index[t] is the source position of stored triangle t.
+			source_indices.resize(mesh.indices.size());
+			for (std::size_t t = 0; t < mesh.triangle_source_index.size(); ++t)
+			{
+				const std::size_t source = static_cast<std::size_t>(mesh.triangle_source_index[t]) * 3;
+				for (std::size_t k = 0; k < 3; ++k)
+				{
+					source_indices[source + k] = mesh.vertex_source_index[mesh.indices[t * 3 + k]];
+				}
+			}
+			indices = source_indices.data();
+		}
+
+		const std::vector<Piece> pieces{
+				Piece{staging.data(), staging.size()},
+				Piece{indices, mesh.indices.size() * sizeof(std::uint32_t)},
+		};
+		if (async_io_backend() != AsyncIoBackend::Off)
+		{
+			write_pieces_async(output_file, pieces);
+		}
+		else
+		{
+			write_pieces(output_file, pieces);
+		}
+	}
+
+}  // namespace transformer
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "io/io_interfaces.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace transformer
+{
+
+	// GPU-ready vertex buffer file, meant to be mmapped by the runtime. Fields are in host byte order
+	// (little-endian on every target the SSE kernels build for).
+	//
+	//   [0, 64)              BinaryMeshHeader
+	//   position_offset      vertex_count positions (3 x f32), vertex_stride bytes apart
+	//   normal_offset        vertex_count normals (3 x f32), vertex_stride bytes apart; 0 when absent
+	//   index_offset         index_count u32 triangle indices; 0 when there are none
+	//
+	// Interleaved: normal_offset = position_offset + 12, so one vertex is position then normal.
+	// Planar: positions and normals are separate streams. position_offset, normal_offset and index_offset
+	// are multiples of alignment, and gaps are zero filled. Vertices and triangles are in source (file)
+	// order, like the OBJ output.
+	constexpr std::uint32_t kBinaryMeshMagic = 0x424D4654;  // "TFMB"
+	constexpr std::uint16_t kBinaryMeshVersion = 1;
+
+	constexpr std::uint16_t kBinaryMeshPlanar = 1U << 0;
+	constexpr std::uint16_t kBinaryMeshHasNormals = 1U << 1;
+
+	struct BinaryMeshHeader
+	{
+		std::uint32_t magic = kBinaryMeshMagic;
+		std::uint16_t version = kBinaryMeshVersion;
+		std::uint16_t flags = 0;
+		std::uint32_t vertex_count = 0;
+		std::uint32_t index_count = 0;
+		std::uint32_t vertex_stride = 0;
+		std::uint32_t alignment = 0;
+		std::uint64_t position_offset = 0;
+		std::uint64_t normal_offset = 0;
+		std::uint64_t index_offset = 0;
+		std::uint64_t file_size = 0;
+		std::uint32_t reserved[2]{};
+	};
+
+	static_assert(sizeof(BinaryMeshHeader) == 64, "BinaryMeshHeader is part of the file format");
+
+	struct BinaryMeshLayout
+	{
+		bool planar = false;
+		// Area-weighted vertex normals of the skinned triangles.
+		bool normals = false;
+		// Bytes between consecutive vertices of a stream; 0 = tightly packed.
+		std::size_t stride = 0;
+		// Power of two, at least 4.
+		std::size_t alignment = 16;
+	};
+
+	// Throws std::runtime_error if the stride is not a multiple of 4 or smaller than a vertex, or the
+	// alignment is not a power of two in [4, 4096].
+	void validate_binary_mesh_layout(const BinaryMeshLayout& layout);
+
+	class BinaryMeshWriter : public IMeshWriter
+	{
+	public:
+		explicit BinaryMeshWriter(const BinaryMeshLayout& layout);
+
+		// The header, the packed vertex streams and the index buffer go out in a single writev call
+		// (indices straight from the mesh when it is in source order), or as concurrent AsyncIo writes
+		// with --async-io.
+		void write(const std::string& output_file, const Mesh& mesh, Profiler& profiler) const override;
+
+	private:
+		BinaryMeshLayout layout_;
+	};
+
+}  // namespace transformer
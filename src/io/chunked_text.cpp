@@ -0,0 +1,61 @@
+#include "io/chunked_text.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		// Below this a worker costs more to start than it saves.
+		constexpr std::size_t kMinChunkBytes = 4U << 20U;
+
+		std::size_t configured_chunk_count = 0;
+
+	}  // namespace
+
+	void configure_parse_chunks(std::size_t chunk_count)
+	{
+		configured_chunk_count = chunk_count;
+	}
+
+	std::size_t choose_chunk_count(std::size_t byte_count)
+	{
+		if (configured_chunk_count != 0)
+		{
+			return configured_chunk_count;
+		}
+		const std::size_t hardware_threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+		return std::clamp<std::size_t>(byte_count / kMinChunkBytes, 1, hardware_threads);
+	}
+
+	std::vector<std::string_view> split_at_lines(std::string_view text, std::size_t chunk_count)
+	{
+		std::vector<std::string_view> chunks;
+		chunk_count = std::max<std::size_t>(chunk_count, 1);
+		const std::size_t target_size = text.size() / chunk_count;
+
+		std::size_t begin = 0;
+		while (begin < text.size())
+		{
+			std::size_t end = text.size();
+			if (chunks.size() + 1 < chunk_count)
+			{
+				const std::size_t newline = text.find('\n', std::min(begin + target_size, text.size()));
+				end = newline == std::string_view::npos ? text.size() : newline + 1;
+			}
+			chunks.push_back(text.substr(begin, end - begin));
+			begin = end;
+		}
+		return chunks;
+	}
+
+	std::size_t line_number_at(std::string_view text, std::size_t offset)
+	{
+		const std::string_view prefix = text.substr(0, std::min(offset, text.size()));
+		return static_cast<std::size_t>(std::count(prefix.begin(), prefix.end(), '\n')) + 1;
+	}
+
+}  // namespace transformer
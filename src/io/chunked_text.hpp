@@ -0,0 +1,87 @@
+#pragma once
+
+#include "core/memory_tracking.hpp"
+
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <string_view>
+#include <vector>
+
+namespace transformer
+{
+
+	// Makes choose_chunk_count() return chunk_count whatever the input size (--parse-chunks), so tests can
+	// split small files; 0 restores the automatic choice. Not thread-safe: call it before reading inputs.
+	void configure_parse_chunks(std::size_t chunk_count);
+
+	// Number of chunks to split byte_count bytes of text into for parallel parsing: at most one per
+	// hardware thread, and none smaller than a few MB, so small inputs stay on the calling thread.
+	[[nodiscard]]
+	std::size_t choose_chunk_count(std::size_t byte_count);
+
+	// Splits text into at most chunk_count pieces. Every piece but the last ends right after a '\n',
+	// so no line straddles two chunks. All pieces view into text.
+	[[nodiscard]]
+	std::vector<std::string_view> split_at_lines(std::string_view text, std::size_t chunk_count);
+
+	// 1-based line of text[offset]. Linear in offset; meant for error messages.
+	[[nodiscard]]
+	std::size_t line_number_at(std::string_view text, std::size_t offset);
+
+	// Runs task(i) for every i in [0, task_count): task 0 on the calling thread, the rest on std::async
+	// workers, whose allocations count towards the caller's AllocationScope. Waits for all of them, then
+	// rethrows the exception of the lowest failing index, so the reported error is the first one in file
+	// order.
+	template <typename Task>
+	void run_chunk_tasks(std::size_t task_count, Task&& task)
+	{
+		AllocationScope* const scope = AllocationScope::current();
+		std::vector<std::future<void>> workers;
+		workers.reserve(task_count > 0 ? task_count - 1 : 0);
+		for (std::size_t i = 1; i < task_count; ++i)
+		{
+			workers.push_back(std::async(
+					std::launch::async,
+					[&task, scope, i]
+					{
+						const AllocationScopeBinding binding(scope);
+						task(i);
+					}));
+		}
+
+		std::exception_ptr first_error;
+		if (task_count > 0)
+		{
+			try
+			{
+				task(0);
+			}
+			catch (...)
+			{
+				first_error = std::current_exception();
+			}
+		}
+
+		for (std::future<void>& worker : workers)
+		{
+			try
+			{
+				worker.get();
+			}
+			catch (...)
+			{
+				if (!first_error)
+				{
+					first_error = std::current_exception();
+				}
+			}
+		}
+
+		if (first_error)
+		{
+			std::rethrow_exception(first_error);
+		}
+	}
+
+}  // namespace transformer
@@ -0,0 +1,609 @@
+#include "io/gltf_io.hpp"
+
+#include "core/profiler.hpp"
+#include "io/async_files.hpp"
+#include "io/json_lite.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include <variant>
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		constexpr std::uint32_t kGlbMagic = 0x46546C67;	 // "glTF"
+		constexpr std::uint32_t kGlbVersion = 2;
+		constexpr std::uint32_t kJsonChunk = 0x4E4F534A;  // "JSON"
+		constexpr std::uint32_t kBinChunk = 0x004E4942;	  // "BIN\0"
+		constexpr std::size_t kGlbHeaderSize = 12;
+		constexpr std::size_t kChunkHeaderSize = 8;
+
+		enum ComponentType : int
+		{
+			kByte = 5120,
+			kUnsignedByte = 5121,
+			kShort = 5122,
+			kUnsignedShort = 5123,
+			kUnsignedInt = 5125,
+			kFloat = 5126,
+		};
+
+		// Accessor elements are copied into these as raw bytes.
+		static_assert(sizeof(Vec3) == 3 * sizeof(float));
+		static_assert(sizeof(Mat4) == 16 * sizeof(float));
+
+		constexpr int kTrianglesMode = 4;
+		// Palette slot 255 is the zero matrix (see VertexBoneWeights).
+		constexpr std::size_t kMaxJointIndex = kMaxBones - 1;
+
+		std::uint32_t read_u32(const char* data)
+		{
+			std::uint32_t value = 0;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		// A loaded .glb: the parsed JSON chunk plus a view of the BIN chunk into the file's bytes.
+		struct GlbFile
+		{
+			InputFile file;
+			// Always holds a JsonObject once open_glb returns.
+			JsonValue root;
+			std::string_view bin;
+
+			[[nodiscard]]
+			const JsonObject& json() const
+			{
+				return std::get<JsonObject>(root.value);
+			}
+		};
+
+		GlbFile open_glb(const std::string& path)
+		{
+			GlbFile glb;
+			glb.file = load_input_file(path);
+			const std::string_view data = glb.file.view();
+
+			if (data.size() < kGlbHeaderSize + kChunkHeaderSize || read_u32(data.data()) != kGlbMagic)
+			{
+				throw std::runtime_error("GLB parse error: not a binary glTF file: " + path);
+			}
+			if (read_u32(data.data() + 4) != kGlbVersion)
+			{
+				throw std::runtime_error("GLB parse error: only glTF 2.0 is supported: " + path);
+			}
+			const std::size_t total_length = std::min<std::size_t>(read_u32(data.data() + 8), data.size());
+
+			std::string_view json_text;
+			std::size_t offset = kGlbHeaderSize;
+			while (offset + kChunkHeaderSize <= total_length)
+			{
+				const std::size_t chunk_length = read_u32(data.data() + offset);
+				const std::uint32_t chunk_type = read_u32(data.data() + offset + 4);
+				offset += kChunkHeaderSize;
+				if (chunk_length > total_length - offset)
+				{
+					throw std::runtime_error("GLB parse error: chunk extends past the end of the file");
+				}
+
+				const std::string_view chunk = data.substr(offset, chunk_length);
+				if (chunk_type == kJsonChunk && json_text.empty())
+				{
+					json_text = chunk;
+				}
+				else if (chunk_type == kBinChunk && glb.bin.empty())
+				{
+					glb.bin = chunk;
+				}
+				offset += chunk_length;
+			}
+
+			if (json_text.empty())
+			{
+				throw std::runtime_error("GLB parse error: missing JSON chunk");
+			}
+			glb.root = JsonLiteParser(json_text).parse_value();
+			if (!std::holds_alternative<JsonObject>(glb.root.value))
+			{
+				throw std::runtime_error("GLB parse error: JSON chunk must be an object");
+			}
+			return glb;
+		}
+
+		std::size_t as_index(const JsonValue& value, const std::string& error)
+		{
+			// Range-checked before the cast, which is undefined for NaN, infinities and values past size_t.
+			// Above 2^53 doubles are not exact integers anyway.
+			constexpr double kIndexLimit =
+				std::min(0x1p53, static_cast<double>(std::numeric_limits<std::size_t>::max()));
+			const double number = as_number(value, error);
+			if (!(number >= 0.0 && number < kIndexLimit))
+			{
+				throw std::runtime_error(error);
+			}
+			const auto index = static_cast<std::size_t>(number);
+			if (static_cast<double>(index) != number)
+			{
+				throw std::runtime_error(error);
+			}
+			return index;
+		}
+
+		// Element index of a top-level array such as "accessors" or "meshes".
+		const JsonObject& top_level_element(const GlbFile& glb, const char* array_name, std::size_t index)
+		{
+			const std::string error = std::string("GLB parse error: invalid ") + array_name + " reference";
+			const JsonValue* array_value = find_key(glb.json(), {array_name});
+			if (array_value == nullptr)
+			{
+				throw std::runtime_error(error);
+			}
+			const JsonArray& elements = as_array(*array_value, error);
+			if (index >= elements.size())
+			{
+				throw std::runtime_error(error);
+			}
+			return as_object(elements[index], error);
+		}
+
+		std::size_t optional_index(const JsonObject& object, const char* key, std::size_t fallback)
+		{
+			const JsonValue* value = find_key(object, {key});
+			return value == nullptr ? fallback : as_index(*value, std::string("GLB parse error: invalid ") + key);
+		}
+
+		std::size_t component_size(int component_type)
+		{
+			switch (component_type)
+			{
+				case kByte:
+				case kUnsignedByte: return 1;
+				case kShort:
+				case kUnsignedShort: return 2;
+				case kUnsignedInt:
+				case kFloat: return 4;
+				default: throw std::runtime_error("GLB parse error: unsupported accessor component type");
+			}
+		}
+
+		std::size_t component_count(const std::string& type)
+		{
+			if (type == "SCALAR")
+			{
+				return 1;
+			}
+			if (type == "VEC2")
+			{
+				return 2;
+			}
+			if (type == "VEC3")
+			{
+				return 3;
+			}
+			if (type == "VEC4" || type == "MAT2")
+			{
+				return 4;
+			}
+			if (type == "MAT3")
+			{
+				return 9;
+			}
+			if (type == "MAT4")
+			{
+				return 16;
+			}
+			throw std::runtime_error("GLB parse error: unsupported accessor type '" + type + "'");
+		}
+
+		// An accessor resolved to memory inside the loaded BIN chunk.
+		struct AccessorView
+		{
+			const char* data = nullptr;
+			std::size_t count = 0;
+			std::size_t stride = 0;
+			int component_type = 0;
+			std::size_t components = 0;
+			bool normalized = false;
+
+			[[nodiscard]]
+			const char* element(std::size_t index) const
+			{
+				return data + index * stride;
+			}
+
+			// Elements are back to back, so the whole accessor can be copied in one go.
+			[[nodiscard]]
+			bool tightly_packed() const
+			{
+				return stride == component_size(component_type) * components;
+			}
+		};
+
+		AccessorView resolve_accessor(const GlbFile& glb, std::size_t accessor_index, const std::string& name)
+		{
+			const std::string error = "GLB parse error: accessor for " + name;
+			const JsonObject& accessor = top_level_element(glb, "accessors", accessor_index);
+			if (find_key(accessor, {"sparse"}) != nullptr)
+			{
+				throw std::runtime_error(error + " is sparse, which is not supported");
+			}
+
+			AccessorView view;
+			const JsonValue* count = find_key(accessor, {"count"});
+			const JsonValue* component_type = find_key(accessor, {"componentType"});
+			const JsonValue* type = find_key(accessor, {"type"});
+			const JsonValue* buffer_view_index = find_key(accessor, {"bufferView"});
+			if (count == nullptr || component_type == nullptr || type == nullptr || buffer_view_index == nullptr)
+			{
+				throw std::runtime_error(error + " must have bufferView, count, componentType and type");
+			}
+			const auto* type_name = std::get_if<std::string>(&type->value);
+			if (type_name == nullptr)
+			{
+				throw std::runtime_error(error + " has an invalid type");
+			}
+
+			view.count = as_index(*count, error + " has an invalid count");
+			view.component_type = static_cast<int>(as_index(*component_type, error + " has an invalid componentType"));
+			view.components = component_count(*type_name);
+			if (const JsonValue* normalized = find_key(accessor, {"normalized"}))
+			{
+				const auto* flag = std::get_if<bool>(&normalized->value);
+				view.normalized = flag != nullptr && *flag;
+			}
+
+			const JsonObject& buffer_view = top_level_element(
+					glb, "bufferViews", as_index(*buffer_view_index, error + " has an invalid bufferView"));
+			if (optional_index(buffer_view, "buffer", 0) != 0)
+			{
+				throw std::runtime_error(error + " references an external buffer, which is not supported");
+			}
+			const JsonObject& buffer = top_level_element(glb, "buffers", 0);
+			if (find_key(buffer, {"uri"}) != nullptr)
+			{
+				throw std::runtime_error(error + " references an external buffer, which is not supported");
+			}
+
+			const std::size_t element_size = component_size(view.component_type) * view.components;
+			const std::size_t view_offset = optional_index(buffer_view, "byteOffset", 0);
+			const std::size_t view_length = optional_index(buffer_view, "byteLength", 0);
+			const std::size_t accessor_offset = optional_index(accessor, "byteOffset", 0);
+			view.stride = optional_index(buffer_view, "byteStride", element_size);
+			if (view.stride < element_size)
+			{
+				throw std::runtime_error(error + " has a byteStride smaller than its elements");
+			}
+
+			const std::size_t used_length = view.count == 0 ? 0 : (view.count - 1) * view.stride + element_size;
+			if (view_offset > glb.bin.size() || view_length > glb.bin.size() - view_offset
+				|| accessor_offset > view_length || used_length > view_length - accessor_offset)
+			{
+				throw std::runtime_error(error + " extends past the end of the BIN chunk");
+			}
+
+			view.data = glb.bin.data() + view_offset + accessor_offset;
+			return view;
+		}
+
+		template <typename T>
+		T load(const char* data)
+		{
+			T value{};
+			std::memcpy(&value, data, sizeof(T));
+			return value;
+		}
+
+		std::uint32_t read_unsigned(const char* data, int component_type)
+		{
+			switch (component_type)
+			{
+				case kUnsignedByte: return load<std::uint8_t>(data);
+				case kUnsignedShort: return load<std::uint16_t>(data);
+				case kUnsignedInt: return load<std::uint32_t>(data);
+				default: throw std::runtime_error("GLB parse error: expected unsigned integer components");
+			}
+		}
+
+		// Float components, or normalized unsigned integers mapped to [0, 1].
+		float read_unit_float(const char* data, int component_type, bool normalized)
+		{
+			if (component_type == kFloat)
+			{
+				return load<float>(data);
+			}
+			if (normalized && component_type == kUnsignedByte)
+			{
+				return static_cast<float>(load<std::uint8_t>(data)) / 255.0F;
+			}
+			if (normalized && component_type == kUnsignedShort)
+			{
+				return static_cast<float>(load<std::uint16_t>(data)) / 65535.0F;
+			}
+			throw std::runtime_error("GLB parse error: expected float or normalized unsigned components");
+		}
+
+		struct SkinnedPrimitive
+		{
+			const JsonObject* attributes = nullptr;
+			const JsonObject* primitive = nullptr;
+			const JsonObject* skin = nullptr;
+		};
+
+		SkinnedPrimitive find_skinned_primitive(const GlbFile& glb)
+		{
+			std::size_t mesh_index = 0;
+			std::size_t skin_index = 0;
+			if (const JsonValue* nodes = find_key(glb.json(), {"nodes"}))
+			{
+				for (const JsonValue& node_value : as_array(*nodes, "GLB parse error: nodes must be an array"))
+				{
+					const JsonObject& node = as_object(node_value, "GLB parse error: node must be an object");
+					if (find_key(node, {"mesh"}) != nullptr && find_key(node, {"skin"}) != nullptr)
+					{
+						mesh_index = optional_index(node, "mesh", 0);
+						skin_index = optional_index(node, "skin", 0);
+						break;
+					}
+				}
+			}
+
+			SkinnedPrimitive result;
+			const JsonObject& mesh = top_level_element(glb, "meshes", mesh_index);
+			const JsonValue* primitives = find_key(mesh, {"primitives"});
+			if (primitives == nullptr || as_array(*primitives, "GLB parse error: invalid primitives").empty())
+			{
+				throw std::runtime_error("GLB parse error: mesh has no primitives");
+			}
+			result.primitive = &as_object(
+					as_array(*primitives, "GLB parse error: invalid primitives").front(),
+					"GLB parse error: primitive must be an object");
+			if (optional_index(*result.primitive, "mode", kTrianglesMode) != kTrianglesMode)
+			{
+				throw std::runtime_error("GLB parse error: only triangle primitives are supported");
+			}
+
+			const JsonValue* attributes = find_key(*result.primitive, {"attributes"});
+			if (attributes == nullptr)
+			{
+				throw std::runtime_error("GLB parse error: primitive has no attributes");
+			}
+			result.attributes = &as_object(*attributes, "GLB parse error: attributes must be an object");
+
+			if (find_key(glb.json(), {"skins"}) != nullptr)
+			{
+				result.skin = &top_level_element(glb, "skins", skin_index);
+			}
+			return result;
+		}
+
+		AccessorView attribute_accessor(const GlbFile& glb, const SkinnedPrimitive& primitive, const char* name)
+		{
+			const JsonValue* accessor_index = find_key(*primitive.attributes, {name});
+			if (accessor_index == nullptr)
+			{
+				throw std::runtime_error(std::string("GLB parse error: primitive has no ") + name + " attribute");
+			}
+			return resolve_accessor(glb, as_index(*accessor_index, "GLB parse error: invalid attribute"), name);
+		}
+
+		bool has_suffix_ignoring_case(const std::string& text, std::string_view suffix)
+		{
+			return text.size() >= suffix.size()
+				   && std::equal(
+						   suffix.begin(),
+						   suffix.end(),
+						   text.end() - static_cast<std::ptrdiff_t>(suffix.size()),
+						   [](char a, char b)
+						   {
+							   return std::tolower(static_cast<unsigned char>(a))
+									  == std::tolower(static_cast<unsigned char>(b));
+						   });
+		}
+
+	}  // namespace
+
+	bool is_glb_file(const std::string& path)
+	{
+		return has_suffix_ignoring_case(path, ".glb");
+	}
+
+	GlbMeshReader::GlbMeshReader(const IMeshReader& fallback) :
+			fallback_(fallback)
+	{}
+
+	Mesh GlbMeshReader::read(const std::string& mesh_file, Profiler& profiler) const
+	{
+		if (!is_glb_file(mesh_file))
+		{
+			return fallback_.read(mesh_file, profiler);
+		}
+
+		const auto scope = profiler.stage("read_glb_mesh");
+		const GlbFile glb = open_glb(mesh_file);
+		const SkinnedPrimitive primitive = find_skinned_primitive(glb);
+
+		const AccessorView positions = attribute_accessor(glb, primitive, "POSITION");
+		if (positions.component_type != kFloat || positions.components != 3)
+		{
+			throw std::runtime_error("GLB parse error: POSITION must be float VEC3");
+		}
+
+		Mesh mesh;
+		mesh.vertex_count = positions.count;
+		mesh.entries.resize(positions.count);
+		for (std::size_t i = 0; i < positions.count; ++i)
+		{
+			std::memcpy(&mesh.entries[i].vertex, positions.element(i), sizeof(Vec3));
+		}
+
+		const JsonValue* indices_value = find_key(*primitive.primitive, {"indices"});
+		if (indices_value == nullptr)
+		{
+			mesh.indices.resize(positions.count);
+			std::iota(mesh.indices.begin(), mesh.indices.end(), 0U);
+		}
+		else
+		{
+			const AccessorView indices
+					= resolve_accessor(glb, as_index(*indices_value, "GLB parse error: invalid indices"), "indices");
+			if (indices.components != 1)
+			{
+				throw std::runtime_error("GLB parse error: indices must be SCALAR");
+			}
+
+			mesh.indices.resize(indices.count);
+			if (indices.component_type == kUnsignedInt && indices.tightly_packed())
+			{
+				std::memcpy(mesh.indices.data(), indices.data, indices.count * sizeof(std::uint32_t));
+			}
+			else
+			{
+				for (std::size_t i = 0; i < indices.count; ++i)
+				{
+					mesh.indices[i] = read_unsigned(indices.element(i), indices.component_type);
+				}
+			}
+		}
+
+		if (mesh.indices.size() % 3 != 0)
+		{
+			throw std::runtime_error("GLB parse error: triangle index count is not a multiple of 3");
+		}
+		const auto out_of_range = [&](std::uint32_t index) { return index >= mesh.vertex_count; };
+		if (std::any_of(mesh.indices.begin(), mesh.indices.end(), out_of_range))
+		{
+			throw std::runtime_error("GLB parse error: index out of range");
+		}
+
+		return mesh;
+	}
+
+	GlbBoneWeightsReader::GlbBoneWeightsReader(const IBoneWeightsReader& fallback) :
+			fallback_(fallback)
+	{}
+
+	BoneWeightsData GlbBoneWeightsReader::read(const std::string& weights_file, Profiler& profiler) const
+	{
+		if (!is_glb_file(weights_file))
+		{
+			return fallback_.read(weights_file, profiler);
+		}
+
+		const auto scope = profiler.stage("read_glb_weights");
+		const GlbFile glb = open_glb(weights_file);
+		const SkinnedPrimitive primitive = find_skinned_primitive(glb);
+
+		const AccessorView joints = attribute_accessor(glb, primitive, "JOINTS_0");
+		const AccessorView weights = attribute_accessor(glb, primitive, "WEIGHTS_0");
+		if (joints.components != 4 || weights.components != 4)
+		{
+			throw std::runtime_error("GLB parse error: JOINTS_0 and WEIGHTS_0 must be VEC4");
+		}
+		if (joints.count != weights.count)
+		{
+			throw std::runtime_error("GLB parse error: JOINTS_0 and WEIGHTS_0 counts differ");
+		}
+
+		const std::size_t joint_size = component_size(joints.component_type);
+		const std::size_t weight_size = component_size(weights.component_type);
+
+		BoneWeightsData data;
+		data.per_vertex_weights.resize(joints.count);
+		for (std::size_t v = 0; v < joints.count; ++v)
+		{
+			VertexBoneWeights& vertex = data.per_vertex_weights[v];
+			for (std::size_t k = 0; k < 4; ++k)
+			{
+				const std::uint32_t joint = read_unsigned(joints.element(v) + k * joint_size, joints.component_type);
+				if (joint > kMaxJointIndex)
+				{
+					throw std::runtime_error(
+							"GLB parse error: joint index " + std::to_string(joint) + " exceeds the palette size");
+				}
+				vertex.bone_indices[k] = static_cast<std::int8_t>(joint);
+				const char* weight = weights.element(v) + k * weight_size;
+				vertex.weights[k] = read_unit_float(weight, weights.component_type, weights.normalized);
+			}
+		}
+
+		return data;
+	}
+
+	GlbBonePoseReader::GlbBonePoseReader(const IBonePoseReader& fallback) :
+			fallback_(fallback)
+	{}
+
+	std::vector<Mat4> GlbBonePoseReader::read_matrices(
+			const std::string& file_path, Profiler& profiler, const std::string& stage_name) const
+	{
+		if (!is_glb_file(file_path))
+		{
+			return fallback_.read_matrices(file_path, profiler, stage_name);
+		}
+
+		const auto scope = profiler.stage(stage_name);
+		const GlbFile glb = open_glb(file_path);
+		const SkinnedPrimitive primitive = find_skinned_primitive(glb);
+		if (primitive.skin == nullptr)
+		{
+			throw std::runtime_error("GLB parse error: file has no skin");
+		}
+
+		const JsonValue* joints = find_key(*primitive.skin, {"joints"});
+		if (joints == nullptr)
+		{
+			throw std::runtime_error("GLB parse error: skin has no joints");
+		}
+		const std::size_t joint_count = as_array(*joints, "GLB parse error: joints must be an array").size();
+		if (joint_count > kMaxBones)
+		{
+			throw std::runtime_error("GLB parse error: more than " + std::to_string(kMaxBones) + " joints");
+		}
+
+		const JsonValue* matrices_index = find_key(*primitive.skin, {"inverseBindMatrices"});
+		if (matrices_index == nullptr)
+		{
+			Mat4 identity;
+			identity.m[0] = identity.m[5] = identity.m[10] = identity.m[15] = 1.0F;
+			return std::vector<Mat4>(joint_count, identity);
+		}
+
+		const AccessorView matrices = resolve_accessor(
+				glb,
+				as_index(*matrices_index, "GLB parse error: invalid inverseBindMatrices"),
+				"inverseBindMatrices");
+		if (matrices.component_type != kFloat || matrices.components != 16)
+		{
+			throw std::runtime_error("GLB parse error: inverseBindMatrices must be float MAT4");
+		}
+		if (matrices.count != joint_count)
+		{
+			throw std::runtime_error("GLB parse error: inverseBindMatrices count differs from the joint count");
+		}
+
+		// glTF matrices are column-major, like Mat4.
+		std::vector<Mat4> result(matrices.count);
+		if (matrices.tightly_packed())
+		{
+			std::memcpy(result.data(), matrices.data, matrices.count * sizeof(Mat4));
+		}
+		else
+		{
+			for (std::size_t i = 0; i < matrices.count; ++i)
+			{
+				std::memcpy(result[i].m.data(), matrices.element(i), sizeof(Mat4));
+			}
+		}
+		return result;
+	}
+
+}  // namespace transformer
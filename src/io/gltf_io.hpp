@@ -0,0 +1,60 @@
+#pragma once
+
+#include "io/io_interfaces.hpp"
+
+#include <string>
+
+namespace transformer
+{
+
+	// Readers for binary glTF 2.0 (.glb) skinned meshes. Each one reads .glb files and hands any other
+	// file to its fallback, so a scene can mix an asset with the usual OBJ/JSON inputs (e.g. a .glb mesh
+	// with a --new-pose JSON file).
+	//
+	// The file is memory mapped and accessors are decoded straight out of its BIN chunk into the Mesh /
+	// weight / matrix arrays; there is no intermediate copy of the buffer. The primitive used is the first
+	// one of the first node that has both a mesh and a skin (mesh 0 / skin 0 if there is no such node).
+	// External (.gltf) buffers, sparse accessors and non-triangle primitives are rejected.
+
+	[[nodiscard]]
+	bool is_glb_file(const std::string& path);
+
+	// POSITION and indices (a non-indexed primitive gets 0, 1, 2, ...).
+	class GlbMeshReader : public IMeshReader
+	{
+	public:
+		explicit GlbMeshReader(const IMeshReader& fallback);
+
+		Mesh read(const std::string& mesh_file, Profiler& profiler) const override;
+
+	private:
+		const IMeshReader& fallback_;
+	};
+
+	// JOINTS_0 and WEIGHTS_0. Joint indices index the skin's joint list, like the bone indices of the
+	// weights JSON index the pose arrays.
+	class GlbBoneWeightsReader : public IBoneWeightsReader
+	{
+	public:
+		explicit GlbBoneWeightsReader(const IBoneWeightsReader& fallback);
+
+		BoneWeightsData read(const std::string& weights_file, Profiler& profiler) const override;
+
+	private:
+		const IBoneWeightsReader& fallback_;
+	};
+
+	// The skin's inverseBindMatrices (identity for every joint if the skin has none).
+	class GlbBonePoseReader : public IBonePoseReader
+	{
+	public:
+		explicit GlbBonePoseReader(const IBonePoseReader& fallback);
+
+		std::vector<Mat4> read_matrices(
+				const std::string& file_path, Profiler& profiler, const std::string& stage_name) const override;
+
+	private:
+		const IBonePoseReader& fallback_;
+	};
+
+}  // namespace transformer
@@ -9,6 +9,8 @@ namespace transformer
 {
 
 	class Profiler;
+	struct AnimationClip;
+	struct AppInput;
 	struct StatsReport;
 
 	class IMeshReader
@@ -34,6 +36,32 @@ namespace transformer
 				= 0;
 	};
 
+	class IMorphTargetReader
+	{
+	public:
+		virtual ~IMorphTargetReader() = default;
+		virtual std::vector<MorphTarget> read_targets(const std::string& file_path, Profiler& profiler) const = 0;
+		// One weight per target for the frame being skinned.
+		virtual std::vector<float> read_weights(const std::string& file_path, Profiler& profiler) const = 0;
+	};
+
+	class IAnimationClipReader
+	{
+	public:
+		virtual ~IAnimationClipReader() = default;
+		virtual AnimationClip read(const std::string& clip_file, Profiler& profiler) const = 0;
+	};
+
+	class IJobManifestReader
+	{
+	public:
+		virtual ~IJobManifestReader() = default;
+		// One AppInput per job, in manifest order. Options the manifest does not set are copied from
+		// defaults; relative input paths are resolved against the manifest's directory.
+		virtual std::vector<AppInput> read(
+				const std::string& manifest_file, const AppInput& defaults, Profiler& profiler) const = 0;
+	};
+
 	class IMeshWriter
 	{
 	public:
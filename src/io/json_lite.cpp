@@ -0,0 +1,338 @@
+#include "io/json_lite.hpp"
+
+#include "io/chunked_text.hpp"
+#include "io/numeric_scan.hpp"
+
+#include <cctype>
+#include <stdexcept>
+
+namespace transformer
+{
+
+	JsonValue JsonLiteParser::parse_value()
+	{
+		skip_ws();
+		if (position_ >= text_.size())
+		{
+			fail("JSON parse error: unexpected end of input");
+		}
+
+		const char c = text_[position_];
+		if (c == '{')
+		{
+			return JsonValue{parse_object()};
+		}
+		if (c == '[')
+		{
+			return JsonValue{parse_array()};
+		}
+		if (c == '"')
+		{
+			return JsonValue{parse_string()};
+		}
+		if (c == 't' || c == 'f')
+		{
+			return JsonValue{parse_bool()};
+		}
+		if (c == 'n')
+		{
+			parse_null();
+			return JsonValue{nullptr};
+		}
+		return JsonValue{parse_number()};
+	}
+
+	void JsonLiteParser::skip_value()
+	{
+		skip_ws();
+		if (position_ >= text_.size() || text_[position_] == ',' || text_[position_] == '}'
+			|| text_[position_] == ']')
+		{
+			fail("JSON parse error: expected value");
+		}
+
+		// Closers still expected, innermost last.
+		std::string closers;
+		bool in_string = false;
+		while (position_ < text_.size())
+		{
+			const char c = text_[position_];
+			if (in_string)
+			{
+				++position_;
+				if (c == '\\')
+				{
+					++position_;
+				}
+				else if (c == '"')
+				{
+					in_string = false;
+					if (closers.empty())
+					{
+						return;
+					}
+				}
+				continue;
+			}
+
+			const bool scalar_end
+					= c == ',' || c == '}' || c == ']' || std::isspace(static_cast<unsigned char>(c)) != 0;
+			if (closers.empty() && scalar_end)
+			{
+				// End of a scalar.
+				return;
+			}
+
+			if (c == '}' || c == ']')
+			{
+				if (c != closers.back())
+				{
+					fail(std::string("JSON parse error: expected '") + closers.back() + "'");
+				}
+				++position_;
+				closers.pop_back();
+				if (closers.empty())
+				{
+					return;
+				}
+				continue;
+			}
+
+			++position_;
+			if (c == '"')
+			{
+				in_string = true;
+			}
+			else if (c == '{')
+			{
+				closers.push_back('}');
+			}
+			else if (c == '[')
+			{
+				closers.push_back(']');
+			}
+		}
+
+		fail("JSON parse error: unexpected end of input");
+	}
+
+	std::string JsonLiteParser::parse_string()
+	{
+		expect_char('"');
+		std::string result;
+		while (position_ < text_.size())
+		{
+			const char c = text_[position_++];
+			if (c == '"')
+			{
+				return result;
+			}
+			if (c == '\\')
+			{
+				if (position_ >= text_.size())
+				{
+					fail("JSON parse error: unfinished escape sequence");
+				}
+				const char escaped = text_[position_++];
+				switch (escaped)
+				{
+					case '"':
+					case '\\':
+					case '/': result.push_back(escaped); break;
+					case 'b': result.push_back('\b'); break;
+					case 'f': result.push_back('\f'); break;
+					case 'n': result.push_back('\n'); break;
+					case 'r': result.push_back('\r'); break;
+					case 't': result.push_back('\t'); break;
+					default: fail("JSON parse error: unsupported escape sequence");
+				}
+				continue;
+			}
+
+			result.push_back(c);
+		}
+
+		fail("JSON parse error: unterminated string");
+	}
+
+	void JsonLiteParser::skip_ws()
+	{
+		while (position_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[position_])) != 0)
+		{
+			++position_;
+		}
+	}
+
+	void JsonLiteParser::expect_char(char c)
+	{
+		skip_ws();
+		if (position_ >= text_.size() || text_[position_] != c)
+		{
+			fail(std::string("JSON parse error: expected '") + c + "'");
+		}
+		++position_;
+	}
+
+	bool JsonLiteParser::consume_char(char c)
+	{
+		skip_ws();
+		if (position_ < text_.size() && text_[position_] == c)
+		{
+			++position_;
+			return true;
+		}
+		return false;
+	}
+
+	bool JsonLiteParser::peek_char(char c)
+	{
+		skip_ws();
+		return position_ < text_.size() && text_[position_] == c;
+	}
+
+	std::size_t JsonLiteParser::position() const
+	{
+		return position_;
+	}
+
+	void JsonLiteParser::fail(const std::string& message) const
+	{
+		throw std::runtime_error(message + " (line " + std::to_string(line_number_at(text_, position_)) + ")");
+	}
+
+	JsonObject JsonLiteParser::parse_object()
+	{
+		expect_char('{');
+		JsonObject object;
+		skip_ws();
+
+		while (!consume_char('}'))
+		{
+			const std::string key = parse_string();
+			expect_char(':');
+			object[key] = parse_value();
+			skip_ws();
+			if (!consume_char(','))
+			{
+				expect_char('}');
+				break;
+			}
+			skip_ws();
+		}
+
+		return object;
+	}
+
+	JsonArray JsonLiteParser::parse_array()
+	{
+		expect_char('[');
+		JsonArray array;
+		skip_ws();
+
+		while (!consume_char(']'))
+		{
+			array.push_back(parse_value());
+			skip_ws();
+			if (!consume_char(','))
+			{
+				expect_char(']');
+				break;
+			}
+			skip_ws();
+		}
+
+		return array;
+	}
+
+	bool JsonLiteParser::parse_bool()
+	{
+		if (match_token("true"))
+		{
+			return true;
+		}
+		if (match_token("false"))
+		{
+			return false;
+		}
+		fail("JSON parse error: expected boolean");
+	}
+
+	void JsonLiteParser::parse_null()
+	{
+		if (!match_token("null"))
+		{
+			fail("JSON parse error: expected null");
+		}
+	}
+
+	double JsonLiteParser::parse_number()
+	{
+		skip_ws();
+		const char* first = text_.data() + position_;
+		double value = 0.0;
+		const char* end = scan_double(first, text_.data() + text_.size(), value);
+		if (end == nullptr)
+		{
+			const char c = position_ < text_.size() ? text_[position_] : '\0';
+			const bool numeric = c == '-' || c == '+' || c == '.' || std::isdigit(static_cast<unsigned char>(c)) != 0;
+			fail(numeric ? "JSON parse error: invalid number" : "JSON parse error: expected number");
+		}
+		position_ += static_cast<std::size_t>(end - first);
+		return value;
+	}
+
+	bool JsonLiteParser::match_token(std::string_view token)
+	{
+		skip_ws();
+		if (text_.substr(position_, token.size()) == token)
+		{
+			position_ += token.size();
+			return true;
+		}
+		return false;
+	}
+
+	const JsonObject& as_object(const JsonValue& value, const std::string& error)
+	{
+		const auto object = std::get_if<JsonObject>(&value.value);
+		if (object == nullptr)
+		{
+			throw std::runtime_error(error);
+		}
+		return *object;
+	}
+
+	const JsonArray& as_array(const JsonValue& value, const std::string& error)
+	{
+		const auto array = std::get_if<JsonArray>(&value.value);
+		if (array == nullptr)
+		{
+			throw std::runtime_error(error);
+		}
+		return *array;
+	}
+
+	double as_number(const JsonValue& value, const std::string& error)
+	{
+		const auto number = std::get_if<double>(&value.value);
+		if (number == nullptr)
+		{
+			throw std::runtime_error(error);
+		}
+		return *number;
+	}
+
+	const JsonValue* find_key(const JsonObject& object, std::initializer_list<const char*> keys)
+	{
+		for (const char* key : keys)
+		{
+			const auto it = object.find(key);
+			if (it != object.end())
+			{
+				return &it->second;
+			}
+		}
+		return nullptr;
+	}
+
+}  // namespace transformer
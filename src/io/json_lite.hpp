@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace transformer
+{
+
+	struct JsonValue;
+	using JsonObject = std::unordered_map<std::string, JsonValue>;
+	using JsonArray = std::vector<JsonValue>;
+
+	struct JsonValue
+	{
+		std::variant<std::nullptr_t, bool, double, std::string, JsonArray, JsonObject> value;
+	};
+
+	// Minimal JSON parser shared by the JSON and glTF readers. Parses out of a view of the whole file (the
+	// mapping outlives the parser); positions are file offsets, so errors can name the line.
+	class JsonLiteParser
+	{
+	public:
+		explicit JsonLiteParser(std::string_view text, std::size_t position = 0) :
+				text_(text),
+				position_(position)
+		{}
+
+		JsonValue parse_value();
+
+		// Moves past one value without building it, only tracking nesting and strings. Used to find
+		// element boundaries; the elements themselves are validated when they are parsed.
+		void skip_value();
+
+		std::string parse_string();
+		void skip_ws();
+		void expect_char(char c);
+		bool consume_char(char c);
+
+		[[nodiscard]]
+		bool peek_char(char c);
+
+		[[nodiscard]]
+		std::size_t position() const;
+
+		// Throws message with the line of the current position appended.
+		[[noreturn]]
+		void fail(const std::string& message) const;
+
+	private:
+		JsonObject parse_object();
+		JsonArray parse_array();
+		bool parse_bool();
+		void parse_null();
+		double parse_number();
+		bool match_token(std::string_view token);
+
+		std::string_view text_;
+		std::size_t position_ = 0;
+	};
+
+	// Tree accessors: return the held value or throw std::runtime_error(error).
+	const JsonObject& as_object(const JsonValue& value, const std::string& error);
+	const JsonArray& as_array(const JsonValue& value, const std::string& error);
+	double as_number(const JsonValue& value, const std::string& error);
+
+	// First of keys present in object (aliases in priority order), or nullptr.
+	const JsonValue* find_key(const JsonObject& object, std::initializer_list<const char*> keys);
+
+}  // namespace transformer
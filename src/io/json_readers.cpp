@@ -1,17 +1,25 @@
 #include "io/json_readers.hpp"
 
+#include "animation/animation_clip.hpp"
+#include "core/app_input.hpp"
+#include "core/memory_tracking.hpp"
 #include "core/profiler.hpp"
+#include "core/vertex_buffer.hpp"
+#include "io/async_files.hpp"
+#include "io/chunked_text.hpp"
+#include "io/gltf_io.hpp"
+#include "io/json_lite.hpp"
+#include "io/mapped_file.hpp"
 
 #include <algorithm>
-#include <cassert>
-#include <cctype>
+#include <array>
 #include <cmath>
+#include <filesystem>
 #include <fstream>
-#include <numeric>
-#include <sstream>
 #include <stdexcept>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -21,295 +29,18 @@ namespace transformer
 	namespace
 	{
 
-		struct JsonValue;
-		using JsonObject = std::unordered_map<std::string, JsonValue>;
-		using JsonArray = std::vector<JsonValue>;
-
-		struct JsonValue
-		{
-			std::variant<std::nullptr_t, bool, double, std::string, JsonArray, JsonObject> value;
-		};
-
-		class JsonLiteParser
+		// Checked before narrowing to int8, where 273 would wrap to bone 17: -1 (unused slot) or a bone below
+		// kMaxBones. 255 would alias the unused slot.
+		std::int8_t parse_bone_index(const JsonValue& value, const std::string& error)
 		{
-		public:
-			explicit JsonLiteParser(std::string text) :
-					text_(std::move(text))
-			{}
-
-			JsonValue parse_value()
-			{
-				skip_ws();
-				if (position_ >= text_.size())
-				{
-					throw std::runtime_error("JSON parse error: unexpected end of input");
-				}
-
-				const char c = text_[position_];
-				if (c == '{')
-				{
-					return JsonValue{parse_object()};
-				}
-				if (c == '[')
-				{
-					return JsonValue{parse_array()};
-				}
-				if (c == '"')
-				{
-					return JsonValue{parse_string()};
-				}
-				if (c == 't' || c == 'f')
-				{
-					return JsonValue{parse_bool()};
-				}
-				if (c == 'n')
-				{
-					parse_null();
-					return JsonValue{nullptr};
-				}
-				return JsonValue{parse_number()};
-			}
-
-		private:
-			JsonObject parse_object()
-			{
-				expect_char('{');
-				JsonObject object;
-				skip_ws();
-
-				while (!consume_char('}'))
-				{
-					const std::string key = parse_string();
-					expect_char(':');
-					object[key] = parse_value();
-					skip_ws();
-					if (!consume_char(','))
-					{
-						expect_char('}');
-						break;
-					}
-					skip_ws();
-				}
-
-				return object;
-			}
-
-			JsonArray parse_array()
+			const double number = as_number(value, error);
+			if (!(number >= -1.0 && number < static_cast<double>(kMaxBones)) || number != std::trunc(number))
 			{
-				expect_char('[');
-				JsonArray array;
-				skip_ws();
-
-				while (!consume_char(']'))
-				{
-					array.push_back(parse_value());
-					skip_ws();
-					if (!consume_char(','))
-					{
-						expect_char(']');
-						break;
-					}
-					skip_ws();
-				}
-
-				return array;
+				throw std::runtime_error(
+						"Weights JSON parse error: bone index must be an integer from -1 to "
+						+ std::to_string(kMaxBones - 1));
 			}
-
-			std::string parse_string()
-			{
-				expect_char('"');
-				std::string result;
-				while (position_ < text_.size())
-				{
-					const char c = text_[position_++];
-					if (c == '"')
-					{
-						return result;
-					}
-					if (c == '\\')
-					{
-						if (position_ >= text_.size())
-						{
-							throw std::runtime_error("JSON parse error: unfinished escape sequence");
-						}
-						const char escaped = text_[position_++];
-						switch (escaped)
-						{
-							case '"':
-							case '\\':
-							case '/': result.push_back(escaped); break;
-							case 'b': result.push_back('\b'); break;
-							case 'f': result.push_back('\f'); break;
-							case 'n': result.push_back('\n'); break;
-							case 'r': result.push_back('\r'); break;
-							case 't': result.push_back('\t'); break;
-							default: throw std::runtime_error("JSON parse error: unsupported escape sequence");
-						}
-						continue;
-					}
-
-					result.push_back(c);
-				}
-
-				throw std::runtime_error("JSON parse error: unterminated string");
-			}
-
-			bool parse_bool()
-			{
-				if (match_token("true"))
-				{
-					return true;
-				}
-				if (match_token("false"))
-				{
-					return false;
-				}
-				throw std::runtime_error("JSON parse error: expected boolean");
-			}
-
-			void parse_null()
-			{
-				if (!match_token("null"))
-				{
-					throw std::runtime_error("JSON parse error: expected null");
-				}
-			}
-
-			double parse_number()
-			{
-				skip_ws();
-				const std::size_t start = position_;
-				while (position_ < text_.size())
-				{
-					const char ch = text_[position_];
-					if (std::isdigit(static_cast<unsigned char>(ch)) != 0 || ch == '-' || ch == '+' || ch == '.'
-						|| ch == 'e' || ch == 'E')
-					{
-						++position_;
-						continue;
-					}
-					break;
-				}
-
-				if (start == position_)
-				{
-					throw std::runtime_error("JSON parse error: expected number");
-				}
-
-				return std::stod(text_.substr(start, position_ - start));
-			}
-
-			bool match_token(const std::string& token)
-			{
-				skip_ws();
-				if (text_.compare(position_, token.size(), token) == 0)
-				{
-					position_ += token.size();
-					return true;
-				}
-				return false;
-			}
-
-			void skip_ws()
-			{
-				while (position_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[position_])) != 0)
-				{
-					++position_;
-				}
-			}
-
-			void expect_char(char c)
-			{
-				skip_ws();
-				if (position_ >= text_.size() || text_[position_] != c)
-				{
-					throw std::runtime_error(std::string("JSON parse error: expected '") + c + "'");
-				}
-				++position_;
-			}
-
-			bool consume_char(char c)
-			{
-				skip_ws();
-				if (position_ < text_.size() && text_[position_] == c)
-				{
-					++position_;
-					return true;
-				}
-				return false;
-			}
-
-			std::string text_;
-			std::size_t position_ = 0;
-		};
-
-		std::string read_file_to_string(const std::string& path)
-		{
-			std::ifstream input(path);
-
-			if (!input)
-			{
-				std::string fallback = path;
-				constexpr char kCommonTypo[] = "asserts/";
-				const std::size_t typo_pos = fallback.find(kCommonTypo);
-				if (typo_pos != std::string::npos)
-				{
-					fallback.replace(typo_pos, std::char_traits<char>::length(kCommonTypo), "assets/");
-					input.open(fallback);
-				}
-			}
-
-			if (!input)
-			{
-				throw std::runtime_error("Failed to open file: " + path);
-			}
-
-			std::ostringstream ss;
-			ss << input.rdbuf();
-			return ss.str();
-		}
-
-		const JsonObject& as_object(const JsonValue& value, const std::string& error)
-		{
-			const auto object = std::get_if<JsonObject>(&value.value);
-			if (object == nullptr)
-			{
-				throw std::runtime_error(error);
-			}
-			return *object;
-		}
-
-		const JsonArray& as_array(const JsonValue& value, const std::string& error)
-		{
-			const auto array = std::get_if<JsonArray>(&value.value);
-			if (array == nullptr)
-			{
-				throw std::runtime_error(error);
-			}
-			return *array;
-		}
-
-		double as_number(const JsonValue& value, const std::string& error)
-		{
-			const auto number = std::get_if<double>(&value.value);
-			if (number == nullptr)
-			{
-				throw std::runtime_error(error);
-			}
-			return *number;
-		}
-
-		const JsonValue* find_key(const JsonObject& object, std::initializer_list<const char*> keys)
-		{
-			for (const char* key : keys)
-			{
-				const auto it = object.find(key);
-				if (it != object.end())
-				{
-					return &it->second;
-				}
-			}
-			return nullptr;
+			return static_cast<std::int8_t>(static_cast<int>(number));
 		}
 
 		std::array<std::int8_t, 4> parse_bone_indices(const JsonValue& value)
@@ -319,8 +50,7 @@ namespace transformer
 
 			for (std::size_t i = 0; i < index_values.size() && i < indices.size(); ++i)
 			{
-				indices[i] = static_cast<std::int8_t>(
-						as_number(index_values[i], "Weights JSON parse error: bone index must be numeric"));
+				indices[i] = parse_bone_index(index_values[i], "Weights JSON parse error: bone index must be numeric");
 			}
 
 			return indices;
@@ -391,51 +121,164 @@ namespace transformer
 								"Weights JSON parse error: influence must contain bone index and weight");
 					}
 
-					vertex_bone_weights.bone_indices[i] = static_cast<std::int8_t>(
-							as_number(*influence_index, "Weights JSON parse error: influence index must be numeric"));
+					vertex_bone_weights.bone_indices[i] = parse_bone_index(
+							*influence_index, "Weights JSON parse error: influence index must be numeric");
 					vertex_bone_weights.weights[i] = static_cast<float>(
 							as_number(*influence_weight, "Weights JSON parse error: influence weight must be numeric"));
 				}
 			}
 
-			// 2. Validate normalization to ensure the hot loop doesn't need to divide by sum.
-			// We use std::accumulate to sum all weights (including zeroed-out unused slots).
-			const float weights_sum
-					= std::accumulate(vertex_bone_weights.weights.begin(), vertex_bone_weights.weights.end(), 0.0F);
-
-			// Floating point epsilon check (0.001 is standard for skinning data validation).
-			assert(std::abs(weights_sum - 1.0F) < 0.001F && "Weights sum must be 1.0 for branchless optimization!");
+			// 2. Normalization (the hot loop doesn't divide by the sum) and bone ranges are checked once the
+			// bone count is known, by validate_bone_weights().
 
 			return vertex_bone_weights;
 		}
 
-		BoneWeightsData parse_bone_weights_data(const JsonValue& root)
+		// Calls on_element(offset) for every element of the array at the parser position; leaves the parser
+		// after it.
+		template <typename OnElement>
+		void scan_array_elements(JsonLiteParser& parser, OnElement&& on_element)
 		{
-			BoneWeightsData data;
+			parser.expect_char('[');
+			while (!parser.consume_char(']'))
+			{
+				on_element(parser.position());
+				parser.skip_value();
+				if (!parser.consume_char(','))
+				{
+					parser.expect_char(']');
+					break;
+				}
+			}
+		}
 
-			const JsonArray* vertices = nullptr;
-			if (const auto* root_array = std::get_if<JsonArray>(&root.value))
+		// Locates the vertices array (same layouts and key aliases as the tree-based readers), calls
+		// on_element(offset) for each of its elements and returns the offset of its '['. Only the structure
+		// is scanned here; the elements are parsed later.
+		template <typename OnElement>
+		std::size_t find_vertex_array(std::string_view text, OnElement&& on_element)
+		{
+			JsonLiteParser parser(text);
+			parser.skip_ws();
+			const std::size_t root_position = parser.position();
+			if (parser.peek_char('['))
 			{
-				vertices = root_array;
+				scan_array_elements(parser, on_element);
+				return root_position;
 			}
-			else
+			if (!parser.peek_char('{'))
 			{
-				const JsonObject& root_object
-						= as_object(root, "Weights JSON parse error: root value must be object or array");
-				const JsonValue* vertices_value
-						= find_key(root_object, {"vertices", "vertex_weights", "weights", "skin"});
-				if (vertices_value == nullptr)
+				parser.fail("Weights JSON parse error: root value must be object or array");
+			}
+
+			// Like find_key: the first alias in this list wins wherever it appears, and a repeated key keeps
+			// its last value.
+			constexpr std::array<std::string_view, 4> kVerticesKeys{"vertices", "vertex_weights", "weights", "skin"};
+			std::size_t found_rank = kVerticesKeys.size();
+			std::size_t found_position = 0;
+			bool found_array = false;
+
+			parser.expect_char('{');
+			while (!parser.consume_char('}'))
+			{
+				const std::string key = parser.parse_string();
+				parser.expect_char(':');
+
+				const auto rank = static_cast<std::size_t>(
+						std::find(kVerticesKeys.begin(), kVerticesKeys.end(), key) - kVerticesKeys.begin());
+				if (rank < kVerticesKeys.size() && rank <= found_rank)
+				{
+					found_rank = rank;
+					found_array = parser.peek_char('[');
+					found_position = parser.position();
+					if (found_array)
+					{
+						scan_array_elements(parser, on_element);
+					}
+					else
+					{
+						parser.parse_value();
+					}
+				}
+				else
+				{
+					parser.parse_value();
+				}
+
+				if (!parser.consume_char(','))
 				{
-					throw std::runtime_error("Weights JSON parse error: root object must contain vertices array");
+					parser.expect_char('}');
+					break;
 				}
-				vertices = &as_array(*vertices_value, "Weights JSON parse error: vertices must be an array");
 			}
 
-			data.per_vertex_weights.reserve(vertices->size());
-			for (const JsonValue& vertex_value : *vertices)
+			if (found_rank == kVerticesKeys.size())
+			{
+				throw std::runtime_error("Weights JSON parse error: root object must contain vertices array");
+			}
+			if (!found_array)
 			{
-				data.per_vertex_weights.push_back(parse_vertex_weights(vertex_value));
+				JsonLiteParser(text, found_position).fail("Weights JSON parse error: vertices must be an array");
 			}
+			return found_position;
+		}
+
+		std::vector<std::size_t> find_vertex_elements(std::string_view text)
+		{
+			std::vector<std::size_t> element_offsets;
+			const std::size_t position
+					= find_vertex_array(text, [&](std::size_t offset) { element_offsets.push_back(offset); });
+			// Arrays under aliases that lose to a later key were scanned too; they all end before the winner.
+			element_offsets.erase(
+					element_offsets.begin(),
+					std::find_if(
+							element_offsets.begin(),
+							element_offsets.end(),
+							[&](std::size_t offset) { return offset > position; }));
+			return element_offsets;
+		}
+
+		// Parses one element of the vertices array; errors name its line.
+		VertexBoneWeights parse_vertex_element(std::string_view text, std::size_t offset)
+		{
+			const JsonValue vertex_value = JsonLiteParser(text, offset).parse_value();
+			try
+			{
+				return parse_vertex_weights(vertex_value);
+			}
+			catch (const std::runtime_error& ex)
+			{
+				throw std::runtime_error(
+						std::string(ex.what()) + " (line " + std::to_string(line_number_at(text, offset)) + ")");
+			}
+		}
+
+		BoneWeightsData parse_bone_weights_data(std::string_view text)
+		{
+			const std::vector<std::size_t> element_offsets = find_vertex_elements(text);
+			const std::size_t vertex_count = element_offsets.size();
+
+			BoneWeightsData data;
+			data.per_vertex_weights.resize(vertex_count);
+			if (vertex_count == 0)
+			{
+				return data;
+			}
+
+			// Contiguous runs of vertices per worker, written straight to their final slots.
+			const std::size_t array_bytes = text.size() - element_offsets.front();
+			const std::size_t chunk_count = std::min(choose_chunk_count(array_bytes), vertex_count);
+			run_chunk_tasks(
+					chunk_count,
+					[&](std::size_t chunk)
+					{
+						const std::size_t begin = vertex_count * chunk / chunk_count;
+						const std::size_t end = vertex_count * (chunk + 1) / chunk_count;
+						for (std::size_t i = begin; i < end; ++i)
+						{
+							data.per_vertex_weights[i] = parse_vertex_element(text, element_offsets[i]);
+						}
+					});
 
 			return data;
 		}
@@ -498,23 +341,430 @@ namespace transformer
 			return matrices;
 		}
 
+		// { "targets": [ { "name": "...", "indices": [v, ...], "deltas": [dx, dy, dz, ...] }, ... ] } or the
+		// bare targets array. Indices are 0-based OBJ vertex order; they are sorted here if needed.
+		std::vector<MorphTarget> parse_morph_targets(const JsonValue& root)
+		{
+			const JsonArray* targets = nullptr;
+			if (const auto* root_array = std::get_if<JsonArray>(&root.value))
+			{
+				targets = root_array;
+			}
+			else
+			{
+				const JsonObject& root_object
+						= as_object(root, "Morph JSON parse error: root value must be object or array");
+				const JsonValue* targets_value = find_key(root_object, {"targets", "morph_targets", "blend_shapes"});
+				if (targets_value == nullptr)
+				{
+					throw std::runtime_error("Morph JSON parse error: root object must contain targets array");
+				}
+				targets = &as_array(*targets_value, "Morph JSON parse error: targets must be an array");
+			}
+
+			std::vector<MorphTarget> morph_targets;
+			morph_targets.reserve(targets->size());
+			for (const JsonValue& target_value : *targets)
+			{
+				const JsonObject& target_object
+						= as_object(target_value, "Morph JSON parse error: each target must be an object");
+				const JsonValue* indices_value = find_key(target_object, {"indices", "vertex_indices", "vertices"});
+				const JsonValue* deltas_value = find_key(target_object, {"deltas", "offsets"});
+				if (indices_value == nullptr || deltas_value == nullptr)
+				{
+					throw std::runtime_error("Morph JSON parse error: target must contain indices and deltas arrays");
+				}
+
+				const JsonArray& indices = as_array(*indices_value, "Morph JSON parse error: indices must be an array");
+				const JsonArray& deltas = as_array(*deltas_value, "Morph JSON parse error: deltas must be an array");
+				if (deltas.size() != indices.size() * 3)
+				{
+					throw std::runtime_error("Morph JSON parse error: deltas must hold 3 values per index");
+				}
+
+				std::vector<std::pair<std::uint32_t, Vec3>> sparse(indices.size());
+				for (std::size_t i = 0; i < indices.size(); ++i)
+				{
+					const double index = as_number(indices[i], "Morph JSON parse error: index must be numeric");
+					if (index < 0.0 || index != std::floor(index))
+					{
+						throw std::runtime_error("Morph JSON parse error: index must be a non-negative integer");
+					}
+					sparse[i].first = static_cast<std::uint32_t>(index);
+					constexpr char kDeltaError[] = "Morph JSON parse error: delta must be numeric";
+					sparse[i].second = {
+							static_cast<float>(as_number(deltas[i * 3], kDeltaError)),
+							static_cast<float>(as_number(deltas[i * 3 + 1], kDeltaError)),
+							static_cast<float>(as_number(deltas[i * 3 + 2], kDeltaError)),
+					};
+				}
+				std::stable_sort(
+						sparse.begin(), sparse.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+				MorphTarget& morph_target = morph_targets.emplace_back();
+				morph_target.vertex_indices.reserve(sparse.size());
+				morph_target.deltas.reserve(sparse.size());
+				for (const auto& [index, delta] : sparse)
+				{
+					morph_target.vertex_indices.push_back(index);
+					morph_target.deltas.push_back(delta);
+				}
+			}
+
+			return morph_targets;
+		}
+
+		// { "weights": [w0, w1, ...] } or the bare array.
+		std::vector<float> parse_morph_weights(const JsonValue& root)
+		{
+			const JsonArray* weights = nullptr;
+			if (const auto* root_array = std::get_if<JsonArray>(&root.value))
+			{
+				weights = root_array;
+			}
+			else
+			{
+				const JsonObject& root_object
+						= as_object(root, "Morph weights JSON parse error: root value must be object or array");
+				const JsonValue* weights_value = find_key(root_object, {"weights"});
+				if (weights_value == nullptr)
+				{
+					throw std::runtime_error("Morph weights JSON parse error: root object must contain weights array");
+				}
+				weights = &as_array(*weights_value, "Morph weights JSON parse error: weights must be an array");
+			}
+
+			std::vector<float> morph_weights;
+			morph_weights.reserve(weights->size());
+			for (const JsonValue& weight : *weights)
+			{
+				morph_weights.push_back(static_cast<float>(
+						as_number(weight, "Morph weights JSON parse error: weight must be numeric")));
+			}
+			return morph_weights;
+		}
+
+		// Reads count groups of width numbers from a flat array.
+		template <std::size_t Width>
+		std::vector<std::array<float, Width>> parse_key_values(
+				const JsonValue& value, std::size_t count, const std::string& field)
+		{
+			const std::string error = "Clip JSON parse error: " + field;
+			const JsonArray& values = as_array(value, error + " must be an array");
+			if (values.size() != count * Width)
+			{
+				throw std::runtime_error(error + " must hold " + std::to_string(Width) + " values per key");
+			}
+
+			std::vector<std::array<float, Width>> keys(count);
+			for (std::size_t i = 0; i < values.size(); ++i)
+			{
+				keys[i / Width][i % Width] = static_cast<float>(as_number(values[i], error + " must be numeric"));
+			}
+			return keys;
+		}
+
+		// { "name": "...", "tracks": [ { "bone": 3, "times": [..], "translations": [x,y,z,..],
+		//   "rotations": [x,y,z,w,..], "scales": [x,y,z,..] }, ... ] }; scales are optional.
+		AnimationClip parse_animation_clip(const JsonValue& root)
+		{
+			const JsonObject& root_object = as_object(root, "Clip JSON parse error: root value must be an object");
+
+			AnimationClip clip;
+			if (const JsonValue* name = find_key(root_object, {"name"}))
+			{
+				if (const auto* text = std::get_if<std::string>(&name->value))
+				{
+					clip.name = *text;
+				}
+			}
+
+			const JsonValue* tracks_value = find_key(root_object, {"tracks"});
+			if (tracks_value == nullptr)
+			{
+				throw std::runtime_error("Clip JSON parse error: root object must contain tracks array");
+			}
+
+			const JsonArray& tracks = as_array(*tracks_value, "Clip JSON parse error: tracks must be an array");
+			for (const JsonValue& track_value : tracks)
+			{
+				const JsonObject& track_object
+						= as_object(track_value, "Clip JSON parse error: each track must be an object");
+				const JsonValue* bone_value = find_key(track_object, {"bone", "bone_index"});
+				const JsonValue* times_value = find_key(track_object, {"times"});
+				const JsonValue* translations_value = find_key(track_object, {"translations"});
+				const JsonValue* rotations_value = find_key(track_object, {"rotations"});
+				const JsonValue* scales_value = find_key(track_object, {"scales"});
+				if (bone_value == nullptr || times_value == nullptr || translations_value == nullptr
+					|| rotations_value == nullptr)
+				{
+					throw std::runtime_error(
+							"Clip JSON parse error: track must contain bone, times, translations and rotations");
+				}
+
+				const double bone = as_number(*bone_value, "Clip JSON parse error: bone must be numeric");
+				if (bone < 0.0 || bone > 254.0 || bone != std::floor(bone))
+				{
+					throw std::runtime_error("Clip JSON parse error: bone must be an integer in [0, 254]");
+				}
+				const auto bone_index = static_cast<std::size_t>(bone);
+				if (bone_index >= clip.tracks.size())
+				{
+					clip.tracks.resize(bone_index + 1);
+				}
+				BoneTrack& track = clip.tracks[bone_index];
+				if (!track.keys.empty())
+				{
+					throw std::runtime_error(
+							"Clip JSON parse error: bone " + std::to_string(bone_index) + " has two tracks");
+				}
+
+				const JsonArray& times = as_array(*times_value, "Clip JSON parse error: times must be an array");
+				if (times.empty())
+				{
+					throw std::runtime_error("Clip JSON parse error: track must have at least one key");
+				}
+				for (const JsonValue& time : times)
+				{
+					const double seconds = as_number(time, "Clip JSON parse error: time must be numeric");
+					track.times.push_back(static_cast<float>(seconds));
+					if (track.times.size() > 1 && track.times.back() <= track.times[track.times.size() - 2])
+					{
+						throw std::runtime_error("Clip JSON parse error: key times must be strictly increasing");
+					}
+				}
+
+				const std::size_t key_count = times.size();
+				const auto translations = parse_key_values<3>(*translations_value, key_count, "translations");
+				const auto rotations = parse_key_values<4>(*rotations_value, key_count, "rotations");
+				std::vector<std::array<float, 3>> scales(key_count, {1.0F, 1.0F, 1.0F});
+				if (scales_value != nullptr)
+				{
+					scales = parse_key_values<3>(*scales_value, key_count, "scales");
+				}
+
+				track.keys.resize(key_count);
+				for (std::size_t key = 0; key < key_count; ++key)
+				{
+					const auto& [x, y, z, w] = rotations[key];
+					const float length = std::sqrt(x * x + y * y + z * z + w * w);
+					if (length == 0.0F)
+					{
+						throw std::runtime_error("Clip JSON parse error: rotation must not be zero");
+					}
+					// Leave unit keys untouched so they round-trip exactly.
+					const float scale = std::abs(length - 1.0F) > 1e-5F ? 1.0F / length : 1.0F;
+
+					track.keys[key] = {
+							.translation = {translations[key][0], translations[key][1], translations[key][2]},
+							.rotation = {x * scale, y * scale, z * scale, w * scale},
+							.scale = {scales[key][0], scales[key][1], scales[key][2]},
+					};
+				}
+			}
+
+			return clip;
+		}
+
+		std::string parse_job_path(
+				const JsonObject& job, const char* key, const std::string& job_name, const std::filesystem::path& base)
+		{
+			const JsonValue* value = find_key(job, {key});
+			const auto* path = value != nullptr ? std::get_if<std::string>(&value->value) : nullptr;
+			if (path == nullptr || path->empty())
+			{
+				throw std::runtime_error(
+						"Job manifest parse error: " + job_name + " needs a \"" + key + "\" path");
+			}
+			const std::filesystem::path resolved(*path);
+			return resolved.is_absolute() ? *path : (base / resolved).lexically_normal().string();
+		}
+
+		AppInput parse_job(
+				const JsonValue& value, std::size_t index, const std::filesystem::path& base, const AppInput& defaults)
+		{
+			const std::string job_name = "job " + std::to_string(index);
+			const JsonObject& job = as_object(value, "Job manifest parse error: " + job_name + " must be an object");
+
+			AppInput input = defaults;
+			input.mesh_file = parse_job_path(job, "mesh", job_name, base);
+			const bool glb = is_glb_file(input.mesh_file);
+			input.weights_file = glb && find_key(job, {"weights"}) == nullptr
+										 ? input.mesh_file
+										 : parse_job_path(job, "weights", job_name, base);
+			input.inverse_bind_pose_file = glb && find_key(job, {"inverse_bind_pose"}) == nullptr
+												   ? input.mesh_file
+												   : parse_job_path(job, "inverse_bind_pose", job_name, base);
+			input.new_pose_file = parse_job_path(job, "new_pose", job_name, base);
+
+			// Kept relative: the batch runner resolves outputs against its output directory.
+			const JsonValue* output = find_key(job, {"output"});
+			const auto* output_path = output != nullptr ? std::get_if<std::string>(&output->value) : nullptr;
+			if (output_path == nullptr || output_path->empty())
+			{
+				throw std::runtime_error("Job manifest parse error: " + job_name + " needs an \"output\" path");
+			}
+			input.output_mesh_file = *output_path;
+
+			if (const JsonValue* clips = find_key(job, {"clips"}))
+			{
+				for (const JsonValue& clip_value :
+					 as_array(*clips, "Job manifest parse error: " + job_name + " clips must be an array"))
+				{
+					const JsonObject& clip = as_object(
+							clip_value, "Job manifest parse error: " + job_name + " clip must be an object");
+					ClipInput clip_input{.file = parse_job_path(clip, "file", job_name, base)};
+					if (const JsonValue* weight = find_key(clip, {"weight"}))
+					{
+						clip_input.weight = static_cast<float>(
+								as_number(*weight, "Job manifest parse error: clip weight must be numeric"));
+					}
+					input.clips.push_back(std::move(clip_input));
+				}
+			}
+			if (const JsonValue* times = find_key(job, {"times"}))
+			{
+				for (const JsonValue& time :
+					 as_array(*times, "Job manifest parse error: " + job_name + " times must be an array"))
+				{
+					input.sample_times.push_back(
+							static_cast<float>(as_number(time, "Job manifest parse error: time must be numeric")));
+				}
+				if (input.clips.empty())
+				{
+					throw std::runtime_error("Job manifest parse error: " + job_name + " has times but no clips");
+				}
+			}
+			return input;
+		}
+
+		void write_aabb(std::ostream& output, const Aabb& box)
+		{
+			if (box.empty())
+			{
+				// A mesh without vertices; infinities are not valid JSON.
+				output << "\"min\": null, \"max\": null";
+				return;
+			}
+			output << "\"min\": [" << box.min.x << ", " << box.min.y << ", " << box.min.z << "], \"max\": ["
+				   << box.max.x << ", " << box.max.y << ", " << box.max.z << ']';
+		}
+
 	}  // namespace
 
 	BoneWeightsData JsonBoneWeightsReader::read(const std::string& weights_file, Profiler& profiler) const
 	{
 		const auto scope = profiler.stage("read_weights_json");
-		const JsonValue parsed_root = JsonLiteParser(read_file_to_string(weights_file)).parse_value();
-		return parse_bone_weights_data(parsed_root);
+		const InputFile file = load_input_file(weights_file);
+		return parse_bone_weights_data(file.view());
+	}
+
+	JsonBoneWeightsStream::JsonBoneWeightsStream(const std::string& weights_file) :
+			file_(open_input_file(weights_file)),
+			text_(file_.view())
+	{
+		// In a root object a later key may hold a preferred alias, so finding the array skips over the
+		// whole object once, dropping pages behind it as it goes.
+		std::size_t array_position = 0;
+		if (!JsonLiteParser(text_).peek_char('['))
+		{
+			constexpr std::size_t kReleaseStep = std::size_t{4} << 20;
+			std::size_t released = 0;
+			array_position = find_vertex_array(
+					text_,
+					[&](std::size_t offset)
+					{
+						if (offset - released >= kReleaseStep)
+						{
+							file_.release(released, offset);
+							released = offset;
+						}
+					});
+			file_.release(released, text_.size());
+		}
+		JsonLiteParser parser(text_, array_position);
+		parser.expect_char('[');
+		position_ = parser.consume_char(']') ? text_.size() : parser.position();
+	}
+
+	std::size_t JsonBoneWeightsStream::read(Mesh::Entry* entries, std::size_t max_count)
+	{
+		const std::size_t begin = position_;
+		std::size_t count = 0;
+		while (count < max_count && position_ < text_.size())
+		{
+			JsonLiteParser parser(text_, position_);
+			parser.skip_ws();
+			entries[count++].bone_weights = parse_vertex_element(text_, parser.position());
+			parser.skip_value();
+			if (parser.consume_char(','))
+			{
+				position_ = parser.position();
+			}
+			else
+			{
+				parser.expect_char(']');
+				position_ = text_.size();
+			}
+		}
+		file_.release(begin, position_);
+		return count;
 	}
 
 	std::vector<Mat4> JsonBonePoseReader::read_matrices(
 			const std::string& file_path, Profiler& profiler, const std::string& stage_name) const
 	{
 		const auto scope = profiler.stage(stage_name);
-		const JsonValue parsed_root = JsonLiteParser(read_file_to_string(file_path)).parse_value();
+		const InputFile file = load_input_file(file_path);
+		const JsonValue parsed_root = JsonLiteParser(file.view()).parse_value();
 		return parse_bone_matrices(parsed_root);
 	}
 
+	std::vector<MorphTarget> JsonMorphTargetReader::read_targets(const std::string& file_path, Profiler& profiler) const
+	{
+		const auto scope = profiler.stage("read_morph_targets_json");
+		const InputFile file = load_input_file(file_path);
+		return parse_morph_targets(JsonLiteParser(file.view()).parse_value());
+	}
+
+	std::vector<float> JsonMorphTargetReader::read_weights(const std::string& file_path, Profiler& profiler) const
+	{
+		const auto scope = profiler.stage("read_morph_weights_json");
+		const InputFile file = load_input_file(file_path);
+		return parse_morph_weights(JsonLiteParser(file.view()).parse_value());
+	}
+
+	AnimationClip JsonAnimationClipReader::read(const std::string& clip_file, Profiler& profiler) const
+	{
+		const auto scope = profiler.stage("read_clip_json");
+		const InputFile file = load_input_file(clip_file);
+		return parse_animation_clip(JsonLiteParser(file.view()).parse_value());
+	}
+
+	std::vector<AppInput> JsonJobManifestReader::read(
+			const std::string& manifest_file, const AppInput& defaults, Profiler& profiler) const
+	{
+		const auto scope = profiler.stage("read_job_manifest");
+		const InputFile file = load_input_file(manifest_file);
+		const JsonValue root = JsonLiteParser(file.view()).parse_value();
+		const JsonObject& object = as_object(root, "Job manifest parse error: root must be an object");
+		const JsonValue* jobs = find_key(object, {"jobs"});
+		if (jobs == nullptr)
+		{
+			throw std::runtime_error("Job manifest parse error: missing \"jobs\" array");
+		}
+
+		const std::filesystem::path base = std::filesystem::path(manifest_file).parent_path();
+		std::vector<AppInput> inputs;
+		const JsonArray& job_values = as_array(*jobs, "Job manifest parse error: \"jobs\" must be an array");
+		inputs.reserve(job_values.size());
+		for (std::size_t index = 0; index < job_values.size(); ++index)
+		{
+			inputs.push_back(parse_job(job_values[index], index, base, defaults));
+		}
+		return inputs;
+	}
+
 	void JsonStatsWriter::write(const std::string& output_file, const StatsReport& stats) const
 	{
 		std::ofstream output(output_file);
@@ -526,11 +776,23 @@ namespace transformer
 		output.setf(std::ios::fixed);
 		output.precision(3);
 
-		output << "{\n  \"unit\": \"microseconds\",\n  \"stages\": [\n";
+		output << "{\n  \"unit\": \"microseconds\",\n";
+		if (!stats.kernel.empty())
+		{
+			output << "  \"kernel\": \"" << stats.kernel << "\",\n";
+		}
+		output << "  \"stages\": [\n";
 		for (std::size_t i = 0; i < stats.stages.size(); ++i)
 		{
 			output << "    { \"stage\": \"" << stats.stages[i].stage
-				   << "\", \"microseconds\": " << stats.stages[i].microseconds << " }";
+				   << "\", \"microseconds\": " << stats.stages[i].microseconds;
+			if (const auto& allocations = stats.stages[i].allocations)
+			{
+				output << ", \"allocations\": " << allocations->allocations
+					   << ", \"allocated_bytes\": " << allocations->allocated_bytes
+					   << ", \"peak_live_bytes\": " << allocations->peak_live_bytes;
+			}
+			output << " }";
 			if (i + 1 < stats.stages.size())
 			{
 				output << ',';
@@ -539,6 +801,39 @@ namespace transformer
 		}
 		output << "  ]";
 
+		if (!stats.counters.empty())
+		{
+			output << ",\n  \"counters\": {\n";
+			for (std::size_t i = 0; i < stats.counters.size(); ++i)
+			{
+				output << "    \"" << stats.counters[i].name << "\": " << stats.counters[i].value;
+				if (i + 1 < stats.counters.size())
+				{
+					output << ',';
+				}
+				output << '\n';
+			}
+			output << "  }";
+		}
+
+		// Sampled here, so the peak covers the whole run up to the report.
+		output << ",\n  \"memory\": {\n    \"peak_rss_bytes\": " << process_peak_rss_bytes();
+		if (allocation_tracking_enabled())
+		{
+			const AllocationCounts totals = allocation_totals();
+			output << ",\n    \"allocations\": " << totals.allocations << ",\n    \"allocated_bytes\": "
+				   << totals.allocated_bytes << ",\n    \"peak_live_bytes\": " << totals.peak_live_bytes;
+		}
+		const VertexBufferCounts mapped = vertex_buffer_counts();
+		if (mapped.reserved_huge_page_bytes + mapped.transparent_huge_page_bytes + mapped.small_page_bytes != 0)
+		{
+			// Vertex buffers mapped since the start, by the pages that back them (see core/vertex_buffer.hpp).
+			output << ",\n    \"vertex_buffer_bytes\": { \"reserved_huge_pages\": " << mapped.reserved_huge_page_bytes
+				   << ", \"transparent_huge_pages\": " << mapped.transparent_huge_page_bytes
+				   << ", \"small_pages\": " << mapped.small_page_bytes << " }";
+		}
+		output << "\n  }";
+
 		if (stats.bench_summary.has_value())
 		{
 			const BenchSummary& bench = stats.bench_summary.value();
@@ -552,6 +847,104 @@ namespace transformer
 				   << "  }";
 		}
 
+		if (stats.vertex_cache.has_value())
+		{
+			const VertexCacheSummary& cache = stats.vertex_cache.value();
+			const auto raw_bytes = static_cast<double>(cache.raw_bytes);
+			const double ratio = cache.encoded_bytes == 0 ? 0.0 : raw_bytes / static_cast<double>(cache.encoded_bytes);
+			// Bytes per microsecond is MB/s.
+			const double throughput = cache.encode_microseconds <= 0.0 ? 0.0 : raw_bytes / cache.encode_microseconds;
+			output << ",\n  \"vertex_cache\": {\n"
+				   << "    \"frames\": " << cache.frames << ",\n"
+				   << "    \"raw_bytes\": " << cache.raw_bytes << ",\n"
+				   << "    \"encoded_bytes\": " << cache.encoded_bytes << ",\n"
+				   << "    \"compression_ratio\": " << ratio << ",\n"
+				   << "    \"encode_microseconds\": " << cache.encode_microseconds << ",\n"
+				   << "    \"encode_mb_per_second\": " << throughput << "\n"
+				   << "  }";
+		}
+
+		if (stats.batch.has_value())
+		{
+			const BatchSummary& batch = stats.batch.value();
+			const double seconds = batch.wall_microseconds / 1e6;
+			const auto per_second = [seconds](double count) { return seconds <= 0.0 ? 0.0 : count / seconds; };
+			const BenchSummary& latency = batch.job_latency;
+			output << ",\n  \"batch\": {\n"
+				   << "    \"workers\": " << batch.workers << ",\n"
+				   << "    \"jobs\": " << batch.jobs << ",\n"
+				   << "    \"failed_jobs\": " << batch.failed_jobs << ",\n"
+				   << "    \"frames\": " << batch.frames << ",\n"
+				   << "    \"vertices_skinned\": " << batch.vertices_skinned << ",\n"
+				   << "    \"wall_microseconds\": " << batch.wall_microseconds << ",\n"
+				   << "    \"jobs_per_second\": " << per_second(static_cast<double>(batch.jobs)) << ",\n"
+				   << "    \"frames_per_second\": " << per_second(static_cast<double>(batch.frames)) << ",\n"
+				   << "    \"vertices_per_second\": " << per_second(static_cast<double>(batch.vertices_skinned))
+				   << ",\n"
+				   << "    \"job_latency\": { \"min_microseconds\": " << latency.min_microseconds
+				   << ", \"median_microseconds\": " << latency.median_microseconds
+				   << ", \"mean_microseconds\": " << latency.mean_microseconds
+				   << ", \"max_microseconds\": " << latency.max_microseconds
+				   << ", \"stddev_microseconds\": " << latency.stddev_microseconds << " }\n"
+				   << "  }";
+		}
+
+		if (stats.determinism.has_value())
+		{
+			const DeterminismSummary& determinism = stats.determinism.value();
+			output << ",\n  \"determinism\": {\n    \"kernel\": \"" << determinism.kernel << "\",\n";
+			if (determinism.fastest_kernel.empty())
+			{
+				output << "    \"fastest_kernel\": null\n  }";
+			}
+			else
+			{
+				// Relative cost of exactness: deterministic time over fused time.
+				const double fused_microseconds = determinism.fastest_microseconds;
+				const double overhead
+						= fused_microseconds <= 0.0 ? 0.0 : determinism.deterministic_microseconds / fused_microseconds;
+				output << "    \"fastest_kernel\": \"" << determinism.fastest_kernel << "\",\n"
+					   << "    \"sample_vertices\": " << determinism.sample_vertices << ",\n"
+					   << "    \"deterministic_microseconds\": " << determinism.deterministic_microseconds << ",\n"
+					   << "    \"fastest_microseconds\": " << determinism.fastest_microseconds << ",\n"
+					   << "    \"overhead\": " << overhead << ",\n"
+					   << "    \"differing_vertices\": " << determinism.differing_vertices << "\n"
+					   << "  }";
+			}
+		}
+
+		if (!stats.bounds.empty())
+		{
+			// Bones that dominate no vertex are left out; "bone" is the pose index.
+			output.precision(6);
+			output << ",\n  \"bounds\": [\n";
+			for (std::size_t frame = 0; frame < stats.bounds.size(); ++frame)
+			{
+				const SkinnedBounds& bounds = stats.bounds[frame];
+				output << "    { \"frame\": " << frame << ", ";
+				write_aabb(output, bounds.mesh);
+				if (!bounds.bones.empty())
+				{
+					output << ", \"bones\": [";
+					bool first = true;
+					for (std::size_t bone = 0; bone < bounds.bones.size(); ++bone)
+					{
+						if (bounds.bones[bone].empty())
+						{
+							continue;
+						}
+						output << (first ? "\n" : ",\n") << "      { \"bone\": " << bone << ", ";
+						write_aabb(output, bounds.bones[bone]);
+						output << " }";
+						first = false;
+					}
+					output << "\n    ]";
+				}
+				output << " }" << (frame + 1 < stats.bounds.size() ? ",\n" : "\n");
+			}
+			output << "  ]";
+		}
+
 		output << "\n}\n";
 	}
 
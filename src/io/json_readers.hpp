@@ -1,6 +1,12 @@
 #pragma once
 
+#include "core/math_types.hpp"
 #include "io/io_interfaces.hpp"
+#include "io/mapped_file.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
 
 namespace transformer
 {
@@ -11,6 +17,25 @@ namespace transformer
 		BoneWeightsData read(const std::string& weights_file, Profiler& profiler) const override;
 	};
 
+	// Front-to-back reader for --stream over the layouts JsonBoneWeightsReader accepts: parses the vertices
+	// array one element at a time and releases the pages behind it.
+	class JsonBoneWeightsStream
+	{
+	public:
+		// Throws std::runtime_error if the file cannot be opened or has no vertices array.
+		explicit JsonBoneWeightsStream(const std::string& weights_file);
+
+		// Weights of the next up to max_count vertices into entries[i].bone_weights; returns how many were
+		// read, 0 once all vertices have been.
+		std::size_t read(Mesh::Entry* entries, std::size_t max_count);
+
+	private:
+		MappedFile file_;
+		std::string_view text_;
+		// Offset of the next element, or of the text end once the closing ']' has been read.
+		std::size_t position_ = 0;
+	};
+
 	class JsonBonePoseReader : public IBonePoseReader
 	{
 	public:
@@ -18,6 +43,29 @@ namespace transformer
 				const std::string& file_path, Profiler& profiler, const std::string& stage_name) const override;
 	};
 
+	class JsonMorphTargetReader : public IMorphTargetReader
+	{
+	public:
+		std::vector<MorphTarget> read_targets(const std::string& file_path, Profiler& profiler) const override;
+		std::vector<float> read_weights(const std::string& file_path, Profiler& profiler) const override;
+	};
+
+	class JsonAnimationClipReader : public IAnimationClipReader
+	{
+	public:
+		AnimationClip read(const std::string& clip_file, Profiler& profiler) const override;
+	};
+
+	// { "jobs": [ { "mesh", "weights", "inverse_bind_pose", "new_pose", "output",
+	//              "clips": [ { "file", "weight" } ], "times": [..] }, ... ] }
+	// weights and inverse_bind_pose default to mesh when it is a .glb; clips and times are optional.
+	class JsonJobManifestReader : public IJobManifestReader
+	{
+	public:
+		std::vector<AppInput> read(
+				const std::string& manifest_file, const AppInput& defaults, Profiler& profiler) const override;
+	};
+
 	class JsonStatsWriter : public IStatsWriter
 	{
 	public:
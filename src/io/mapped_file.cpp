@@ -0,0 +1,193 @@
+#include "io/mapped_file.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace transformer
+{
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			data_ = std::exchange(other.data_, nullptr);
+			size_ = std::exchange(other.size_, 0);
+#if defined(_WIN32)
+			file_handle_ = std::exchange(other.file_handle_, nullptr);
+			mapping_handle_ = std::exchange(other.mapping_handle_, nullptr);
+#endif
+		}
+		return *this;
+	}
+
+#if defined(_WIN32)
+	bool MappedFile::open(const std::string& path)
+	{
+		close();
+
+		HANDLE file = CreateFileA(
+				path.c_str(),
+				GENERIC_READ,
+				FILE_SHARE_READ,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_FLAG_SEQUENTIAL_SCAN,
+				nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER size{};
+		if (!GetFileSizeEx(file, &size))
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		file_handle_ = file;
+		size_ = static_cast<std::size_t>(size.QuadPart);
+		if (size_ == 0)
+		{
+			// Empty files cannot be mapped; an empty view is all there is to parse.
+			return true;
+		}
+
+		mapping_handle_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping_handle_ == nullptr)
+		{
+			close();
+			return false;
+		}
+
+		data_ = static_cast<const char*>(MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+		if (data_ == nullptr)
+		{
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (data_ != nullptr)
+		{
+			UnmapViewOfFile(data_);
+		}
+		if (mapping_handle_ != nullptr)
+		{
+			CloseHandle(mapping_handle_);
+		}
+		if (file_handle_ != nullptr)
+		{
+			CloseHandle(file_handle_);
+		}
+		data_ = nullptr;
+		size_ = 0;
+		mapping_handle_ = nullptr;
+		file_handle_ = nullptr;
+	}
+
+	void MappedFile::release(std::size_t /*begin*/, std::size_t /*end*/)
+	{
+	}
+#else
+	bool MappedFile::open(const std::string& path)
+	{
+		close();
+
+		const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			return false;
+		}
+
+		struct stat status{};
+		if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+		{
+			::close(fd);
+			return false;
+		}
+
+		size_ = static_cast<std::size_t>(status.st_size);
+		if (size_ == 0)
+		{
+			// Empty files cannot be mapped; an empty view is all there is to parse.
+			::close(fd);
+			return true;
+		}
+
+		void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+		// The mapping keeps its own reference to the file.
+		::close(fd);
+		if (data == MAP_FAILED)
+		{
+			size_ = 0;
+			return false;
+		}
+
+		// Parsers walk the file front to back.
+		::madvise(data, size_, MADV_SEQUENTIAL);
+		data_ = static_cast<const char*>(data);
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (data_ != nullptr)
+		{
+			::munmap(const_cast<char*>(data_), size_);
+		}
+		data_ = nullptr;
+		size_ = 0;
+	}
+
+	void MappedFile::release(std::size_t begin, std::size_t end)
+	{
+		// mmap returns a page-aligned address, so page boundaries are offsets into the file.
+		const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+		begin = (begin + page_size - 1) / page_size * page_size;
+		end = std::min(end, size_) / page_size * page_size;
+		if (data_ != nullptr && begin < end)
+		{
+			::madvise(const_cast<char*>(data_) + begin, end - begin, MADV_DONTNEED);
+		}
+	}
+#endif
+
+	std::string_view MappedFile::view() const
+	{
+		return data_ == nullptr ? std::string_view{} : std::string_view(data_, size_);
+	}
+
+	MappedFile open_input_file(const std::string& path)
+	{
+		MappedFile file;
+		open_with_typo_fallback(file, path);
+		return file;
+	}
+
+}  // namespace transformer
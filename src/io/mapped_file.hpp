@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace transformer
+{
+
+	// Read-only memory mapping of a whole file. Readers parse straight out of the page cache instead of
+	// copying the file into a std::string first.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		// Returns false if the file cannot be opened or mapped, like checking an std::ifstream.
+		bool open(const std::string& path);
+		void close();
+
+		[[nodiscard]]
+		std::string_view view() const;
+
+		// Drops the pages wholly inside [begin, end) from this process; they are read back from the file if
+		// touched again. Streaming readers call it behind their read position so resident memory does not
+		// grow with the file. No-op on Windows.
+		void release(std::size_t begin, std::size_t end);
+
+	private:
+		const char* data_ = nullptr;
+		std::size_t size_ = 0;
+#if defined(_WIN32)
+		void* file_handle_ = nullptr;
+		void* mapping_handle_ = nullptr;
+#endif
+	};
+
+	// Calls file.open(path); if that fails and the path contains "asserts/", retries with "assets/" (a
+	// common typo in scene configs). Throws std::runtime_error if neither can be opened.
+	template <class File>
+	void open_with_typo_fallback(File& file, const std::string& path)
+	{
+		if (!file.open(path))
+		{
+			std::string fallback = path;
+			constexpr char kCommonTypo[] = "asserts/";
+			const std::size_t typo_pos = fallback.find(kCommonTypo);
+			if (typo_pos == std::string::npos
+				|| !file.open(fallback.replace(typo_pos, std::char_traits<char>::length(kCommonTypo), "assets/")))
+			{
+				throw std::runtime_error("Failed to open file: " + path);
+			}
+		}
+	}
+
+	// Maps path for reading, with open_with_typo_fallback().
+	[[nodiscard]]
+	MappedFile open_input_file(const std::string& path);
+
+}  // namespace transformer
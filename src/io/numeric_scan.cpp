@@ -0,0 +1,142 @@
+#include "io/numeric_scan.hpp"
+
+#include <charconv>
+#include <system_error>
+
+#if !defined(__cpp_lib_to_chars)
+	#include <algorithm>
+	#include <cerrno>
+	#include <cstdlib>
+#endif
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		bool is_digit(char c)
+		{
+			return c >= '0' && c <= '9';
+		}
+
+		// Skips a '+' that from_chars would reject; nullptr for "+-".
+		const char* skip_plus(const char* first, const char* last)
+		{
+			if (first == last || *first != '+')
+			{
+				return first;
+			}
+			++first;
+			return first != last && *first == '-' ? nullptr : first;
+		}
+
+		// skip_plus, then checks that a digit (or '.' and a digit) follows the sign, which rules out inf and
+		// nan. Returns where from_chars should start, or nullptr.
+		const char* number_start(const char* first, const char* last)
+		{
+			first = skip_plus(first, last);
+			if (first == nullptr)
+			{
+				return nullptr;
+			}
+			const char* digits = first != last && *first == '-' ? first + 1 : first;
+			if (digits != last && *digits == '.')
+			{
+				++digits;
+			}
+			return digits != last && is_digit(*digits) ? first : nullptr;
+		}
+
+#if defined(__cpp_lib_to_chars)
+		template <typename Real>
+		const char* scan_real(const char* first, const char* last, Real& value)
+		{
+			first = number_start(first, last);
+			if (first == nullptr)
+			{
+				return nullptr;
+			}
+			Real parsed{};
+			const auto [end, error] = std::from_chars(first, last, parsed, std::chars_format::general);
+			if (error != std::errc())
+			{
+				return nullptr;
+			}
+			value = parsed;
+			return end;
+		}
+#else
+		// Standard libraries without floating-point from_chars: strtof/strtod on a terminated copy of the
+		// candidate characters. The program never calls setlocale, so these run in the "C" locale.
+		template <typename Real>
+		const char* scan_real(const char* first, const char* last, Real& value)
+		{
+			first = number_start(first, last);
+			if (first == nullptr)
+			{
+				return nullptr;
+			}
+			char buffer[128];
+			std::size_t length = 0;
+			while (first + length != last && length + 1 < sizeof(buffer))
+			{
+				const char c = first[length];
+				if (!is_digit(c) && c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E')
+				{
+					break;
+				}
+				buffer[length++] = c;
+			}
+			buffer[length] = '\0';
+
+			char* end = nullptr;
+			errno = 0;
+			Real parsed{};
+			if constexpr (sizeof(Real) == sizeof(float))
+			{
+				parsed = std::strtof(buffer, &end);
+			}
+			else
+			{
+				parsed = std::strtod(buffer, &end);
+			}
+			if (end == buffer || errno == ERANGE)
+			{
+				return nullptr;
+			}
+			value = parsed;
+			return first + (end - buffer);
+		}
+#endif
+
+	}  // namespace
+
+	const char* scan_float(const char* first, const char* last, float& value)
+	{
+		return scan_real(first, last, value);
+	}
+
+	const char* scan_double(const char* first, const char* last, double& value)
+	{
+		return scan_real(first, last, value);
+	}
+
+	const char* scan_integer(const char* first, const char* last, long long& value)
+	{
+		first = skip_plus(first, last);
+		if (first == nullptr)
+		{
+			return nullptr;
+		}
+		long long parsed = 0;
+		const auto [end, error] = std::from_chars(first, last, parsed);
+		if (error != std::errc())
+		{
+			return nullptr;
+		}
+		value = parsed;
+		return end;
+	}
+
+}  // namespace transformer
@@ -0,0 +1,23 @@
+#pragma once
+
+namespace transformer
+{
+
+	// Locale-independent number parsing straight out of file text, shared by the OBJ and JSON readers.
+	// Each function parses the number that starts at first (no whitespace is skipped) and returns one past
+	// its last character, or nullptr if no valid number starts there; value is only written on success.
+	// Accepted: an optional sign ('+' too, as some OBJ writers emit it), digits with an optional fraction
+	// and exponent. Not accepted: hex, inf, nan, and values out of the target type's range.
+
+	// Correctly rounded to float directly, not through double.
+	[[nodiscard]]
+	const char* scan_float(const char* first, const char* last, float& value);
+
+	[[nodiscard]]
+	const char* scan_double(const char* first, const char* last, double& value);
+
+	// Decimal integer only; a fraction or exponent ends the number.
+	[[nodiscard]]
+	const char* scan_integer(const char* first, const char* last, long long& value);
+
+}  // namespace transformer
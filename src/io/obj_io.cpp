@@ -1,11 +1,21 @@
 #include "io/obj_io.hpp"
 
 #include "core/profiler.hpp"
+#include "io/async_files.hpp"
+#include "io/chunked_text.hpp"
+#include "io/mapped_file.hpp"
+#include "io/numeric_scan.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cctype>
 #include <fstream>
-#include <sstream>
+#include <initializer_list>
+#include <ostream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace transformer
 {
@@ -13,91 +23,409 @@ namespace transformer
 	namespace
 	{
 
-		std::int16_t parse_face_index(const std::string& token)
+		bool is_space(char c)
 		{
-			// Supports forms: v, v/t, v//n, v/t/n
-			const std::size_t slash_pos = token.find('/');
-			const std::string vertex_str = (slash_pos == std::string::npos) ? token : token.substr(0, slash_pos);
-			const int index_1_based = std::stoi(vertex_str);
-			return static_cast<std::int16_t>(index_1_based - 1);
+			return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
 		}
 
-	}  // namespace
-
-	Mesh ObjMeshReader::read(const std::string& mesh_file, Profiler& profiler) const
-	{
-		const auto scope = profiler.stage("read_obj_mesh");
+		// Next whitespace-separated token of line from position on (empty past the last one); position moves
+		// past it.
+		std::string_view next_token(std::string_view line, std::size_t& position)
+		{
+			while (position < line.size() && is_space(line[position]))
+			{
+				++position;
+			}
+			const std::size_t begin = position;
+			while (position < line.size() && !is_space(line[position]))
+			{
+				++position;
+			}
+			return line.substr(begin, position - begin);
+		}
 
-		std::ifstream input(mesh_file);
-		if (!input)
+		std::uint32_t parse_face_index(std::string_view token)
 		{
-			throw std::runtime_error("Failed to open OBJ file: " + mesh_file);
+			// Supports forms: v, v/t, v//n, v/t/n
+			long long index_1_based = 0;
+			if (scan_integer(token.data(), token.data() + token.size(), index_1_based) == nullptr)
+			{
+				throw std::runtime_error("OBJ parse error: invalid face index '" + std::string(token) + "'");
+			}
+			return static_cast<std::uint32_t>(index_1_based - 1);
 		}
 
-		Mesh mesh;
-		std::string line;
+		enum class ObjLine
+		{
+			Other,
+			Vertex,
+			Face,
+		};
 
-		while (std::getline(input, line))
+		// One line without its '\n'. A "v" line fills position, an "f" line the three 0-based face indices.
+		ObjLine parse_obj_line(std::string_view line, Vec3& position, std::array<std::uint32_t, 3>& face)
 		{
 			if (line.empty() || line[0] == '#')
 			{
-				continue;
+				return ObjLine::Other;
 			}
 
-			std::istringstream iss(line);
-			std::string prefix;
-			iss >> prefix;
-
+			std::size_t cursor = 0;
+			const std::string_view prefix = next_token(line, cursor);
 			if (prefix == "v")
 			{
-				Vec3 pos{};
-				iss >> pos.x >> pos.y >> pos.z;
-				mesh.entries.push_back({.vertex = pos});
-				++mesh.vertex_count;
+				for (float* coordinate : {&position.x, &position.y, &position.z})
+				{
+					const std::string_view token = next_token(line, cursor);
+					const char* token_end = token.data() + token.size();
+					if (token.empty())
+					{
+						throw std::runtime_error("OBJ parse error: a vertex needs three coordinates");
+					}
+					if (scan_float(token.data(), token_end, *coordinate) != token_end)
+					{
+						throw std::runtime_error(
+								"OBJ parse error: invalid vertex coordinate '" + std::string(token) + "'");
+					}
+				}
+				return ObjLine::Vertex;
 			}
-			else if (prefix == "f")
+			if (prefix == "f")
 			{
-				std::string t0;
-				std::string t1;
-				std::string t2;
-				iss >> t0 >> t1 >> t2;
+				const std::string_view t0 = next_token(line, cursor);
+				const std::string_view t1 = next_token(line, cursor);
+				const std::string_view t2 = next_token(line, cursor);
 				if (t0.empty() || t1.empty() || t2.empty())
 				{
 					throw std::runtime_error("Only triangulated OBJ faces are supported");
 				}
 
-				mesh.indices.push_back(parse_face_index(t0));
-				mesh.indices.push_back(parse_face_index(t1));
-				mesh.indices.push_back(parse_face_index(t2));
+				face = {parse_face_index(t0), parse_face_index(t1), parse_face_index(t2)};
+				return ObjLine::Face;
+			}
+			return ObjLine::Other;
+		}
+
+		// What parse_obj_line would make of line, from its first token only; lets the streaming passes skip
+		// the lines of the other pass without parsing them.
+		ObjLine classify_obj_line(std::string_view line)
+		{
+			const std::size_t begin = line.find_first_not_of(" \t\r\v\f");
+			if (begin == std::string_view::npos
+				|| (begin + 1 < line.size() && std::isspace(static_cast<unsigned char>(line[begin + 1])) == 0))
+			{
+				return ObjLine::Other;
+			}
+			return line[begin] == 'v' ? ObjLine::Vertex : line[begin] == 'f' ? ObjLine::Face : ObjLine::Other;
+		}
+
+		// Calls on_line(line, file offset) for every line of chunk, a view into file_text. Parse errors get
+		// the line number appended.
+		template <typename OnLine>
+		void for_each_obj_line(std::string_view file_text, std::string_view chunk, OnLine&& on_line)
+		{
+			std::size_t line_begin = 0;
+			while (line_begin < chunk.size())
+			{
+				std::size_t line_end = chunk.find('\n', line_begin);
+				if (line_end == std::string_view::npos)
+				{
+					line_end = chunk.size();
+				}
+				const std::string_view line = chunk.substr(line_begin, line_end - line_begin);
+				const std::size_t line_offset = static_cast<std::size_t>(chunk.data() - file_text.data()) + line_begin;
+				line_begin = line_end + 1;
+
+				try
+				{
+					if (!on_line(line, line_offset))
+					{
+						return;
+					}
+				}
+				catch (const std::runtime_error& ex)
+				{
+					throw std::runtime_error(
+							std::string(ex.what()) + " (line " + std::to_string(line_number_at(file_text, line_offset))
+							+ ")");
+				}
+			}
+		}
+
+		struct ObjChunk
+		{
+			std::vector<Vec3> vertices;
+			std::vector<std::uint32_t> indices;
+		};
+
+		// Parses whole lines of one chunk. Face indices are absolute, so chunks do not depend on each other.
+		void parse_obj_chunk(std::string_view file_text, std::string_view chunk, ObjChunk& result)
+		{
+			Vec3 position{};
+			std::array<std::uint32_t, 3> face{};
+			for_each_obj_line(
+					file_text,
+					chunk,
+					[&](std::string_view line, std::size_t /*offset*/)
+					{
+						const ObjLine kind = parse_obj_line(line, position, face);
+						if (kind == ObjLine::Vertex)
+						{
+							result.vertices.push_back(position);
+						}
+						else if (kind == ObjLine::Face)
+						{
+							result.indices.insert(result.indices.end(), face.begin(), face.end());
+						}
+						return true;
+					});
+		}
+
+		// Streams release pages behind them at least this often, so a long run of lines they skip (the faces
+		// after the last vertex, the vertices before the first face) does not stay resident.
+		constexpr std::size_t kReleaseStep = std::size_t{4} << 20;
+
+		// Inverse of a stored->source permutation: for every source index, where it is stored.
+		std::vector<std::uint32_t> invert_order(const std::vector<std::uint32_t>& source_index)
+		{
+			std::vector<std::uint32_t> stored_index(source_index.size());
+			for (std::size_t i = 0; i < source_index.size(); ++i)
+			{
+				stored_index[source_index[i]] = static_cast<std::uint32_t>(i);
 			}
+			return stored_index;
 		}
 
+		// Shared by the std::ofstream and AsyncFileWriter paths, so both produce the same bytes.
+		void write_obj_text(std::ostream& output, const Mesh& mesh)
+		{
+			output << "# Skinned mesh\n";
+
+			// A reordered mesh is written back in source order so results stay comparable to the input file.
+			if (!mesh.vertex_source_index.empty())
+			{
+				const std::vector<std::uint32_t> stored_vertex = invert_order(mesh.vertex_source_index);
+				const std::vector<std::uint32_t> stored_triangle = invert_order(mesh.triangle_source_index);
+
+				for (std::size_t i = 0; i < mesh.vertex_count; ++i)
+				{
+					const Vec3& pos = mesh.entries[stored_vertex[i]].vertex;
+					output << "v " << pos.x << ' ' << pos.y << ' ' << pos.z << '\n';
+				}
+
+				for (const std::uint32_t triangle : stored_triangle)
+				{
+					const std::size_t i = static_cast<std::size_t>(triangle) * 3;
+					output << "f " << mesh.vertex_source_index[mesh.indices[i]] + 1 << ' '
+						   << mesh.vertex_source_index[mesh.indices[i + 1]] + 1 << ' '
+						   << mesh.vertex_source_index[mesh.indices[i + 2]] + 1 << '\n';
+				}
+				return;
+			}
+
+			for (std::size_t i = 0; i < mesh.vertex_count; ++i)
+			{
+				const Vec3& pos = mesh.entries[i].vertex;
+				output << "v " << pos.x << ' ' << pos.y << ' ' << pos.z << '\n';
+			}
+
+			for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+			{
+				output << "f " << mesh.indices[i] + 1 << ' ' << mesh.indices[i + 1] + 1 << ' '
+					   << mesh.indices[i + 2] + 1 << '\n';
+			}
+		}
+
+	}  // namespace
+
+	Mesh ObjMeshReader::read(const std::string& mesh_file, Profiler& profiler) const
+	{
+		const auto scope = profiler.stage("read_obj_mesh");
+
+		InputFile file;
+		if (!file.open(mesh_file))
+		{
+			throw std::runtime_error("Failed to open OBJ file: " + mesh_file);
+		}
+
+		// Split at line boundaries and parse the chunks in parallel, then stitch the per-chunk vertices and
+		// indices together at their prefix-sum offsets.
+		const std::string_view text = file.view();
+		const std::vector<std::string_view> chunks = split_at_lines(text, choose_chunk_count(text.size()));
+		std::vector<ObjChunk> results(chunks.size());
+		run_chunk_tasks(chunks.size(), [&](std::size_t i) { parse_obj_chunk(text, chunks[i], results[i]); });
+
+		std::vector<std::size_t> vertex_offsets(results.size() + 1, 0);
+		std::vector<std::size_t> index_offsets(results.size() + 1, 0);
+		for (std::size_t i = 0; i < results.size(); ++i)
+		{
+			vertex_offsets[i + 1] = vertex_offsets[i] + results[i].vertices.size();
+			index_offsets[i + 1] = index_offsets[i] + results[i].indices.size();
+		}
+
+		Mesh mesh;
+		mesh.vertex_count = vertex_offsets.back();
+		mesh.entries.resize(mesh.vertex_count);
+		mesh.indices.resize(index_offsets.back());
+		run_chunk_tasks(
+				results.size(),
+				[&](std::size_t i)
+				{
+					Mesh::Entry* entries = mesh.entries.data() + vertex_offsets[i];
+					for (std::size_t v = 0; v < results[i].vertices.size(); ++v)
+					{
+						entries[v].vertex = results[i].vertices[v];
+					}
+					std::copy(
+							results[i].indices.begin(),
+							results[i].indices.end(),
+							mesh.indices.begin() + static_cast<std::ptrdiff_t>(index_offsets[i]));
+				});
+
 		return mesh;
 	}
 
-	void ObjMeshWriter::write(const std::string& output_file, const Mesh& mesh, Profiler& profiler) const
+	ObjMeshStream::ObjMeshStream(const std::string& mesh_file)
 	{
-		const auto scope = profiler.stage("write_obj_mesh");
+		if (!file_.open(mesh_file))
+		{
+			throw std::runtime_error("Failed to open OBJ file: " + mesh_file);
+		}
+		text_ = file_.view();
+	}
 
-		std::ofstream output(output_file);
-		if (!output)
+	std::size_t ObjMeshStream::read_vertices(Mesh::Entry* entries, std::size_t max_count)
+	{
+		const std::size_t begin = vertex_position_;
+		std::size_t released = begin;
+		std::size_t count = 0;
+		Vec3 position{};
+		std::array<std::uint32_t, 3> face{};
+		vertex_position_ = text_.size();
+		for_each_obj_line(
+				text_,
+				text_.substr(begin),
+				[&](std::string_view line, std::size_t offset)
+				{
+					if (count == max_count)
+					{
+						vertex_position_ = offset;
+						return false;
+					}
+					if (offset - released >= kReleaseStep)
+					{
+						file_.release(released, offset);
+						released = offset;
+					}
+					if (classify_obj_line(line) == ObjLine::Vertex)
+					{
+						parse_obj_line(line, position, face);
+						entries[count++].vertex = position;
+					}
+					return true;
+				});
+		file_.release(released, vertex_position_);
+		return count;
+	}
+
+	std::size_t ObjMeshStream::read_faces(std::uint32_t* indices, std::size_t max_triangles)
+	{
+		const std::size_t begin = face_position_;
+		std::size_t released = begin;
+		std::size_t count = 0;
+		Vec3 position{};
+		std::array<std::uint32_t, 3> face{};
+		face_position_ = text_.size();
+		for_each_obj_line(
+				text_,
+				text_.substr(begin),
+				[&](std::string_view line, std::size_t offset)
+				{
+					if (count == max_triangles)
+					{
+						face_position_ = offset;
+						return false;
+					}
+					if (offset - released >= kReleaseStep)
+					{
+						file_.release(released, offset);
+						released = offset;
+					}
+					if (classify_obj_line(line) == ObjLine::Face)
+					{
+						parse_obj_line(line, position, face);
+						std::copy(face.begin(), face.end(), indices + count * 3);
+						++count;
+					}
+					return true;
+				});
+		file_.release(released, face_position_);
+		return count;
+	}
+
+	ObjStreamWriter::ObjStreamWriter(const std::string& output_file) :
+			output_file_(output_file),
+			output_(output_file)
+	{
+		if (!output_)
 		{
 			throw std::runtime_error("Failed to open output OBJ file: " + output_file);
 		}
+		output_ << "# Skinned mesh\n";
+	}
 
-		output << "# Skinned mesh\n";
+	void ObjStreamWriter::write_vertices(const Mesh& window)
+	{
+		for (std::size_t i = 0; i < window.vertex_count; ++i)
+		{
+			const Vec3& pos = window.entries[i].vertex;
+			output_ << "v " << pos.x << ' ' << pos.y << ' ' << pos.z << '\n';
+		}
+	}
 
-		for (std::size_t i = 0; i < mesh.vertex_count; ++i)
+	void ObjStreamWriter::write_faces(const std::uint32_t* indices, std::size_t triangle_count)
+	{
+		for (std::size_t i = 0; i < triangle_count * 3; i += 3)
 		{
-			const Vec3& pos = mesh.entries[i].vertex;
-			output << "v " << pos.x << ' ' << pos.y << ' ' << pos.z << '\n';
+			output_ << "f " << indices[i] + 1 << ' ' << indices[i + 1] + 1 << ' ' << indices[i + 2] + 1 << '\n';
 		}
+	}
 
-		for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+	void ObjStreamWriter::close()
+	{
+		output_.close();
+		if (!output_)
 		{
-			output << "f " << mesh.indices[i] + 1 << ' ' << mesh.indices[i + 1] + 1 << ' ' << mesh.indices[i + 2] + 1
-				   << '\n';
+			throw std::runtime_error("Failed to write output OBJ file: " + output_file_);
+		}
+	}
+
+	void ObjMeshWriter::write(const std::string& output_file, const Mesh& mesh, Profiler& profiler) const
+	{
+		const auto scope = profiler.stage("write_obj_mesh");
+
+		if (async_io_backend() != AsyncIoBackend::Off)
+		{
+			AsyncFileWriter file(thread_async_io());
+			if (!file.open(output_file))
+			{
+				throw std::runtime_error("Failed to open output OBJ file: " + output_file);
+			}
+			std::ostream output(&file);
+			write_obj_text(output, mesh);
+			if (!file.close())
+			{
+				throw std::runtime_error("Failed to write output OBJ file: " + output_file);
+			}
+			return;
+		}
+
+		std::ofstream output(output_file);
+		if (!output)
+		{
+			throw std::runtime_error("Failed to open output OBJ file: " + output_file);
 		}
+		write_obj_text(output, mesh);
 	}
 
 }  // namespace transformer
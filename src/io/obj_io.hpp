@@ -1,6 +1,14 @@
 #pragma once
 
+#include "core/math_types.hpp"
 #include "io/io_interfaces.hpp"
+#include "io/mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
 
 namespace transformer
 {
@@ -17,4 +25,44 @@ namespace transformer
 		void write(const std::string& output_file, const Mesh& mesh, Profiler& profiler) const override;
 	};
 
+	// Front-to-back OBJ reader for --stream: hands out the vertex positions a window at a time, then (in a
+	// second pass over the file) the faces. Pages behind the read position are released, so resident
+	// memory stays at about one window whatever the file size.
+	class ObjMeshStream
+	{
+	public:
+		// Throws std::runtime_error if the file cannot be opened.
+		explicit ObjMeshStream(const std::string& mesh_file);
+
+		// Positions of the next up to max_count vertices into entries[i].vertex; returns how many were
+		// read, 0 once all vertices have been.
+		std::size_t read_vertices(Mesh::Entry* entries, std::size_t max_count);
+
+		// Next up to max_triangles faces as 0-based indices, three per triangle; returns the triangle count.
+		std::size_t read_faces(std::uint32_t* indices, std::size_t max_triangles);
+
+	private:
+		MappedFile file_;
+		std::string_view text_;
+		std::size_t vertex_position_ = 0;
+		std::size_t face_position_ = 0;
+	};
+
+	// Writes an OBJ file in the order ObjMeshWriter does (header, vertices, faces), one window at a time.
+	class ObjStreamWriter
+	{
+	public:
+		explicit ObjStreamWriter(const std::string& output_file);
+
+		void write_vertices(const Mesh& window);
+		// Faces as 0-based indices, three per triangle.
+		void write_faces(const std::uint32_t* indices, std::size_t triangle_count);
+		// Flushes and throws if any write failed.
+		void close();
+
+	private:
+		std::string output_file_;
+		std::ofstream output_;
+	};
+
 }  // namespace transformer
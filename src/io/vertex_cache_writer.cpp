@@ -0,0 +1,248 @@
+#include "io/vertex_cache_writer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		constexpr std::size_t kMaxQueuedFrames = 2;
+
+		std::int32_t quantize(float value, float origin, float step)
+		{
+			const double q = std::nearbyint((static_cast<double>(value) - origin) / step);
+			return static_cast<std::int32_t>(std::clamp<double>(
+					q,
+					static_cast<double>(std::numeric_limits<std::int32_t>::min()),
+					static_cast<double>(std::numeric_limits<std::int32_t>::max())));
+		}
+
+		void put_varint(std::vector<std::uint8_t>& out, std::int32_t delta)
+		{
+			// Zigzag keeps small negative deltas small: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+			auto value = (static_cast<std::uint32_t>(delta) << 1U) ^ static_cast<std::uint32_t>(delta >> 31);
+			while (value >= 0x80U)
+			{
+				out.push_back(static_cast<std::uint8_t>(value | 0x80U));
+				value >>= 7U;
+			}
+			out.push_back(static_cast<std::uint8_t>(value));
+		}
+
+	}  // namespace
+
+	VertexCacheWriter::VertexCacheWriter(const std::string& output_file, std::size_t frame_count, unsigned bits) :
+			output_file_(output_file),
+			frame_count_(frame_count),
+			bits_(bits)
+	{
+		if (bits_ < 1 || bits_ > 24)
+		{
+			throw std::runtime_error("Vertex cache quantization bits must be in [1, 24]");
+		}
+		output_.open(output_file_, std::ios::binary);
+		if (!output_)
+		{
+			throw std::runtime_error("Failed to open output vertex cache file: " + output_file_);
+		}
+		encoder_ = std::thread([this] { encode_loop(); });
+	}
+
+	VertexCacheWriter::~VertexCacheWriter()
+	{
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			closing_ = true;
+		}
+		changed_.notify_all();
+		if (encoder_.joinable())
+		{
+			encoder_.join();
+		}
+	}
+
+	void VertexCacheWriter::push(const Mesh& mesh)
+	{
+		std::vector<Vec3> positions;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			changed_.wait(lock, [this] { return queue_.size() < kMaxQueuedFrames || error_; });
+			if (error_)
+			{
+				std::rethrow_exception(error_);
+			}
+			if (!free_buffers_.empty())
+			{
+				positions = std::move(free_buffers_.back());
+				free_buffers_.pop_back();
+			}
+		}
+
+		// A reordered mesh is written in source order, like the other writers.
+		positions.resize(mesh.vertex_count);
+		const bool reordered = !mesh.vertex_source_index.empty();
+		for (std::size_t i = 0; i < mesh.vertex_count; ++i)
+		{
+			positions[reordered ? mesh.vertex_source_index[i] : i] = mesh.entries[i].vertex;
+		}
+
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			queue_.push_back(std::move(positions));
+			++frames_pushed_;
+		}
+		changed_.notify_all();
+	}
+
+	VertexCacheSummary VertexCacheWriter::finish()
+	{
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			closing_ = true;
+		}
+		changed_.notify_all();
+		encoder_.join();
+
+		if (error_)
+		{
+			std::rethrow_exception(error_);
+		}
+		if (frames_pushed_ != frame_count_)
+		{
+			throw std::runtime_error(
+					"Vertex cache expected " + std::to_string(frame_count_) + " frames, got "
+					+ std::to_string(frames_pushed_));
+		}
+
+		output_.close();
+		if (!output_)
+		{
+			throw std::runtime_error("Failed to write vertex cache file: " + output_file_);
+		}
+		return summary_;
+	}
+
+	void VertexCacheWriter::encode_loop()
+	{
+		while (true)
+		{
+			std::vector<Vec3> positions;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				changed_.wait(lock, [this] { return !queue_.empty() || closing_; });
+				if (queue_.empty())
+				{
+					return;
+				}
+				positions = std::move(queue_.front());
+				queue_.pop_front();
+			}
+			changed_.notify_all();
+
+			try
+			{
+				encode_frame(positions);
+			}
+			catch (...)
+			{
+				const std::lock_guard<std::mutex> lock(mutex_);
+				error_ = std::current_exception();
+				queue_.clear();
+				changed_.notify_all();
+				return;
+			}
+
+			const std::lock_guard<std::mutex> lock(mutex_);
+			free_buffers_.push_back(std::move(positions));
+		}
+	}
+
+	void VertexCacheWriter::encode_frame(const std::vector<Vec3>& positions)
+	{
+		const auto encode_start = std::chrono::steady_clock::now();
+
+		const bool first_frame = summary_.frames == 0;
+		if (first_frame)
+		{
+			// The first frame's AABB fixes the quantization grid for the whole cache.
+			Vec3 low{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+					 std::numeric_limits<float>::max()};
+			Vec3 high{std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+					  std::numeric_limits<float>::lowest()};
+			for (const Vec3& p : positions)
+			{
+				low = {std::min(low.x, p.x), std::min(low.y, p.y), std::min(low.z, p.z)};
+				high = {std::max(high.x, p.x), std::max(high.y, p.y), std::max(high.z, p.z)};
+			}
+			if (positions.empty())
+			{
+				low = high = Vec3{};
+			}
+
+			const float levels = static_cast<float>((1U << bits_) - 1U);
+			const float lows[3] = {low.x, low.y, low.z};
+			const float extents[3] = {high.x - low.x, high.y - low.y, high.z - low.z};
+			for (std::size_t axis = 0; axis < 3; ++axis)
+			{
+				header_.origin[axis] = lows[axis];
+				// A flat axis still needs a non-zero step for later frames that move along it.
+				header_.step[axis] = extents[axis] > 0.0F ? extents[axis] / levels : 1.0F / levels;
+			}
+			header_.bits = static_cast<std::uint16_t>(bits_);
+			header_.vertex_count = static_cast<std::uint32_t>(positions.size());
+			header_.frame_count = static_cast<std::uint32_t>(frame_count_);
+			previous_.assign(positions.size() * 3, 0);
+		}
+		else if (positions.size() != header_.vertex_count)
+		{
+			throw std::runtime_error("Vertex cache frames must all have the same vertex count");
+		}
+
+		encoded_.clear();
+		std::int32_t last[3] = {0, 0, 0};
+		for (std::size_t i = 0; i < positions.size(); ++i)
+		{
+			const float values[3] = {positions[i].x, positions[i].y, positions[i].z};
+			for (std::size_t axis = 0; axis < 3; ++axis)
+			{
+				const std::int32_t q = quantize(values[axis], header_.origin[axis], header_.step[axis]);
+				std::int32_t& previous = previous_[i * 3 + axis];
+				// Wrapping subtraction: the decoder adds back modulo 2^32 as well.
+				const auto delta = static_cast<std::int32_t>(
+						static_cast<std::uint32_t>(q)
+						- static_cast<std::uint32_t>(first_frame ? last[axis] : previous));
+				put_varint(encoded_, delta);
+				last[axis] = q;
+				previous = q;
+			}
+		}
+
+		const auto encode_end = std::chrono::steady_clock::now();
+		summary_.encode_microseconds += std::chrono::duration<double, std::micro>(encode_end - encode_start).count();
+
+		if (first_frame)
+		{
+			output_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+			summary_.encoded_bytes += sizeof(header_);
+		}
+		const auto byte_count = static_cast<std::uint32_t>(encoded_.size());
+		output_.write(reinterpret_cast<const char*>(&byte_count), sizeof(byte_count));
+		output_.write(reinterpret_cast<const char*>(encoded_.data()), static_cast<std::streamsize>(encoded_.size()));
+		if (!output_)
+		{
+			throw std::runtime_error("Failed to write vertex cache file: " + output_file_);
+		}
+
+		summary_.encoded_bytes += sizeof(byte_count) + encoded_.size();
+		summary_.raw_bytes += positions.size() * sizeof(Vec3);
+		++summary_.frames;
+	}
+
+}  // namespace transformer
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "core/math_types.hpp"
+#include "core/profiler.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace transformer
+{
+
+	// Multi-frame vertex cache: every frame of a run in one file, positions quantized and delta encoded.
+	// Fields are in host byte order (little-endian on every target the SSE kernels build for).
+	//
+	//   VertexCacheHeader
+	//   frame_count x { u32 byte_count, byte_count bytes }
+	//
+	// Positions are quantized to q = round((p - origin) / step) per axis, where origin and step come from
+	// the AABB of the first frame (step = extent / (2^bits - 1)); later frames may leave the box, q is
+	// just an int32. Each frame stores, per vertex in source order, x, y and z deltas as zigzag LEB128
+	// varints: against the previous vertex in frame 0, against the same vertex of the previous frame
+	// after that. Decoding is p = origin + q * step.
+	constexpr std::uint32_t kVertexCacheMagic = 0x43564654;  // "TFVC"
+	constexpr std::uint16_t kVertexCacheVersion = 1;
+
+	struct VertexCacheHeader
+	{
+		std::uint32_t magic = kVertexCacheMagic;
+		std::uint16_t version = kVertexCacheVersion;
+		std::uint16_t bits = 0;
+		std::uint32_t vertex_count = 0;
+		std::uint32_t frame_count = 0;
+		float origin[3]{};
+		float step[3]{};
+	};
+
+	static_assert(sizeof(VertexCacheHeader) == 40, "VertexCacheHeader is part of the file format");
+
+	// Encodes on its own thread, so frame N is quantized, entropy coded and written while the caller
+	// skins frame N + 1. At most two frames wait in the queue; push blocks beyond that.
+	class VertexCacheWriter
+	{
+	public:
+		VertexCacheWriter(const std::string& output_file, std::size_t frame_count, unsigned bits);
+		~VertexCacheWriter();
+
+		VertexCacheWriter(const VertexCacheWriter&) = delete;
+		VertexCacheWriter& operator=(const VertexCacheWriter&) = delete;
+
+		// Copies the mesh positions (source order) into the queue and returns; the mesh can be reused
+		// for the next frame right away.
+		void push(const Mesh& mesh);
+
+		// Waits until every pushed frame is written and closes the file. Rethrows an encoder error, and
+		// throws if fewer or more frames than frame_count were pushed.
+		VertexCacheSummary finish();
+
+	private:
+		void encode_loop();
+		void encode_frame(const std::vector<Vec3>& positions);
+
+		std::string output_file_;
+		std::size_t frame_count_ = 0;
+		unsigned bits_ = 0;
+
+		std::mutex mutex_;
+		std::condition_variable changed_;
+		std::deque<std::vector<Vec3>> queue_;
+		std::vector<std::vector<Vec3>> free_buffers_;
+		std::size_t frames_pushed_ = 0;
+		bool closing_ = false;
+		std::exception_ptr error_;
+
+		// Encoder thread only.
+		std::ofstream output_;
+		VertexCacheHeader header_;
+		std::vector<std::int32_t> previous_;
+		std::vector<std::uint8_t> encoded_;
+		VertexCacheSummary summary_;
+
+		std::thread encoder_;
+	};
+
+}  // namespace transformer
@@ -1,36 +1,150 @@
 #include "app/app.hpp"
+#include "app/batch_runner.hpp"
+#include "app/stream_runner.hpp"
 #include "core/app_input.hpp"
+#include "core/memory_tracking.hpp"
+#include "core/vertex_buffer.hpp"
+#include "io/async_io.hpp"
+#include "io/binary_mesh_writer.hpp"
+#include "io/chunked_text.hpp"
+#include "io/gltf_io.hpp"
 #include "io/json_readers.hpp"
 #include "io/obj_io.hpp"
+#include "service/service_client.hpp"
+#include "service/skinning_server.hpp"
+#include "skinning/kernels/kernel_registry.hpp"
 #include "skinning/mesh_skinner.hpp"
+#include "skinning/skinning_cache.hpp"
 
+#include <cctype>
+#include <cstdint>
 #include <cstdlib>
+#include <exception>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
 
 using transformer::AppInput;
+using transformer::BatchOptions;
+using transformer::BatchRunner;
+using transformer::BinaryMeshLayout;
+using transformer::BinaryMeshWriter;
+using transformer::GlbBonePoseReader;
+using transformer::GlbBoneWeightsReader;
+using transformer::GlbMeshReader;
+using transformer::JsonAnimationClipReader;
 using transformer::JsonBonePoseReader;
 using transformer::JsonBoneWeightsReader;
+using transformer::JsonJobManifestReader;
+using transformer::JsonMorphTargetReader;
 using transformer::JsonStatsWriter;
 using transformer::MeshSkinner;
 using transformer::ObjMeshReader;
 using transformer::ObjMeshWriter;
 using transformer::SkinningApp;
+using transformer::SkinningCache;
+using transformer::StreamRunner;
+using transformer::SkinningKernel;
+using transformer::SkinningServer;
 
 static void print_help(const char* prog)
 {
 	std::cerr << "Usage: " << (prog ? prog : "transformer")
-			  << " --mesh <meshFile.obj> --bones-weights <boneWeightFile.json>"
+			  << " --mesh <meshFile.obj|asset.glb> --bones-weights <boneWeightFile.json>"
 				 " --inverse-bind-pose <inverseBindPoseFile.json>"
 				 " --new-pose <newPoseFile.json> --output <resultFile.obj>"
-				 " --stats <statsFile.json> [--bench <N>]\n";
+				 " --stats <statsFile.json> [--bench <N>] [--optimize-layout] [--incremental] [--bounds mesh|bones]"
+				 " [--weights-policy error|renormalize]"
+				 " [--kernel auto|fastest|avx512|avx2|sse41|scalar|avx512_fma|avx2_fma]"
+				 " [--deterministic]"
+				 " [--morph-targets <morphTargets.json> --morph-weights <morphWeights.json>]"
+				 " [--clip <clip.json>[@weight] ... [--times <t0,t1,...>]]"
+				 " [--output-format obj|binary|vertex-cache [--cache-bits <N>] [--layout interleaved|planar]"
+				 " [--stride <bytes>] [--align <bytes>]"
+				 " [--normals]] [--client <socket> [--shutdown-server]] [--stream [--memory-budget <bytes>]]"
+				 " [--track-allocations] [--huge-pages] [--skin-threads <N>|auto]"
+				 " [--skin-cache <bytes> [--cache-outputs]] [--async-io off|auto|uring|threads] [--parse-chunks <N>]\n";
+	std::cerr << "       " << (prog ? prog : "transformer") << " --serve <socket> [--stats <statsFile.json>]\n";
+	std::cerr << "       " << (prog ? prog : "transformer")
+			  << " --jobs <manifest.json> --stats <statsFile.json> [--threads <N>] [--output <dir>]"
+				 " [--optimize-layout] [--weights-policy ...] [--kernel ...] [--output-format obj|binary ...]\n";
 	std::cerr << "Input format:\n"
 				 "  - weights json: { \"vertices\": [ { \"bone_indices\": [0,1,...], \"weights\": [..] }, ... ] }\n"
 				 "  - pose json: { \"bones\": [ { \"matrix\": [16 column-major float values] }, ... ] }\n"
+				 "  - glb: binary glTF 2.0 with POSITION, JOINTS_0, WEIGHTS_0 and a skin; --bones-weights and\n"
+				 "    --inverse-bind-pose default to the --mesh file when it is a .glb\n"
+				 "  - morph targets json: { \"targets\": [ { \"indices\": [..], \"deltas\": [dx,dy,dz,..] }, ... ] }\n"
+				 "  - morph weights json: { \"weights\": [one value per target] }\n"
+				 "  - clip json: { \"name\": \"walk\", \"tracks\": [ { \"bone\": 0, \"times\": [..],"
+				 " \"translations\": [x,y,z,..],\n"
+				 "                 \"rotations\": [x,y,z,w,..], \"scales\": [x,y,z,..] (optional) }, ... ] }\n"
 				 "\n"
 				 "Options:\n"
 				 "  --bench <N>  Run cpu_skinning N times in a loop and write summary stats.\n"
-				 "               If omitted, skinning runs once.\n";
+				 "               If omitted, skinning runs once.\n"
+				 "  --optimize-layout  Reorder vertices by dominant bone and triangles for vertex cache reuse\n"
+				 "                     before skinning. Output is still written in the source order.\n"
+				 "  --incremental      Skin with the stateful incremental skinner: only bones whose pose changed\n"
+				 "                     since the previous run are rebuilt, and only their vertices re-skinned.\n"
+				 "  --bounds <mode>    Collect the skinned AABB of every frame during skinning and write it to the\n"
+				 "                     stats file: mesh, or bones for the mesh box plus one per dominant bone.\n"
+				 "  --weights-policy   error (default): refuse vertices whose weights are negative, do not sum to 1\n"
+				 "                     or use a bone index past the pose; renormalize: drop those influences and\n"
+				 "                     rescale the rest.\n"
+				 "  --kernel <name>    Skinning kernel: auto (default) picks the widest exact one this CPU supports;\n"
+				 "                     avx512, avx2, sse41 or scalar force one. All produce identical output.\n"
+				 "                     avx512_fma and avx2_fma fuse multiply-adds: faster, but the last bits of\n"
+				 "                     positions differ from the others. fastest picks the widest of all.\n"
+				 "  --deterministic    Refuse the fused kernels and write to the stats file how much slower the\n"
+				 "                     kernel in use is than the fastest fused one, measured on a mesh sample.\n"
+				 "  --morph-targets    Blend sparse morph targets into the mesh before skinning, in the same pass.\n"
+				 "  --morph-weights    Per-target weights for this frame; zero-weight targets are skipped.\n"
+				 "  --clip <file>[@w]  Sample a keyframed clip instead of using --new-pose for the bones it animates.\n"
+				 "                     Repeat to blend several clips; @w is the blend weight (default 1).\n"
+				 "  --times <t,...>    Comma-separated sample times in seconds (default 0). With more than one,\n"
+				 "                     every time is skinned and written to <output>_<index>.<ext>.\n"
+				 "  --output-format    obj (default) or binary: a GPU-ready vertex buffer file with a layout header\n"
+				 "                     (see src/io/binary_mesh_writer.hpp).\n"
+				 "                     vertex-cache: all frames in one file, quantized and delta encoded (see\n"
+				 "                     src/io/vertex_cache_writer.hpp).\n"
+				 "  --cache-bits <N>   Vertex cache: quantization bits per axis over the first frame's AABB\n"
+				 "                     (1-24, default 16).\n"
+				 "  --layout           Binary output: interleaved (default) or planar position/normal streams.\n"
+				 "  --stride <bytes>   Binary output: bytes between vertices (multiple of 4; default tightly packed).\n"
+				 "  --align <bytes>    Binary output: alignment of each stream (power of two, default 16).\n"
+				 "  --normals          Binary output: also write area-weighted normals of the skinned mesh.\n"
+				 "  --serve <socket>   Run as a persistent skinning service on a Unix domain socket. Meshes stay\n"
+				 "                     loaded between requests; stops on a shutdown request.\n"
+				 "  --client <socket>  Load and skin the mesh through a running service instead of in-process.\n"
+				 "  --shutdown-server  With --client: stop the service after the output is written.\n"
+				 "  --jobs <manifest>  Run every job of a JSON manifest on a work-stealing thread pool; inputs shared\n"
+				 "                     by several jobs are parsed once. --output is then the directory relative job\n"
+				 "                     outputs go to (default: the manifest's directory).\n"
+				 "  --threads <N>      With --jobs: worker threads (default: one per hardware thread).\n"
+				 "  --stream           Read, skin and write an OBJ mesh and JSON weights in windows of vertices,\n"
+				 "                     overlapping reads and writes with skinning, for meshes larger than memory.\n"
+				 "  --memory-budget    With --stream: bytes of window buffers, with optional K, M or G suffix\n"
+				 "                     (default 256M).\n"
+				 "  --track-allocations\n"
+				 "                     Count heap allocations, bytes and peak live bytes per stage and write them to\n"
+				 "                     the stats file next to the timings (costs atomic updates per new/delete).\n"
+				 "  --huge-pages       Back vertex buffers of 2 MB and more with huge pages: reserved ones\n"
+				 "                     (MAP_HUGETLB) if the pool has room, else transparent ones, else normal pages.\n"
+				 "  --skin-threads <N> Split each skinning pass over N threads (auto: one per hardware thread).\n"
+				 "                     Each thread first touches the part of every vertex buffer it will skin.\n"
+				 "  --skin-cache <bytes>\n"
+				 "                     Cache skinning palettes by pose, least recently used first out past this\n"
+				 "                     many bytes (K, M or G suffix). Hits and misses go to the stats counters.\n"
+				 "  --cache-outputs    With --skin-cache: also cache skinned vertex buffers by mesh content and\n"
+				 "                     pose, so a repeated pose of a mesh is copied instead of skinned.\n"
+				 "  --async-io <backend>\n"
+				 "                     Read inputs and write OBJ and binary outputs with many transfers in flight\n"
+				 "                     from one thread: uring (io_uring), threads (a pool of I/O threads) or auto\n"
+				 "                     (uring where the kernel allows it). Default off: inputs are memory-mapped.\n"
+				 "  --parse-chunks <N> Split OBJ and weights JSON inputs into N chunks parsed in parallel, whatever\n"
+				 "                     their size (default: one per 4 MB, at most one per hardware thread).\n";
 }
 
 static bool parse_positive_int(const std::string& value, std::size_t& out)
@@ -51,6 +165,79 @@ static bool parse_positive_int(const std::string& value, std::size_t& out)
 	return true;
 }
 
+static bool parse_float(const std::string& value, float& out)
+{
+	if (value.empty())
+	{
+		return false;
+	}
+
+	char* end = nullptr;
+	const float parsed = std::strtof(value.c_str(), &end);
+	if (end == nullptr || *end != '\0')
+	{
+		return false;
+	}
+
+	out = parsed;
+	return true;
+}
+
+// Positive byte count with an optional binary K/M/G suffix, e.g. 64M.
+static bool parse_byte_size(const std::string& value, std::size_t& out)
+{
+	std::string digits = value;
+	std::size_t scale = 1;
+	if (!digits.empty())
+	{
+		const char suffix = digits.back();
+		const std::string suffixes = "KMG";
+		const std::size_t power = suffixes.find(static_cast<char>(std::toupper(static_cast<unsigned char>(suffix))));
+		if (power != std::string::npos)
+		{
+			scale = std::size_t{1} << (10 * (power + 1));
+			digits.pop_back();
+		}
+	}
+	std::size_t count = 0;
+	if (!parse_positive_int(digits, count) || count > SIZE_MAX / scale)
+	{
+		return false;
+	}
+	out = count * scale;
+	return true;
+}
+
+// "<file>" or "<file>@<weight>"; the weight must be positive.
+static bool parse_clip(const std::string& value, transformer::ClipInput& out)
+{
+	const std::size_t at = value.rfind('@');
+	out.file = value.substr(0, at);
+	out.weight = 1.0F;
+	if (at != std::string::npos && (!parse_float(value.substr(at + 1), out.weight) || !(out.weight > 0.0F)))
+	{
+		return false;
+	}
+	return !out.file.empty();
+}
+
+static bool parse_times(const std::string& value, std::vector<float>& out)
+{
+	out.clear();
+	std::istringstream stream(value);
+	std::string item;
+	while (std::getline(stream, item, ','))
+	{
+		float time = 0.0F;
+		if (!parse_float(item, time))
+		{
+			return false;
+		}
+		out.push_back(time);
+	}
+	return !out.empty();
+}
+
 int main(int argc, char** argv)
 {
 	if (argc == 2 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h"))
@@ -60,6 +247,22 @@ int main(int argc, char** argv)
 	}
 
 	AppInput input;
+	std::string serve_socket;
+	std::string jobs_manifest;
+	std::size_t threads = 0;
+	transformer::VertexBufferOptions vertex_buffers;
+	bool skin_threads_set = false;
+	std::size_t parse_chunks = 0;
+	bool stream = false;
+	std::size_t memory_budget = 0;
+	std::size_t skin_cache_budget = 0;
+	bool cache_outputs = false;
+	transformer::AsyncIoBackend async_io = transformer::AsyncIoBackend::Off;
+	std::string kernel_name;
+	bool binary_output = false;
+	bool vertex_cache_output = false;
+	bool binary_layout_set = false;
+	BinaryMeshLayout binary_layout;
 	bool mesh_set = false;
 	bool weights_set = false;
 	bool inverse_bind_set = false;
@@ -157,6 +360,326 @@ int main(int argc, char** argv)
 			}
 			input.bench_runs = bench_runs;
 		}
+		else if (arg == "--optimize-layout")
+		{
+			input.optimize_layout = true;
+		}
+		else if (arg == "--incremental")
+		{
+			input.incremental = true;
+		}
+		else if (arg == "--bounds")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			const std::string mode = value;
+			if (mode != "mesh" && mode != "bones")
+			{
+				std::cerr << "Invalid value for --bounds (expected mesh or bones): " << mode << std::endl;
+				return 1;
+			}
+			input.bounds = mode == "mesh" ? transformer::BoundsMode::Mesh : transformer::BoundsMode::MeshAndBones;
+		}
+		else if (arg == "--weights-policy")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			const std::string policy = value;
+			if (policy != "error" && policy != "renormalize")
+			{
+				std::cerr << "Invalid value for --weights-policy (expected error or renormalize): " << policy
+						  << std::endl;
+				return 1;
+			}
+			input.weights_policy
+					= policy == "error" ? transformer::WeightsPolicy::Error : transformer::WeightsPolicy::Renormalize;
+		}
+		else if (arg == "--kernel")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			kernel_name = value;
+		}
+		else if (arg == "--deterministic")
+		{
+			input.deterministic = true;
+		}
+		else if (arg == "--morph-targets")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			input.morph_targets_file = value;
+		}
+		else if (arg == "--morph-weights")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			input.morph_weights_file = value;
+		}
+		else if (arg == "--clip")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			transformer::ClipInput clip;
+			if (!parse_clip(value, clip))
+			{
+				std::cerr << "Invalid value for --clip (expected <file.json>[@weight > 0]): " << value << std::endl;
+				return 1;
+			}
+			input.clips.push_back(clip);
+		}
+		else if (arg == "--times")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			if (!parse_times(value, input.sample_times))
+			{
+				std::cerr << "Invalid value for --times (expected comma-separated numbers): " << value << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--output-format")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			const std::string format = value;
+			if (format != "obj" && format != "binary" && format != "vertex-cache")
+			{
+				std::cerr << "Invalid value for --output-format (expected obj, binary or vertex-cache): " << format
+						  << std::endl;
+				return 1;
+			}
+			binary_output = format == "binary";
+			vertex_cache_output = format == "vertex-cache";
+		}
+		else if (arg == "--cache-bits")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			std::size_t bits = 0;
+			if (!parse_positive_int(value, bits) || bits > 24)
+			{
+				std::cerr << "Invalid value for --cache-bits (expected integer in [1, 24]): " << value << std::endl;
+				return 1;
+			}
+			input.vertex_cache_bits = static_cast<unsigned>(bits);
+		}
+		else if (arg == "--layout")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			const std::string layout = value;
+			if (layout != "interleaved" && layout != "planar")
+			{
+				std::cerr << "Invalid value for --layout (expected interleaved or planar): " << layout << std::endl;
+				return 1;
+			}
+			binary_layout.planar = layout == "planar";
+			binary_layout_set = true;
+		}
+		else if (arg == "--stride" || arg == "--align")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			std::size_t bytes = 0;
+			if (!parse_positive_int(value, bytes))
+			{
+				std::cerr << "Invalid value for " << arg << " (expected positive integer): " << value << std::endl;
+				return 1;
+			}
+			(arg == "--stride" ? binary_layout.stride : binary_layout.alignment) = bytes;
+			binary_layout_set = true;
+		}
+		else if (arg == "--normals")
+		{
+			binary_layout.normals = true;
+			binary_layout_set = true;
+		}
+		else if (arg == "--serve")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			serve_socket = value;
+		}
+		else if (arg == "--client")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			input.client_socket = value;
+		}
+		else if (arg == "--shutdown-server")
+		{
+			input.shutdown_server = true;
+		}
+		else if (arg == "--stream")
+		{
+			stream = true;
+		}
+		else if (arg == "--memory-budget")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			if (!parse_byte_size(value, memory_budget))
+			{
+				std::cerr << "Invalid value for --memory-budget (expected bytes, e.g. 65536 or 64M): " << value
+						  << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--track-allocations")
+		{
+			// Before the inputs are read, so every stage is counted.
+			transformer::enable_allocation_tracking();
+		}
+		else if (arg == "--jobs")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			jobs_manifest = value;
+		}
+		else if (arg == "--threads")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			if (!parse_positive_int(value, threads))
+			{
+				std::cerr << "Invalid value for --threads (expected positive integer): " << value << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--skin-threads")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			if (std::string(value) == "auto")
+			{
+				vertex_buffers.threads = 0;
+			}
+			else if (!parse_positive_int(value, vertex_buffers.threads))
+			{
+				std::cerr << "Invalid value for --skin-threads (expected positive integer or auto): " << value
+						  << std::endl;
+				return 1;
+			}
+			skin_threads_set = true;
+		}
+		else if (arg == "--parse-chunks")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			if (!parse_positive_int(value, parse_chunks))
+			{
+				std::cerr << "Invalid value for --parse-chunks (expected positive integer): " << value << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--huge-pages")
+		{
+			vertex_buffers.huge_pages = true;
+		}
+		else if (arg == "--skin-cache")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			if (!parse_byte_size(value, skin_cache_budget))
+			{
+				std::cerr << "Invalid value for --skin-cache (expected bytes, e.g. 65536 or 64M): " << value
+						  << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--cache-outputs")
+		{
+			cache_outputs = true;
+		}
+		else if (arg == "--async-io")
+		{
+			const char* value = require_value(arg);
+			if (value == nullptr)
+			{
+				return 1;
+			}
+			const std::string backend = value;
+			if (backend == "off")
+			{
+				async_io = transformer::AsyncIoBackend::Off;
+			}
+			else if (backend == "auto")
+			{
+				async_io = transformer::AsyncIoBackend::Auto;
+			}
+			else if (backend == "uring")
+			{
+				async_io = transformer::AsyncIoBackend::Uring;
+			}
+			else if (backend == "threads")
+			{
+				async_io = transformer::AsyncIoBackend::Threads;
+			}
+			else
+			{
+				std::cerr << "Invalid value for --async-io (expected off, auto, uring or threads): " << backend
+						  << std::endl;
+				return 1;
+			}
+		}
 		else
 		{
 			std::cerr << "Unknown argument: " << arg << std::endl;
@@ -165,6 +688,190 @@ int main(int argc, char** argv)
 		}
 	}
 
+	// .glb files go to the glTF readers, everything else to the OBJ/JSON ones.
+	const ObjMeshReader obj_mesh_reader;
+	const JsonBoneWeightsReader json_bone_weights_reader;
+	const JsonBonePoseReader json_pose_reader;
+	const GlbMeshReader mesh_reader(obj_mesh_reader);
+	const GlbBoneWeightsReader bone_weights_reader(json_bone_weights_reader);
+	const GlbBonePoseReader pose_reader(json_pose_reader);
+	const JsonMorphTargetReader morph_target_reader;
+	const JsonAnimationClipReader clip_reader;
+	if (binary_layout_set && !binary_output)
+	{
+		std::cerr << "--layout, --stride, --align and --normals require --output-format binary." << std::endl;
+		return 1;
+	}
+
+	if (input.vertex_cache_bits != 0 && !vertex_cache_output)
+	{
+		std::cerr << "--cache-bits requires --output-format vertex-cache." << std::endl;
+		return 1;
+	}
+	if (vertex_cache_output)
+	{
+		if (!input.client_socket.empty())
+		{
+			std::cerr << "--output-format vertex-cache is not supported with --client." << std::endl;
+			return 1;
+		}
+		if (input.vertex_cache_bits == 0)
+		{
+			input.vertex_cache_bits = 16;
+		}
+	}
+
+	const ObjMeshWriter obj_mesh_writer;
+	std::unique_ptr<BinaryMeshWriter> binary_mesh_writer;
+	if (binary_output)
+	{
+		try
+		{
+			binary_mesh_writer = std::make_unique<BinaryMeshWriter>(binary_layout);
+		}
+		catch (const std::exception& ex)
+		{
+			std::cerr << ex.what() << std::endl;
+			return 1;
+		}
+	}
+	const transformer::IMeshWriter& mesh_writer
+			= binary_mesh_writer ? static_cast<const transformer::IMeshWriter&>(*binary_mesh_writer) : obj_mesh_writer;
+	const JsonStatsWriter stats_writer;
+	const SkinningKernel* kernel = nullptr;
+	try
+	{
+		kernel = &transformer::find_skinning_kernel(kernel_name);
+	}
+	catch (const std::exception& ex)
+	{
+		std::cerr << ex.what() << std::endl;
+		return 1;
+	}
+	if (input.deterministic && !kernel->deterministic)
+	{
+		std::cerr << "--deterministic cannot use the fused kernel '" << kernel->name
+				  << "' (its output differs from the other kernels)." << std::endl;
+		return 1;
+	}
+	if (cache_outputs && skin_cache_budget == 0)
+	{
+		std::cerr << "--cache-outputs requires --skin-cache." << std::endl;
+		return 1;
+	}
+	if (skin_cache_budget != 0 && (!serve_socket.empty() || !input.client_socket.empty() || input.incremental))
+	{
+		std::cerr << "--skin-cache is not supported with --serve, --client or --incremental." << std::endl;
+		return 1;
+	}
+	if (cache_outputs && input.bench_runs > 1)
+	{
+		// Every run after the first would time a copy out of the cache.
+		std::cerr << "--cache-outputs is not supported with --bench." << std::endl;
+		return 1;
+	}
+	std::unique_ptr<SkinningCache> skinning_cache;
+	if (skin_cache_budget != 0)
+	{
+		skinning_cache = std::make_unique<SkinningCache>(skin_cache_budget, cache_outputs);
+	}
+	const MeshSkinner skinner(*kernel, skinning_cache.get());
+
+	if (skin_threads_set && !jobs_manifest.empty())
+	{
+		std::cerr << "--skin-threads is not supported with --jobs (frames already run on --threads workers)."
+				  << std::endl;
+		return 1;
+	}
+	// Before any mesh is loaded, so every vertex buffer is placed by these options.
+	transformer::configure_vertex_buffers(vertex_buffers);
+	transformer::configure_parse_chunks(parse_chunks);
+	try
+	{
+		transformer::configure_async_io(async_io);
+	}
+	catch (const std::exception& ex)
+	{
+		std::cerr << "Error: " << ex.what() << std::endl;
+		return 1;
+	}
+
+	if (!serve_socket.empty())
+	{
+		if (mesh_set || weights_set || inverse_bind_set || new_pose_set || output_set || !input.client_socket.empty()
+			|| !jobs_manifest.empty())
+		{
+			std::cerr << "--serve only accepts --stats; mesh and pose files are sent by clients." << std::endl;
+			return 1;
+		}
+		SkinningServer server(mesh_reader, bone_weights_reader, pose_reader, skinner);
+		return server.run(serve_socket, stats_writer, input.stats_file);
+	}
+
+	if (threads != 0 && jobs_manifest.empty())
+	{
+		std::cerr << "--threads requires --jobs." << std::endl;
+		return 1;
+	}
+
+	if (!jobs_manifest.empty())
+	{
+		// Per-job inputs come from the manifest; only options that apply to every job are accepted.
+		if (mesh_set || weights_set || inverse_bind_set || new_pose_set || !input.morph_targets_file.empty()
+			|| !input.morph_weights_file.empty() || !input.clips.empty() || !input.sample_times.empty()
+			|| input.bench_runs > 1 || input.incremental || input.bounds != transformer::BoundsMode::None
+			|| vertex_cache_output || !input.client_socket.empty() || stream)
+		{
+			std::cerr << "--jobs takes inputs, clips and times from the manifest and does not support --bench,"
+						 " --incremental, --bounds, morph targets, vertex-cache output or --client."
+					  << std::endl;
+			return 1;
+		}
+		if (!stats_set)
+		{
+			std::cerr << "Missing required arguments." << std::endl;
+			print_help(argc > 0 ? argv[0] : nullptr);
+			return 1;
+		}
+		const JsonJobManifestReader manifest_reader;
+		const BatchRunner runner(
+				manifest_reader,
+				mesh_reader,
+				bone_weights_reader,
+				pose_reader,
+				clip_reader,
+				mesh_writer,
+				stats_writer,
+				skinner);
+		const BatchOptions options{
+				.threads = threads,
+				.output_directory = input.output_mesh_file,
+				.stats_file = input.stats_file,
+		};
+		return runner.run(jobs_manifest, input, options);
+	}
+
+	if (input.shutdown_server && input.client_socket.empty())
+	{
+		std::cerr << "--shutdown-server requires --client." << std::endl;
+		return 1;
+	}
+
+	// A skinned .glb carries its own weights and inverse bind matrices.
+	if (mesh_set && transformer::is_glb_file(input.mesh_file))
+	{
+		if (!weights_set)
+		{
+			input.weights_file = input.mesh_file;
+			weights_set = true;
+		}
+		if (!inverse_bind_set)
+		{
+			input.inverse_bind_pose_file = input.mesh_file;
+			inverse_bind_set = true;
+		}
+	}
+
 	if (!(mesh_set && weights_set && inverse_bind_set && new_pose_set && output_set && stats_set))
 	{
 		std::cerr << "Missing required arguments." << std::endl;
@@ -172,13 +879,78 @@ int main(int argc, char** argv)
 		return 1;
 	}
 
-	const ObjMeshReader mesh_reader;
-	const JsonBoneWeightsReader bone_weights_reader;
-	const JsonBonePoseReader pose_reader;
-	const ObjMeshWriter mesh_writer;
-	const JsonStatsWriter stats_writer;
-	const MeshSkinner skinner;
+	if (input.morph_targets_file.empty() != input.morph_weights_file.empty())
+	{
+		std::cerr << "--morph-targets and --morph-weights must be given together." << std::endl;
+		return 1;
+	}
+
+	if (!input.morph_targets_file.empty() && (input.incremental || !input.client_socket.empty()))
+	{
+		std::cerr << "Morph targets are not supported with --incremental or --client." << std::endl;
+		return 1;
+	}
+
+	if (input.bounds != transformer::BoundsMode::None && (input.incremental || !input.client_socket.empty()))
+	{
+		std::cerr << "--bounds is not supported with --incremental or --client." << std::endl;
+		return 1;
+	}
+
+	// The incremental skinner has its own single-threaded vertex loop, not a registry kernel.
+	if (input.incremental && (!kernel_name.empty() || input.deterministic || skin_threads_set))
+	{
+		std::cerr << "--kernel, --deterministic and --skin-threads are not supported with --incremental." << std::endl;
+		return 1;
+	}
+
+	if (!input.sample_times.empty() && input.clips.empty())
+	{
+		std::cerr << "--times requires --clip." << std::endl;
+		return 1;
+	}
+
+	if (!input.clips.empty() && !input.client_socket.empty())
+	{
+		std::cerr << "Animation clips are not supported with --client." << std::endl;
+		return 1;
+	}
+
+	if (memory_budget != 0 && !stream)
+	{
+		std::cerr << "--memory-budget requires --stream." << std::endl;
+		return 1;
+	}
+
+	if (stream)
+	{
+		if (transformer::is_glb_file(input.mesh_file) || binary_output || vertex_cache_output
+			|| !input.morph_targets_file.empty() || !input.clips.empty() || input.bench_runs > 1 || input.incremental
+			|| input.optimize_layout || input.bounds != transformer::BoundsMode::None || !input.client_socket.empty())
+		{
+			std::cerr << "--stream supports OBJ meshes with JSON weights and OBJ output only, without --bench,"
+						 " --incremental, --optimize-layout, --bounds, morph targets, clips or --client."
+					  << std::endl;
+			return 1;
+		}
+		input.stream_memory_budget = memory_budget != 0 ? memory_budget : std::size_t{256} << 20;
+		const StreamRunner runner(pose_reader, stats_writer, skinner);
+		return runner.run(input);
+	}
+
+	if (!input.client_socket.empty())
+	{
+		return transformer::run_service_client(input, pose_reader, mesh_writer, stats_writer);
+	}
 
-	const SkinningApp app(mesh_reader, bone_weights_reader, pose_reader, mesh_writer, stats_writer, skinner);
+	const SkinningApp app(
+			mesh_reader,
+			bone_weights_reader,
+			pose_reader,
+			morph_target_reader,
+			clip_reader,
+			mesh_writer,
+			stats_writer,
+			skinner);
 	return app.run(input);
 }
@@ -0,0 +1,266 @@
+#include "service/service_client.hpp"
+
+#include "core/profiler.hpp"
+
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#if !defined(_WIN32)
+	#include <cerrno>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+#endif
+
+namespace transformer
+{
+
+	using service::Message;
+	using service::Opcode;
+	using service::PayloadReader;
+	using service::PayloadWriter;
+	using service::Status;
+
+#if defined(_WIN32)
+	SkinningServiceClient::SkinningServiceClient(const std::string&, std::chrono::milliseconds)
+	{
+		throw std::runtime_error("Skinning service requires Unix domain sockets");
+	}
+
+	SkinningServiceClient::~SkinningServiceClient() = default;
+#else
+	SkinningServiceClient::SkinningServiceClient(
+			const std::string& socket_path, std::chrono::milliseconds connect_timeout)
+	{
+		sockaddr_un address{};
+		address.sun_family = AF_UNIX;
+		if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path))
+		{
+			throw std::runtime_error("Socket path is empty or too long: " + socket_path);
+		}
+		std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+		const auto deadline = std::chrono::steady_clock::now() + connect_timeout;
+		while (true)
+		{
+			fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+			if (fd_ < 0)
+			{
+				throw std::runtime_error(std::string("Failed to create socket: ") + std::strerror(errno));
+			}
+			if (::connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0)
+			{
+				return;
+			}
+
+			const int error = errno;
+			::close(fd_);
+			fd_ = -1;
+			// The server may still be starting up.
+			if ((error != ENOENT && error != ECONNREFUSED) || std::chrono::steady_clock::now() >= deadline)
+			{
+				throw std::runtime_error("Failed to connect to " + socket_path + ": " + std::strerror(error));
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+
+	SkinningServiceClient::~SkinningServiceClient()
+	{
+		if (fd_ >= 0)
+		{
+			::close(fd_);
+		}
+	}
+#endif
+
+	SkinningServiceClient::LoadedMesh SkinningServiceClient::load_mesh(
+			const std::string& mesh_file,
+			const std::string& weights_file,
+			const std::string& inverse_bind_pose_file,
+			bool optimize_layout,
+			bool renormalize_weights)
+	{
+		PayloadWriter payload;
+		payload.put_string(mesh_file);
+		payload.put_string(weights_file);
+		payload.put_string(inverse_bind_pose_file);
+
+		const auto flags = static_cast<std::uint16_t>(
+				(optimize_layout ? service::kLoadMeshOptimizeLayout : 0U)
+				| (renormalize_weights ? service::kLoadMeshRenormalizeWeights : 0U));
+		PayloadReader reply(request(Opcode::LoadMesh, flags, payload.bytes()).payload);
+
+		LoadedMesh mesh;
+		mesh.mesh_id = reply.get<std::uint32_t>();
+		mesh.vertex_count = reply.get<std::uint32_t>();
+		mesh.bone_count = reply.get<std::uint32_t>();
+		mesh.indices.resize(reply.get<std::uint32_t>());
+		reply.get_bytes(mesh.indices.data(), mesh.indices.size() * sizeof(std::uint32_t));
+		return mesh;
+	}
+
+	std::vector<Vec3> SkinningServiceClient::skin(
+			std::uint32_t mesh_id, const std::vector<Mat4>& new_poses, std::uint32_t pose_count)
+	{
+		if (pose_count == 0 || new_poses.size() % pose_count != 0)
+		{
+			throw std::runtime_error("Pose batch size does not match the number of matrices");
+		}
+
+		PayloadWriter payload;
+		payload.put(mesh_id);
+		payload.put(pose_count);
+		payload.put(static_cast<std::uint32_t>(new_poses.size() / pose_count));
+		payload.put_bytes(new_poses.data(), new_poses.size() * sizeof(Mat4));
+
+		PayloadReader reply(request(Opcode::Skin, 0, payload.bytes()).payload);
+		const auto reply_pose_count = reply.get<std::uint32_t>();
+		const auto vertex_count = reply.get<std::uint32_t>();
+
+		std::vector<Vec3> positions(static_cast<std::size_t>(reply_pose_count) * vertex_count);
+		reply.get_bytes(positions.data(), positions.size() * sizeof(Vec3));
+		return positions;
+	}
+
+	void SkinningServiceClient::unload_mesh(std::uint32_t mesh_id)
+	{
+		PayloadWriter payload;
+		payload.put(mesh_id);
+		request(Opcode::UnloadMesh, 0, payload.bytes());
+	}
+
+	ServiceStats SkinningServiceClient::stats()
+	{
+		PayloadReader reply(request(Opcode::Stats, 0, {}).payload);
+
+		ServiceStats stats;
+		stats.requests = reply.get<std::uint64_t>();
+		stats.poses = reply.get<std::uint64_t>();
+		stats.latency.runs = static_cast<std::size_t>(stats.requests);
+		stats.latency.min_microseconds = reply.get<double>();
+		stats.latency.max_microseconds = reply.get<double>();
+		stats.latency.mean_microseconds = reply.get<double>();
+		stats.latency.median_microseconds = reply.get<double>();
+		stats.latency.stddev_microseconds = reply.get<double>();
+		return stats;
+	}
+
+	void SkinningServiceClient::shutdown_server()
+	{
+		request(Opcode::Shutdown, 0, {});
+	}
+
+	const Message& SkinningServiceClient::request(
+			Opcode opcode, std::uint16_t flags, const std::vector<std::byte>& payload)
+	{
+		service::write_message(fd_, static_cast<std::uint16_t>(opcode), flags, payload.data(), payload.size());
+		if (!service::read_message(fd_, reply_))
+		{
+			throw std::runtime_error("Skinning service closed the connection");
+		}
+
+		if (static_cast<Status>(reply_.header.code) != Status::Ok)
+		{
+			const auto* text = reinterpret_cast<const char*>(reply_.payload.data());
+			throw std::runtime_error("Skinning service error: " + std::string(text, reply_.payload.size()));
+		}
+		return reply_;
+	}
+
+	int run_service_client(
+			const AppInput& input,
+			const IBonePoseReader& bone_pose_reader,
+			const IMeshWriter& mesh_writer,
+			const IStatsWriter& stats_writer)
+	{
+		Profiler profiler;
+		const auto total_start = std::chrono::steady_clock::now();
+
+		try
+		{
+			SkinningServiceClient client(input.client_socket);
+
+			SkinningServiceClient::LoadedMesh loaded;
+			{
+				const auto scope = profiler.stage("service_load_mesh");
+				// The server resolves paths against its own working directory.
+				loaded = client.load_mesh(
+						std::filesystem::absolute(input.mesh_file).string(),
+						std::filesystem::absolute(input.weights_file).string(),
+						std::filesystem::absolute(input.inverse_bind_pose_file).string(),
+						input.optimize_layout,
+						input.weights_policy == WeightsPolicy::Renormalize);
+			}
+
+			const std::vector<Mat4> new_pose
+					= bone_pose_reader.read_matrices(input.new_pose_file, profiler, "read_new_pose_json");
+
+			std::vector<double> bench_runs_microseconds;
+			std::vector<Vec3> positions;
+			for (std::size_t run_index = 0; run_index < input.bench_runs; ++run_index)
+			{
+				const auto run_start = std::chrono::steady_clock::now();
+				positions = client.skin(loaded.mesh_id, new_pose, 1);
+				const auto run_end = std::chrono::steady_clock::now();
+
+				const double run_us = std::chrono::duration<double, std::micro>(run_end - run_start).count();
+				profiler.record("service_skin", run_us);
+				bench_runs_microseconds.push_back(run_us);
+			}
+
+			Mesh skinned_mesh;
+			skinned_mesh.vertex_count = loaded.vertex_count;
+			skinned_mesh.entries.resize(loaded.vertex_count);
+			for (std::size_t i = 0; i < skinned_mesh.vertex_count; ++i)
+			{
+				skinned_mesh.entries[i].vertex = positions[i];
+			}
+			skinned_mesh.indices = std::move(loaded.indices);
+
+			mesh_writer.write(input.output_mesh_file, skinned_mesh, profiler);
+
+			client.unload_mesh(loaded.mesh_id);
+			if (input.shutdown_server)
+			{
+				client.shutdown_server();
+			}
+
+			const auto total_end = std::chrono::steady_clock::now();
+			profiler.record("total", std::chrono::duration<double, std::micro>(total_end - total_start).count());
+
+			StatsReport report{.stages = profiler.entries(), .counters = profiler.counters()};
+			if (input.bench_runs > 1)
+			{
+				report.bench_summary = compute_bench_summary(bench_runs_microseconds);
+			}
+			stats_writer.write(input.stats_file, report);
+
+			std::cout << "Success" << std::endl;
+			return 0;
+		}
+		catch (const std::exception& ex)
+		{
+			const auto total_end = std::chrono::steady_clock::now();
+			profiler.record("total", std::chrono::duration<double, std::micro>(total_end - total_start).count());
+
+			try
+			{
+				const StatsReport report{.stages = profiler.entries(), .counters = profiler.counters()};
+				stats_writer.write(input.stats_file, report);
+			}
+			catch (...)
+			{
+				// Best effort: do not mask original error.
+			}
+
+			std::cerr << "Error: " << ex.what() << std::endl;
+			return 1;
+		}
+	}
+
+}  // namespace transformer
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "core/app_input.hpp"
+#include "core/math_types.hpp"
+#include "core/profiler.hpp"
+#include "io/io_interfaces.hpp"
+#include "service/service_protocol.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace transformer
+{
+
+	struct ServiceStats
+	{
+		std::uint64_t requests = 0;
+		std::uint64_t poses = 0;
+		BenchSummary latency;
+	};
+
+	// Blocking client for SkinningServer. Connecting retries until the timeout, so a client can be
+	// started together with the server.
+	class SkinningServiceClient
+	{
+	public:
+		struct LoadedMesh
+		{
+			std::uint32_t mesh_id = 0;
+			std::uint32_t vertex_count = 0;
+			std::uint32_t bone_count = 0;
+			std::vector<std::uint32_t> indices;
+		};
+
+		explicit SkinningServiceClient(
+				const std::string& socket_path, std::chrono::milliseconds connect_timeout = std::chrono::seconds(10));
+		~SkinningServiceClient();
+
+		SkinningServiceClient(const SkinningServiceClient&) = delete;
+		SkinningServiceClient& operator=(const SkinningServiceClient&) = delete;
+
+		// Paths are resolved by the server process, so pass absolute ones. Invalid weights fail the load
+		// unless renormalize_weights is set.
+		LoadedMesh load_mesh(
+				const std::string& mesh_file,
+				const std::string& weights_file,
+				const std::string& inverse_bind_pose_file,
+				bool optimize_layout,
+				bool renormalize_weights = false);
+
+		// new_poses holds pose_count * bone_count matrices; returns pose_count * vertex_count positions.
+		std::vector<Vec3> skin(std::uint32_t mesh_id, const std::vector<Mat4>& new_poses, std::uint32_t pose_count);
+
+		void unload_mesh(std::uint32_t mesh_id);
+		ServiceStats stats();
+		void shutdown_server();
+
+	private:
+		const service::Message& request(
+				service::Opcode opcode, std::uint16_t flags, const std::vector<std::byte>& payload);
+
+		int fd_ = -1;
+		service::Message reply_;
+	};
+
+	// `transformer --client <socket> ...`: same inputs and outputs as SkinningApp::run, but the mesh is
+	// loaded and skinned by a running server.
+	int run_service_client(
+			const AppInput& input,
+			const IBonePoseReader& bone_pose_reader,
+			const IMeshWriter& mesh_writer,
+			const IStatsWriter& stats_writer);
+
+}  // namespace transformer
@@ -0,0 +1,176 @@
+#include "service/service_protocol.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+	#include <cerrno>
+	#include <sys/socket.h>
+	#include <sys/types.h>
+	#include <unistd.h>
+#endif
+
+namespace transformer::service
+{
+
+	namespace
+	{
+
+		// Upper bound for a single message, to reject garbage headers outright.
+		constexpr std::uint64_t kMaxPayloadSize = 1ULL << 32;
+		// Payloads are read, and their buffer grown, this much at a time: a header that claims more than the
+		// peer sends costs what was sent, not what was claimed.
+		constexpr std::size_t kPayloadReadBytes = std::size_t{1} << 20;
+
+#if defined(_WIN32)
+		bool read_exact(int, void*, std::size_t)
+		{
+			throw std::runtime_error("Skinning service requires Unix domain sockets");
+		}
+
+		void write_exact(int, const void*, std::size_t)
+		{
+			throw std::runtime_error("Skinning service requires Unix domain sockets");
+		}
+#else
+		// Returns false if the stream ends before the first byte.
+		bool read_exact(int fd, void* data, std::size_t size)
+		{
+			auto* cursor = static_cast<char*>(data);
+			std::size_t done = 0;
+			while (done < size)
+			{
+				const ssize_t received = ::recv(fd, cursor + done, size - done, 0);
+				if (received == 0)
+				{
+					if (done == 0)
+					{
+						return false;
+					}
+					throw std::runtime_error("Service protocol error: connection closed mid-message");
+				}
+				if (received < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					throw std::runtime_error(std::string("Service socket read failed: ") + std::strerror(errno));
+				}
+				done += static_cast<std::size_t>(received);
+			}
+			return true;
+		}
+
+		void write_exact(int fd, const void* data, std::size_t size)
+		{
+	#if defined(MSG_NOSIGNAL)
+			constexpr int kSendFlags = MSG_NOSIGNAL;
+	#else
+			constexpr int kSendFlags = 0;
+	#endif
+			const auto* cursor = static_cast<const char*>(data);
+			std::size_t done = 0;
+			while (done < size)
+			{
+				const ssize_t sent = ::send(fd, cursor + done, size - done, kSendFlags);
+				if (sent < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					throw std::runtime_error(std::string("Service socket write failed: ") + std::strerror(errno));
+				}
+				done += static_cast<std::size_t>(sent);
+			}
+		}
+#endif
+
+	}  // namespace
+
+	bool read_message(int fd, Message& message)
+	{
+		if (!read_exact(fd, &message.header, sizeof(message.header)))
+		{
+			return false;
+		}
+		if (message.header.magic != kMagic)
+		{
+			throw std::runtime_error("Service protocol error: bad message magic");
+		}
+		if (message.header.payload_size > kMaxPayloadSize)
+		{
+			throw std::runtime_error("Service protocol error: payload too large");
+		}
+
+		const auto payload_size = static_cast<std::size_t>(message.header.payload_size);
+		message.payload.clear();
+		while (message.payload.size() < payload_size)
+		{
+			const std::size_t offset = message.payload.size();
+			message.payload.resize(offset + std::min(kPayloadReadBytes, payload_size - offset));
+			if (!read_exact(fd, message.payload.data() + offset, message.payload.size() - offset))
+			{
+				throw std::runtime_error("Service protocol error: connection closed mid-message");
+			}
+		}
+		return true;
+	}
+
+	void write_message(int fd, std::uint16_t code, std::uint16_t flags, const void* payload, std::size_t payload_size)
+	{
+		const MessageHeader header{.magic = kMagic, .code = code, .flags = flags, .payload_size = payload_size};
+		write_exact(fd, &header, sizeof(header));
+		if (payload_size != 0)
+		{
+			write_exact(fd, payload, payload_size);
+		}
+	}
+
+	void PayloadWriter::put_bytes(const void* data, std::size_t size)
+	{
+		const auto* bytes = static_cast<const std::byte*>(data);
+		bytes_.insert(bytes_.end(), bytes, bytes + size);
+	}
+
+	void PayloadWriter::put_string(const std::string& value)
+	{
+		put(static_cast<std::uint32_t>(value.size()));
+		put_bytes(value.data(), value.size());
+	}
+
+	const std::vector<std::byte>& PayloadWriter::bytes() const
+	{
+		return bytes_;
+	}
+
+	PayloadReader::PayloadReader(const std::vector<std::byte>& payload) :
+			payload_(payload)
+	{}
+
+	void PayloadReader::get_bytes(void* data, std::size_t size)
+	{
+		std::memcpy(data, view(size), size);
+	}
+
+	std::string PayloadReader::get_string()
+	{
+		const auto size = get<std::uint32_t>();
+		const std::byte* data = view(size);
+		return std::string(reinterpret_cast<const char*>(data), size);
+	}
+
+	const std::byte* PayloadReader::view(std::size_t size)
+	{
+		if (size > payload_.size() - position_)
+		{
+			throw std::runtime_error("Service protocol error: truncated payload");
+		}
+		const std::byte* data = payload_.data() + position_;
+		position_ += size;
+		return data;
+	}
+
+}  // namespace transformer::service
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace transformer::service
+{
+
+	// Binary protocol over a Unix domain socket. Client and server run on the same machine, so every
+	// field is in host byte order. Each message is a MessageHeader followed by payload_size bytes.
+	//
+	// Requests (header.code = Opcode):
+	//   LoadMesh   flags bit 0 = optimize layout, bit 1 = renormalize invalid weights; payload:
+	//              3 x (u32 length + bytes) = mesh, weights, inverse bind pose paths. Reply: u32 mesh_id,
+	//              u32 vertex_count, u32 bone_count, u32 index_count, index_count x u32 (source order).
+	//   Skin       payload: u32 mesh_id, u32 pose_count, u32 bone_count, pose_count * bone_count * 16 f32
+	//              (column-major new pose matrices). Reply: u32 pose_count, u32 vertex_count,
+	//              pose_count * vertex_count * 3 f32 (xyz, source order).
+	//   UnloadMesh payload: u32 mesh_id. Reply: empty.
+	//   Stats      Reply: u64 requests, u64 poses, f64 min/max/mean/median/stddev request latency (us).
+	//   Shutdown   Reply: empty; the server stops after answering.
+	//
+	// Replies use header.code = Status; an Error reply carries the message text as payload.
+
+	constexpr std::uint32_t kMagic = 0x4B534654;  // "TFSK"
+
+	enum class Opcode : std::uint16_t
+	{
+		LoadMesh = 1,
+		Skin = 2,
+		UnloadMesh = 3,
+		Stats = 4,
+		Shutdown = 5,
+	};
+
+	enum class Status : std::uint16_t
+	{
+		Ok = 0,
+		Error = 1,
+	};
+
+	constexpr std::uint16_t kLoadMeshOptimizeLayout = 1U << 0;
+	constexpr std::uint16_t kLoadMeshRenormalizeWeights = 1U << 1;
+
+	struct MessageHeader
+	{
+		std::uint32_t magic = kMagic;
+		std::uint16_t code = 0;
+		std::uint16_t flags = 0;
+		std::uint64_t payload_size = 0;
+	};
+
+	static_assert(sizeof(MessageHeader) == 16, "MessageHeader is part of the wire format");
+
+	struct Message
+	{
+		MessageHeader header;
+		std::vector<std::byte> payload;
+	};
+
+	// Blocking helpers; throw std::runtime_error on I/O errors. read_message returns false on a clean
+	// end of stream before a header, and grows the payload only as its bytes arrive.
+	bool read_message(int fd, Message& message);
+	void write_message(int fd, std::uint16_t code, std::uint16_t flags, const void* payload, std::size_t payload_size);
+
+	// Appends plain values to a payload and reads them back with bounds checks.
+	class PayloadWriter
+	{
+	public:
+		template <typename T>
+		void put(const T& value)
+		{
+			put_bytes(&value, sizeof(T));
+		}
+
+		void put_bytes(const void* data, std::size_t size);
+		void put_string(const std::string& value);
+
+		[[nodiscard]]
+		const std::vector<std::byte>& bytes() const;
+
+	private:
+		std::vector<std::byte> bytes_;
+	};
+
+	class PayloadReader
+	{
+	public:
+		explicit PayloadReader(const std::vector<std::byte>& payload);
+
+		template <typename T>
+		T get()
+		{
+			T value{};
+			get_bytes(&value, sizeof(T));
+			return value;
+		}
+
+		void get_bytes(void* data, std::size_t size);
+		std::string get_string();
+		// Pointer to the next size bytes without copying.
+		const std::byte* view(std::size_t size);
+
+	private:
+		const std::vector<std::byte>& payload_;
+		std::size_t position_ = 0;
+	};
+
+}  // namespace transformer::service
@@ -0,0 +1,351 @@
+#include "service/skinning_server.hpp"
+
+#include "core/mesh_utils.hpp"
+#include "core/profiler.hpp"
+#include "core/weight_validation.hpp"
+#include "skinning/mesh_optimizer.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+	#include <cerrno>
+	#include <poll.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+#endif
+
+namespace transformer
+{
+
+	using service::Message;
+	using service::Opcode;
+	using service::PayloadReader;
+	using service::Status;
+
+	namespace
+	{
+
+		template <typename T>
+		void append(std::vector<std::byte>& bytes, const T& value)
+		{
+			const auto* data = reinterpret_cast<const std::byte*>(&value);
+			bytes.insert(bytes.end(), data, data + sizeof(T));
+		}
+
+	}  // namespace
+
+	SkinningServer::SkinningServer(
+			const IMeshReader& mesh_reader,
+			const IBoneWeightsReader& bone_weights_reader,
+			const IBonePoseReader& bone_pose_reader,
+			const MeshSkinner& mesh_skinner) :
+			mesh_reader_(mesh_reader),
+			bone_weights_reader_(bone_weights_reader),
+			bone_pose_reader_(bone_pose_reader),
+			mesh_skinner_(mesh_skinner)
+	{}
+
+#if defined(_WIN32)
+	int SkinningServer::run(const std::string&, const IStatsWriter&, const std::string&)
+	{
+		std::cerr << "Error: --serve requires Unix domain sockets, which this build does not support" << std::endl;
+		return 1;
+	}
+#else
+	int SkinningServer::run(
+			const std::string& socket_path, const IStatsWriter& stats_writer, const std::string& stats_file)
+	{
+		const auto serve_start = std::chrono::steady_clock::now();
+
+		sockaddr_un address{};
+		address.sun_family = AF_UNIX;
+		if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path))
+		{
+			std::cerr << "Error: socket path is empty or too long: " << socket_path << std::endl;
+			return 1;
+		}
+		std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+		const int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (listen_fd < 0)
+		{
+			std::cerr << "Error: failed to create socket: " << std::strerror(errno) << std::endl;
+			return 1;
+		}
+
+		// A stale socket file from a previous run would make bind() fail.
+		::unlink(socket_path.c_str());
+		if (::bind(listen_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+			|| ::listen(listen_fd, SOMAXCONN) != 0)
+		{
+			std::cerr << "Error: failed to listen on " << socket_path << ": " << std::strerror(errno) << std::endl;
+			::close(listen_fd);
+			return 1;
+		}
+
+		std::cout << "Listening on " << socket_path << std::endl;
+
+		std::vector<pollfd> poll_fds{{.fd = listen_fd, .events = POLLIN, .revents = 0}};
+		Message request;
+		bool running = true;
+		while (running)
+		{
+			if (::poll(poll_fds.data(), poll_fds.size(), -1) < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				std::cerr << "Error: poll failed: " << std::strerror(errno) << std::endl;
+				break;
+			}
+
+			// Every ready connection gets one request per iteration, so concurrent clients interleave.
+			for (std::size_t i = 1; i < poll_fds.size() && running; ++i)
+			{
+				if ((poll_fds[i].revents & (POLLIN | POLLHUP | POLLERR)) == 0)
+				{
+					continue;
+				}
+
+				bool keep_connection = true;
+				try
+				{
+					keep_connection = service::read_message(poll_fds[i].fd, request);
+					if (keep_connection)
+					{
+						running = handle(poll_fds[i].fd, request);
+					}
+				}
+				catch (const std::exception& ex)
+				{
+					// Broken stream: the connection cannot be resynchronised.
+					std::cerr << "Connection dropped: " << ex.what() << std::endl;
+					keep_connection = false;
+				}
+
+				if (!keep_connection)
+				{
+					::close(poll_fds[i].fd);
+					poll_fds[i].fd = -1;
+				}
+			}
+			std::erase_if(poll_fds, [](const pollfd& entry) { return entry.fd < 0; });
+
+			if ((poll_fds[0].revents & POLLIN) != 0)
+			{
+				const int client_fd = ::accept(listen_fd, nullptr, nullptr);
+				if (client_fd >= 0)
+				{
+					poll_fds.push_back({.fd = client_fd, .events = POLLIN, .revents = 0});
+				}
+			}
+		}
+
+		for (const pollfd& entry : poll_fds)
+		{
+			::close(entry.fd);
+		}
+		::unlink(socket_path.c_str());
+
+		if (!stats_file.empty())
+		{
+			Profiler profiler;
+			const auto serve_end = std::chrono::steady_clock::now();
+			profiler.record("serve", std::chrono::duration<double, std::micro>(serve_end - serve_start).count());
+			profiler.add_counter("service_requests", request_microseconds_.size());
+			profiler.add_counter("service_poses_skinned", poses_skinned_);
+
+			StatsReport report{.stages = profiler.entries(), .counters = profiler.counters()};
+			report.kernel = mesh_skinner_.kernel_name();
+			if (!request_microseconds_.empty())
+			{
+				report.bench_summary = compute_bench_summary(request_microseconds_);
+			}
+			stats_writer.write(stats_file, report);
+		}
+
+		return 0;
+	}
+#endif
+
+	bool SkinningServer::handle(int fd, const Message& request)
+	{
+		const auto request_start = std::chrono::steady_clock::now();
+		const auto opcode = static_cast<Opcode>(request.header.code);
+
+		reply_.clear();
+		Status status = Status::Ok;
+		try
+		{
+			switch (opcode)
+			{
+				case Opcode::LoadMesh: load_mesh(request); break;
+				case Opcode::Skin: skin(request); break;
+				case Opcode::UnloadMesh: unload_mesh(request); break;
+				case Opcode::Stats: stats(); break;
+				case Opcode::Shutdown: break;
+				default: throw std::runtime_error("Service protocol error: unknown opcode");
+			}
+		}
+		catch (const std::exception& ex)
+		{
+			// Request-level failure (bad path, count mismatch, ...): report it, keep the connection.
+			status = Status::Error;
+			reply_.clear();
+			const std::string message = ex.what();
+			reply_.insert(
+					reply_.end(),
+					reinterpret_cast<const std::byte*>(message.data()),
+					reinterpret_cast<const std::byte*>(message.data() + message.size()));
+		}
+
+		service::write_message(fd, static_cast<std::uint16_t>(status), 0, reply_.data(), reply_.size());
+
+		const auto request_end = std::chrono::steady_clock::now();
+		request_microseconds_.push_back(
+				std::chrono::duration<double, std::micro>(request_end - request_start).count());
+
+		return opcode != Opcode::Shutdown;
+	}
+
+	void SkinningServer::load_mesh(const Message& request)
+	{
+		PayloadReader payload(request.payload);
+		const std::string mesh_file = payload.get_string();
+		const std::string weights_file = payload.get_string();
+		const std::string inverse_bind_pose_file = payload.get_string();
+
+		Profiler profiler;
+		auto resident = std::make_unique<ResidentMesh>();
+		resident->source_mesh = mesh_reader_.read(mesh_file, profiler);
+		merge_bone_weights(resident->source_mesh, bone_weights_reader_.read(weights_file, profiler));
+		const std::vector<Mat4> inverse_bind_pose
+				= bone_pose_reader_.read_matrices(inverse_bind_pose_file, profiler, "read_inverse_bind_pose_json");
+		// Refused before the mesh becomes resident: every Skin request would build a palette from it.
+		if (inverse_bind_pose.size() > kMaxBones)
+		{
+			throw std::runtime_error(
+					"Too many bones: " + std::to_string(inverse_bind_pose.size()) + " (at most "
+					+ std::to_string(kMaxBones) + ")");
+		}
+		const bool renormalize = (request.header.flags & service::kLoadMeshRenormalizeWeights) != 0;
+		validate_bone_weights(
+				resident->source_mesh,
+				inverse_bind_pose.size(),
+				renormalize ? WeightsPolicy::Renormalize : WeightsPolicy::Error);
+		if ((request.header.flags & service::kLoadMeshOptimizeLayout) != 0)
+		{
+			optimize_mesh_layout(resident->source_mesh, profiler);
+		}
+
+		resident->bone_pose_data = make_bone_pose_data(inverse_bind_pose, inverse_bind_pose);
+		resident->skinned_mesh = resident->source_mesh;
+
+		const Mesh& mesh = resident->source_mesh;
+		const std::uint32_t mesh_id = next_mesh_id_++;
+		append(reply_, mesh_id);
+		append(reply_, static_cast<std::uint32_t>(mesh.vertex_count));
+		append(reply_, static_cast<std::uint32_t>(inverse_bind_pose.size()));
+		append(reply_, static_cast<std::uint32_t>(mesh.indices.size()));
+
+		// Faces go back in source order, against source vertex indices.
+		const std::size_t triangle_count = mesh.indices.size() / 3;
+		std::vector<std::uint32_t> indices(mesh.indices.size());
+		for (std::size_t t = 0; t < triangle_count; ++t)
+		{
+			const std::size_t source_triangle = mesh.triangle_source_index.empty() ? t : mesh.triangle_source_index[t];
+			for (std::size_t corner = 0; corner < 3; ++corner)
+			{
+				const std::uint32_t index = mesh.indices[t * 3 + corner];
+				indices[source_triangle * 3 + corner]
+						= mesh.vertex_source_index.empty() ? index : mesh.vertex_source_index[index];
+			}
+		}
+		const auto* index_bytes = reinterpret_cast<const std::byte*>(indices.data());
+		reply_.insert(reply_.end(), index_bytes, index_bytes + indices.size() * sizeof(std::uint32_t));
+
+		meshes_.emplace(mesh_id, std::move(resident));
+	}
+
+	void SkinningServer::skin(const Message& request)
+	{
+		PayloadReader payload(request.payload);
+		const auto mesh_id = payload.get<std::uint32_t>();
+		const auto pose_count = payload.get<std::uint32_t>();
+		const auto bone_count = payload.get<std::uint32_t>();
+
+		const auto it = meshes_.find(mesh_id);
+		if (it == meshes_.end())
+		{
+			throw std::runtime_error("Unknown mesh id: " + std::to_string(mesh_id));
+		}
+		ResidentMesh& resident = *it->second;
+		if (bone_count != resident.bone_pose_data.bone_poses.size())
+		{
+			throw std::runtime_error("Bone count mismatch between inverse bind pose and new pose");
+		}
+
+		const Mesh& source_mesh = resident.source_mesh;
+		const std::size_t vertex_count = source_mesh.vertex_count;
+		const std::byte* poses = payload.view(static_cast<std::size_t>(pose_count) * bone_count * sizeof(Mat4));
+
+		append(reply_, pose_count);
+		append(reply_, static_cast<std::uint32_t>(vertex_count));
+		const std::size_t header_size = reply_.size();
+		reply_.resize(header_size + static_cast<std::size_t>(pose_count) * vertex_count * sizeof(Vec3));
+		static_assert(sizeof(Vec3) == 3 * sizeof(float), "Skin replies are tightly packed xyz floats");
+		auto* output = reinterpret_cast<Vec3*>(reply_.data() + header_size);
+
+		Profiler profiler;
+		for (std::uint32_t pose = 0; pose < pose_count; ++pose)
+		{
+			for (std::uint32_t bone = 0; bone < bone_count; ++bone)
+			{
+				std::memcpy(
+						&resident.bone_pose_data.bone_poses[bone][1],
+						poses + (static_cast<std::size_t>(pose) * bone_count + bone) * sizeof(Mat4),
+						sizeof(Mat4));
+			}
+
+			mesh_skinner_.skin(source_mesh, resident.bone_pose_data, profiler, resident.skinned_mesh);
+
+			Vec3* pose_output = output + static_cast<std::size_t>(pose) * vertex_count;
+			for (std::size_t i = 0; i < vertex_count; ++i)
+			{
+				const std::size_t source_index
+						= source_mesh.vertex_source_index.empty() ? i : source_mesh.vertex_source_index[i];
+				pose_output[source_index] = resident.skinned_mesh.entries[i].vertex;
+			}
+		}
+		poses_skinned_ += pose_count;
+	}
+
+	void SkinningServer::unload_mesh(const Message& request)
+	{
+		PayloadReader payload(request.payload);
+		const auto mesh_id = payload.get<std::uint32_t>();
+		if (meshes_.erase(mesh_id) == 0)
+		{
+			throw std::runtime_error("Unknown mesh id: " + std::to_string(mesh_id));
+		}
+	}
+
+	void SkinningServer::stats()
+	{
+		const BenchSummary summary = compute_bench_summary(request_microseconds_);
+		append(reply_, static_cast<std::uint64_t>(request_microseconds_.size()));
+		append(reply_, poses_skinned_);
+		append(reply_, summary.min_microseconds);
+		append(reply_, summary.max_microseconds);
+		append(reply_, summary.mean_microseconds);
+		append(reply_, summary.median_microseconds);
+		append(reply_, summary.stddev_microseconds);
+	}
+
+}  // namespace transformer
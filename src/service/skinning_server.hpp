@@ -0,0 +1,61 @@
+#pragma once
+
+#include "core/math_types.hpp"
+#include "io/io_interfaces.hpp"
+#include "service/service_protocol.hpp"
+#include "skinning/mesh_skinner.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace transformer
+{
+
+	// Persistent skinning daemon (`transformer --serve <socket>`). Meshes are parsed once and stay
+	// resident; clients then send batches of poses and get skinned vertex buffers back.
+	// See service_protocol.hpp for the wire format.
+	class SkinningServer
+	{
+	public:
+		SkinningServer(
+				const IMeshReader& mesh_reader,
+				const IBoneWeightsReader& bone_weights_reader,
+				const IBonePoseReader& bone_pose_reader,
+				const MeshSkinner& mesh_skinner);
+
+		// Serves until a Shutdown request arrives. Per-request latency stats go to stats_file, if set.
+		int run(const std::string& socket_path, const IStatsWriter& stats_writer, const std::string& stats_file);
+
+	private:
+		struct ResidentMesh
+		{
+			Mesh source_mesh;
+			Mesh skinned_mesh;
+			BonePoseData bone_pose_data;
+		};
+
+		// Returns false once the server should stop.
+		bool handle(int fd, const service::Message& request);
+		void load_mesh(const service::Message& request);
+		void skin(const service::Message& request);
+		void unload_mesh(const service::Message& request);
+		void stats();
+
+		const IMeshReader& mesh_reader_;
+		const IBoneWeightsReader& bone_weights_reader_;
+		const IBonePoseReader& bone_pose_reader_;
+		const MeshSkinner& mesh_skinner_;
+
+		std::unordered_map<std::uint32_t, std::unique_ptr<ResidentMesh>> meshes_;
+		std::uint32_t next_mesh_id_ = 1;
+
+		// Reused between requests so steady-state skinning does not allocate.
+		std::vector<std::byte> reply_;
+		std::vector<double> request_microseconds_;
+		std::uint64_t poses_skinned_ = 0;
+	};
+
+}  // namespace transformer
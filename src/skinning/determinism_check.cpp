@@ -0,0 +1,82 @@
+#include "skinning/determinism_check.hpp"
+
+#include "skinning/kernels/kernel_registry.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		// Enough for stable timings (a few hundred microseconds per pass), small enough to stay a fraction
+		// of a real run.
+		constexpr std::size_t kSampleVertices = 65536;
+		constexpr std::size_t kSampleRuns = 7;
+
+		double skin_sample(
+				const SkinRangeFunction skin_block,
+				const SkinningPalette& palette,
+				const Mesh& mesh,
+				std::size_t count,
+				std::vector<Mesh::Entry>& result)
+		{
+			const SkinRange range{.source = mesh.entries.data(), .count = count, .result = result.data()};
+			const auto start = std::chrono::steady_clock::now();
+			skin_block(palette, range);
+			return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+		}
+
+	}  // namespace
+
+	DeterminismSummary compare_with_fastest_kernel(
+			const SkinningKernel& kernel, const Mesh& mesh, const BonePoseData& bone_pose_data)
+	{
+		DeterminismSummary summary{.kernel = kernel.name};
+		const SkinningKernel* fastest = fastest_fused_skinning_kernel();
+		if (fastest == nullptr)
+		{
+			return summary;
+		}
+		summary.fastest_kernel = fastest->name;
+
+		auto palette = std::make_unique<SkinningPalette>();
+		build_palette(*palette, bone_pose_data);
+
+		// The loop MeshSkinner would run for this mesh without morphs or bounds.
+		const std::size_t influences = std::clamp<std::size_t>(mesh.max_influences, 1, kMaxInfluences);
+		const SkinRangeFunction exact = kernel.skin_ranges->find(influences, BoundsMode::None, false);
+		const SkinRangeFunction fused = fastest->skin_ranges->find(influences, BoundsMode::None, false);
+
+		const std::size_t count = std::min(mesh.vertex_count, kSampleVertices);
+		std::vector<Mesh::Entry> exact_result(count);
+		std::vector<Mesh::Entry> fused_result(count);
+		// Alternated and the minimum of each kept, so frequency changes hit both alike.
+		summary.deterministic_microseconds = std::numeric_limits<double>::infinity();
+		summary.fastest_microseconds = std::numeric_limits<double>::infinity();
+		for (std::size_t run = 0; run < kSampleRuns; ++run)
+		{
+			summary.deterministic_microseconds = std::min(
+					summary.deterministic_microseconds, skin_sample(exact, *palette, mesh, count, exact_result));
+			summary.fastest_microseconds
+					= std::min(summary.fastest_microseconds, skin_sample(fused, *palette, mesh, count, fused_result));
+		}
+
+		summary.sample_vertices = count;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			if (std::memcmp(&exact_result[i].vertex, &fused_result[i].vertex, sizeof(Vec3)) != 0)
+			{
+				++summary.differing_vertices;
+			}
+		}
+		return summary;
+	}
+
+}  // namespace transformer
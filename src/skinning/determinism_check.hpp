@@ -0,0 +1,18 @@
+#pragma once
+
+#include "core/math_types.hpp"
+#include "core/profiler.hpp"
+
+namespace transformer
+{
+
+	struct SkinningKernel;
+
+	// For --deterministic: times kernel (a deterministic variant) against the fastest fused variant on the
+	// first vertices of mesh in this pose, and counts the vertices whose fused result has other bits.
+	// Without a fused variant on this machine, only the kernel name is filled in.
+	[[nodiscard]]
+	DeterminismSummary compare_with_fastest_kernel(
+			const SkinningKernel& kernel, const Mesh& mesh, const BonePoseData& bone_pose_data);
+
+}  // namespace transformer
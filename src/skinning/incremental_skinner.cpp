@@ -0,0 +1,141 @@
+#include "skinning/incremental_skinner.hpp"
+
+#include "core/profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace transformer
+{
+
+	IncrementalMeshSkinner::IncrementalMeshSkinner(const Mesh& source_mesh) :
+			source_mesh_(source_mesh),
+			bone_vertex_offsets_(257, 0),
+			palette_(std::make_unique<SkinningPalette>()),
+			vertex_stamp_(source_mesh.vertex_count, 0)
+	{
+		// Zero-weight slots are left out: 0 * M adds nothing, so those bones cannot move the vertex.
+		auto for_each_influence = [&](auto&& visit)
+		{
+			for (std::size_t vertex_index = 0; vertex_index < source_mesh_.vertex_count; ++vertex_index)
+			{
+				const VertexBoneWeights& bone_weights = source_mesh_.entries[vertex_index].bone_weights;
+				for (std::size_t i = 0; i < 4; ++i)
+				{
+					const auto bone = static_cast<std::uint8_t>(bone_weights.bone_indices[i]);
+					if (bone != 255 && bone_weights.weights[i] != 0.0F)
+					{
+						visit(bone, static_cast<std::uint32_t>(vertex_index));
+					}
+				}
+			}
+		};
+
+		for_each_influence([&](std::uint8_t bone, std::uint32_t) { ++bone_vertex_offsets_[bone + 1]; });
+		for (std::size_t bone = 0; bone < 256; ++bone)
+		{
+			bone_vertex_offsets_[bone + 1] += bone_vertex_offsets_[bone];
+		}
+
+		bone_vertices_.resize(bone_vertex_offsets_.back());
+		std::vector<std::uint32_t> cursor(bone_vertex_offsets_.begin(), bone_vertex_offsets_.end() - 1);
+		for_each_influence([&](std::uint8_t bone, std::uint32_t vertex_index)
+						   { bone_vertices_[cursor[bone]++] = vertex_index; });
+
+		touched_vertices_.reserve(source_mesh_.vertex_count);
+	}
+
+	IncrementalUpdateStats IncrementalMeshSkinner::update(
+			const BonePoseData& bone_pose_data, Profiler& profiler, Mesh& result_mesh)
+	{
+		const auto scope = profiler.stage("cpu_skinning");
+
+		IncrementalUpdateStats stats;
+		const std::size_t bone_count = bone_pose_data.bone_poses.size();
+
+		if (!primed_ || previous_poses_.size() != bone_count || result_mesh.entries.size() != source_mesh_.vertex_count)
+		{
+			// Same palette a fresh MeshSkinner::skin would build: bones past bone_count stay zero.
+			build_palette(*palette_, bone_pose_data);
+			previous_poses_.assign(bone_pose_data.bone_poses.begin(), bone_pose_data.bone_poses.begin() + bone_count);
+			primed_ = true;
+
+			skin_all(result_mesh);
+			stats = {.changed_bones = bone_count, .vertices_touched = source_mesh_.vertex_count, .full_update = true};
+			last_update_ = stats;
+			return stats;
+		}
+
+		changed_bones_.clear();
+		for (std::size_t bone_index = 0; bone_index < bone_count; ++bone_index)
+		{
+			const std::array<Mat4, 2>& bone_pose = bone_pose_data.bone_poses[bone_index];
+			if (std::memcmp(&previous_poses_[bone_index], &bone_pose, sizeof(bone_pose)) != 0)
+			{
+				previous_poses_[bone_index] = bone_pose;
+				update_palette_entry(*palette_, bone_pose_data, bone_index);
+				changed_bones_.push_back(bone_index);
+			}
+		}
+
+		if (++stamp_ == 0)
+		{
+			std::fill(vertex_stamp_.begin(), vertex_stamp_.end(), 0);
+			stamp_ = 1;
+		}
+
+		touched_vertices_.clear();
+		for (const std::size_t bone_index : changed_bones_)
+		{
+			for (std::uint32_t i = bone_vertex_offsets_[bone_index]; i < bone_vertex_offsets_[bone_index + 1]; ++i)
+			{
+				const std::uint32_t vertex_index = bone_vertices_[i];
+				if (vertex_stamp_[vertex_index] != stamp_)
+				{
+					vertex_stamp_[vertex_index] = stamp_;
+					touched_vertices_.push_back(vertex_index);
+				}
+			}
+		}
+
+		stats.changed_bones = changed_bones_.size();
+		stats.vertices_touched = touched_vertices_.size();
+
+		// Past roughly half the mesh a sequential sweep beats scattered access.
+		if (touched_vertices_.size() * 2 > source_mesh_.vertex_count)
+		{
+			skin_all(result_mesh);
+			stats.vertices_touched = source_mesh_.vertex_count;
+			stats.full_update = true;
+		}
+		else
+		{
+			for (const std::uint32_t vertex_index : touched_vertices_)
+			{
+				result_mesh.entries[vertex_index].vertex = skin_position(*palette_, source_mesh_.entries[vertex_index]);
+			}
+		}
+
+		last_update_ = stats;
+		return stats;
+	}
+
+	void IncrementalMeshSkinner::reset()
+	{
+		primed_ = false;
+	}
+
+	const IncrementalUpdateStats& IncrementalMeshSkinner::last_update() const
+	{
+		return last_update_;
+	}
+
+	void IncrementalMeshSkinner::skin_all(Mesh& result_mesh) const
+	{
+		for (std::size_t vertex_index = 0; vertex_index < source_mesh_.vertex_count; ++vertex_index)
+		{
+			result_mesh.entries[vertex_index].vertex = skin_position(*palette_, source_mesh_.entries[vertex_index]);
+		}
+	}
+
+}  // namespace transformer
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core/math_types.hpp"
+#include "skinning/skinning_kernel.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace transformer
+{
+
+	class Profiler;
+
+	struct IncrementalUpdateStats
+	{
+		std::size_t changed_bones = 0;
+		std::size_t vertices_touched = 0;
+		bool full_update = false;
+	};
+
+	// Stateful skinner for interactive posing: diffs every pose against the previous one, rebuilds only
+	// the changed palette entries and re-skins only the vertices those bones influence.
+	// The caller keeps passing the same result mesh, which holds the previous update's output.
+	class IncrementalMeshSkinner
+	{
+	public:
+		// The stats "kernel" of runs it skins: it calls skin_position() itself instead of a registry kernel.
+		static constexpr const char* kKernelName = "incremental";
+
+		// Builds the bone -> vertex inverted index. source_mesh must outlive the skinner.
+		explicit IncrementalMeshSkinner(const Mesh& source_mesh);
+
+		IncrementalUpdateStats update(const BonePoseData& bone_pose_data, Profiler& profiler, Mesh& result_mesh);
+
+		// Forces the next update to skin every vertex.
+		void reset();
+
+		[[nodiscard]]
+		const IncrementalUpdateStats& last_update() const;
+
+	private:
+		void skin_all(Mesh& result_mesh) const;
+
+		const Mesh& source_mesh_;
+		// CSR inverted index: vertices with a non-zero weight for bone b are
+		// bone_vertices_[bone_vertex_offsets_[b] .. bone_vertex_offsets_[b + 1]).
+		std::vector<std::uint32_t> bone_vertex_offsets_;
+		std::vector<std::uint32_t> bone_vertices_;
+
+		std::unique_ptr<SkinningPalette> palette_;
+		std::vector<std::array<Mat4, 2>> previous_poses_;
+		bool primed_ = false;
+
+		// Per-vertex stamp of the last update that queued it, so shared vertices are skinned once.
+		std::vector<std::uint32_t> vertex_stamp_;
+		std::uint32_t stamp_ = 0;
+		std::vector<std::uint32_t> touched_vertices_;
+		std::vector<std::size_t> changed_bones_;
+
+		IncrementalUpdateStats last_update_;
+	};
+
+}  // namespace transformer
@@ -0,0 +1,140 @@
+#include "skinning/kernels/kernel_registry.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	#include <intrin.h>
+#endif
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		struct CpuFeatures
+		{
+			bool sse41 = false;
+			bool avx2 = false;
+			bool fma = false;
+			bool avx512f = false;
+		};
+
+		CpuFeatures detect_cpu_features()
+		{
+			CpuFeatures features;
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+			// Also checks that the OS saves the wider register state (XGETBV).
+			__builtin_cpu_init();
+			features.sse41 = __builtin_cpu_supports("sse4.1") != 0;
+			features.avx2 = __builtin_cpu_supports("avx2") != 0;
+			features.fma = __builtin_cpu_supports("fma") != 0;
+			features.avx512f = __builtin_cpu_supports("avx512f") != 0;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+			int registers[4] = {};
+			__cpuid(registers, 0);
+			const int max_leaf = registers[0];
+			__cpuid(registers, 1);
+			features.sse41 = (registers[2] & (1 << 19)) != 0;
+			const bool fma = (registers[2] & (1 << 12)) != 0;
+			const bool os_saves_ymm = (registers[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+			const bool os_saves_zmm = os_saves_ymm && (_xgetbv(0) & 0xE6) == 0xE6;
+			if (max_leaf >= 7)
+			{
+				__cpuidex(registers, 7, 0);
+				features.avx2 = os_saves_ymm && (registers[1] & (1 << 5)) != 0;
+				features.fma = os_saves_ymm && fma;
+				features.avx512f = os_saves_zmm && (registers[1] & (1 << 16)) != 0;
+			}
+#endif
+			return features;
+		}
+
+		std::vector<SkinningKernel> detect_kernels()
+		{
+			[[maybe_unused]] const CpuFeatures cpu = detect_cpu_features();
+			std::vector<SkinningKernel> kernels;
+#if defined(TRANSFORMER_KERNEL_AVX512_FMA)
+			// AVX-512F includes the 512-bit FMA instructions.
+			if (cpu.avx512f)
+			{
+				kernels.push_back({"avx512_fma", &skin_ranges_avx512_fma, false});
+			}
+#endif
+#if defined(TRANSFORMER_KERNEL_AVX512)
+			if (cpu.avx512f)
+			{
+				kernels.push_back({"avx512", &skin_ranges_avx512});
+			}
+#endif
+#if defined(TRANSFORMER_KERNEL_AVX2_FMA)
+			if (cpu.avx2 && cpu.fma)
+			{
+				kernels.push_back({"avx2_fma", &skin_ranges_avx2_fma, false});
+			}
+#endif
+#if defined(TRANSFORMER_KERNEL_AVX2)
+			if (cpu.avx2)
+			{
+				kernels.push_back({"avx2", &skin_ranges_avx2});
+			}
+#endif
+#if defined(TRANSFORMER_KERNEL_SSE41)
+			if (cpu.sse41)
+			{
+				kernels.push_back({"sse41", &skin_ranges_sse41});
+			}
+#endif
+			kernels.push_back({"scalar", &skin_ranges_scalar});
+			return kernels;
+		}
+
+	}  // namespace
+
+	const std::vector<SkinningKernel>& available_skinning_kernels()
+	{
+		static const std::vector<SkinningKernel> kernels = detect_kernels();
+		return kernels;
+	}
+
+	const SkinningKernel& find_skinning_kernel(const std::string& name)
+	{
+		const std::vector<SkinningKernel>& kernels = available_skinning_kernels();
+		if (name.empty() || name == "auto")
+		{
+			// Scalar, the last one, is always deterministic.
+			return *std::find_if(
+					kernels.begin(), kernels.end(), [](const SkinningKernel& kernel) { return kernel.deterministic; });
+		}
+		if (name == "fastest")
+		{
+			return kernels.front();
+		}
+
+		std::string available;
+		for (const SkinningKernel& kernel : kernels)
+		{
+			if (name == kernel.name)
+			{
+				return kernel;
+			}
+			available += available.empty() ? kernel.name : std::string(", ") + kernel.name;
+		}
+		throw std::runtime_error("Skinning kernel '" + name + "' is not available on this machine (available: "
+								 + available + ")");
+	}
+
+	const SkinningKernel* fastest_fused_skinning_kernel()
+	{
+		for (const SkinningKernel& kernel : available_skinning_kernels())
+		{
+			if (!kernel.deterministic)
+			{
+				return &kernel;
+			}
+		}
+		return nullptr;
+	}
+
+}  // namespace transformer
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "skinning/kernels/skin_range.hpp"
+
+#include <string>
+#include <vector>
+
+namespace transformer
+{
+
+	struct SkinningKernel
+	{
+		// "avx512_fma", "avx512", "avx2_fma", "avx2", "sse41" or "scalar"; also the --kernel value and the
+		// stats "kernel" field.
+		const char* name = nullptr;
+		// The variant's loop for every SkinPolicy.
+		const SkinRangeTable* skin_ranges = nullptr;
+		// Same multiplies and adds in the same order as the scalar loop, so the output is bit-identical to
+		// every other deterministic variant at any thread count. False for the fused (_fma) variants.
+		bool deterministic = true;
+	};
+
+	// Variants built into this binary that the CPU (and OS) can run, fastest first; "scalar" is always
+	// last. Detected once, on first use.
+	[[nodiscard]]
+	const std::vector<SkinningKernel>& available_skinning_kernels();
+
+	// The named variant, the fastest deterministic one for an empty name or "auto", or the fastest of all
+	// (fused where the CPU has FMA) for "fastest". Throws std::runtime_error listing the available variants
+	// if the name is unknown or not supported here.
+	[[nodiscard]]
+	const SkinningKernel& find_skinning_kernel(const std::string& name);
+
+	// The fastest variant that is not deterministic, or nullptr if none is available.
+	[[nodiscard]]
+	const SkinningKernel* fastest_fused_skinning_kernel();
+
+}  // namespace transformer
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "core/math_types.hpp"
+#include "skinning/skinning_kernel.hpp"
+
+#include <cstddef>
+#include <utility>
+
+namespace transformer
+{
+
+	// One call of a skinning kernel: count consecutive vertices, their positions either from source or
+	// from a separate (morphed) array, weights always from source.
+	struct SkinRange
+	{
+		const Mesh::Entry* source = nullptr;
+		// Positions to skin instead of source[i].vertex; used by SkinPolicy<..., Morphed = true> only.
+		const Vec3* positions = nullptr;
+		std::size_t count = 0;
+		Mesh::Entry* result = nullptr;
+		// BoundsMode::Mesh and up: widened by every skinned position.
+		Aabb* mesh_bounds = nullptr;
+		// BoundsMode::MeshAndBones: 256 boxes, widened by every skinned position, indexed by the vertex's
+		// dominant bone.
+		Aabb* bone_bounds = nullptr;
+	};
+
+	using SkinRangeFunction = void (*)(const SkinningPalette& palette, const SkinRange& range);
+
+	constexpr std::size_t kMaxInfluences = 4;
+	constexpr std::size_t kBoundsModeCount = 3;
+
+	// Every SkinPolicy instantiation of one kernel variant; MeshSkinner looks its loop up once per call.
+	struct SkinRangeTable
+	{
+		SkinRangeFunction functions[kMaxInfluences][kBoundsModeCount][2]{};
+
+		// influences in [1, kMaxInfluences].
+		[[nodiscard]]
+		SkinRangeFunction find(std::size_t influences, BoundsMode bounds, bool morphed) const
+		{
+			return functions[influences - 1][static_cast<std::size_t>(bounds)][morphed ? 1 : 0];
+		}
+	};
+
+	inline namespace TRANSFORMER_KERNEL_ISA
+	{
+
+		// Compile-time shape of one skinning loop. Each kernel variant instantiates its loop for every
+		// combination (make_skin_range_table), so none of these is tested inside the vertex loop:
+		//   Influences  leading weight slots read per vertex (Mesh::max_influences);
+		//   Bounds      what is collected besides the positions;
+		//   Morphed     positions come from SkinRange::positions instead of the source entries.
+		// Weights are always float and blending is always linear: Mesh has no other encoding or mode.
+		template <std::size_t Influences, BoundsMode Bounds, bool Morphed>
+		struct SkinPolicy
+		{
+			static constexpr std::size_t kInfluences = Influences;
+			static constexpr BoundsMode kBounds = Bounds;
+
+			static const Vec3& position(const SkinRange& range, std::size_t i)
+			{
+				if constexpr (Morphed)
+				{
+					return range.positions[i];
+				}
+				else
+				{
+					return range.source[i].vertex;
+				}
+			}
+		};
+
+		// Plain comparisons rather than std::min/max: a std:: template instantiated here would be shared
+		// with baseline translation units, see skinning_kernel.hpp.
+		inline void widen(Aabb& box, const Vec3& p)
+		{
+			box.min = {p.x < box.min.x ? p.x : box.min.x, p.y < box.min.y ? p.y : box.min.y,
+					   p.z < box.min.z ? p.z : box.min.z};
+			box.max = {p.x > box.max.x ? p.x : box.max.x, p.y > box.max.y ? p.y : box.max.y,
+					   p.z > box.max.z ? p.z : box.max.z};
+		}
+
+		template <template <class> class Loop, std::size_t... Index>
+		constexpr SkinRangeTable make_skin_range_table(std::index_sequence<Index...> /*unused*/)
+		{
+			SkinRangeTable table;
+			((table.functions[Index / (kBoundsModeCount * 2)][Index / 2 % kBoundsModeCount][Index % 2]
+			  = &Loop<SkinPolicy<
+					  Index / (kBoundsModeCount * 2) + 1,
+					  static_cast<BoundsMode>(Index / 2 % kBoundsModeCount),
+					  Index % 2 != 0>>::run),
+			 ...);
+			return table;
+		}
+
+		// Loop<Policy>::run for every SkinPolicy, at compile time.
+		template <template <class> class Loop>
+		constexpr SkinRangeTable make_skin_range_table()
+		{
+			return make_skin_range_table<Loop>(std::make_index_sequence<kMaxInfluences * kBoundsModeCount * 2>());
+		}
+
+	}  // namespace TRANSFORMER_KERNEL_ISA
+
+	// One table per instruction set, each built in its own translation unit with its own target flags
+	// (CMakeLists.txt); only those the compiler supports exist, see TRANSFORMER_KERNEL_*. All of them
+	// produce the same bits as skin_position_scalar, except the _fma ones, which fuse multiply-adds.
+	extern const SkinRangeTable skin_ranges_scalar;
+	extern const SkinRangeTable skin_ranges_sse41;
+	extern const SkinRangeTable skin_ranges_avx2;
+	extern const SkinRangeTable skin_ranges_avx2_fma;
+	extern const SkinRangeTable skin_ranges_avx512;
+	extern const SkinRangeTable skin_ranges_avx512_fma;
+
+}  // namespace transformer
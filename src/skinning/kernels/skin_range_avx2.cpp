@@ -0,0 +1,140 @@
+#include "skinning/kernels/skin_range.hpp"
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		// Two vertices per iteration, one per 128-bit half of a 256-bit register. Every lane sees the
+		// multiplies and adds of skin_position_simd in the same order (no FMA), so results are identical.
+		// Built again as avx2_fma with TRANSFORMER_KERNEL_FUSED, which fuses them: faster, but each fused
+		// multiply-add rounds once instead of twice, so that variant's bits differ.
+		inline __m256 pair(__m128 first, __m128 second)
+		{
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(first), second, 1);
+		}
+
+		template <std::size_t Influences>
+		inline __m256 skin_pair(
+				const SkinningPalette& palette,
+				const Vec3& pa,
+				const VertexBoneWeights& wa,
+				const Vec3& pb,
+				const VertexBoneWeights& wb)
+		{
+			const __m256 xxxx = pair(_mm_set1_ps(pa.x), _mm_set1_ps(pb.x));
+			const __m256 yyyy = pair(_mm_set1_ps(pa.y), _mm_set1_ps(pb.y));
+			const __m256 zzzz = pair(_mm_set1_ps(pa.z), _mm_set1_ps(pb.z));
+
+			__m256 v_acc = _mm256_setzero_ps();
+			for (std::size_t i = 0; i < Influences; ++i)
+			{
+				const Mat4& ma = palette[static_cast<std::uint8_t>(wa.bone_indices[i])];
+				const Mat4& mb = palette[static_cast<std::uint8_t>(wb.bone_indices[i])];
+				const __m256 col0 = _mm256_loadu2_m128(&mb.m[0], &ma.m[0]);
+				const __m256 col1 = _mm256_loadu2_m128(&mb.m[4], &ma.m[4]);
+				const __m256 col2 = _mm256_loadu2_m128(&mb.m[8], &ma.m[8]);
+				const __m256 col3 = _mm256_loadu2_m128(&mb.m[12], &ma.m[12]);
+
+				const __m256 v_weight = pair(_mm_set1_ps(wa.weights[i]), _mm_set1_ps(wb.weights[i]));
+#if defined(TRANSFORMER_KERNEL_FUSED)
+				__m256 res = _mm256_mul_ps(col0, xxxx);
+				res = _mm256_fmadd_ps(col1, yyyy, res);
+				res = _mm256_fmadd_ps(col2, zzzz, res);
+				res = _mm256_add_ps(res, col3);
+				v_acc = _mm256_fmadd_ps(res, v_weight, v_acc);
+#else
+				__m256 res = _mm256_mul_ps(col0, xxxx);
+				res = _mm256_add_ps(res, _mm256_mul_ps(col1, yyyy));
+				res = _mm256_add_ps(res, _mm256_mul_ps(col2, zzzz));
+				res = _mm256_add_ps(res, col3);
+				v_acc = _mm256_add_ps(v_acc, _mm256_mul_ps(res, v_weight));
+#endif
+			}
+			return v_acc;
+		}
+
+		template <class Policy>
+		struct SkinLoop
+		{
+			static void run(const SkinningPalette& palette, const SkinRange& range)
+			{
+				__m256 low = _mm256_setzero_ps();
+				__m256 high = low;
+				if constexpr (Policy::kBounds != BoundsMode::None)
+				{
+					const Aabb& box = *range.mesh_bounds;
+					low = _mm256_setr_ps(
+							box.min.x, box.min.y, box.min.z, 0.0F, box.min.x, box.min.y, box.min.z, 0.0F);
+					high = _mm256_setr_ps(
+							box.max.x, box.max.y, box.max.z, 0.0F, box.max.x, box.max.y, box.max.z, 0.0F);
+				}
+
+				std::size_t i = 0;
+				for (; i + 2 <= range.count; i += 2)
+				{
+					const VertexBoneWeights& wa = range.source[i].bone_weights;
+					const VertexBoneWeights& wb = range.source[i + 1].bone_weights;
+					const __m256 skinned = skin_pair<Policy::kInfluences>(
+							palette, Policy::position(range, i), wa, Policy::position(range, i + 1), wb);
+
+					alignas(32) float lanes[8];
+					_mm256_store_ps(lanes, skinned);
+					range.result[i].vertex = {lanes[0], lanes[1], lanes[2]};
+					range.result[i + 1].vertex = {lanes[4], lanes[5], lanes[6]};
+					if constexpr (Policy::kBounds != BoundsMode::None)
+					{
+						low = _mm256_min_ps(low, skinned);
+						high = _mm256_max_ps(high, skinned);
+					}
+					if constexpr (Policy::kBounds == BoundsMode::MeshAndBones)
+					{
+						widen(range.bone_bounds[dominant_bone(wa)], range.result[i].vertex);
+						widen(range.bone_bounds[dominant_bone(wb)], range.result[i + 1].vertex);
+					}
+				}
+
+				__m128 low_half = _mm_min_ps(_mm256_castps256_ps128(low), _mm256_extractf128_ps(low, 1));
+				__m128 high_half = _mm_max_ps(_mm256_castps256_ps128(high), _mm256_extractf128_ps(high, 1));
+				for (; i < range.count; ++i)
+				{
+					const VertexBoneWeights& bone_weights = range.source[i].bone_weights;
+#if defined(TRANSFORMER_KERNEL_FUSED)
+					// The vertex in both halves of the fused pair: it gets the same bits as in the loop above,
+					// wherever a thread chunk or morph block ends.
+					const Vec3& position = Policy::position(range, i);
+					const __m128 skinned = _mm256_castps256_ps128(skin_pair<Policy::kInfluences>(
+							palette, position, bone_weights, position, bone_weights));
+#else
+					const __m128 skinned = skin_position_simd<Policy::kInfluences>(
+							palette, Policy::position(range, i), bone_weights);
+#endif
+					range.result[i].vertex = to_vec3(skinned);
+					if constexpr (Policy::kBounds != BoundsMode::None)
+					{
+						low_half = _mm_min_ps(low_half, skinned);
+						high_half = _mm_max_ps(high_half, skinned);
+					}
+					if constexpr (Policy::kBounds == BoundsMode::MeshAndBones)
+					{
+						widen(range.bone_bounds[dominant_bone(bone_weights)], range.result[i].vertex);
+					}
+				}
+
+				if constexpr (Policy::kBounds != BoundsMode::None)
+				{
+					*range.mesh_bounds = {to_vec3(low_half), to_vec3(high_half)};
+				}
+			}
+		};
+
+	}  // namespace
+
+#if defined(TRANSFORMER_KERNEL_FUSED)
+	constinit const SkinRangeTable skin_ranges_avx2_fma = make_skin_range_table<SkinLoop>();
+#else
+	constinit const SkinRangeTable skin_ranges_avx2 = make_skin_range_table<SkinLoop>();
+#endif
+
+}  // namespace transformer
@@ -0,0 +1,3 @@
+// The avx2 loop with fused multiply-adds: the same source built with TRANSFORMER_KERNEL_FUSED and its own
+// TRANSFORMER_KERNEL_ISA (CMakeLists.txt), so it defines skin_ranges_avx2_fma instead of skin_ranges_avx2.
+#include "skinning/kernels/skin_range_avx2.cpp"
@@ -0,0 +1,179 @@
+#include "skinning/kernels/skin_range.hpp"
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		// Four vertices per iteration, one per 128-bit lane of a 512-bit register; same per-lane operation
+		// order as skin_position_simd (no FMA), so results are identical. The avx512_fma build
+		// (TRANSFORMER_KERNEL_FUSED) fuses the multiply-adds, like avx2_fma.
+		inline __m512 quad(__m128 a, __m128 b, __m128 c, __m128 d)
+		{
+			const __m512 ab = _mm512_insertf32x4(_mm512_castps128_ps512(a), b, 1);
+			return _mm512_insertf32x4(_mm512_insertf32x4(ab, c, 2), d, 3);
+		}
+
+		inline __m512 load_column(const SkinningPalette& palette, const VertexBoneWeights* const w[4], std::size_t slot,
+				std::size_t column)
+		{
+			const auto load = [&](std::size_t v)
+			{ return _mm_loadu_ps(&palette[static_cast<std::uint8_t>(w[v]->bone_indices[slot])].m[column * 4]); };
+			return quad(load(0), load(1), load(2), load(3));
+		}
+
+		template <std::size_t Influences>
+		inline __m512 skin_quad(
+				const SkinningPalette& palette, const Vec3* const p[4], const VertexBoneWeights* const w[4])
+		{
+			const __m512 xxxx
+					= quad(_mm_set1_ps(p[0]->x), _mm_set1_ps(p[1]->x), _mm_set1_ps(p[2]->x), _mm_set1_ps(p[3]->x));
+			const __m512 yyyy
+					= quad(_mm_set1_ps(p[0]->y), _mm_set1_ps(p[1]->y), _mm_set1_ps(p[2]->y), _mm_set1_ps(p[3]->y));
+			const __m512 zzzz
+					= quad(_mm_set1_ps(p[0]->z), _mm_set1_ps(p[1]->z), _mm_set1_ps(p[2]->z), _mm_set1_ps(p[3]->z));
+
+			__m512 v_acc = _mm512_setzero_ps();
+			for (std::size_t i = 0; i < Influences; ++i)
+			{
+				const __m512 v_weight = quad(
+						_mm_set1_ps(w[0]->weights[i]),
+						_mm_set1_ps(w[1]->weights[i]),
+						_mm_set1_ps(w[2]->weights[i]),
+						_mm_set1_ps(w[3]->weights[i]));
+#if defined(TRANSFORMER_KERNEL_FUSED)
+				__m512 res = _mm512_mul_ps(load_column(palette, w, i, 0), xxxx);
+				res = _mm512_fmadd_ps(load_column(palette, w, i, 1), yyyy, res);
+				res = _mm512_fmadd_ps(load_column(palette, w, i, 2), zzzz, res);
+				res = _mm512_add_ps(res, load_column(palette, w, i, 3));
+				v_acc = _mm512_fmadd_ps(res, v_weight, v_acc);
+#else
+				__m512 res = _mm512_mul_ps(load_column(palette, w, i, 0), xxxx);
+				res = _mm512_add_ps(res, _mm512_mul_ps(load_column(palette, w, i, 1), yyyy));
+				res = _mm512_add_ps(res, _mm512_mul_ps(load_column(palette, w, i, 2), zzzz));
+				res = _mm512_add_ps(res, load_column(palette, w, i, 3));
+				v_acc = _mm512_add_ps(v_acc, _mm512_mul_ps(res, v_weight));
+#endif
+			}
+			return v_acc;
+		}
+
+		template <class Policy>
+		struct SkinLoop
+		{
+			static void run(const SkinningPalette& palette, const SkinRange& range)
+			{
+				__m128 low = _mm_setzero_ps();
+				__m128 high = low;
+				if constexpr (Policy::kBounds != BoundsMode::None)
+				{
+					const Aabb& box = *range.mesh_bounds;
+					low = _mm_setr_ps(box.min.x, box.min.y, box.min.z, 0.0F);
+					high = _mm_setr_ps(box.max.x, box.max.y, box.max.z, 0.0F);
+				}
+				__m512 wide_low = quad(low, low, low, low);
+				__m512 wide_high = quad(high, high, high, high);
+
+				std::size_t i = 0;
+				for (; i + 4 <= range.count; i += 4)
+				{
+					const Vec3* const positions[4] = {
+							&Policy::position(range, i),
+							&Policy::position(range, i + 1),
+							&Policy::position(range, i + 2),
+							&Policy::position(range, i + 3),
+					};
+					const VertexBoneWeights* const weights[4] = {
+							&range.source[i].bone_weights,
+							&range.source[i + 1].bone_weights,
+							&range.source[i + 2].bone_weights,
+							&range.source[i + 3].bone_weights,
+					};
+					const __m512 skinned = skin_quad<Policy::kInfluences>(palette, positions, weights);
+
+					alignas(64) float lanes[16];
+					_mm512_store_ps(lanes, skinned);
+					for (std::size_t v = 0; v < 4; ++v)
+					{
+						range.result[i + v].vertex = {lanes[v * 4], lanes[v * 4 + 1], lanes[v * 4 + 2]};
+					}
+					if constexpr (Policy::kBounds != BoundsMode::None)
+					{
+						wide_low = _mm512_min_ps(wide_low, skinned);
+						wide_high = _mm512_max_ps(wide_high, skinned);
+					}
+					if constexpr (Policy::kBounds == BoundsMode::MeshAndBones)
+					{
+						for (std::size_t v = 0; v < 4; ++v)
+						{
+							widen(range.bone_bounds[dominant_bone(*weights[v])], range.result[i + v].vertex);
+						}
+					}
+				}
+
+				if constexpr (Policy::kBounds != BoundsMode::None)
+				{
+					alignas(64) float lows[16];
+					alignas(64) float highs[16];
+					_mm512_store_ps(lows, wide_low);
+					_mm512_store_ps(highs, wide_high);
+					for (std::size_t v = 0; v < 4; ++v)
+					{
+						low = _mm_min_ps(low, _mm_load_ps(lows + v * 4));
+						high = _mm_max_ps(high, _mm_load_ps(highs + v * 4));
+					}
+				}
+
+				for (; i < range.count; ++i)
+				{
+					const VertexBoneWeights& bone_weights = range.source[i].bone_weights;
+#if defined(TRANSFORMER_KERNEL_FUSED)
+					// The vertex in all four lanes of the fused quad, so its bits do not depend on where a
+					// thread chunk or morph block ends (see skin_range_avx2.cpp).
+					const Vec3* const positions[4] = {
+							&Policy::position(range, i),
+							&Policy::position(range, i),
+							&Policy::position(range, i),
+							&Policy::position(range, i),
+					};
+					const VertexBoneWeights* const weights[4] = {
+							&bone_weights,
+							&bone_weights,
+							&bone_weights,
+							&bone_weights,
+					};
+					const __m128 skinned
+							= _mm512_castps512_ps128(skin_quad<Policy::kInfluences>(palette, positions, weights));
+#else
+					const __m128 skinned = skin_position_simd<Policy::kInfluences>(
+							palette, Policy::position(range, i), bone_weights);
+#endif
+					range.result[i].vertex = to_vec3(skinned);
+					if constexpr (Policy::kBounds != BoundsMode::None)
+					{
+						low = _mm_min_ps(low, skinned);
+						high = _mm_max_ps(high, skinned);
+					}
+					if constexpr (Policy::kBounds == BoundsMode::MeshAndBones)
+					{
+						widen(range.bone_bounds[dominant_bone(bone_weights)], range.result[i].vertex);
+					}
+				}
+
+				if constexpr (Policy::kBounds != BoundsMode::None)
+				{
+					*range.mesh_bounds = {to_vec3(low), to_vec3(high)};
+				}
+			}
+		};
+
+	}  // namespace
+
+#if defined(TRANSFORMER_KERNEL_FUSED)
+	constinit const SkinRangeTable skin_ranges_avx512_fma = make_skin_range_table<SkinLoop>();
+#else
+	constinit const SkinRangeTable skin_ranges_avx512 = make_skin_range_table<SkinLoop>();
+#endif
+
+}  // namespace transformer
@@ -0,0 +1,3 @@
+// The avx512 loop with fused multiply-adds: the same source built with TRANSFORMER_KERNEL_FUSED and its own
+// TRANSFORMER_KERNEL_ISA (CMakeLists.txt), so it defines skin_ranges_avx512_fma instead of skin_ranges_avx512.
+#include "skinning/kernels/skin_range_avx512.cpp"
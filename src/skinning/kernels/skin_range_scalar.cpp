@@ -0,0 +1,36 @@
+#include "skinning/kernels/skin_range.hpp"
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		template <class Policy>
+		struct SkinLoop
+		{
+			static void run(const SkinningPalette& palette, const SkinRange& range)
+			{
+				for (std::size_t i = 0; i < range.count; ++i)
+				{
+					const VertexBoneWeights& bone_weights = range.source[i].bone_weights;
+					const Vec3 skinned = skin_position_scalar<Policy::kInfluences>(
+							palette, Policy::position(range, i), bone_weights);
+					range.result[i].vertex = skinned;
+					if constexpr (Policy::kBounds != BoundsMode::None)
+					{
+						widen(*range.mesh_bounds, skinned);
+					}
+					if constexpr (Policy::kBounds == BoundsMode::MeshAndBones)
+					{
+						widen(range.bone_bounds[dominant_bone(bone_weights)], skinned);
+					}
+				}
+			}
+		};
+
+	}  // namespace
+
+	constinit const SkinRangeTable skin_ranges_scalar = make_skin_range_table<SkinLoop>();
+
+}  // namespace transformer
@@ -0,0 +1,55 @@
+#include "skinning/kernels/skin_range.hpp"
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		// The original kernel, one vertex per 128-bit register; built with -msse4.1 so the lane packing
+		// (set/insert of the position and the mesh box) can use insertps. The mesh box lives in two
+		// running min/max registers.
+		template <class Policy>
+		struct SkinLoop
+		{
+			static void run(const SkinningPalette& palette, const SkinRange& range)
+			{
+				__m128 low = _mm_setzero_ps();
+				__m128 high = low;
+				if constexpr (Policy::kBounds != BoundsMode::None)
+				{
+					const Aabb& box = *range.mesh_bounds;
+					low = _mm_setr_ps(box.min.x, box.min.y, box.min.z, 0.0F);
+					high = _mm_setr_ps(box.max.x, box.max.y, box.max.z, 0.0F);
+				}
+
+				for (std::size_t i = 0; i < range.count; ++i)
+				{
+					const VertexBoneWeights& bone_weights = range.source[i].bone_weights;
+					const __m128 skinned = skin_position_simd<Policy::kInfluences>(
+							palette, Policy::position(range, i), bone_weights);
+					const Vec3 position = to_vec3(skinned);
+					range.result[i].vertex = position;
+					if constexpr (Policy::kBounds != BoundsMode::None)
+					{
+						low = _mm_min_ps(low, skinned);
+						high = _mm_max_ps(high, skinned);
+					}
+					if constexpr (Policy::kBounds == BoundsMode::MeshAndBones)
+					{
+						widen(range.bone_bounds[dominant_bone(bone_weights)], position);
+					}
+				}
+
+				if constexpr (Policy::kBounds != BoundsMode::None)
+				{
+					*range.mesh_bounds = {to_vec3(low), to_vec3(high)};
+				}
+			}
+		};
+
+	}  // namespace
+
+	constinit const SkinRangeTable skin_ranges_sse41 = make_skin_range_table<SkinLoop>();
+
+}  // namespace transformer
@@ -0,0 +1,335 @@
+#include "skinning/mesh_optimizer.hpp"
+
+#include "core/profiler.hpp"
+#include "skinning/skinning_kernel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		constexpr std::size_t kVertexCacheSize = 32;
+		constexpr std::uint32_t kNotInCache = std::numeric_limits<std::uint32_t>::max();
+
+		// Counting sort by dominant bone. Stable, so file order (usually spatially coherent) is kept
+		// inside every cluster.
+		std::vector<std::uint32_t> cluster_by_dominant_bone(const Mesh& mesh, std::size_t& cluster_count)
+		{
+			std::array<std::size_t, 257> offsets{};
+			std::vector<std::uint8_t> keys(mesh.vertex_count);
+			for (std::size_t vertex_index = 0; vertex_index < mesh.vertex_count; ++vertex_index)
+			{
+				keys[vertex_index] = dominant_bone(mesh.entries[vertex_index].bone_weights);
+				++offsets[keys[vertex_index] + 1];
+			}
+
+			cluster_count = 0;
+			for (std::size_t bone = 0; bone < 256; ++bone)
+			{
+				cluster_count += offsets[bone + 1] != 0 ? 1 : 0;
+				offsets[bone + 1] += offsets[bone];
+			}
+
+			std::vector<std::uint32_t> order(mesh.vertex_count);
+			for (std::size_t vertex_index = 0; vertex_index < mesh.vertex_count; ++vertex_index)
+			{
+				order[offsets[keys[vertex_index]]++] = static_cast<std::uint32_t>(vertex_index);
+			}
+			return order;
+		}
+
+		float vertex_cache_score(std::uint32_t cache_position, std::uint32_t remaining_triangles)
+		{
+			// Constants from Tom Forsyth, "Linear-Speed Vertex Cache Optimisation".
+			constexpr float kLastTriangleScore = 0.75F;
+			constexpr float kCacheDecayPower = 1.5F;
+			constexpr float kValenceBoostScale = 2.0F;
+			constexpr float kValenceBoostPower = 0.5F;
+
+			if (remaining_triangles == 0)
+			{
+				return -1.0F;
+			}
+
+			float score = 0.0F;
+			if (cache_position != kNotInCache)
+			{
+				if (cache_position < 3)
+				{
+					// The triangle just emitted: not worth re-using right away, just slightly favoured.
+					score = kLastTriangleScore;
+				}
+				else
+				{
+					const float scaler = 1.0F / static_cast<float>(kVertexCacheSize - 3);
+					score = std::pow(1.0F - static_cast<float>(cache_position - 3) * scaler, kCacheDecayPower);
+				}
+			}
+
+			// Boost vertices with few triangles left so they get finished off instead of being orphaned.
+			score += kValenceBoostScale
+				   * std::pow(static_cast<float>(remaining_triangles), -kValenceBoostPower);
+			return score;
+		}
+
+		// Returns the emitted triangle order (indices into the input triangle list).
+		std::vector<std::uint32_t> optimize_triangle_order(
+				const std::vector<std::uint32_t>& indices, std::size_t vertex_count)
+		{
+			const std::size_t triangle_count = indices.size() / 3;
+
+			// Vertex -> triangles adjacency (CSR). The live part of every list shrinks as triangles are emitted.
+			std::vector<std::uint32_t> adjacency_offsets(vertex_count + 1, 0);
+			for (const std::uint32_t index : indices)
+			{
+				++adjacency_offsets[index + 1];
+			}
+			for (std::size_t v = 0; v < vertex_count; ++v)
+			{
+				adjacency_offsets[v + 1] += adjacency_offsets[v];
+			}
+
+			std::vector<std::uint32_t> live_triangles(vertex_count, 0);
+			std::vector<std::uint32_t> adjacency(indices.size());
+			for (std::size_t i = 0; i < indices.size(); ++i)
+			{
+				const std::uint32_t v = indices[i];
+				adjacency[adjacency_offsets[v] + live_triangles[v]++] = static_cast<std::uint32_t>(i / 3);
+			}
+
+			std::vector<std::uint32_t> cache_position(vertex_count, kNotInCache);
+			std::vector<float> vertex_score(vertex_count);
+			for (std::size_t v = 0; v < vertex_count; ++v)
+			{
+				vertex_score[v] = vertex_cache_score(kNotInCache, live_triangles[v]);
+			}
+
+			std::vector<float> triangle_score(triangle_count);
+			std::vector<bool> emitted(triangle_count, false);
+			for (std::size_t t = 0; t < triangle_count; ++t)
+			{
+				triangle_score[t] = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]]
+								  + vertex_score[indices[t * 3 + 2]];
+			}
+
+			std::vector<std::uint32_t> cache;
+			std::vector<std::uint32_t> next_cache;
+			cache.reserve(kVertexCacheSize + 3);
+			next_cache.reserve(kVertexCacheSize + 3);
+
+			std::vector<std::uint32_t> order;
+			order.reserve(triangle_count);
+
+			std::size_t scan_cursor = 0;
+			std::size_t best_triangle = triangle_count;
+			float best_score = -1.0F;
+			for (std::size_t t = 0; t < triangle_count; ++t)
+			{
+				if (triangle_score[t] > best_score)
+				{
+					best_score = triangle_score[t];
+					best_triangle = t;
+				}
+			}
+
+			while (order.size() < triangle_count)
+			{
+				if (best_triangle == triangle_count)
+				{
+					// Nothing adjacent to the cache is left: continue with the next unemitted triangle.
+					while (emitted[scan_cursor])
+					{
+						++scan_cursor;
+					}
+					best_triangle = scan_cursor;
+				}
+
+				emitted[best_triangle] = true;
+				order.push_back(static_cast<std::uint32_t>(best_triangle));
+
+				next_cache.clear();
+				for (std::size_t corner = 0; corner < 3; ++corner)
+				{
+					const std::uint32_t v = indices[best_triangle * 3 + corner];
+					next_cache.push_back(v);
+
+					// Remove the emitted triangle from the live part of the vertex adjacency list.
+					const std::uint32_t begin = adjacency_offsets[v];
+					const std::uint32_t end = begin + live_triangles[v];
+					for (std::uint32_t a = begin; a < end; ++a)
+					{
+						if (adjacency[a] == best_triangle)
+						{
+							adjacency[a] = adjacency[end - 1];
+							--live_triangles[v];
+							break;
+						}
+					}
+				}
+				for (const std::uint32_t v : cache)
+				{
+					if (v != next_cache[0] && v != next_cache[1] && v != next_cache[2])
+					{
+						next_cache.push_back(v);
+					}
+				}
+
+				for (std::size_t i = 0; i < next_cache.size(); ++i)
+				{
+					const std::uint32_t v = next_cache[i];
+					cache_position[v] = i < kVertexCacheSize ? static_cast<std::uint32_t>(i) : kNotInCache;
+					vertex_score[v] = vertex_cache_score(cache_position[v], live_triangles[v]);
+				}
+
+				best_triangle = triangle_count;
+				best_score = -1.0F;
+				for (const std::uint32_t v : next_cache)
+				{
+					const std::uint32_t begin = adjacency_offsets[v];
+					const std::uint32_t end = begin + live_triangles[v];
+					for (std::uint32_t a = begin; a < end; ++a)
+					{
+						const std::uint32_t t = adjacency[a];
+						triangle_score[t] = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]]
+										  + vertex_score[indices[t * 3 + 2]];
+						if (triangle_score[t] > best_score)
+						{
+							best_score = triangle_score[t];
+							best_triangle = t;
+						}
+					}
+				}
+
+				if (next_cache.size() > kVertexCacheSize)
+				{
+					next_cache.resize(kVertexCacheSize);
+				}
+				cache.swap(next_cache);
+			}
+
+			return order;
+		}
+
+	}  // namespace
+
+	double compute_acmr(const std::vector<std::uint32_t>& indices, std::size_t vertex_count, std::size_t cache_size)
+	{
+		const std::size_t triangle_count = indices.size() / 3;
+		if (triangle_count == 0)
+		{
+			return 0.0;
+		}
+
+		// FIFO cache: a vertex is resident while fewer than cache_size misses happened since it was loaded.
+		constexpr std::size_t kNeverLoaded = std::numeric_limits<std::size_t>::max();
+		std::vector<std::size_t> loaded_at(vertex_count, kNeverLoaded);
+		std::size_t misses = 0;
+		for (const std::uint32_t index : indices)
+		{
+			if (loaded_at[index] == kNeverLoaded || misses - loaded_at[index] >= cache_size)
+			{
+				loaded_at[index] = misses;
+				++misses;
+			}
+		}
+
+		return static_cast<double>(misses) / static_cast<double>(triangle_count);
+	}
+
+	MeshLayoutStats optimize_mesh_layout(Mesh& mesh, Profiler& profiler)
+	{
+		const auto scope = profiler.stage("optimize_mesh_layout");
+
+		if (mesh.indices.size() % 3 != 0)
+		{
+			throw std::runtime_error("Mesh layout optimization requires a triangulated index buffer");
+		}
+		for (const std::uint32_t index : mesh.indices)
+		{
+			if (index >= mesh.vertex_count)
+			{
+				throw std::runtime_error("Mesh layout optimization: face references a vertex out of range");
+			}
+		}
+
+		MeshLayoutStats stats;
+		stats.acmr_before = compute_acmr(mesh.indices, mesh.vertex_count);
+
+		// 1. Vertex order
+		const std::vector<std::uint32_t> vertex_order = cluster_by_dominant_bone(mesh, stats.bone_clusters);
+
+		Mesh::Entries entries(mesh.vertex_count);
+		std::vector<std::uint32_t> vertex_source_index(mesh.vertex_count);
+		std::vector<std::uint32_t> new_position(mesh.vertex_count);
+		for (std::size_t stored = 0; stored < mesh.vertex_count; ++stored)
+		{
+			const std::uint32_t previous = vertex_order[stored];
+			entries[stored] = mesh.entries[previous];
+			vertex_source_index[stored]
+					= mesh.vertex_source_index.empty() ? previous : mesh.vertex_source_index[previous];
+			new_position[previous] = static_cast<std::uint32_t>(stored);
+		}
+
+		for (std::uint32_t& index : mesh.indices)
+		{
+			index = new_position[index];
+		}
+
+		// Morph targets follow their vertices and are re-sorted for the skinning loop's cursors.
+		for (MorphTarget& morph_target : mesh.morph_targets)
+		{
+			std::vector<std::uint32_t> order(morph_target.vertex_indices.size());
+			std::iota(order.begin(), order.end(), 0U);
+			std::sort(
+					order.begin(),
+					order.end(),
+					[&](std::uint32_t a, std::uint32_t b)
+					{
+						return new_position[morph_target.vertex_indices[a]]
+							   < new_position[morph_target.vertex_indices[b]];
+					});
+
+			MorphTarget remapped;
+			remapped.vertex_indices.reserve(order.size());
+			remapped.deltas.reserve(order.size());
+			for (const std::uint32_t i : order)
+			{
+				remapped.vertex_indices.push_back(new_position[morph_target.vertex_indices[i]]);
+				remapped.deltas.push_back(morph_target.deltas[i]);
+			}
+			morph_target = std::move(remapped);
+		}
+
+		// 2. Triangle order
+		const std::vector<std::uint32_t> triangle_order = optimize_triangle_order(mesh.indices, mesh.vertex_count);
+
+		std::vector<std::uint32_t> indices(mesh.indices.size());
+		std::vector<std::uint32_t> triangle_source_index(triangle_order.size());
+		for (std::size_t stored = 0; stored < triangle_order.size(); ++stored)
+		{
+			const std::uint32_t previous = triangle_order[stored];
+			indices[stored * 3] = mesh.indices[previous * 3];
+			indices[stored * 3 + 1] = mesh.indices[previous * 3 + 1];
+			indices[stored * 3 + 2] = mesh.indices[previous * 3 + 2];
+			triangle_source_index[stored]
+					= mesh.triangle_source_index.empty() ? previous : mesh.triangle_source_index[previous];
+		}
+
+		mesh.entries = std::move(entries);
+		mesh.indices = std::move(indices);
+		mesh.vertex_source_index = std::move(vertex_source_index);
+		mesh.triangle_source_index = std::move(triangle_source_index);
+
+		stats.acmr_after = compute_acmr(mesh.indices, mesh.vertex_count);
+		return stats;
+	}
+
+}  // namespace transformer
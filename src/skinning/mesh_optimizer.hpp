@@ -0,0 +1,34 @@
+#pragma once
+
+#include "core/math_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace transformer
+{
+
+	class Profiler;
+
+	struct MeshLayoutStats
+	{
+		std::size_t bone_clusters = 0;
+		double acmr_before = 0.0;
+		double acmr_after = 0.0;
+	};
+
+	// Offline layout pass, run once after bone weights are merged into Mesh::entries:
+	// 1. Vertices are clustered by dominant bone, so consecutive vertices in the skinning loop hit the
+	//    same palette matrices.
+	// 2. Triangles are reordered for post-transform vertex cache reuse (Forsyth's linear-speed algorithm)
+	//    and rewritten against the new vertex order.
+	// The applied permutation is kept in Mesh::vertex_source_index / Mesh::triangle_source_index.
+	MeshLayoutStats optimize_mesh_layout(Mesh& mesh, Profiler& profiler);
+
+	// Average cache miss ratio (transformed vertices per triangle) of an index buffer for a FIFO cache.
+	[[nodiscard]]
+	double compute_acmr(
+			const std::vector<std::uint32_t>& indices, std::size_t vertex_count, std::size_t cache_size = 32);
+
+}  // namespace transformer
@@ -1,131 +1,235 @@
 #include "skinning/mesh_skinner.hpp"
 
-#include "core/math_utils.hpp"
+#include "core/chunk_threads.hpp"
 #include "core/profiler.hpp"
+#include "core/vertex_buffer.hpp"
+#include "skinning/kernels/kernel_registry.hpp"
+#include "skinning/skinning_cache.hpp"
+#include "skinning/skinning_kernel.hpp"
 
-// Non cross-platform
-#include <immintrin.h>	// SIMD
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <utility>
 
 namespace transformer
 {
 
+	namespace
+	{
+
+		// Below this, waking the skinning threads costs more than the pass.
+		constexpr std::size_t kMinParallelVertices = 16384;
+
+		void merge_box(Aabb& box, const Aabb& other)
+		{
+			if (!other.empty())
+			{
+				widen(box, other.min);
+				widen(box, other.max);
+			}
+		}
+
+	}  // namespace
+
+	MeshSkinner::MeshSkinner() :
+			kernel_(&find_skinning_kernel({}))
+	{
+	}
+
+	MeshSkinner::MeshSkinner(const SkinningKernel& kernel, SkinningCache* cache) :
+			kernel_(&kernel),
+			cache_(cache)
+	{
+	}
+
+	const char* MeshSkinner::kernel_name() const
+	{
+		return kernel_->name;
+	}
+
+	const SkinningKernel& MeshSkinner::kernel() const
+	{
+		return *kernel_;
+	}
+
+	SkinningCache* MeshSkinner::cache() const
+	{
+		return cache_;
+	}
+
 	void MeshSkinner::skin(
 			const Mesh& source_mesh, const BonePoseData& bone_pose_data, Profiler& profiler, Mesh& result_mesh) const
+	{
+		skin(source_mesh, bone_pose_data, {}, profiler, result_mesh);
+	}
+
+	void MeshSkinner::skin(
+			const Mesh& source_mesh,
+			const BonePoseData& bone_pose_data,
+			const std::vector<float>& morph_weights,
+			Profiler& profiler,
+			Mesh& result_mesh) const
+	{
+		SkinnedBounds unused;
+		skin(source_mesh, bone_pose_data, morph_weights, profiler, result_mesh, BoundsMode::None, unused);
+	}
+
+	void MeshSkinner::skin(
+			const Mesh& source_mesh,
+			const BonePoseData& bone_pose_data,
+			const std::vector<float>& morph_weights,
+			Profiler& profiler,
+			Mesh& result_mesh,
+			BoundsMode bounds_mode,
+			SkinnedBounds& bounds) const
 	{
 		const auto scope = profiler.stage("cpu_skinning");
 
+		const bool morphed = !MorphAccumulator(source_mesh.morph_targets, morph_weights).empty();
+		const bool cache_output = cache_ != nullptr && cache_->caches_outputs() && source_mesh.content_key != 0
+								  && !morphed && bounds_mode == BoundsMode::None;
+		if (cache_output)
+		{
+			const std::shared_ptr<const std::vector<Vec3>> cached
+					= cache_->find_output(source_mesh.content_key, bone_pose_data);
+			if (cached != nullptr)
+			{
+				for (std::size_t i = 0; i < cached->size(); ++i)
+				{
+					result_mesh.entries[i].vertex = (*cached)[i];
+				}
+				return;
+			}
+		}
+
 		// 1. Precompute skinning matrices for each bone to avoid redundant multiplications
 		// 2. Another trick is is to use last matrix as empty one (255) with identity values to avoid branching
-		auto skinning_matrices = std::make_unique<std::array<Mat4, 256>>();
-		std::array<Mat4, 256>& precomputed_skinning_matrixes = *skinning_matrices;
-		for (std::size_t bone_index = 0; bone_index < bone_pose_data.bone_poses.size(); ++bone_index)
+		std::shared_ptr<const SkinningPalette> skinning_matrices;
+		if (cache_ != nullptr)
 		{
-			precomputed_skinning_matrixes[bone_index]
-					= multiply(bone_pose_data.bone_poses[bone_index][1], bone_pose_data.bone_poses[bone_index][0]);
+			skinning_matrices = cache_->palette(bone_pose_data);
 		}
-
-		for (std::size_t vertex_index = 0; vertex_index < source_mesh.vertex_count; ++vertex_index)
+		else
 		{
-			const Mesh::Entry& source_entry = source_mesh.entries[vertex_index];
-			const Vec3& sp = source_entry.vertex;
-			const VertexBoneWeights& vertex_bone_weights = source_entry.bone_weights;
+			auto palette = std::make_shared<SkinningPalette>();
+			build_palette(*palette, bone_pose_data);
+			skinning_matrices = std::move(palette);
+		}
+		const SkinningPalette& precomputed_skinning_matrixes = *skinning_matrices;
 
-			// SIMD: Accumulator for weighted positions: [X, Y, Z, 0.0]
-			__m128 v_acc = _mm_setzero_ps();
+		// The loop instantiated for this mesh, bounds mode and position source; nothing below is decided
+		// per vertex.
+		const std::size_t influences = std::clamp<std::size_t>(source_mesh.max_influences, 1, kMaxInfluences);
+		const SkinRangeFunction skin_block = kernel_->skin_ranges->find(influences, bounds_mode, morphed);
 
-			// Instead of Vec4 we can use 3 separate floats as we ignore w bevause of being sure sum of weights is 1
-			float blended_position_x = 0.0F;
-			float blended_position_y = 0.0F;
-			float blended_position_z = 0.0F;
+		// Skins vertices [begin, end) into the given boxes.
+		const auto skin_span = [&](std::size_t begin, std::size_t end, Aabb& mesh_box, std::vector<Aabb>& bone_boxes)
+		{
+			SkinRange range{
+					.source = source_mesh.entries.data() + begin,
+					.count = end - begin,
+					.result = result_mesh.entries.data() + begin,
+			};
+			if (bounds_mode != BoundsMode::None)
+			{
+				range.mesh_bounds = &mesh_box;
+			}
+			if (bounds_mode == BoundsMode::MeshAndBones)
+			{
+				bone_boxes.resize(256);
+				range.bone_bounds = bone_boxes.data();
+			}
 
-			// As soon as we sure weights' sum is always 1 we better skip branching
-			// and run over all 4 bones to make zero vector to add to blended one
-			for (std::size_t i = 0; i < 4; ++i)
+			if (!morphed)
 			{
-				// We prepared data to be -1 in case of unused bone slot, so we can just cast it to uint8_t to get 255 index for zero matrix
-				const auto safe_bone_index = static_cast<std::uint8_t>(vertex_bone_weights.bone_indices[i]);
-				const float weight = vertex_bone_weights.weights[i];
-
-				// We remove this branching because of being sure our weights' sum is always 1
-				//if (bone_index < 0 || weight <= 0.0F)
-				//{
-				//    continue;
-				//}
-
-				// We can ignore full Ve4
-				const Mat4& sm = precomputed_skinning_matrixes[safe_bone_index];
-
-				// We can ignore full 4 dimension multiplication now
-				//const Vec4 transformed_position = multiply(skinning_matrix, source_position_h);
-				//blended_position.x += transformed_position.x * weight;
-				//blended_position.y += transformed_position.y * weight;
-				//blended_position.z += transformed_position.z * weight;
-				//blended_position.w += transformed_position.w * weight;
-
-				// In favor of lightier option without W
-				// And we remove this block in favor of SIMD
-				//const float tx = sm.m[0] * sp.x + sm.m[4] * sp.y + sm.m[8] * sp.z  + sm.m[12];
-				//const float ty = sm.m[1] * sp.x + sm.m[5] * sp.y + sm.m[9] * sp.z  + sm.m[13];
-				//const float tz = sm.m[2] * sp.x + sm.m[6] * sp.y + sm.m[10] * sp.z + sm.m[14];
-				//blended_position_x += tx * weight;
-				//blended_position_y += ty * weight;
-				//blended_position_z += tz * weight;
-
-				// SIMD:
-				// Load columns of the matrix
-				// Columns represent the transformed basis vectors and translation
-				__m128 col0 = _mm_loadu_ps(&sm.m[0]);	// Basis X
-				__m128 col1 = _mm_loadu_ps(&sm.m[4]);	// Basis Y
-				__m128 col2 = _mm_loadu_ps(&sm.m[8]);	// Basis Z
-				__m128 col3 = _mm_loadu_ps(&sm.m[12]);	// Translation
-
-				// Replicate (splat) coordinates to all 4 SIMD lanes
-				__m128 xxxx = _mm_set1_ps(sp.x);
-				__m128 yyyy = _mm_set1_ps(sp.y);
-				__m128 zzzz = _mm_set1_ps(sp.z);
-
-				// Matrix * Vector (Point) multiplication:
-				// Result = Col0*X + Col1*Y + Col2*Z + Col3 (since W=1.0)
-				__m128 res = _mm_mul_ps(col0, xxxx);
-				res = _mm_add_ps(res, _mm_mul_ps(col1, yyyy));
-				res = _mm_add_ps(res, _mm_mul_ps(col2, zzzz));
-				res = _mm_add_ps(res, col3);
-
-				// Multiply the result by bone weight and add to accumulator
-				__m128 v_weight = _mm_set1_ps(weight);
-				v_acc = _mm_add_ps(v_acc, _mm_mul_ps(res, v_weight));
-
-				// no more accumulated weight
-				//accumulated_weight += weight;
+				skin_block(precomputed_skinning_matrixes, range);
+				return;
 			}
+			MorphAccumulator morphs(source_mesh.morph_targets, morph_weights);
+			morphs.seek(static_cast<std::uint32_t>(begin));
+			// Small enough that the morphed block is still in L1 when it is skinned.
+			constexpr std::size_t kMorphBlock = 256;
+			std::array<Vec3, kMorphBlock> positions;
+			for (std::size_t block_start = begin; block_start < end; block_start += kMorphBlock)
+			{
+				const std::size_t count = std::min(kMorphBlock, end - block_start);
+				const Mesh::Entry* source_entries = source_mesh.entries.data() + block_start;
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					positions[i] = source_entries[i].vertex;
+				}
+
+				morphs.apply(static_cast<std::uint32_t>(block_start), count, positions.data());
+
+				range.source = source_entries;
+				range.positions = positions.data();
+				range.count = count;
+				range.result = result_mesh.entries.data() + block_start;
+				skin_block(precomputed_skinning_matrixes, range);
+			}
+		};
 
-			// No more accumulated weight
-			//if (accumulated_weight <= 0.0F)
-			//{
-			//    result_mesh.entries[vertex_index].vertex = source_position;
-			//    continue;
-			//}
-
-			// Even no more normalization because of this weights' sum 1
-			//const float normalization_scale = 1.0F / accumulated_weight;
-			//blended_position.x *= normalization_scale;
-			//blended_position.y *= normalization_scale;
-			//blended_position.z *= normalization_scale;
-			//blended_position.w *= normalization_scale;
-
-			// Instead just a simple adding (assume some of the positions can be zero because of zero weights, but it doesn't matter for us)
-
-			// Remove the division operation as well
-			//result_mesh.entries[vertex_index].vertex = divide_by_w(blended_position);
-			// And again remove this code in favor of SIMD result
-			//result_mesh.entries[vertex_index].vertex = {blended_position_x, blended_position_y, blended_position_z};
-
-			// SIMD
-			// Write back to mesh (extracting X, Y, Z)
-			alignas(16) float final_pos[4];
-			_mm_store_ps(final_pos, v_acc);
-			result_mesh.entries[vertex_index].vertex = {final_pos[0], final_pos[1], final_pos[2]};
+		Aabb mesh_box;
+		std::vector<Aabb> bone_boxes;
+		ChunkThreads* threads = vertex_buffer_threads();
+		if (threads == nullptr || source_mesh.vertex_count < kMinParallelVertices)
+		{
+			skin_span(0, source_mesh.vertex_count, mesh_box, bone_boxes);
+		}
+		else
+		{
+			// Same split as the first touch of the buffers, so each thread skins the pages it placed.
+			std::vector<Aabb> chunk_mesh_boxes(threads->thread_count());
+			std::vector<std::vector<Aabb>> chunk_bone_boxes(threads->thread_count());
+			threads->run(
+					source_mesh.vertex_count,
+					[&](std::size_t chunk, std::size_t begin, std::size_t end)
+					{ skin_span(begin, end, chunk_mesh_boxes[chunk], chunk_bone_boxes[chunk]); });
+			for (std::size_t chunk = 0; chunk < threads->thread_count(); ++chunk)
+			{
+				merge_box(mesh_box, chunk_mesh_boxes[chunk]);
+				bone_boxes.resize(std::max(bone_boxes.size(), chunk_bone_boxes[chunk].size()));
+				for (std::size_t bone = 0; bone < chunk_bone_boxes[chunk].size(); ++bone)
+				{
+					merge_box(bone_boxes[bone], chunk_bone_boxes[chunk][bone]);
+				}
+			}
+		}
+
+		if (bounds_mode != BoundsMode::None)
+		{
+			bounds.mesh = mesh_box;
+			const std::size_t bone_count = std::min(bone_boxes.size(), bone_pose_data.bone_poses.size());
+			bounds.bones.assign(bone_boxes.begin(), bone_boxes.begin() + static_cast<std::ptrdiff_t>(bone_count));
+		}
+		if (cache_output)
+		{
+			cache_->store_output(source_mesh.content_key, bone_pose_data, result_mesh);
+		}
+	}
+
+	void MeshSkinner::skin_entries(
+			const SkinningPalette& palette,
+			const Mesh::Entry* source,
+			Mesh::Entry* result,
+			std::size_t count,
+			std::size_t max_influences,
+			ChunkThreads* threads) const
+	{
+		const std::size_t influences = std::clamp<std::size_t>(max_influences, 1, kMaxInfluences);
+		const SkinRangeFunction skin_block = kernel_->skin_ranges->find(influences, BoundsMode::None, false);
+		const auto skin_span = [&](std::size_t begin, std::size_t end)
+		{
+			skin_block(palette, {.source = source + begin, .count = end - begin, .result = result + begin});
+		};
+
+		if (threads == nullptr || count < kMinParallelVertices)
+		{
+			skin_span(0, count);
+			return;
 		}
+		threads->run(count, [&](std::size_t /*chunk*/, std::size_t begin, std::size_t end) { skin_span(begin, end); });
 	}
 
 }  // namespace transformer
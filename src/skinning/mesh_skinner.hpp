@@ -2,16 +2,74 @@
 
 #include "core/math_types.hpp"
 
+#include <array>
+#include <cstddef>
+#include <vector>
+
 namespace transformer
 {
 
+	class ChunkThreads;
 	class Profiler;
+	class SkinningCache;
+	struct SkinningKernel;
 
 	class MeshSkinner
 	{
 	public:
+		// Skins with the best kernel variant for this CPU (see kernels/kernel_registry.hpp).
+		MeshSkinner();
+		// With a cache, palettes are looked up by pose, and if it caches outputs, meshes with a content_key
+		// skinned without morphs or bounds are looked up by mesh and pose.
+		explicit MeshSkinner(const SkinningKernel& kernel, SkinningCache* cache = nullptr);
+
+		// Name of the kernel variant in use, e.g. "avx2".
+		[[nodiscard]]
+		const char* kernel_name() const;
+
+		[[nodiscard]]
+		const SkinningKernel& kernel() const;
+
+		[[nodiscard]]
+		SkinningCache* cache() const;
+
 		void skin(const Mesh& source_mesh, const BonePoseData& bone_pose_data, Profiler& profiler, Mesh& result_mesh)
 				const;
+
+		// Same, with source_mesh.morph_targets blended in by morph_weights (one per target) before the
+		// skinning transform, in the same vertex pass.
+		void skin(
+				const Mesh& source_mesh,
+				const BonePoseData& bone_pose_data,
+				const std::vector<float>& morph_weights,
+				Profiler& profiler,
+				Mesh& result_mesh) const;
+
+		// Same, and collects the skinned bounds selected by bounds_mode in the same vertex pass (from the
+		// kernel's result registers, before the positions are stored).
+		void skin(
+				const Mesh& source_mesh,
+				const BonePoseData& bone_pose_data,
+				const std::vector<float>& morph_weights,
+				Profiler& profiler,
+				Mesh& result_mesh,
+				BoundsMode bounds_mode,
+				SkinnedBounds& bounds) const;
+
+		// Skins count entries with a ready palette (a SkinningPalette, slot 255 zero): no cache, morphs or
+		// bounds. result may be source, as every kernel reads an entry before it stores it. The range is split
+		// over threads like skin() splits a mesh; nullptr runs it on the calling thread.
+		void skin_entries(
+				const std::array<Mat4, 256>& palette,
+				const Mesh::Entry* source,
+				Mesh::Entry* result,
+				std::size_t count,
+				std::size_t max_influences,
+				ChunkThreads* threads) const;
+
+	private:
+		const SkinningKernel* kernel_ = nullptr;
+		SkinningCache* cache_ = nullptr;
 	};
 
 }  // namespace transformer
@@ -0,0 +1,208 @@
+#include "skinning/skinning_cache.hpp"
+
+#include "core/profiler.hpp"
+
+#include <cstring>
+#include <utility>
+
+namespace transformer
+{
+
+	namespace
+	{
+
+		std::uint64_t mix(std::uint64_t hash, std::uint64_t word)
+		{
+			hash ^= word + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+			hash *= 0xff51afd7ed558ccdULL;
+			return hash ^ (hash >> 33);
+		}
+
+		// Word at a time: the hashed data are arrays of floats, a few KB (poses) to tens of MB (meshes).
+		std::uint64_t hash_bytes(std::uint64_t hash, const void* data, std::size_t size)
+		{
+			const auto* bytes = static_cast<const unsigned char*>(data);
+			std::size_t offset = 0;
+			for (; offset + sizeof(std::uint64_t) <= size; offset += sizeof(std::uint64_t))
+			{
+				std::uint64_t word = 0;
+				std::memcpy(&word, bytes + offset, sizeof(word));
+				hash = mix(hash, word);
+			}
+			std::uint64_t tail = 0;
+			if (offset != size)
+			{
+				std::memcpy(&tail, bytes + offset, size - offset);
+			}
+			return mix(hash, tail ^ size);
+		}
+
+		std::uint64_t pose_hash(std::uint64_t content_key, const BonePoseData& bone_pose_data)
+		{
+			const std::vector<std::array<Mat4, 2>>& poses = bone_pose_data.bone_poses;
+			return hash_bytes(content_key, poses.data(), poses.size() * sizeof(poses[0]));
+		}
+
+		std::size_t pose_bytes(const BonePoseData& bone_pose_data)
+		{
+			return bone_pose_data.bone_poses.size() * sizeof(bone_pose_data.bone_poses[0]);
+		}
+
+	}  // namespace
+
+	SkinningCache::SkinningCache(std::size_t budget_bytes, bool cache_outputs) :
+			budget_bytes_(budget_bytes),
+			cache_outputs_(cache_outputs)
+	{}
+
+	bool SkinningCache::caches_outputs() const
+	{
+		return cache_outputs_;
+	}
+
+	std::shared_ptr<const SkinningPalette> SkinningCache::palette(const BonePoseData& bone_pose_data)
+	{
+		const std::uint64_t hash = pose_hash(0, bone_pose_data);
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			const Lru::iterator found = find(hash, 0, bone_pose_data.bone_poses);
+			if (found != entries_.end())
+			{
+				++stats_.palette_hits;
+				return found->palette;
+			}
+			++stats_.palette_misses;
+		}
+
+		// Built outside the lock; a thread that missed at the same time builds its own and one is kept.
+		auto palette = std::make_shared<SkinningPalette>();
+		build_palette(*palette, bone_pose_data);
+
+		const std::lock_guard<std::mutex> lock(mutex_);
+		insert({
+				.hash = hash,
+				.poses = bone_pose_data.bone_poses,
+				.palette = palette,
+				.bytes = sizeof(SkinningPalette) + pose_bytes(bone_pose_data),
+		});
+		return palette;
+	}
+
+	std::shared_ptr<const std::vector<Vec3>> SkinningCache::find_output(
+			std::uint64_t content_key, const BonePoseData& bone_pose_data)
+	{
+		const std::uint64_t hash = pose_hash(content_key, bone_pose_data);
+		const std::lock_guard<std::mutex> lock(mutex_);
+		const Lru::iterator found = find(hash, content_key, bone_pose_data.bone_poses);
+		if (found == entries_.end())
+		{
+			++stats_.output_misses;
+			return nullptr;
+		}
+		++stats_.output_hits;
+		return found->output;
+	}
+
+	void SkinningCache::store_output(
+			std::uint64_t content_key, const BonePoseData& bone_pose_data, const Mesh& result_mesh)
+	{
+		const std::size_t bytes = result_mesh.vertex_count * sizeof(Vec3) + pose_bytes(bone_pose_data);
+		if (bytes > budget_bytes_)
+		{
+			return;
+		}
+		auto output = std::make_shared<std::vector<Vec3>>(result_mesh.vertex_count);
+		for (std::size_t i = 0; i < result_mesh.vertex_count; ++i)
+		{
+			(*output)[i] = result_mesh.entries[i].vertex;
+		}
+
+		const std::lock_guard<std::mutex> lock(mutex_);
+		insert({
+				.hash = pose_hash(content_key, bone_pose_data),
+				.content_key = content_key,
+				.poses = bone_pose_data.bone_poses,
+				.output = std::move(output),
+				.bytes = bytes,
+		});
+	}
+
+	SkinningCacheStats SkinningCache::stats() const
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		return stats_;
+	}
+
+	void SkinningCache::add_counters(Profiler& profiler) const
+	{
+		const SkinningCacheStats current = stats();
+		profiler.add_counter("palette_cache_hits", current.palette_hits);
+		profiler.add_counter("palette_cache_misses", current.palette_misses);
+		if (cache_outputs_)
+		{
+			profiler.add_counter("output_cache_hits", current.output_hits);
+			profiler.add_counter("output_cache_misses", current.output_misses);
+		}
+		profiler.add_counter("skin_cache_evictions", current.evictions);
+		profiler.add_counter("skin_cache_bytes", current.bytes);
+	}
+
+	SkinningCache::Lru::iterator SkinningCache::find(
+			std::uint64_t hash, std::uint64_t content_key, const std::vector<std::array<Mat4, 2>>& poses)
+	{
+		const auto [first, last] = index_.equal_range(hash);
+		for (auto it = first; it != last; ++it)
+		{
+			const Entry& entry = *it->second;
+			if (entry.content_key == content_key && entry.poses.size() == poses.size()
+				&& std::memcmp(entry.poses.data(), poses.data(), poses.size() * sizeof(poses[0])) == 0)
+			{
+				entries_.splice(entries_.begin(), entries_, it->second);
+				return entries_.begin();
+			}
+		}
+		return entries_.end();
+	}
+
+	void SkinningCache::insert(Entry entry)
+	{
+		if (entry.bytes > budget_bytes_)
+		{
+			return;
+		}
+		// Another thread may have inserted the same key since this one missed.
+		if (find(entry.hash, entry.content_key, entry.poses) != entries_.end())
+		{
+			return;
+		}
+		while (!entries_.empty() && stats_.bytes + entry.bytes > budget_bytes_)
+		{
+			const Lru::iterator oldest = std::prev(entries_.end());
+			const auto [first, last] = index_.equal_range(oldest->hash);
+			for (auto it = first; it != last; ++it)
+			{
+				if (it->second == oldest)
+				{
+					index_.erase(it);
+					break;
+				}
+			}
+			stats_.bytes -= oldest->bytes;
+			++stats_.evictions;
+			entries_.erase(oldest);
+		}
+
+		stats_.bytes += entry.bytes;
+		const std::uint64_t hash = entry.hash;
+		entries_.push_front(std::move(entry));
+		index_.emplace(hash, entries_.begin());
+	}
+
+	std::uint64_t mesh_content_key(const Mesh& mesh)
+	{
+		std::uint64_t hash = mix(mix(0, mesh.vertex_count), mesh.max_influences);
+		hash = hash_bytes(hash, mesh.entries.data(), mesh.vertex_count * sizeof(Mesh::Entry));
+		return hash == 0 ? 1 : hash;
+	}
+
+}  // namespace transformer
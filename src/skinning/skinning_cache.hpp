@@ -0,0 +1,96 @@
+#pragma once
+
+#include "core/math_types.hpp"
+#include "skinning/skinning_kernel.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace transformer
+{
+
+	class Profiler;
+
+	struct SkinningCacheStats
+	{
+		std::uint64_t palette_hits = 0;
+		std::uint64_t palette_misses = 0;
+		std::uint64_t output_hits = 0;
+		std::uint64_t output_misses = 0;
+		std::uint64_t evictions = 0;
+		// Held now, palettes and outputs together.
+		std::size_t bytes = 0;
+	};
+
+	// LRU cache of skinning palettes and, optionally, skinned vertex buffers, keyed by content and shared by
+	// every MeshSkinner given it (thread-safe). A palette depends only on the pose, so frames and instances
+	// that repeat a pose reuse it. A skinned buffer also depends on the mesh, which is identified by
+	// Mesh::content_key. Poses are stored with their entry and compared in full, so a pose hash collision
+	// only costs a miss; the mesh is trusted to its 64-bit content hash.
+	class SkinningCache
+	{
+	public:
+		// Least recently used entries are evicted to keep palettes plus outputs within budget_bytes.
+		SkinningCache(std::size_t budget_bytes, bool cache_outputs);
+
+		[[nodiscard]]
+		bool caches_outputs() const;
+
+		// The palette for bone_pose_data, built and inserted on a miss.
+		[[nodiscard]]
+		std::shared_ptr<const SkinningPalette> palette(const BonePoseData& bone_pose_data);
+
+		// Skinned positions of the mesh with this content key in this pose, or nullptr. Only positions are
+		// kept: skinning writes nothing else into the result mesh.
+		[[nodiscard]]
+		std::shared_ptr<const std::vector<Vec3>> find_output(
+				std::uint64_t content_key, const BonePoseData& bone_pose_data);
+		void store_output(std::uint64_t content_key, const BonePoseData& bone_pose_data, const Mesh& result_mesh);
+
+		[[nodiscard]]
+		SkinningCacheStats stats() const;
+
+		// Adds the stats as palette_cache_hits, palette_cache_misses, output_cache_hits, output_cache_misses,
+		// skin_cache_evictions and skin_cache_bytes.
+		void add_counters(Profiler& profiler) const;
+
+	private:
+		struct Entry
+		{
+			std::uint64_t hash = 0;
+			// 0 for a palette.
+			std::uint64_t content_key = 0;
+			std::vector<std::array<Mat4, 2>> poses;
+			std::shared_ptr<const SkinningPalette> palette;
+			std::shared_ptr<const std::vector<Vec3>> output;
+			std::size_t bytes = 0;
+		};
+		using Lru = std::list<Entry>;
+
+		// Both under mutex_. find moves a match to the front; insert evicts from the back to make room.
+		Lru::iterator find(
+				std::uint64_t hash, std::uint64_t content_key, const std::vector<std::array<Mat4, 2>>& poses);
+		void insert(Entry entry);
+
+		const std::size_t budget_bytes_;
+		const bool cache_outputs_;
+
+		mutable std::mutex mutex_;
+		// Most recently used first.
+		Lru entries_;
+		std::unordered_multimap<std::uint64_t, Lru::iterator> index_;
+		SkinningCacheStats stats_;
+	};
+
+	// Hash of what skinning reads from a mesh (vertex count, influences, positions and weights), for
+	// Mesh::content_key. Never 0.
+	[[nodiscard]]
+	std::uint64_t mesh_content_key(const Mesh& mesh);
+
+}  // namespace transformer
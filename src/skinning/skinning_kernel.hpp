@@ -0,0 +1,257 @@
+#pragma once
+
+#include "core/math_types.hpp"
+#include "core/math_utils.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "core/simd.hpp"
+
+// The per-ISA kernels (skinning/kernels/) include this header with their own target flags. Each one
+// defines TRANSFORMER_KERNEL_ISA, so the inline helpers below become separate symbols per instruction
+// set and the linker can never hand an AVX copy to a baseline caller.
+#ifndef TRANSFORMER_KERNEL_ISA
+	#define TRANSFORMER_KERNEL_ISA baseline
+#endif
+
+namespace transformer
+{
+inline namespace TRANSFORMER_KERNEL_ISA
+{
+
+	// Precomputed new_pose * inverse_bind_pose per bone. Slot 255 is never written and stays a zero
+	// matrix: unused influence slots (-1) are cast to 255, so the hot loop never branches.
+	using SkinningPalette = std::array<Mat4, 256>;
+
+	inline void update_palette_entry(
+			SkinningPalette& palette, const BonePoseData& bone_pose_data, std::size_t bone_index)
+	{
+		palette[bone_index]
+				= multiply(bone_pose_data.bone_poses[bone_index][1], bone_pose_data.bone_poses[bone_index][0]);
+	}
+
+	// Every bone's entry, and zeros past the last bone, so slot 255 is the zero matrix in a reused palette
+	// too. Throws std::runtime_error for more than kMaxBones bones, which would overwrite it.
+	inline void build_palette(SkinningPalette& palette, const BonePoseData& bone_pose_data)
+	{
+		const std::size_t bone_count = bone_pose_data.bone_poses.size();
+		if (bone_count > kMaxBones)
+		{
+			throw std::runtime_error(
+					"Too many bones: " + std::to_string(bone_count) + " (at most " + std::to_string(kMaxBones) + ")");
+		}
+		for (std::size_t bone_index = 0; bone_index < bone_count; ++bone_index)
+		{
+			update_palette_entry(palette, bone_pose_data, bone_index);
+		}
+		std::fill(palette.begin() + static_cast<std::ptrdiff_t>(bone_count), palette.end(), Mat4{});
+	}
+
+	// Bone with the largest weight. Unused slots (-1) map to the zero matrix 255, like in skin_position.
+	inline std::uint8_t dominant_bone(const VertexBoneWeights& bone_weights)
+	{
+		std::size_t best_slot = 0;
+		for (std::size_t i = 1; i < bone_weights.weights.size(); ++i)
+		{
+			if (bone_weights.weights[i] > bone_weights.weights[best_slot])
+			{
+				best_slot = i;
+			}
+		}
+		return static_cast<std::uint8_t>(bone_weights.bone_indices[best_slot]);
+	}
+
+	// Portable reference for skin_position_simd: the same multiplies and adds in the same order and
+	// without fused multiply-add, so every kernel variant produces bit-identical positions.
+	// Influences < 4 skips trailing slots, which must have zero weight (Mesh::max_influences).
+	template <std::size_t Influences = 4>
+	inline Vec3 skin_position_scalar(
+			const SkinningPalette& precomputed_skinning_matrixes,
+			const Vec3& sp,
+			const VertexBoneWeights& vertex_bone_weights)
+	{
+		float acc[3] = {0.0F, 0.0F, 0.0F};
+		for (std::size_t i = 0; i < Influences; ++i)
+		{
+			const auto safe_bone_index = static_cast<std::uint8_t>(vertex_bone_weights.bone_indices[i]);
+			const float weight = vertex_bone_weights.weights[i];
+			const Mat4& sm = precomputed_skinning_matrixes[safe_bone_index];
+			for (std::size_t row = 0; row < 3; ++row)
+			{
+				float res = sm.m[row] * sp.x;
+				res = res + sm.m[4 + row] * sp.y;
+				res = res + sm.m[8 + row] * sp.z;
+				res = res + sm.m[12 + row];
+				acc[row] = acc[row] + res * weight;
+			}
+		}
+		return {acc[0], acc[1], acc[2]};
+	}
+
+#if TRANSFORMER_HAS_SSE2
+	// Skins one vertex against a prepared palette and leaves the result in a register: [X, Y, Z, W].
+	// Shared by every skinner so results match bit for bit. Influences as in skin_position_scalar.
+	template <std::size_t Influences = 4>
+	inline __m128 skin_position_simd(
+			const SkinningPalette& precomputed_skinning_matrixes,
+			const Vec3& sp,
+			const VertexBoneWeights& vertex_bone_weights)
+	{
+		// Accumulator for weighted positions: [X, Y, Z, 0.0]
+		__m128 v_acc = _mm_setzero_ps();
+
+		// Weights sum to 1 and unused slots (index -1, weight 0) read the zero matrix in slot 255, so every
+		// slot is blended without branching, W is never computed and no normalization is needed.
+		for (std::size_t i = 0; i < Influences; ++i)
+		{
+			const auto safe_bone_index = static_cast<std::uint8_t>(vertex_bone_weights.bone_indices[i]);
+			const float weight = vertex_bone_weights.weights[i];
+			const Mat4& sm = precomputed_skinning_matrixes[safe_bone_index];
+
+			// Columns are the transformed basis vectors and the translation.
+			__m128 col0 = _mm_loadu_ps(&sm.m[0]);
+			__m128 col1 = _mm_loadu_ps(&sm.m[4]);
+			__m128 col2 = _mm_loadu_ps(&sm.m[8]);
+			__m128 col3 = _mm_loadu_ps(&sm.m[12]);
+
+			__m128 xxxx = _mm_set1_ps(sp.x);
+			__m128 yyyy = _mm_set1_ps(sp.y);
+			__m128 zzzz = _mm_set1_ps(sp.z);
+
+			// Col0*X + Col1*Y + Col2*Z + Col3 (W = 1)
+			__m128 res = _mm_mul_ps(col0, xxxx);
+			res = _mm_add_ps(res, _mm_mul_ps(col1, yyyy));
+			res = _mm_add_ps(res, _mm_mul_ps(col2, zzzz));
+			res = _mm_add_ps(res, col3);
+
+			__m128 v_weight = _mm_set1_ps(weight);
+			v_acc = _mm_add_ps(v_acc, _mm_mul_ps(res, v_weight));
+		}
+
+		return v_acc;
+	}
+
+	inline Vec3 to_vec3(__m128 v)
+	{
+		// SIMD
+		// Write back to mesh (extracting X, Y, Z)
+		alignas(16) float final_pos[4];
+		_mm_store_ps(final_pos, v);
+		return {final_pos[0], final_pos[1], final_pos[2]};
+	}
+
+	inline Vec3 skin_position(
+			const SkinningPalette& precomputed_skinning_matrixes,
+			const Vec3& sp,
+			const VertexBoneWeights& vertex_bone_weights)
+	{
+		return to_vec3(skin_position_simd(precomputed_skinning_matrixes, sp, vertex_bone_weights));
+	}
+#else
+	inline Vec3 skin_position(
+			const SkinningPalette& precomputed_skinning_matrixes,
+			const Vec3& sp,
+			const VertexBoneWeights& vertex_bone_weights)
+	{
+		return skin_position_scalar(precomputed_skinning_matrixes, sp, vertex_bone_weights);
+	}
+#endif
+
+	inline Vec3 skin_position(const SkinningPalette& precomputed_skinning_matrixes, const Mesh::Entry& source_entry)
+	{
+		return skin_position(precomputed_skinning_matrixes, source_entry.vertex, source_entry.bone_weights);
+	}
+
+	// Adds weighted morph target deltas inside the skinning loop, so blend shapes cost no extra pass
+	// over the vertex buffer: the skinner copies a small block of positions, this adds the deltas that
+	// fall into it, and the block is skinned while still in L1. Zero-weight targets are dropped up
+	// front, and each active target keeps a cursor into its sorted vertex list.
+	class MorphAccumulator
+	{
+	public:
+		MorphAccumulator(const std::vector<MorphTarget>& morph_targets, const std::vector<float>& weights)
+		{
+			for (std::size_t target = 0; target < morph_targets.size() && target < weights.size(); ++target)
+			{
+				const MorphTarget& morph_target = morph_targets[target];
+				if (weights[target] != 0.0F && !morph_target.vertex_indices.empty())
+				{
+					active_.push_back({&morph_target, 0, weights[target]});
+				}
+			}
+		}
+
+		[[nodiscard]]
+		bool empty() const
+		{
+			return active_.empty();
+		}
+
+		// Skips the deltas of vertices before first_vertex, for a pass that starts mid-mesh.
+		void seek(std::uint32_t first_vertex)
+		{
+			for (ActiveTarget& target : active_)
+			{
+				const std::vector<std::uint32_t>& vertex_indices = target.morph_target->vertex_indices;
+				std::size_t cursor = target.cursor;
+				while (cursor < vertex_indices.size() && vertex_indices[cursor] < first_vertex)
+				{
+					++cursor;
+				}
+				target.cursor = cursor;
+			}
+		}
+
+		// positions holds vertices [first_vertex, first_vertex + count); blocks must come in increasing order.
+		void apply(std::uint32_t first_vertex, std::size_t count, Vec3* positions)
+		{
+			const auto end_vertex = static_cast<std::uint32_t>(first_vertex + count);
+			for (ActiveTarget& target : active_)
+			{
+				const std::vector<std::uint32_t>& vertex_indices = target.morph_target->vertex_indices;
+				const std::vector<Vec3>& deltas = target.morph_target->deltas;
+				std::size_t cursor = target.cursor;
+#if TRANSFORMER_HAS_SSE2
+				const __m128 weight = _mm_set1_ps(target.weight);
+				for (; cursor < vertex_indices.size() && vertex_indices[cursor] < end_vertex; ++cursor)
+				{
+					Vec3& p = positions[vertex_indices[cursor] - first_vertex];
+					const Vec3& d = deltas[cursor];
+					__m128 acc = _mm_setr_ps(p.x, p.y, p.z, 0.0F);
+					acc = _mm_add_ps(acc, _mm_mul_ps(weight, _mm_setr_ps(d.x, d.y, d.z, 0.0F)));
+
+					alignas(16) float morphed[4];
+					_mm_store_ps(morphed, acc);
+					p = {morphed[0], morphed[1], morphed[2]};
+				}
+#else
+				for (; cursor < vertex_indices.size() && vertex_indices[cursor] < end_vertex; ++cursor)
+				{
+					Vec3& p = positions[vertex_indices[cursor] - first_vertex];
+					const Vec3& d = deltas[cursor];
+					p = {p.x + target.weight * d.x, p.y + target.weight * d.y, p.z + target.weight * d.z};
+				}
+#endif
+				target.cursor = cursor;
+			}
+		}
+
+	private:
+		struct ActiveTarget
+		{
+			const MorphTarget* morph_target = nullptr;
+			std::size_t cursor = 0;
+			float weight = 0.0F;
+		};
+
+		std::vector<ActiveTarget> active_;
+	};
+
+}  // namespace TRANSFORMER_KERNEL_ISA
+}  // namespace transformer
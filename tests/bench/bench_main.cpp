@@ -0,0 +1,820 @@
+#include "api/transformer.h"
+#include "core/profiler.hpp"
+#include "core/vertex_buffer.hpp"
+#include "io/async_files.hpp"
+#include "io/async_io.hpp"
+#include "io/json_readers.hpp"
+#include "io/numeric_scan.hpp"
+#include "io/obj_io.hpp"
+#include "skinning/incremental_skinner.hpp"
+#include "skinning/kernels/kernel_registry.hpp"
+#include "skinning/mesh_optimizer.hpp"
+#include "skinning/mesh_skinner.hpp"
+#include "skinning/skinning_cache.hpp"
+#include "skinning/skinning_kernel.hpp"
+#include "synthetic_mesh.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using transformer::BenchSummary;
+using transformer::compute_bench_summary;
+using transformer::IncrementalMeshSkinner;
+using transformer::IncrementalUpdateStats;
+using transformer::Mesh;
+using transformer::MeshSkinner;
+using transformer::optimize_mesh_layout;
+using transformer::Profiler;
+using transformer::SkinningCache;
+using transformer::bench::make_synthetic_scene;
+using transformer::bench::SyntheticMeshOptions;
+using transformer::bench::SyntheticScene;
+
+namespace
+{
+
+	struct BenchOptions
+	{
+		std::size_t vertex_count = 1000000;
+		std::size_t runs = 20;
+		std::size_t skin_threads = std::max(1U, std::thread::hardware_concurrency());
+	};
+
+	BenchSummary bench_skinning(const Mesh& source_mesh, const SyntheticScene& scene, std::size_t runs)
+	{
+		const MeshSkinner skinner;
+		Profiler profiler;
+		Mesh skinned_mesh = source_mesh;
+
+		std::vector<double> run_microseconds;
+		run_microseconds.reserve(runs);
+		for (std::size_t run = 0; run < runs; ++run)
+		{
+			skinner.skin(source_mesh, scene.bone_pose_data, profiler, skinned_mesh);
+			run_microseconds.push_back(profiler.entries().back().microseconds);
+		}
+		return compute_bench_summary(run_microseconds);
+	}
+
+	void print_summary(const char* name, const BenchSummary& summary, double acmr, bool last)
+	{
+		std::cout << "    \"" << name << "\": { \"median_microseconds\": " << summary.median_microseconds
+				  << ", \"min_microseconds\": " << summary.min_microseconds << ", \"acmr\": " << acmr << " }"
+				  << (last ? "\n" : ",\n");
+	}
+
+	// Skinning in file order vs. after optimize_mesh_layout() on a shuffled mesh.
+	void bench_layout(const BenchOptions& options)
+	{
+		const SyntheticScene scene = make_synthetic_scene(SyntheticMeshOptions{.vertex_count = options.vertex_count});
+
+		Mesh optimized_mesh = scene.mesh;
+		Profiler profiler;
+		const transformer::MeshLayoutStats layout = optimize_mesh_layout(optimized_mesh, profiler);
+
+		const BenchSummary file_order = bench_skinning(scene.mesh, scene, options.runs);
+		const BenchSummary optimized = bench_skinning(optimized_mesh, scene, options.runs);
+
+		std::cout << "  \"layout\": {\n"
+				  << "    \"vertices\": " << scene.mesh.vertex_count << ",\n"
+				  << "    \"triangles\": " << scene.mesh.indices.size() / 3 << ",\n"
+				  << "    \"bone_clusters\": " << layout.bone_clusters << ",\n"
+				  << "    \"optimize_microseconds\": " << profiler.entries().back().microseconds << ",\n";
+		print_summary("file_order", file_order, layout.acmr_before, false);
+		print_summary("optimized", optimized, layout.acmr_after, false);
+		std::cout << "    \"speedup\": " << file_order.median_microseconds / optimized.median_microseconds << "\n"
+				  << "  }";
+	}
+
+	// Editor-style posing: every update moves a single bone; full skin vs. IncrementalMeshSkinner.
+	void bench_incremental(const BenchOptions& options)
+	{
+		SyntheticScene scene = make_synthetic_scene(SyntheticMeshOptions{.vertex_count = options.vertex_count});
+		const std::size_t bone_count = scene.bone_pose_data.bone_poses.size();
+
+		const BenchSummary full = bench_skinning(scene.mesh, scene, options.runs);
+
+		IncrementalMeshSkinner skinner(scene.mesh);
+		Profiler profiler;
+		Mesh skinned_mesh = scene.mesh;
+		skinner.update(scene.bone_pose_data, profiler, skinned_mesh);
+
+		std::vector<double> run_microseconds;
+		std::size_t vertices_touched = 0;
+		for (std::size_t run = 0; run < options.runs; ++run)
+		{
+			transformer::Mat4& pose = scene.bone_pose_data.bone_poses[run % bone_count][1];
+			pose.m[12] += 0.01F;
+
+			const IncrementalUpdateStats update = skinner.update(scene.bone_pose_data, profiler, skinned_mesh);
+			vertices_touched += update.vertices_touched;
+			run_microseconds.push_back(profiler.entries().back().microseconds);
+		}
+		const BenchSummary incremental = compute_bench_summary(run_microseconds);
+
+		std::cout << "  \"incremental\": {\n"
+				  << "    \"vertices\": " << scene.mesh.vertex_count << ",\n"
+				  << "    \"bones\": " << bone_count << ",\n"
+				  << "    \"full_median_microseconds\": " << full.median_microseconds << ",\n"
+				  << "    \"incremental_median_microseconds\": " << incremental.median_microseconds << ",\n"
+				  << "    \"mean_vertices_touched\": "
+				  << static_cast<double>(vertices_touched) / static_cast<double>(options.runs) << ",\n"
+				  << "    \"speedup\": " << full.median_microseconds / incremental.median_microseconds << "\n"
+				  << "  }";
+	}
+
+	// Facial-rig style blend shapes: many sparse targets, a few active per frame. Morphs fused into the
+	// skinning pass vs. a separate morph pass over a copy of the mesh followed by skinning.
+	void bench_morph(const BenchOptions& options)
+	{
+		constexpr std::size_t kTargetCount = 32;
+		constexpr std::size_t kActiveTargets = 8;
+
+		SyntheticScene scene = make_synthetic_scene(SyntheticMeshOptions{.vertex_count = options.vertex_count});
+		Mesh& mesh = scene.mesh;
+
+		std::mt19937 rng(7);
+		std::uniform_real_distribution<float> offset(-0.01F, 0.01F);
+		std::size_t deltas = 0;
+		for (std::size_t target = 0; target < kTargetCount; ++target)
+		{
+			// Each target moves a contiguous 5% region, like a facial feature.
+			const std::size_t region = mesh.vertex_count / 20;
+			const std::size_t first = target * (mesh.vertex_count - region) / kTargetCount;
+			transformer::MorphTarget& morph_target = mesh.morph_targets.emplace_back();
+			for (std::size_t vertex = first; vertex < first + region; ++vertex)
+			{
+				morph_target.vertex_indices.push_back(static_cast<std::uint32_t>(vertex));
+				morph_target.deltas.push_back({offset(rng), offset(rng), offset(rng)});
+			}
+			deltas += region;
+		}
+
+		std::vector<float> weights(kTargetCount, 0.0F);
+		for (std::size_t target = 0; target < kTargetCount; target += kTargetCount / kActiveTargets)
+		{
+			weights[target] = 0.5F;
+		}
+
+		const MeshSkinner skinner;
+		Profiler profiler;
+		Mesh skinned_mesh = mesh;
+
+		std::vector<double> fused_microseconds;
+		std::vector<double> two_pass_microseconds;
+		Mesh morphed_mesh = mesh;
+		for (std::size_t run = 0; run < options.runs; ++run)
+		{
+			skinner.skin(mesh, scene.bone_pose_data, weights, profiler, skinned_mesh);
+			fused_microseconds.push_back(profiler.entries().back().microseconds);
+
+			const auto start = std::chrono::steady_clock::now();
+			for (std::size_t vertex = 0; vertex < mesh.vertex_count; ++vertex)
+			{
+				morphed_mesh.entries[vertex].vertex = mesh.entries[vertex].vertex;
+			}
+			for (std::size_t target = 0; target < kTargetCount; ++target)
+			{
+				const transformer::MorphTarget& morph_target = mesh.morph_targets[target];
+				for (std::size_t i = 0; weights[target] != 0.0F && i < morph_target.vertex_indices.size(); ++i)
+				{
+					transformer::Vec3& position = morphed_mesh.entries[morph_target.vertex_indices[i]].vertex;
+					position.x += weights[target] * morph_target.deltas[i].x;
+					position.y += weights[target] * morph_target.deltas[i].y;
+					position.z += weights[target] * morph_target.deltas[i].z;
+				}
+			}
+			skinner.skin(morphed_mesh, scene.bone_pose_data, profiler, skinned_mesh);
+			const auto end = std::chrono::steady_clock::now();
+			two_pass_microseconds.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+		}
+
+		const BenchSummary plain = bench_skinning(mesh, scene, options.runs);
+		const BenchSummary fused = compute_bench_summary(fused_microseconds);
+		const BenchSummary two_pass = compute_bench_summary(two_pass_microseconds);
+
+		std::cout << "  \"morph\": {\n"
+				  << "    \"vertices\": " << mesh.vertex_count << ",\n"
+				  << "    \"targets\": " << kTargetCount << ",\n"
+				  << "    \"active_targets\": " << kActiveTargets << ",\n"
+				  << "    \"deltas\": " << deltas << ",\n"
+				  << "    \"skin_only_median_microseconds\": " << plain.median_microseconds << ",\n"
+				  << "    \"fused_median_microseconds\": " << fused.median_microseconds << ",\n"
+				  << "    \"two_pass_median_microseconds\": " << two_pass.median_microseconds << ",\n"
+				  << "    \"speedup\": " << two_pass.median_microseconds / fused.median_microseconds << "\n"
+				  << "  }";
+	}
+
+	// Skinned AABB plus per-dominant-bone boxes: collected inside the skinning pass vs. a separate pass
+	// over the skinned output (the vertex weights are re-read there to find each dominant bone).
+	void bench_bounds(const BenchOptions& options)
+	{
+		const SyntheticScene scene = make_synthetic_scene(SyntheticMeshOptions{.vertex_count = options.vertex_count});
+		const Mesh& mesh = scene.mesh;
+		const std::size_t bone_count = scene.bone_pose_data.bone_poses.size();
+
+		const MeshSkinner skinner;
+		Profiler profiler;
+		Mesh skinned_mesh = mesh;
+		transformer::SkinnedBounds bounds;
+
+		std::vector<double> fused_microseconds;
+		std::vector<double> two_pass_microseconds;
+		for (std::size_t run = 0; run < options.runs; ++run)
+		{
+			skinner.skin(
+					mesh,
+					scene.bone_pose_data,
+					{},
+					profiler,
+					skinned_mesh,
+					transformer::BoundsMode::MeshAndBones,
+					bounds);
+			fused_microseconds.push_back(profiler.entries().back().microseconds);
+
+			const auto start = std::chrono::steady_clock::now();
+			skinner.skin(mesh, scene.bone_pose_data, profiler, skinned_mesh);
+			bounds.mesh = {};
+			bounds.bones.assign(256, {});
+			for (std::size_t vertex = 0; vertex < mesh.vertex_count; ++vertex)
+			{
+				const transformer::Vec3& p = skinned_mesh.entries[vertex].vertex;
+				transformer::widen(bounds.mesh, p);
+				transformer::widen(bounds.bones[transformer::dominant_bone(mesh.entries[vertex].bone_weights)], p);
+			}
+			bounds.bones.resize(std::min<std::size_t>(bone_count, 256));
+			const auto end = std::chrono::steady_clock::now();
+			two_pass_microseconds.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+		}
+
+		const BenchSummary plain = bench_skinning(mesh, scene, options.runs);
+		const BenchSummary fused = compute_bench_summary(fused_microseconds);
+		const BenchSummary two_pass = compute_bench_summary(two_pass_microseconds);
+
+		std::cout << "  \"bounds\": {\n"
+				  << "    \"vertices\": " << mesh.vertex_count << ",\n"
+				  << "    \"bones\": " << bone_count << ",\n"
+				  << "    \"skin_only_median_microseconds\": " << plain.median_microseconds << ",\n"
+				  << "    \"fused_median_microseconds\": " << fused.median_microseconds << ",\n"
+				  << "    \"two_pass_median_microseconds\": " << two_pass.median_microseconds << ",\n"
+				  << "    \"speedup\": " << two_pass.median_microseconds / fused.median_microseconds << "\n"
+				  << "  }";
+	}
+
+	BenchSummary bench_kernel(
+			const transformer::SkinningKernel& kernel, const Mesh& source_mesh, const SyntheticScene& scene,
+			std::size_t runs)
+	{
+		const MeshSkinner skinner(kernel);
+		Profiler profiler;
+		Mesh skinned_mesh = source_mesh;
+		std::vector<double> run_microseconds;
+		for (std::size_t run = 0; run < runs; ++run)
+		{
+			skinner.skin(source_mesh, scene.bone_pose_data, profiler, skinned_mesh);
+			run_microseconds.push_back(profiler.entries().back().microseconds);
+		}
+		return compute_bench_summary(run_microseconds);
+	}
+
+	// The same skinning pass with every kernel variant this CPU can run (--kernel), widest first, each
+	// with the loop specialised for the mesh's two influences and with the generic four-slot loop.
+	void bench_kernels(const BenchOptions& options)
+	{
+		const SyntheticScene scene = make_synthetic_scene(SyntheticMeshOptions{.vertex_count = options.vertex_count});
+		Mesh four_slot_mesh = scene.mesh;
+		four_slot_mesh.max_influences = 4;
+		const std::vector<transformer::SkinningKernel>& kernels = transformer::available_skinning_kernels();
+
+		std::vector<BenchSummary> specialised;
+		std::vector<BenchSummary> four_slot;
+		for (const transformer::SkinningKernel& kernel : kernels)
+		{
+			specialised.push_back(bench_kernel(kernel, scene.mesh, scene, options.runs));
+			four_slot.push_back(bench_kernel(kernel, four_slot_mesh, scene, options.runs));
+		}
+
+		std::cout << "  \"kernels\": {\n"
+				  << "    \"vertices\": " << scene.mesh.vertex_count << ",\n"
+				  << "    \"influences\": " << scene.mesh.max_influences << ",\n";
+		for (std::size_t i = 0; i < kernels.size(); ++i)
+		{
+			std::cout << "    \"" << kernels[i].name << "\": { \"median_microseconds\": "
+					  << specialised[i].median_microseconds << ", \"four_slot_median_microseconds\": "
+					  << four_slot[i].median_microseconds << ", \"speedup_over_scalar\": "
+					  << specialised.back().median_microseconds / specialised[i].median_microseconds << " }"
+					  << (i + 1 < kernels.size() ? ",\n" : "\n");
+		}
+		std::cout << "  }";
+	}
+
+	// A looping clip: frames cycle through four poses. Skinning every frame vs. a SkinningCache of
+	// palettes vs. one that also keeps the skinned positions.
+	void bench_skin_cache(const BenchOptions& options)
+	{
+		const SyntheticScene scene = make_synthetic_scene(SyntheticMeshOptions{.vertex_count = options.vertex_count});
+		constexpr std::size_t kPoseCount = 4;
+		std::vector<transformer::BonePoseData> poses(kPoseCount, scene.bone_pose_data);
+		for (std::size_t pose = 0; pose < kPoseCount; ++pose)
+		{
+			for (auto& bone_pose : poses[pose].bone_poses)
+			{
+				bone_pose[1].m[12] += 0.01F * static_cast<float>(pose);
+			}
+		}
+		Mesh source_mesh = scene.mesh;
+		source_mesh.content_key = transformer::mesh_content_key(source_mesh);
+
+		const auto run_frames = [&](SkinningCache* cache)
+		{
+			const MeshSkinner skinner(transformer::find_skinning_kernel({}), cache);
+			Profiler profiler;
+			Mesh skinned_mesh = source_mesh;
+			std::vector<double> run_microseconds;
+			for (std::size_t run = 0; run < options.runs; ++run)
+			{
+				skinner.skin(source_mesh, poses[run % kPoseCount], profiler, skinned_mesh);
+				run_microseconds.push_back(profiler.entries().back().microseconds);
+			}
+			return compute_bench_summary(run_microseconds);
+		};
+
+		const BenchSummary uncached = run_frames(nullptr);
+		SkinningCache palette_cache(std::size_t{1} << 20, false);
+		const BenchSummary palettes = run_frames(&palette_cache);
+		SkinningCache output_cache(kPoseCount * source_mesh.vertex_count * sizeof(transformer::Vec3) + (1 << 20), true);
+		const BenchSummary outputs = run_frames(&output_cache);
+
+		std::cout << "  \"skin_cache\": {\n"
+				  << "    \"vertices\": " << source_mesh.vertex_count << ",\n"
+				  << "    \"poses\": " << kPoseCount << ",\n"
+				  << "    \"uncached_median_microseconds\": " << uncached.median_microseconds << ",\n"
+				  << "    \"palettes_median_microseconds\": " << palettes.median_microseconds << ",\n"
+				  << "    \"outputs_median_microseconds\": " << outputs.median_microseconds << ",\n"
+				  << "    \"output_hits\": " << output_cache.stats().output_hits << ",\n"
+				  << "    \"output_speedup\": " << uncached.median_microseconds / outputs.median_microseconds << "\n"
+				  << "  }";
+	}
+
+	// Skinning with the vertex buffers on normal or huge pages, on one thread or split over --skin-threads
+	// threads that first-touched their part of the buffers. The mesh and its output copy are allocated
+	// after each configure_vertex_buffers() call, so they are placed by it.
+	void bench_vertex_buffers(const BenchOptions& options)
+	{
+		struct Variant
+		{
+			const char* name;
+			transformer::VertexBufferOptions buffers;
+		};
+		const Variant variants[] = {
+				{"small_pages", {.huge_pages = false, .threads = 1}},
+				{"huge_pages", {.huge_pages = true, .threads = 1}},
+				{"small_pages_threaded", {.huge_pages = false, .threads = options.skin_threads}},
+				{"huge_pages_threaded", {.huge_pages = true, .threads = options.skin_threads}},
+		};
+
+		std::cout << "  \"vertex_buffers\": {\n"
+				  << "    \"vertices\": " << options.vertex_count << ",\n"
+				  << "    \"skin_threads\": " << options.skin_threads << ",\n";
+		double baseline = 0.0;
+		for (const Variant& variant : variants)
+		{
+			transformer::configure_vertex_buffers(variant.buffers);
+			const transformer::VertexBufferCounts before = transformer::vertex_buffer_counts();
+			const SyntheticScene scene
+					= make_synthetic_scene(SyntheticMeshOptions{.vertex_count = options.vertex_count});
+			const BenchSummary summary = bench_skinning(scene.mesh, scene, options.runs);
+			const transformer::VertexBufferCounts after = transformer::vertex_buffer_counts();
+			if (baseline == 0.0)
+			{
+				baseline = summary.median_microseconds;
+			}
+
+			// Which pages the mesh and the skinned copy actually got; huge pages fall back silently.
+			std::cout << "    \"" << variant.name << "\": { \"median_microseconds\": " << summary.median_microseconds
+					  << ", \"speedup\": " << baseline / summary.median_microseconds
+					  << ", \"reserved_huge_page_bytes\": "
+					  << after.reserved_huge_page_bytes - before.reserved_huge_page_bytes
+					  << ", \"transparent_huge_page_bytes\": "
+					  << after.transparent_huge_page_bytes - before.transparent_huge_page_bytes
+					  << ", \"small_page_bytes\": " << after.small_page_bytes - before.small_page_bytes << " }"
+					  << (&variant != &variants[std::size(variants) - 1] ? ",\n" : "\n");
+		}
+		transformer::configure_vertex_buffers({});
+		std::cout << "  }";
+	}
+
+	// Writes the scene's weights in the layout JsonBoneWeightsReader expects.
+	void write_weights_json(const std::string& path, const Mesh& mesh)
+	{
+		std::ofstream output(path);
+		output.precision(9);
+		output << "{ \"vertices\": [\n";
+		for (std::size_t vertex = 0; vertex < mesh.vertex_count; ++vertex)
+		{
+			const transformer::VertexBoneWeights& weights = mesh.entries[vertex].bone_weights;
+			output << "  { \"bone_indices\": [";
+			for (std::size_t slot = 0; slot < 4; ++slot)
+			{
+				output << (slot == 0 ? "" : ", ") << static_cast<int>(weights.bone_indices[slot]);
+			}
+			output << "], \"weights\": [";
+			for (std::size_t slot = 0; slot < 4; ++slot)
+			{
+				output << (slot == 0 ? "" : ", ") << weights.weights[slot];
+			}
+			output << "] }" << (vertex + 1 < mesh.vertex_count ? ",\n" : "\n");
+		}
+		output << "] }\n";
+	}
+
+	// Median MB/s of read(path) over runs.
+	template <typename Read>
+	double megabytes_per_second(const std::string& path, std::size_t runs, Read&& read)
+	{
+		const auto bytes = static_cast<double>(std::filesystem::file_size(path));
+		std::vector<double> run_microseconds;
+		for (std::size_t run = 0; run < runs; ++run)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			read();
+			const auto end = std::chrono::steady_clock::now();
+			run_microseconds.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+		}
+		// Bytes per microsecond is MB/s.
+		return bytes / compute_bench_summary(run_microseconds).median_microseconds;
+	}
+
+	// Text parsing throughput of the scene written as OBJ and weights JSON: the readers end to end (split
+	// over threads for large files), and the numbers of the OBJ text alone through scan_float, strtof and
+	// istream >> float on one thread.
+	void bench_parsing(const BenchOptions& options)
+	{
+		const SyntheticScene scene = make_synthetic_scene(SyntheticMeshOptions{.vertex_count = options.vertex_count});
+		const std::filesystem::path directory = std::filesystem::temp_directory_path();
+		const std::string obj_path = (directory / "transformer_bench_mesh.obj").string();
+		const std::string weights_path = (directory / "transformer_bench_weights.json").string();
+		Profiler profiler;
+		transformer::ObjMeshWriter().write(obj_path, scene.mesh, profiler);
+		write_weights_json(weights_path, scene.mesh);
+
+		// Fewer runs: each one reads the whole file.
+		const std::size_t runs = std::max<std::size_t>(1, options.runs / 4);
+		const double obj_rate = megabytes_per_second(
+				obj_path, runs, [&] { (void)transformer::ObjMeshReader().read(obj_path, profiler); });
+		const double weights_rate = megabytes_per_second(
+				weights_path, runs, [&] { (void)transformer::JsonBoneWeightsReader().read(weights_path, profiler); });
+
+		// Only the vertex lines' numbers, space separated.
+		std::string numbers;
+		{
+			std::ifstream input(obj_path);
+			std::string line;
+			while (std::getline(input, line))
+			{
+				if (line.rfind("v ", 0) == 0)
+				{
+					numbers.append(line, 2).push_back(' ');
+				}
+			}
+		}
+		std::filesystem::remove(obj_path);
+		std::filesystem::remove(weights_path);
+
+		const auto number_rate = [&](auto&& parse_all)
+		{
+			float sum = 0.0F;
+			std::vector<double> run_microseconds;
+			for (std::size_t run = 0; run < runs; ++run)
+			{
+				const auto start = std::chrono::steady_clock::now();
+				sum += parse_all();
+				const auto end = std::chrono::steady_clock::now();
+				run_microseconds.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+			}
+			// Keeps the parse from being optimised away.
+			volatile float sink = sum;
+			(void)sink;
+			return static_cast<double>(numbers.size()) / compute_bench_summary(run_microseconds).median_microseconds;
+		};
+		const double scan_rate = number_rate(
+				[&]
+				{
+					float sum = 0.0F;
+					const char* cursor = numbers.data();
+					const char* last = numbers.data() + numbers.size();
+					float value = 0.0F;
+					while (cursor < last)
+					{
+						const char* end = transformer::scan_float(cursor, last, value);
+						sum += value;
+						cursor = end == nullptr ? cursor + 1 : end + 1;
+					}
+					return sum;
+				});
+		const double strtof_rate = number_rate(
+				[&]
+				{
+					float sum = 0.0F;
+					const char* cursor = numbers.c_str();
+					char* end = nullptr;
+					for (float value = std::strtof(cursor, &end); end != cursor; value = std::strtof(cursor, &end))
+					{
+						sum += value;
+						cursor = end;
+					}
+					return sum;
+				});
+		const double istream_rate = number_rate(
+				[&]
+				{
+					float sum = 0.0F;
+					std::istringstream input(numbers);
+					for (float value = 0.0F; input >> value;)
+					{
+						sum += value;
+					}
+					return sum;
+				});
+
+		std::cout << "  \"parsing\": {\n"
+				  << "    \"vertices\": " << scene.mesh.vertex_count << ",\n"
+				  << "    \"obj_mb_per_second\": " << obj_rate << ",\n"
+				  << "    \"weights_json_mb_per_second\": " << weights_rate << ",\n"
+				  << "    \"numbers_scan_float_mb_per_second\": " << scan_rate << ",\n"
+				  << "    \"numbers_strtof_mb_per_second\": " << strtof_rate << ",\n"
+				  << "    \"numbers_istream_mb_per_second\": " << istream_rate << "\n"
+				  << "  }";
+	}
+
+	// Writes one pose of the scene (0 = inverse bind, 1 = new) in the layout JsonBonePoseReader expects.
+	void write_pose_json(const std::string& path, const transformer::BonePoseData& bone_pose_data, std::size_t pose)
+	{
+		std::ofstream output(path);
+		output.precision(9);
+		output << "{ \"bones\": [\n";
+		for (std::size_t bone = 0; bone < bone_pose_data.bone_poses.size(); ++bone)
+		{
+			const transformer::Mat4& matrix = bone_pose_data.bone_poses[bone][pose];
+			output << "  { \"matrix\": [";
+			for (std::size_t i = 0; i < matrix.m.size(); ++i)
+			{
+				output << (i == 0 ? "" : ", ") << matrix.m[i];
+			}
+			output << "] }" << (bone + 1 < bone_pose_data.bone_poses.size() ? ",\n" : "\n");
+		}
+		output << "] }\n";
+	}
+
+	// One skinning call the way an engine tool pays for it: a `transformer` process reading the scene from
+	// files and writing the result, vs. the C API on buffers already in memory (palette built per call).
+	// Both on one thread.
+	void bench_embedding(const BenchOptions& options)
+	{
+		const SyntheticScene scene = make_synthetic_scene(SyntheticMeshOptions{.vertex_count = options.vertex_count});
+		const std::filesystem::path directory = std::filesystem::temp_directory_path();
+		const std::string obj_path = (directory / "transformer_bench_embed_mesh.obj").string();
+		const std::string weights_path = (directory / "transformer_bench_embed_weights.json").string();
+		const std::string inverse_bind_path = (directory / "transformer_bench_embed_inverse_bind.json").string();
+		const std::string new_pose_path = (directory / "transformer_bench_embed_new_pose.json").string();
+		const std::string output_path = (directory / "transformer_bench_embed_result.obj").string();
+		const std::string stats_path = (directory / "transformer_bench_embed_stats.json").string();
+		Profiler profiler;
+		transformer::ObjMeshWriter().write(obj_path, scene.mesh, profiler);
+		write_weights_json(weights_path, scene.mesh);
+		write_pose_json(inverse_bind_path, scene.bone_pose_data, 0);
+		write_pose_json(new_pose_path, scene.bone_pose_data, 1);
+
+#if defined(_WIN32)
+		const char* discard = " > NUL";
+#else
+		const char* discard = " > /dev/null";
+#endif
+		const std::string command = std::string("\"") + TRANSFORMER_CLI + "\" --mesh \"" + obj_path
+									+ "\" --bones-weights \"" + weights_path + "\" --inverse-bind-pose \""
+									+ inverse_bind_path + "\" --new-pose \"" + new_pose_path + "\" --output \""
+									+ output_path + "\" --stats \"" + stats_path + "\"" + discard;
+
+		// Fewer runs: each one parses and writes the whole mesh.
+		const std::size_t cli_runs = std::max<std::size_t>(1, options.runs / 4);
+		std::vector<double> cli_microseconds;
+		for (std::size_t run = 0; run < cli_runs; ++run)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			if (std::system(command.c_str()) != 0)
+			{
+				throw std::runtime_error("transformer failed: " + command);
+			}
+			const auto end = std::chrono::steady_clock::now();
+			cli_microseconds.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+		}
+		for (const std::string& path :
+			 {obj_path, weights_path, inverse_bind_path, new_pose_path, output_path, stats_path})
+		{
+			std::filesystem::remove(path);
+		}
+
+		// The engine's own buffers: vertices with weights, and the two poses as flat column-major matrices.
+		std::vector<transformer_vertex> vertices(scene.mesh.vertex_count);
+		for (std::size_t i = 0; i < vertices.size(); ++i)
+		{
+			const Mesh::Entry& entry = scene.mesh.entries[i];
+			vertices[i] = {{entry.vertex.x, entry.vertex.y, entry.vertex.z}, {}, {}};
+			std::copy(entry.bone_weights.bone_indices.begin(), entry.bone_weights.bone_indices.end(),
+					  vertices[i].bone_indices);
+			std::copy(entry.bone_weights.weights.begin(), entry.bone_weights.weights.end(), vertices[i].weights);
+		}
+		std::vector<transformer_vertex> result = vertices;
+		std::vector<float> inverse_bind_pose;
+		std::vector<float> new_pose;
+		for (const auto& bone_pose : scene.bone_pose_data.bone_poses)
+		{
+			inverse_bind_pose.insert(inverse_bind_pose.end(), bone_pose[0].m.begin(), bone_pose[0].m.end());
+			new_pose.insert(new_pose.end(), bone_pose[1].m.begin(), bone_pose[1].m.end());
+		}
+		std::vector<float> palette(TRANSFORMER_PALETTE_SIZE * 16);
+
+		transformer_skinner* skinner = nullptr;
+		if (transformer_skinner_create(nullptr, 1, &skinner) != TRANSFORMER_OK)
+		{
+			throw std::runtime_error(transformer_last_error());
+		}
+		std::vector<double> in_process_microseconds;
+		for (std::size_t run = 0; run < options.runs; ++run)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			const bool ok = transformer_build_palette(
+									inverse_bind_pose.data(), new_pose.data(), scene.bone_pose_data.bone_poses.size(),
+									palette.data())
+									== TRANSFORMER_OK
+							&& transformer_skin(
+									   skinner, palette.data(), vertices.data(), result.data(), vertices.size(),
+									   scene.mesh.max_influences)
+									   == TRANSFORMER_OK;
+			const auto end = std::chrono::steady_clock::now();
+			if (!ok)
+			{
+				transformer_skinner_destroy(skinner);
+				throw std::runtime_error(transformer_last_error());
+			}
+			in_process_microseconds.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+		}
+		transformer_skinner_destroy(skinner);
+
+		const BenchSummary cli = compute_bench_summary(cli_microseconds);
+		const BenchSummary in_process = compute_bench_summary(in_process_microseconds);
+		std::cout << "  \"embedding\": {\n"
+				  << "    \"vertices\": " << vertices.size() << ",\n"
+				  << "    \"cli_median_microseconds\": " << cli.median_microseconds << ",\n"
+				  << "    \"in_process_median_microseconds\": " << in_process.median_microseconds << ",\n"
+				  << "    \"speedup\": " << cli.median_microseconds / in_process.median_microseconds << "\n"
+				  << "  }";
+	}
+
+	// Writing the synthetic mesh as OBJ and loading the file back whole, per --async-io backend. The load
+	// touches one byte per page so a mapping pays for its page faults too.
+	void bench_async_io(const BenchOptions& options)
+	{
+		const SyntheticScene scene = make_synthetic_scene(SyntheticMeshOptions{.vertex_count = options.vertex_count});
+		const std::string path
+				= (std::filesystem::temp_directory_path() / "transformer_bench_async_io.obj").string();
+
+		std::vector<std::pair<const char*, transformer::AsyncIoBackend>> backends{
+				{"off", transformer::AsyncIoBackend::Off},
+				{"threads", transformer::AsyncIoBackend::Threads},
+		};
+		if (transformer::io_uring_available())
+		{
+			backends.emplace_back("uring", transformer::AsyncIoBackend::Uring);
+		}
+
+		const std::size_t runs = std::max<std::size_t>(1, options.runs / 4);
+		std::uintmax_t file_bytes = 0;
+		std::cout << "  \"async_io\": {\n";
+		for (std::size_t b = 0; b < backends.size(); ++b)
+		{
+			transformer::configure_async_io(backends[b].second);
+			std::vector<double> write_microseconds;
+			std::vector<double> load_microseconds;
+			for (std::size_t run = 0; run < runs; ++run)
+			{
+				Profiler profiler;
+				transformer::ObjMeshWriter().write(path, scene.mesh, profiler);
+				write_microseconds.push_back(profiler.entries().back().microseconds);
+
+				const auto start = std::chrono::steady_clock::now();
+				const transformer::InputFile file = transformer::load_input_file(path);
+				const std::string_view bytes = file.view();
+				std::size_t checksum = 0;
+				for (std::size_t i = 0; i < bytes.size(); i += 4096)
+				{
+					checksum += static_cast<unsigned char>(bytes[i]);
+				}
+				const auto end = std::chrono::steady_clock::now();
+				if (checksum == 0 && !bytes.empty())
+				{
+					throw std::runtime_error("async_io bench: unexpected file content");
+				}
+				load_microseconds.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+			}
+			file_bytes = std::filesystem::file_size(path);
+
+			const BenchSummary write = compute_bench_summary(write_microseconds);
+			const BenchSummary load = compute_bench_summary(load_microseconds);
+			std::cout << "    \"" << backends[b].first
+					  << "\": { \"write_obj_median_microseconds\": " << write.median_microseconds
+					  << ", \"load_median_microseconds\": " << load.median_microseconds << " },\n";
+		}
+		transformer::configure_async_io(transformer::AsyncIoBackend::Off);
+		std::filesystem::remove(path);
+		std::cout << "    \"file_bytes\": " << file_bytes << "\n  }";
+	}
+
+	bool parse_size(const char* value, std::size_t& out)
+	{
+		char* end = nullptr;
+		const unsigned long long parsed = std::strtoull(value, &end, 10);
+		if (end == value || *end != '\0' || parsed == 0)
+		{
+			return false;
+		}
+		out = static_cast<std::size_t>(parsed);
+		return true;
+	}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		std::size_t* target = nullptr;
+		if (arg == "--vertices")
+		{
+			target = &options.vertex_count;
+		}
+		else if (arg == "--runs")
+		{
+			target = &options.runs;
+		}
+		else if (arg == "--skin-threads")
+		{
+			target = &options.skin_threads;
+		}
+
+		if (target == nullptr || i + 1 >= argc || !parse_size(argv[++i], *target))
+		{
+			std::cerr << "Usage: " << argv[0] << " [--vertices <N>] [--runs <N>] [--skin-threads <N>]" << std::endl;
+			return 1;
+		}
+	}
+
+	try
+	{
+		std::cout.setf(std::ios::fixed);
+		std::cout.precision(3);
+		std::cout << "{\n";
+		bench_layout(options);
+		std::cout << ",\n";
+		bench_incremental(options);
+		std::cout << ",\n";
+		bench_morph(options);
+		std::cout << ",\n";
+		bench_bounds(options);
+		std::cout << ",\n";
+		bench_kernels(options);
+		std::cout << ",\n";
+		bench_skin_cache(options);
+		std::cout << ",\n";
+		bench_vertex_buffers(options);
+		std::cout << ",\n";
+		bench_parsing(options);
+		std::cout << ",\n";
+		bench_embedding(options);
+		std::cout << ",\n";
+		bench_async_io(options);
+		std::cout << "\n}\n";
+	}
+	catch (const std::exception& ex)
+	{
+		std::cerr << "Error: " << ex.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
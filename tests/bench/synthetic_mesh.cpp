@@ -0,0 +1,124 @@
+#include "synthetic_mesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace transformer::bench
+{
+
+	namespace
+	{
+
+		constexpr std::size_t kSegments = 64;
+		constexpr float kPi = 3.14159265358979323846F;
+
+		Mat4 make_transform(float angle_z, float translate_x, float translate_y)
+		{
+			const float c = std::cos(angle_z);
+			const float s = std::sin(angle_z);
+			// Column-major, one column per line.
+			return Mat4{{
+					c, s, 0.0F, 0.0F,  //
+					-s, c, 0.0F, 0.0F,  //
+					0.0F, 0.0F, 1.0F, 0.0F,  //
+					translate_x, translate_y, 0.0F, 1.0F,
+			}};
+		}
+
+	}  // namespace
+
+	SyntheticScene make_synthetic_scene(const SyntheticMeshOptions& options)
+	{
+		SyntheticScene scene;
+		Mesh& mesh = scene.mesh;
+
+		const std::size_t rings = std::max<std::size_t>(2, options.vertex_count / kSegments);
+		const std::size_t bone_count = std::clamp<std::size_t>(options.bone_count, 1, 255);
+		const float height = static_cast<float>(rings);
+
+		mesh.vertex_count = rings * kSegments;
+		mesh.entries.resize(mesh.vertex_count);
+		// Two bones per vertex, as validate_bone_weights() would find.
+		mesh.max_influences = 2;
+		for (std::size_t ring = 0; ring < rings; ++ring)
+		{
+			const float y = static_cast<float>(ring);
+			// Position along the bone chain, bones centred on equal-height sections.
+			const float bone_position = std::clamp(
+					y / height * static_cast<float>(bone_count) - 0.5F, 0.0F, static_cast<float>(bone_count - 1));
+			const auto lower_bone = static_cast<std::size_t>(bone_position);
+			const std::size_t upper_bone = std::min(lower_bone + 1, bone_count - 1);
+			const float upper_weight = bone_position - static_cast<float>(lower_bone);
+
+			for (std::size_t segment = 0; segment < kSegments; ++segment)
+			{
+				const float angle = 2.0F * kPi * static_cast<float>(segment) / static_cast<float>(kSegments);
+				Mesh::Entry& entry = mesh.entries[ring * kSegments + segment];
+				entry.vertex = {std::cos(angle), y, std::sin(angle)};
+				entry.bone_weights.bone_indices = {
+						static_cast<std::int8_t>(lower_bone), static_cast<std::int8_t>(upper_bone), -1, -1};
+				entry.bone_weights.weights = {1.0F - upper_weight, upper_weight, 0.0F, 0.0F};
+			}
+		}
+
+		for (std::size_t ring = 0; ring + 1 < rings; ++ring)
+		{
+			for (std::size_t segment = 0; segment < kSegments; ++segment)
+			{
+				const auto a = static_cast<std::uint32_t>(ring * kSegments + segment);
+				const auto b = static_cast<std::uint32_t>(ring * kSegments + (segment + 1) % kSegments);
+				const auto c = static_cast<std::uint32_t>(a + kSegments);
+				const auto d = static_cast<std::uint32_t>(b + kSegments);
+				mesh.indices.insert(mesh.indices.end(), {a, b, c, b, d, c});
+			}
+		}
+
+		if (options.shuffle)
+		{
+			std::mt19937 rng(options.seed);
+
+			std::vector<std::uint32_t> vertex_order(mesh.vertex_count);
+			std::iota(vertex_order.begin(), vertex_order.end(), 0U);
+			std::shuffle(vertex_order.begin(), vertex_order.end(), rng);
+
+			Mesh::Entries entries(mesh.vertex_count);
+			std::vector<std::uint32_t> new_position(mesh.vertex_count);
+			for (std::size_t i = 0; i < mesh.vertex_count; ++i)
+			{
+				entries[i] = mesh.entries[vertex_order[i]];
+				new_position[vertex_order[i]] = static_cast<std::uint32_t>(i);
+			}
+			mesh.entries = std::move(entries);
+
+			std::vector<std::uint32_t> triangle_order(mesh.indices.size() / 3);
+			std::iota(triangle_order.begin(), triangle_order.end(), 0U);
+			std::shuffle(triangle_order.begin(), triangle_order.end(), rng);
+
+			std::vector<std::uint32_t> indices(mesh.indices.size());
+			for (std::size_t t = 0; t < triangle_order.size(); ++t)
+			{
+				for (std::size_t corner = 0; corner < 3; ++corner)
+				{
+					indices[t * 3 + corner] = new_position[mesh.indices[triangle_order[t] * 3 + corner]];
+				}
+			}
+			mesh.indices = std::move(indices);
+		}
+
+		// Inverse bind: undo the bone's rest offset. New pose: bend the chain progressively around Z.
+		scene.bone_pose_data.bone_poses.resize(bone_count);
+		for (std::size_t bone = 0; bone < bone_count; ++bone)
+		{
+			const float rest_y = (static_cast<float>(bone) + 0.5F) * height / static_cast<float>(bone_count);
+			const float bend = 0.5F * static_cast<float>(bone) / static_cast<float>(bone_count);
+			scene.bone_pose_data.bone_poses[bone][0] = make_transform(0.0F, 0.0F, -rest_y);
+			scene.bone_pose_data.bone_poses[bone][1] = make_transform(bend, bend * rest_y, rest_y);
+		}
+
+		return scene;
+	}
+
+}  // namespace transformer::bench
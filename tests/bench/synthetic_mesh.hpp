@@ -0,0 +1,30 @@
+#pragma once
+
+#include "core/math_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace transformer::bench
+{
+
+	struct SyntheticMeshOptions
+	{
+		std::size_t vertex_count = 1000000;
+		std::size_t bone_count = 64;
+		// Shuffle vertex and triangle order, like assets exported without any layout care.
+		bool shuffle = true;
+		std::uint32_t seed = 42;
+	};
+
+	struct SyntheticScene
+	{
+		Mesh mesh;	// Bone weights already merged into entries.
+		BonePoseData bone_pose_data;
+	};
+
+	// Tube along Y with bones stacked along its height; every vertex blends its two nearest bones.
+	[[nodiscard]]
+	SyntheticScene make_synthetic_scene(const SyntheticMeshOptions& options);
+
+}  // namespace transformer::bench
@@ -0,0 +1,90 @@
+#include "core/work_stealing_pool.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using transformer::WorkStealingPool;
+
+namespace
+{
+
+	constexpr int kExitPassed = 0;
+	constexpr int kExitFailed = 1;
+	constexpr int kExitUsage = 2;
+
+	constexpr std::size_t kPoolThreads = 4;
+	constexpr std::size_t kSubmitters = 8;
+	constexpr std::size_t kNestedTasks = 2000;
+
+	// Each round, kSubmitters tasks each submit kNestedTasks tasks from inside the pool, the way a batch
+	// job submits its frames. When wait() returns, every task must have finished, submitters included.
+	bool check_nested_submission(std::size_t rounds)
+	{
+		// Declared before the pool, so tasks a failed round left running cannot outlive them.
+		std::atomic<std::size_t> submitters_running{0};
+		std::atomic<std::size_t> finished{0};
+		WorkStealingPool pool(kPoolThreads);
+		for (std::size_t round = 0; round < rounds; ++round)
+		{
+			finished.store(0);
+			for (std::size_t s = 0; s < kSubmitters; ++s)
+			{
+				pool.submit(
+						[&]
+						{
+							submitters_running.fetch_add(1);
+							for (std::size_t i = 0; i < kNestedTasks; ++i)
+							{
+								pool.submit([&] { finished.fetch_add(1); });
+							}
+							finished.fetch_add(1);
+							submitters_running.fetch_sub(1);
+						});
+			}
+			pool.wait();
+
+			const std::size_t running = submitters_running.load();
+			const std::size_t done = finished.load();
+			if (running != 0 || done != kSubmitters * (kNestedTasks + 1))
+			{
+				std::cerr << "Round " << round << ": wait() returned with " << running
+						  << " submitters still running and " << done << " of "
+						  << kSubmitters * (kNestedTasks + 1) << " tasks finished" << std::endl;
+				return false;
+			}
+		}
+		std::cout << "work_stealing_pool: " << rounds << " rounds passed" << std::endl;
+		return true;
+	}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+	std::size_t rounds = 300;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		char* end = nullptr;
+		if (arg == "--rounds" && i + 1 < argc && (rounds = std::strtoull(argv[++i], &end, 10)) != 0 && *end == '\0')
+		{
+			continue;
+		}
+		std::cerr << "Usage: " << argv[0] << " [--rounds <N>]" << std::endl;
+		return kExitUsage;
+	}
+
+	try
+	{
+		return check_nested_submission(rounds) ? kExitPassed : kExitFailed;
+	}
+	catch (const std::exception& ex)
+	{
+		std::cerr << "Error: " << ex.what() << std::endl;
+		return kExitUsage;
+	}
+}
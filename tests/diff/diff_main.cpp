@@ -0,0 +1,182 @@
+#include "kernel_differential.hpp"
+#include "mesh_diff.hpp"
+
+#include "core/profiler.hpp"
+#include "io/obj_io.hpp"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace transformer;
+using namespace transformer::diff;
+
+namespace
+{
+
+	constexpr int kExitPassed = 0;
+	constexpr int kExitFailed = 1;
+	constexpr int kExitUsage = 2;
+
+	constexpr const char* kUsage
+			= " <expected.obj> <actual.obj> [--abs <E>] [--rel <E>] [--ulp <N>]\n"
+			  "       transformer_diff --kernels [--vertices <N>] [--seed <N>] [--abs <E>] [--rel <E>] [--ulp <N>]\n"
+			  "       transformer_diff --api [--vertices <N>] [--seed <N>] [--threads <N>]";
+
+	bool parse_double(const char* value, double& out)
+	{
+		char* end = nullptr;
+		const double parsed = std::strtod(value, &end);
+		if (end == value || *end != '\0' || !(parsed >= 0.0))
+		{
+			return false;
+		}
+		out = parsed;
+		return true;
+	}
+
+	bool parse_unsigned(const char* value, std::uint64_t& out)
+	{
+		char* end = nullptr;
+		const unsigned long long parsed = std::strtoull(value, &end, 10);
+		if (end == value || *end != '\0')
+		{
+			return false;
+		}
+		out = parsed;
+		return true;
+	}
+
+	int diff_obj_files(const std::string& expected_file, const std::string& actual_file, const DiffTolerance& tolerance)
+	{
+		const ObjMeshReader reader;
+		Profiler profiler;
+		const Mesh expected = reader.read(expected_file, profiler);
+		const Mesh actual = reader.read(actual_file, profiler);
+		if (expected.vertex_count != actual.vertex_count)
+		{
+			std::cerr << "Vertex count differs: " << expected.vertex_count << " expected, " << actual.vertex_count
+					  << " actual" << std::endl;
+			return kExitFailed;
+		}
+
+		std::vector<Vec3> expected_positions;
+		std::vector<Vec3> actual_positions;
+		expected_positions.reserve(expected.vertex_count);
+		actual_positions.reserve(actual.vertex_count);
+		for (std::size_t i = 0; i < expected.vertex_count; ++i)
+		{
+			expected_positions.push_back(expected.entries[i].vertex);
+			actual_positions.push_back(actual.entries[i].vertex);
+		}
+		const DiffReport report
+				= diff_points(expected_positions.data(), actual_positions.data(), expected.vertex_count, tolerance);
+		// Skinning never moves faces, so they have to match exactly.
+		const bool faces_equal = expected.indices == actual.indices;
+
+		std::cout << "{\n  \"faces_equal\": " << (faces_equal ? "true" : "false") << ",\n  \"positions\": ";
+		write_report(std::cout, report, "  ");
+		std::cout << "\n}\n";
+		return report.passed() && faces_equal ? kExitPassed : kExitFailed;
+	}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+	bool kernels = false;
+	bool api = false;
+	std::size_t api_threads = 3;
+	bool tolerance_given = false;
+	DiffTolerance tolerance;
+	KernelDifferentialOptions kernel_options;
+	std::vector<std::string> files;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		const bool has_value = i + 1 < argc;
+		bool valid = true;
+		std::uint64_t number = 0;
+		if (arg == "--kernels")
+		{
+			kernels = true;
+		}
+		else if (arg == "--api")
+		{
+			api = true;
+		}
+		else if (arg == "--threads" && has_value)
+		{
+			valid = parse_unsigned(argv[++i], number) && number != 0;
+			api_threads = static_cast<std::size_t>(number);
+		}
+		else if (arg == "--abs" && has_value)
+		{
+			valid = parse_double(argv[++i], tolerance.absolute);
+			tolerance_given = true;
+		}
+		else if (arg == "--rel" && has_value)
+		{
+			valid = parse_double(argv[++i], tolerance.relative);
+			tolerance_given = true;
+		}
+		else if (arg == "--ulp" && has_value)
+		{
+			valid = parse_unsigned(argv[++i], tolerance.ulp);
+			tolerance_given = true;
+		}
+		else if (arg == "--vertices" && has_value)
+		{
+			valid = parse_unsigned(argv[++i], number) && number != 0;
+			kernel_options.vertex_count = static_cast<std::size_t>(number);
+		}
+		else if (arg == "--seed" && has_value)
+		{
+			valid = parse_unsigned(argv[++i], number);
+			kernel_options.seed = static_cast<std::uint32_t>(number);
+		}
+		else if (!arg.starts_with("--"))
+		{
+			files.push_back(arg);
+		}
+		else
+		{
+			valid = false;
+		}
+
+		if (!valid)
+		{
+			std::cerr << "Usage: " << argv[0] << kUsage << std::endl;
+			return kExitUsage;
+		}
+	}
+	if ((kernels && api) || (kernels || api ? !files.empty() : files.size() != 2))
+	{
+		std::cerr << "Usage: " << argv[0] << kUsage << std::endl;
+		return kExitUsage;
+	}
+
+	try
+	{
+		if (api)
+		{
+			return run_api_differential(kernel_options, api_threads, std::cout) ? kExitPassed : kExitFailed;
+		}
+		if (kernels)
+		{
+			if (tolerance_given)
+			{
+				kernel_options.fused_tolerance = tolerance;
+			}
+			return run_kernel_differential(kernel_options, std::cout) ? kExitPassed : kExitFailed;
+		}
+		return diff_obj_files(files[0], files[1], tolerance);
+	}
+	catch (const std::exception& ex)
+	{
+		std::cerr << "Error: " << ex.what() << std::endl;
+		return kExitUsage;
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "mesh_diff.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+
+namespace transformer::diff
+{
+
+	struct KernelDifferentialOptions
+	{
+		// Odd by default, so every vector loop runs its tail.
+		std::size_t vertex_count = 10007;
+		std::uint32_t seed = 42;
+		// Applied to the fused (_fma) kernels; deterministic kernels must match the scalar loop exactly.
+		// Unset: kFusedExtentEpsilons float epsilons of the largest skinned coordinate, absolute. Relative
+		// and ulp bounds do not fit: a fused sum that cancels to near zero keeps the error of its terms.
+		std::optional<DiffTolerance> fused_tolerance;
+	};
+
+	constexpr double kFusedExtentEpsilons = 4.0;
+
+	// Runs every SkinPolicy of every available kernel on randomized weights and morphed positions and
+	// compares positions and bounds with the scalar loop. Writes one JSON report to output; returns true if
+	// every kernel is within its tolerance.
+	bool run_kernel_differential(const KernelDifferentialOptions& options, std::ostream& output);
+
+	// Skins the synthetic tube with every available kernel through the C API (src/api/transformer.h), in
+	// place and split over api_threads threads, and compares it with MeshSkinner::skin on the same kernel
+	// in one piece, which has to match bit for bit. Returns true if all match.
+	bool run_api_differential(
+			const KernelDifferentialOptions& options, std::size_t api_threads, std::ostream& output);
+
+}  // namespace transformer::diff
@@ -0,0 +1,120 @@
+#include "mesh_diff.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <ostream>
+
+namespace transformer::diff
+{
+
+	namespace
+	{
+
+		// Maps float bits to integers in the same order as the floats, with +0 and -0 both 0.
+		std::int64_t ordered_bits(float value)
+		{
+			std::uint32_t bits = 0;
+			std::memcpy(&bits, &value, sizeof(bits));
+			const auto magnitude = static_cast<std::int64_t>(bits & 0x7FFFFFFFU);
+			return (bits & 0x80000000U) != 0 ? -magnitude : magnitude;
+		}
+
+		void widen_maximum(DiffMaximum& maximum, double value, std::size_t vertex, std::size_t axis)
+		{
+			if (value > maximum.value)
+			{
+				maximum = {value, vertex, axis};
+			}
+		}
+
+		void write_maximum(std::ostream& output, const char* name, const DiffMaximum& maximum)
+		{
+			static constexpr char kAxes[] = "xyz";
+			output << '"' << name << "\": { \"value\": " << maximum.value << ", \"vertex\": " << maximum.vertex
+				   << ", \"axis\": \"" << kAxes[maximum.axis] << "\" }";
+		}
+
+	}  // namespace
+
+	std::uint64_t ulp_distance(float a, float b)
+	{
+		if (std::isnan(a) || std::isnan(b))
+		{
+			return std::isnan(a) && std::isnan(b) ? 0 : std::numeric_limits<std::uint64_t>::max();
+		}
+		const std::int64_t distance = ordered_bits(a) - ordered_bits(b);
+		return static_cast<std::uint64_t>(distance < 0 ? -distance : distance);
+	}
+
+	DiffReport diff_points(const Vec3* expected, const Vec3* actual, std::size_t count, const DiffTolerance& tolerance)
+	{
+		DiffReport report;
+		report.vertices = count;
+		for (std::size_t vertex = 0; vertex < count; ++vertex)
+		{
+			const float expected_axes[3] = {expected[vertex].x, expected[vertex].y, expected[vertex].z};
+			const float actual_axes[3] = {actual[vertex].x, actual[vertex].y, actual[vertex].z};
+			bool differs = false;
+			bool fails = false;
+			for (std::size_t axis = 0; axis < 3; ++axis)
+			{
+				const float e = expected_axes[axis];
+				const float a = actual_axes[axis];
+				const std::uint64_t ulp = ulp_distance(e, a);
+				if (ulp == 0)
+				{
+					continue;
+				}
+				differs = true;
+
+				const double absolute = std::abs(static_cast<double>(a) - static_cast<double>(e));
+				const double magnitude = std::max(std::abs(static_cast<double>(a)), std::abs(static_cast<double>(e)));
+				const double relative = magnitude == 0.0 ? 0.0 : absolute / magnitude;
+				// NaN against a number: the distances above are NaN, which no tolerance accepts.
+				const bool within = absolute <= tolerance.absolute || relative <= tolerance.relative
+									|| ulp <= tolerance.ulp;
+				fails = fails || !within;
+
+				widen_maximum(report.max_absolute, std::isnan(absolute) ? HUGE_VAL : absolute, vertex, axis);
+				widen_maximum(report.max_relative, std::isnan(relative) ? HUGE_VAL : relative, vertex, axis);
+				widen_maximum(report.max_ulp, static_cast<double>(ulp), vertex, axis);
+			}
+			report.differing_vertices += differs ? 1 : 0;
+			report.failing_vertices += fails ? 1 : 0;
+		}
+		return report;
+	}
+
+	void merge_report(DiffReport& report, const DiffReport& other)
+	{
+		for (auto maximum : {&DiffReport::max_absolute, &DiffReport::max_relative, &DiffReport::max_ulp})
+		{
+			if ((other.*maximum).value > (report.*maximum).value)
+			{
+				report.*maximum = other.*maximum;
+			}
+		}
+		report.vertices += other.vertices;
+		report.differing_vertices += other.differing_vertices;
+		report.failing_vertices += other.failing_vertices;
+	}
+
+	void write_report(std::ostream& output, const DiffReport& report, const char* indent)
+	{
+		output << "{\n"
+			   << indent << "  \"passed\": " << (report.passed() ? "true" : "false") << ",\n"
+			   << indent << "  \"vertices\": " << report.vertices << ",\n"
+			   << indent << "  \"differing_vertices\": " << report.differing_vertices << ",\n"
+			   << indent << "  \"failing_vertices\": " << report.failing_vertices << ",\n"
+			   << indent << "  ";
+		write_maximum(output, "max_absolute_error", report.max_absolute);
+		output << ",\n" << indent << "  ";
+		write_maximum(output, "max_relative_error", report.max_relative);
+		output << ",\n" << indent << "  ";
+		write_maximum(output, "max_ulp", report.max_ulp);
+		output << "\n" << indent << "}";
+	}
+
+}  // namespace transformer::diff
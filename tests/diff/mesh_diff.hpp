@@ -0,0 +1,64 @@
+#pragma once
+
+#include "core/math_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+namespace transformer::diff
+{
+
+	// A coordinate passes if it is within any one of the three; all zero means bit-exact (+0 and -0 equal).
+	struct DiffTolerance
+	{
+		double absolute = 0.0;
+		// Of the larger magnitude of the two values.
+		double relative = 0.0;
+		// Representable floats between the two values.
+		std::uint64_t ulp = 0;
+	};
+
+	// Largest error of one kind and where it is.
+	struct DiffMaximum
+	{
+		double value = 0.0;
+		std::size_t vertex = 0;
+		// 0, 1, 2 for x, y, z.
+		std::size_t axis = 0;
+	};
+
+	struct DiffReport
+	{
+		std::size_t vertices = 0;
+		// Vertices with any coordinate that is not bit-identical.
+		std::size_t differing_vertices = 0;
+		// Vertices with any coordinate out of tolerance.
+		std::size_t failing_vertices = 0;
+		DiffMaximum max_absolute;
+		DiffMaximum max_relative;
+		DiffMaximum max_ulp;
+
+		[[nodiscard]]
+		bool passed() const
+		{
+			return failing_vertices == 0;
+		}
+	};
+
+	// Distance in units in the last place between two floats; NaN against anything else is the maximum.
+	[[nodiscard]]
+	std::uint64_t ulp_distance(float a, float b);
+
+	// Compares count points of each, coordinate by coordinate.
+	[[nodiscard]]
+	DiffReport diff_points(const Vec3* expected, const Vec3* actual, std::size_t count, const DiffTolerance& tolerance);
+
+	// Adds other's counts to report and keeps the larger of each maximum; a maximum's vertex stays the index
+	// in the comparison it came from.
+	void merge_report(DiffReport& report, const DiffReport& other);
+
+	// One JSON object, no trailing newline; indent is prepended to every line after the first.
+	void write_report(std::ostream& output, const DiffReport& report, const char* indent);
+
+}  // namespace transformer::diff
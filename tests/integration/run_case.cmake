@@ -47,20 +47,59 @@ foreach(raw_line IN LISTS CASE_PARAMS)
         set(INVERSE_BIND_POSE_FILE "${CASE_DIR}/${value}")
     elseif(key STREQUAL "new_pose")
         set(NEW_POSE_FILE "${CASE_DIR}/${value}")
+    elseif(key STREQUAL "manifest")
+        set(MANIFEST_FILE "${CASE_DIR}/${value}")
     elseif(key STREQUAL "expected_output")
         set(EXPECTED_OUTPUT_FILE "${CASE_DIR}/${value}")
+    elseif(key STREQUAL "compared_output")
+        # File of the case output directory compared with expected_output instead of result_mesh.obj,
+        # e.g. result_mesh_1.obj for the second frame of a multi-frame run.
+        set(COMPARED_OUTPUT_NAME "${value}")
+    elseif(key STREQUAL "args")
+        # Extra transformer options for this case, e.g. args=--optimize-layout. Relative paths in them
+        # resolve against the case directory.
+        separate_arguments(EXTRA_ARGS UNIX_COMMAND "${value}")
+    elseif(key STREQUAL "tolerance")
+        # transformer_diff tolerance options, e.g. tolerance=--rel 1e-5 --abs 1e-6: positions are compared
+        # per coordinate within them (faces exactly) instead of byte for byte.
+        separate_arguments(TOLERANCE_ARGS UNIX_COMMAND "${value}")
+        set(COMPARE_WITH_TOLERANCE TRUE)
+    elseif(key STREQUAL "repeat")
+        # repeat=N runs on N copies of the mesh vertices (faces dropped), the weights array and the
+        # expected output's vertices: a mesh N times larger whose expected output needs no new golden file.
+        set(REPEAT_COUNT "${value}")
+    elseif(key STREQUAL "expected_error")
+        # The run must fail with this text in its error output; there is no output to compare.
+        set(EXPECTED_ERROR "${value}")
+    elseif(key STREQUAL "mode")
+        # mode=service: start `transformer --serve` and run the case through `--client` against it
+        # mode=jobs: run `transformer --jobs <manifest>` with the case output directory as --output; the
+        # job whose output is result_mesh.obj is compared
+        if(NOT value STREQUAL "service" AND NOT value STREQUAL "jobs")
+            message(FATAL_ERROR "Unknown mode '${value}' in params file: ${PARAMS_FILE}")
+        endif()
+        set(CASE_MODE "${value}")
     else()
         message(FATAL_ERROR "Unknown key '${key}' in params file: ${PARAMS_FILE}")
     endif()
 endforeach()
 
-set(REQUIRED_VARS
-    MESH_FILE
-    WEIGHTS_FILE
-    INVERSE_BIND_POSE_FILE
-    NEW_POSE_FILE
-    EXPECTED_OUTPUT_FILE
-)
+if(CASE_MODE STREQUAL "jobs")
+    set(REQUIRED_VARS
+        MANIFEST_FILE
+        EXPECTED_OUTPUT_FILE
+    )
+else()
+    set(REQUIRED_VARS
+        MESH_FILE
+        WEIGHTS_FILE
+        INVERSE_BIND_POSE_FILE
+        NEW_POSE_FILE
+    )
+endif()
+if(NOT DEFINED EXPECTED_ERROR)
+    list(APPEND REQUIRED_VARS EXPECTED_OUTPUT_FILE)
+endif()
 
 foreach(required_var IN LISTS REQUIRED_VARS)
     if(NOT DEFINED ${required_var})
@@ -77,39 +116,158 @@ endif()
 set(CASE_OUTPUT_DIR "${_integration_output_root}/${CASE_NAME}")
 file(MAKE_DIRECTORY "${CASE_OUTPUT_DIR}")
 
-set(ACTUAL_OUTPUT_FILE "${CASE_OUTPUT_DIR}/result_mesh.obj")
+set(OUTPUT_FILE "${CASE_OUTPUT_DIR}/result_mesh.obj")
+if(DEFINED COMPARED_OUTPUT_NAME)
+    set(ACTUAL_OUTPUT_FILE "${CASE_OUTPUT_DIR}/${COMPARED_OUTPUT_NAME}")
+else()
+    set(ACTUAL_OUTPUT_FILE "${OUTPUT_FILE}")
+endif()
 set(STATS_FILE "${CASE_OUTPUT_DIR}/stats.json")
 
+if(DEFINED REPEAT_COUNT)
+    # Only vertex lines: faces would need their indices offset in every copy.
+    file(STRINGS "${MESH_FILE}" _mesh_vertices REGEX "^v ")
+    string(JOIN "\n" _mesh_vertices ${_mesh_vertices})
+    string(REPEAT "${_mesh_vertices}\n" ${REPEAT_COUNT} _repeated)
+    set(MESH_FILE "${CASE_OUTPUT_DIR}/repeated_mesh.obj")
+    file(WRITE "${MESH_FILE}" "${_repeated}")
+
+    file(READ "${WEIGHTS_FILE}" _weights)
+    string(STRIP "${_weights}" _weights)
+    string(LENGTH "${_weights}" _weights_length)
+    math(EXPR _last_index "${_weights_length} - 1")
+    string(SUBSTRING "${_weights}" 0 1 _first)
+    string(SUBSTRING "${_weights}" ${_last_index} 1 _last)
+    if(NOT _first STREQUAL "[" OR NOT _last STREQUAL "]")
+        message(FATAL_ERROR "repeat needs a weights file whose root is the vertex array: ${WEIGHTS_FILE}")
+    endif()
+    math(EXPR _body_length "${_weights_length} - 2")
+    string(SUBSTRING "${_weights}" 1 ${_body_length} _weights)
+    math(EXPR _leading_copies "${REPEAT_COUNT} - 1")
+    string(REPEAT "${_weights}," ${_leading_copies} _repeated)
+    set(WEIGHTS_FILE "${CASE_OUTPUT_DIR}/repeated_weights.json")
+    file(WRITE "${WEIGHTS_FILE}" "[${_repeated}${_weights}]")
+
+    file(STRINGS "${EXPECTED_OUTPUT_FILE}" _expected_comments REGEX "^#")
+    file(STRINGS "${EXPECTED_OUTPUT_FILE}" _expected_vertices REGEX "^v ")
+    string(JOIN "\n" _expected_comments ${_expected_comments})
+    string(JOIN "\n" _expected_vertices ${_expected_vertices})
+    string(REPEAT "${_expected_vertices}\n" ${REPEAT_COUNT} _repeated)
+    set(EXPECTED_OUTPUT_FILE "${CASE_OUTPUT_DIR}/repeated_expected.obj")
+    file(WRITE "${EXPECTED_OUTPUT_FILE}" "${_expected_comments}\n${_repeated}")
+endif()
+
+if(DEFINED EXPECTED_ERROR)
+    set(_capture_error ERROR_VARIABLE APP_ERROR_OUTPUT)
+endif()
+
 # Record start time
 string(TIMESTAMP _start_iso "%Y-%m-%dT%H:%M:%S%z")
 string(TIMESTAMP _start_epoch "%s")
 
-execute_process(
-    COMMAND "${TRANSFORMER_BIN}"
-        --mesh "${MESH_FILE}"
-        --bones-weights "${WEIGHTS_FILE}"
-        --inverse-bind-pose "${INVERSE_BIND_POSE_FILE}"
-        --new-pose "${NEW_POSE_FILE}"
-        --output "${ACTUAL_OUTPUT_FILE}"
-        --stats "${STATS_FILE}"
-    RESULT_VARIABLE APP_EXIT_CODE
-)
+if(CASE_MODE STREQUAL "service")
+    if(WIN32)
+        message(STATUS "Case '${CASE_NAME}' skipped: the skinning service needs Unix domain sockets")
+        return()
+    endif()
+
+    # sun_path is limited to ~100 bytes, so keep the socket out of the (possibly deep) build tree.
+    string(RANDOM LENGTH 8 _socket_suffix)
+    set(SERVICE_SOCKET "/tmp/transformer-${CASE_NAME}-${_socket_suffix}.sock")
+
+    # Commands of one execute_process run concurrently; the client retries until the server listens.
+    execute_process(
+        COMMAND "${TRANSFORMER_BIN}" --serve "${SERVICE_SOCKET}"
+        COMMAND "${TRANSFORMER_BIN}"
+            --client "${SERVICE_SOCKET}"
+            --mesh "${MESH_FILE}"
+            --bones-weights "${WEIGHTS_FILE}"
+            --inverse-bind-pose "${INVERSE_BIND_POSE_FILE}"
+            --new-pose "${NEW_POSE_FILE}"
+            --output "${OUTPUT_FILE}"
+            --stats "${STATS_FILE}"
+            ${EXTRA_ARGS}
+        WORKING_DIRECTORY "${CASE_DIR}"
+        RESULTS_VARIABLE _service_exit_codes
+        TIMEOUT 60
+        ${_capture_error}
+    )
+    file(REMOVE "${SERVICE_SOCKET}")
+
+    set(APP_EXIT_CODE 0)
+    foreach(_code IN LISTS _service_exit_codes)
+        if(NOT _code EQUAL 0)
+            set(APP_EXIT_CODE "${_code}")
+        endif()
+    endforeach()
+elseif(CASE_MODE STREQUAL "jobs")
+    execute_process(
+        COMMAND "${TRANSFORMER_BIN}"
+            --jobs "${MANIFEST_FILE}"
+            --output "${CASE_OUTPUT_DIR}"
+            --stats "${STATS_FILE}"
+            ${EXTRA_ARGS}
+        WORKING_DIRECTORY "${CASE_DIR}"
+        RESULT_VARIABLE APP_EXIT_CODE
+        ${_capture_error}
+    )
+else()
+    execute_process(
+        COMMAND "${TRANSFORMER_BIN}"
+            --mesh "${MESH_FILE}"
+            --bones-weights "${WEIGHTS_FILE}"
+            --inverse-bind-pose "${INVERSE_BIND_POSE_FILE}"
+            --new-pose "${NEW_POSE_FILE}"
+            --output "${OUTPUT_FILE}"
+            --stats "${STATS_FILE}"
+            ${EXTRA_ARGS}
+        WORKING_DIRECTORY "${CASE_DIR}"
+        RESULT_VARIABLE APP_EXIT_CODE
+        ${_capture_error}
+    )
+endif()
 
 # Record end time and duration (seconds)
 string(TIMESTAMP _end_iso "%Y-%m-%dT%H:%M:%S%z")
 string(TIMESTAMP _end_epoch "%s")
 math(EXPR _duration_seconds "${_end_epoch} - ${_start_epoch}")
 
+if(DEFINED EXPECTED_ERROR)
+    string(FIND "${APP_ERROR_OUTPUT}" "${EXPECTED_ERROR}" _error_pos)
+    if(APP_EXIT_CODE EQUAL 0 OR _error_pos EQUAL -1)
+        message(FATAL_ERROR "Case '${CASE_NAME}' failed: expected an error containing '${EXPECTED_ERROR}'\nExit code: ${APP_EXIT_CODE}\nError output: ${APP_ERROR_OUTPUT}")
+    endif()
+    message(STATUS "Case '${CASE_NAME}' succeeded: failed with the expected error")
+    return()
+endif()
+
 if(NOT APP_EXIT_CODE EQUAL 0)
     message(FATAL_ERROR "Case '${CASE_NAME}' failed: transformer exited with code ${APP_EXIT_CODE}")
 endif()
 
-execute_process(
-    COMMAND "${CMAKE_COMMAND}" -E compare_files
-        "${EXPECTED_OUTPUT_FILE}"
-        "${ACTUAL_OUTPUT_FILE}"
-    RESULT_VARIABLE COMPARE_EXIT_CODE
-)
+if(COMPARE_WITH_TOLERANCE)
+    if(NOT DIFF_BIN)
+        message(FATAL_ERROR "Case '${CASE_NAME}' has a tolerance but transformer_diff is not built")
+    endif()
+    execute_process(
+        COMMAND "${DIFF_BIN}" "${EXPECTED_OUTPUT_FILE}" "${ACTUAL_OUTPUT_FILE}" ${TOLERANCE_ARGS}
+        RESULT_VARIABLE COMPARE_EXIT_CODE
+        OUTPUT_VARIABLE _diff_report
+        ERROR_VARIABLE _diff_error
+    )
+    if(NOT COMPARE_EXIT_CODE EQUAL 0)
+        # The line-by-line search below would only find the first (tolerated or not) rounding difference.
+        file(WRITE "${STATS_FILE}" "${_diff_report}")
+        message(FATAL_ERROR "Case '${CASE_NAME}' failed: output mesh is out of tolerance\nExpected: ${EXPECTED_OUTPUT_FILE}\nActual:   ${ACTUAL_OUTPUT_FILE}\n${_diff_error}${_diff_report}")
+    endif()
+else()
+    execute_process(
+        COMMAND "${CMAKE_COMMAND}" -E compare_files
+            "${EXPECTED_OUTPUT_FILE}"
+            "${ACTUAL_OUTPUT_FILE}"
+        RESULT_VARIABLE COMPARE_EXIT_CODE
+    )
+endif()
 
 # On success, write enriched stats for performance analysis
 if(COMPARE_EXIT_CODE EQUAL 0)
@@ -153,7 +311,7 @@ if(COMPARE_EXIT_CODE EQUAL 0)
             endif()
         endif()
         if(EXISTS "/proc/cpuinfo")
-            execute_process(COMMAND bash -c "grep 'model name' /proc/cpuinfo | head -n1 | cut -d: -f2 | sed 's/^\s*//'" OUTPUT_VARIABLE _tmp_cpu OUTPUT_STRIP_TRAILING_WHITESPACE)
+            execute_process(COMMAND bash -c "grep 'model name' /proc/cpuinfo | head -n1 | cut -d: -f2 | sed 's/^[[:space:]]*//'" OUTPUT_VARIABLE _tmp_cpu OUTPUT_STRIP_TRAILING_WHITESPACE)
             if(_tmp_cpu)
                 set(_cpu_model "${_tmp_cpu}")
             endif()